@@ -217,7 +217,7 @@ void b196167f_reset(ListArray *listArray) {
 }
 
 void b196167f_sort(ListArray *listArray, int compare(void *a, void *b)) {
-	if (listArray->length > 0) {
+	if (listArray->length > 1) {
 		b33b0483_sortPtrArray(listArray->values, 0, listArray->length-1, compare);
 	}
 }
@@ -0,0 +1,1191 @@
+/*
+ * deflate.c - DevOpsBroker C source file for the org.devopsbroker.compress.Deflate struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The match finder and the greedy/lazy evaluation follow the classic zlib
+ * design so the levels are comparable. The Huffman code lengths are computed
+ * with the in-place algorithm of Moffat and Katajainen and then limited to
+ * the maximum code length by adjusting the length counts.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "deflate.h"
+#include "bits.h"
+
+#include "../hash/crc32.h"
+#include "../lang/memory.h"
+#include "../memory/slabpool.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define WINDOW_MASK        (DEFLATE_WINDOW_SIZE - 1)
+#define WINDOW_BUF_SIZE    (DEFLATE_WINDOW_SIZE * 2)
+#define WINDOW_BUF_SLACK   16
+
+#define HASH_BITS          15
+#define HASH_SIZE          (1 << HASH_BITS)
+
+#define MIN_MATCH          3
+#define MAX_MATCH          258
+#define MIN_LOOKAHEAD      (MAX_MATCH + MIN_MATCH + 1)
+#define MAX_DIST           (DEFLATE_WINDOW_SIZE - MIN_LOOKAHEAD)
+#define TOO_FAR            4096
+
+#define SYMBOL_LIST_SIZE   16384
+#define SPLIT_INTERVAL     4096
+#define SPLIT_BLOCK_COST   1024
+
+#define STORED_MAX_LENGTH  65535
+
+#define LITLEN_EOB         256
+#define LITLEN_TBL_OFFSET  257
+#define NUM_FIXED_LITLENS  288
+#define NUM_CODELENS       19
+
+#define MAX_CODE_LENGTH     15
+#define MAX_CODELEN_LENGTH  7
+
+#define CODELEN_COPY       16
+#define CODELEN_ZEROS      17
+#define CODELEN_ZEROS2     18
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+/*
+ * Match parameters for each compression level; the same values as zlib
+ *   - Reduce the hash chain search if the previous match is at least this long
+ *   - Do not look for a lazy match if the previous match is at least this long;
+ *     for greedy levels the longest match whose strings are all hashed
+ *   - Stop searching once a match of this length is found
+ *   - Maximum number of hash chain links to follow
+ */
+typedef struct DeflateConfig {
+	uint16_t goodLength;
+	uint16_t maxLazy;
+	uint16_t niceLength;
+	uint16_t maxChain;
+	bool     isLazy;
+} DeflateConfig;
+
+/*
+ * Huffman tree leaf used to sort the symbols by frequency
+ */
+typedef struct SymbolFreq {
+	uint32_t freq;
+	uint32_t symbol;
+} SymbolFreq;
+
+/*
+ * Huffman code for a symbol, bit-reversed for the LSB-first bit stream
+ */
+typedef struct HuffmanCode {
+	uint16_t code;
+	uint16_t length;
+} HuffmanCode;
+
+static_assert(sizeof(HuffmanCode) == 4, "Check your assumptions");
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+static const DeflateConfig configTable[DEFLATE_MAX_LEVEL + 1] = {
+	{  0,   0,   0,    0, false },    // 0 - stored
+	{  4,   4,   8,    4, false },    // 1
+	{  4,   5,  16,    8, false },    // 2
+	{  4,   6,  32,   32, false },    // 3
+	{  4,   4,  16,   16, true  },    // 4
+	{  8,  16,  32,   32, true  },    // 5
+	{  8,  16, 128,  128, true  },    // 6
+	{  8,  32, 128,  256, true  },    // 7
+	{ 32, 128, 258, 1024, true  },    // 8
+	{ 32, 258, 258, 4096, true  }     // 9
+};
+
+static const uint8_t codelenLengthsOrder[NUM_CODELENS] =
+{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static uint32_t fillWindow(Deflate *deflate, uint8_t *input, uint32_t length);
+static void slideWindow(Deflate *deflate);
+static inline uint32_t insertString(Deflate *deflate, uint32_t position);
+
+static void compressStored(Deflate *deflate);
+static void compressGreedy(Deflate *deflate, bool flush);
+static void compressLazy(Deflate *deflate, bool flush);
+static uint32_t longestMatch(Deflate *deflate, uint32_t curMatch);
+
+static void tallyLiteral(Deflate *deflate, uint32_t literal, uint32_t inputEnd);
+static void tallyMatch(Deflate *deflate, uint32_t dist, uint32_t length, uint32_t inputEnd);
+static void checkBlockSplit(Deflate *deflate, uint32_t inputEnd);
+static void resetBlock(Deflate *deflate, uint32_t inputEnd);
+static float estimateCost(uint32_t *freqList, uint32_t numFreqs);
+
+static void emitBlock(Deflate *deflate, uint32_t numSymbols, uint32_t *litlenFreq, uint32_t *distFreq,
+                      int64_t blockStart, int64_t blockEnd, bool isFinal);
+static void emitStoredBlocks(Deflate *deflate, uint8_t *data, uint32_t length, bool isFinal);
+static void emitSymbols(Deflate *deflate, uint32_t numSymbols, HuffmanCode *litlenCodes, HuffmanCode *distCodes);
+
+static void buildCodeLengths(uint32_t *freqList, uint32_t numSymbols, uint32_t maxLength, uint8_t *lengthList);
+static void buildCodes(uint8_t *lengthList, uint32_t numSymbols, HuffmanCode *codeList);
+static int compareSymbolFreq(const void *first, const void *second);
+
+static void putBits(Deflate *deflate, uint64_t value, uint32_t numBits);
+static void alignBits(Deflate *deflate);
+static void writeByte(Deflate *deflate, uint8_t value);
+static void writeData(Deflate *deflate, uint8_t *data, uint32_t length);
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
+
+Deflate *a8a82d35_createDeflate(int level, OutputBuffer *outputBuffer) {
+	Deflate *deflate = f668c4bd_malloc(sizeof(Deflate));
+
+	a8a82d35_initDeflate(deflate, level, outputBuffer);
+
+	return deflate;
+}
+
+void a8a82d35_destroyDeflate(Deflate *deflate) {
+	a8a82d35_cleanUpDeflate(deflate);
+	f668c4bd_free(deflate);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void a8a82d35_cleanUpDeflate(Deflate *deflate) {
+	f668c4bd_free(deflate->window);
+	f668c4bd_free(deflate->hashHead);
+	f668c4bd_free(deflate->hashPrev);
+	f668c4bd_free(deflate->symbolList);
+}
+
+void a8a82d35_initDeflate(Deflate *deflate, int level, OutputBuffer *outputBuffer) {
+	const DeflateConfig *config;
+
+	// 1. Clamp the compression level and load its match parameters
+	if (level < DEFLATE_MIN_LEVEL) {
+		level = DEFLATE_DEFAULT_LEVEL;
+	} else if (level > DEFLATE_MAX_LEVEL) {
+		level = DEFLATE_MAX_LEVEL;
+	}
+
+	config = &configTable[level];
+	deflate->level = level;
+	deflate->goodLength = config->goodLength;
+	deflate->maxLazy = config->maxLazy;
+	deflate->niceLength = config->niceLength;
+	deflate->maxChain = config->maxChain;
+	deflate->isLazy = config->isLazy;
+
+	// 2. Allocate the window, hash chains and symbol list
+	deflate->window = f668c4bd_malloc(WINDOW_BUF_SIZE + WINDOW_BUF_SLACK);
+	deflate->hashHead = f668c4bd_mallocArray(sizeof(uint16_t), HASH_SIZE);
+	deflate->hashPrev = f668c4bd_mallocArray(sizeof(uint16_t), DEFLATE_WINDOW_SIZE);
+	deflate->symbolList = f668c4bd_mallocArray(sizeof(uint32_t), SYMBOL_LIST_SIZE);
+
+	f668c4bd_meminit(deflate->window, WINDOW_BUF_SIZE + WINDOW_BUF_SLACK);
+	f668c4bd_meminit(deflate->hashPrev, sizeof(uint16_t) * DEFLATE_WINDOW_SIZE);
+
+	// 3. Initialize the stream state
+	a8a82d35_resetDeflate(deflate, outputBuffer);
+}
+
+void a8a82d35_resetDeflate(Deflate *deflate, OutputBuffer *outputBuffer) {
+	f668c4bd_meminit(deflate->hashHead, sizeof(uint16_t) * HASH_SIZE);
+
+	deflate->outputBuffer = outputBuffer;
+	deflate->bitBuffer = 0;
+	deflate->bitCount = 0;
+	deflate->totalIn = 0;
+	deflate->totalOut = 0;
+	deflate->crc32 = 0;
+
+	deflate->strStart = 0;
+	deflate->lookahead = 0;
+	deflate->matchStart = 0;
+	deflate->matchLength = MIN_MATCH - 1;
+	deflate->prevMatch = 0;
+	deflate->prevLength = MIN_MATCH - 1;
+	deflate->isMatchAvailable = false;
+	deflate->isFinished = false;
+
+	resetBlock(deflate, 0);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void a8a82d35_deflate(Deflate *deflate, void *input, uint32_t length, bool isFinal) {
+	uint8_t *inputPtr;
+	uint32_t numBytes;
+	bool flush;
+
+	if (deflate->isFinished) {
+		return;
+	}
+
+	// 1. Checksum the input while it is still in the cache
+	if (length > 0) {
+		deflate->crc32 = b7e0468d_crc32(input, length, deflate->crc32);
+		deflate->totalIn += length;
+	}
+
+	inputPtr = input;
+
+	do {
+		// 2. Copy as much input as fits into the window
+		numBytes = fillWindow(deflate, inputPtr, length);
+		inputPtr += numBytes;
+		length -= numBytes;
+
+		// 3. Compress the window; all of it once the last input is in
+		flush = (isFinal && length == 0);
+
+		if (deflate->level == 0) {
+			compressStored(deflate);
+		} else if (deflate->isLazy) {
+			compressLazy(deflate, flush);
+		} else {
+			compressGreedy(deflate, flush);
+		}
+	} while (length > 0);
+
+	// 4. Emit the final block and pad the stream to a byte boundary
+	if (isFinal) {
+		if (deflate->level == 0) {
+			emitStoredBlocks(deflate, deflate->window + deflate->blockStart, deflate->strStart - deflate->blockStart, true);
+		} else {
+			emitBlock(deflate, deflate->numSymbols, deflate->litlenFreq, deflate->distFreq,
+			          deflate->blockStart, deflate->strStart, true);
+		}
+
+		alignBits(deflate);
+		deflate->isFinished = true;
+	}
+}
+
+void a8a82d35_setDictionary(Deflate *deflate, void *dictionary, uint32_t length) {
+	uint8_t *dictPtr;
+
+	// Stored blocks never refer back to earlier data
+	if (deflate->level == 0 || length < MIN_MATCH) {
+		return;
+	}
+
+	// 1. Copy the end of the dictionary to the start of the window
+	dictPtr = dictionary;
+
+	if (length > DEFLATE_WINDOW_SIZE) {
+		dictPtr += length - DEFLATE_WINDOW_SIZE;
+		length = DEFLATE_WINDOW_SIZE;
+	}
+
+	f668c4bd_memcopy(dictPtr, deflate->window, length);
+
+	// 2. Hash every dictionary position so the input can match against it
+	for (uint32_t position=0; position <= length - MIN_MATCH; position++) {
+		insertString(deflate, position);
+	}
+
+	// 3. The first block starts after the dictionary
+	deflate->strStart = length;
+	resetBlock(deflate, length);
+}
+
+void a8a82d35_syncFlush(Deflate *deflate) {
+	if (deflate->isFinished) {
+		return;
+	}
+
+	// 1. Compress all of the lookahead and emit it as a non-final block
+	if (deflate->level == 0) {
+		compressStored(deflate);
+
+		if (deflate->strStart > deflate->blockStart) {
+			emitStoredBlocks(deflate, deflate->window + deflate->blockStart, deflate->strStart - deflate->blockStart, false);
+		}
+	} else {
+		if (deflate->isLazy) {
+			compressLazy(deflate, true);
+		} else {
+			compressGreedy(deflate, true);
+		}
+
+		if (deflate->numSymbols > 0) {
+			emitBlock(deflate, deflate->numSymbols, deflate->litlenFreq, deflate->distFreq,
+			          deflate->blockStart, deflate->strStart, false);
+		}
+	}
+
+	resetBlock(deflate, deflate->strStart);
+
+	// 2. An empty stored block pads the output to a byte boundary
+	emitStoredBlocks(deflate, NULL, 0, false);
+
+	// 3. Matching starts over at the next input
+	deflate->matchLength = MIN_MATCH - 1;
+	deflate->prevLength = MIN_MATCH - 1;
+	deflate->isMatchAvailable = false;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static uint32_t fillWindow(Deflate *deflate, uint8_t *input, uint32_t length) {
+	uint32_t windowEnd, numBytes;
+
+	// 1. Make room once the lookahead reaches the end of the window
+	if (deflate->strStart >= WINDOW_BUF_SIZE - MIN_LOOKAHEAD) {
+		slideWindow(deflate);
+	}
+
+	// 2. Append the input to the lookahead
+	windowEnd = deflate->strStart + deflate->lookahead;
+	numBytes = WINDOW_BUF_SIZE - windowEnd;
+
+	if (numBytes > length) {
+		numBytes = length;
+	}
+
+	if (numBytes > 0) {
+		f668c4bd_memcopy(input, deflate->window + windowEnd, numBytes);
+		deflate->lookahead += numBytes;
+	}
+
+	return numBytes;
+}
+
+static void slideWindow(Deflate *deflate) {
+	uint16_t *hashPtr;
+	uint32_t i;
+
+	// 1. Move the upper half of the window down
+	f668c4bd_memcopy(deflate->window + DEFLATE_WINDOW_SIZE, deflate->window, DEFLATE_WINDOW_SIZE);
+
+	deflate->strStart -= DEFLATE_WINDOW_SIZE;
+	deflate->matchStart = (deflate->matchStart >= DEFLATE_WINDOW_SIZE) ? deflate->matchStart - DEFLATE_WINDOW_SIZE : 0;
+	deflate->blockStart -= DEFLATE_WINDOW_SIZE;
+	deflate->splitStart -= DEFLATE_WINDOW_SIZE;
+
+	// 2. Rebase the hash chains; positions that fell out of the window become NIL
+	hashPtr = deflate->hashHead;
+	for (i=0; i < HASH_SIZE; i++) {
+		hashPtr[i] = (hashPtr[i] >= DEFLATE_WINDOW_SIZE) ? hashPtr[i] - DEFLATE_WINDOW_SIZE : 0;
+	}
+
+	hashPtr = deflate->hashPrev;
+	for (i=0; i < DEFLATE_WINDOW_SIZE; i++) {
+		hashPtr[i] = (hashPtr[i] >= DEFLATE_WINDOW_SIZE) ? hashPtr[i] - DEFLATE_WINDOW_SIZE : 0;
+	}
+}
+
+static inline uint32_t insertString(Deflate *deflate, uint32_t position) {
+	uint32_t hash, hashHead;
+
+	hash = ((*(uint32_t*)(deflate->window + position) & 0xFFFFFF) * 0x9E3779B1) >> (32 - HASH_BITS);
+	hashHead = deflate->hashHead[hash];
+
+	deflate->hashPrev[position & WINDOW_MASK] = hashHead;
+	deflate->hashHead[hash] = position;
+
+	return hashHead;
+}
+
+static void compressStored(Deflate *deflate) {
+	// Everything in the lookahead is consumed as is
+	deflate->strStart += deflate->lookahead;
+	deflate->lookahead = 0;
+
+	// Emit the window before it would need to slide
+	if (deflate->strStart >= WINDOW_BUF_SIZE - MIN_LOOKAHEAD) {
+		emitStoredBlocks(deflate, deflate->window + deflate->blockStart, deflate->strStart - deflate->blockStart, false);
+		deflate->strStart = 0;
+		deflate->blockStart = 0;
+	}
+}
+
+static void compressGreedy(Deflate *deflate, bool flush) {
+	uint32_t hashHead, matchLength, start;
+	uint8_t literal;
+
+	while (deflate->lookahead >= MIN_LOOKAHEAD || (flush && deflate->lookahead > 0)) {
+		hashHead = 0;
+		matchLength = 0;
+
+		// 1. Insert the string at strStart and look for a match
+		if (deflate->lookahead >= MIN_MATCH) {
+			hashHead = insertString(deflate, deflate->strStart);
+		}
+
+		if (hashHead != 0 && deflate->strStart - hashHead <= MAX_DIST) {
+			deflate->prevLength = MIN_MATCH - 1;
+			matchLength = longestMatch(deflate, hashHead);
+		}
+
+		// 2. Take the match right away, otherwise emit a literal
+		if (matchLength >= MIN_MATCH) {
+			start = deflate->strStart;
+			deflate->lookahead -= matchLength;
+
+			if (matchLength <= deflate->maxLazy && deflate->lookahead >= MIN_MATCH) {
+				for (uint32_t i=1; i < matchLength; i++) {
+					insertString(deflate, start + i);
+				}
+			}
+
+			deflate->strStart += matchLength;
+			tallyMatch(deflate, start - deflate->matchStart, matchLength, deflate->strStart);
+		} else {
+			literal = deflate->window[deflate->strStart];
+			deflate->strStart++;
+			deflate->lookahead--;
+			tallyLiteral(deflate, literal, deflate->strStart);
+		}
+	}
+}
+
+static void compressLazy(Deflate *deflate, bool flush) {
+	uint32_t hashHead, maxInsert, start, length;
+
+	while (deflate->lookahead >= MIN_LOOKAHEAD || (flush && deflate->lookahead > 0)) {
+		hashHead = 0;
+
+		// 1. Insert the string at strStart and look for a longer match than the previous one
+		if (deflate->lookahead >= MIN_MATCH) {
+			hashHead = insertString(deflate, deflate->strStart);
+		}
+
+		deflate->prevLength = deflate->matchLength;
+		deflate->prevMatch = deflate->matchStart;
+		deflate->matchLength = MIN_MATCH - 1;
+
+		if (hashHead != 0 && deflate->prevLength < deflate->maxLazy && deflate->strStart - hashHead <= MAX_DIST) {
+			deflate->matchLength = longestMatch(deflate, hashHead);
+
+			// A minimum length match that far back costs more than three literals
+			if (deflate->matchLength == MIN_MATCH && deflate->strStart - deflate->matchStart > TOO_FAR) {
+				deflate->matchLength = MIN_MATCH - 1;
+			}
+		}
+
+		// 2. Emit the previous match if the current one is no better
+		if (deflate->prevLength >= MIN_MATCH && deflate->matchLength <= deflate->prevLength) {
+			start = deflate->strStart - 1;
+			length = deflate->prevLength;
+			maxInsert = deflate->strStart + deflate->lookahead - MIN_MATCH;
+
+			deflate->lookahead -= length - 1;
+
+			for (uint32_t position = deflate->strStart + 1; position < start + length; position++) {
+				if (position <= maxInsert) {
+					insertString(deflate, position);
+				}
+			}
+
+			deflate->strStart = start + length;
+			deflate->isMatchAvailable = false;
+			deflate->matchLength = MIN_MATCH - 1;
+
+			tallyMatch(deflate, start - deflate->prevMatch, length, deflate->strStart);
+
+		// 3. The previous position was not part of a match
+		} else if (deflate->isMatchAvailable) {
+			tallyLiteral(deflate, deflate->window[deflate->strStart - 1], deflate->strStart);
+			deflate->strStart++;
+			deflate->lookahead--;
+
+		// 4. Defer the decision on this position until the next one is known
+		} else {
+			deflate->isMatchAvailable = true;
+			deflate->strStart++;
+			deflate->lookahead--;
+		}
+	}
+
+	if (flush && deflate->isMatchAvailable) {
+		tallyLiteral(deflate, deflate->window[deflate->strStart - 1], deflate->strStart);
+		deflate->isMatchAvailable = false;
+	}
+}
+
+static uint32_t longestMatch(Deflate *deflate, uint32_t curMatch) {
+	uint8_t *scan, *match;
+	uint64_t diff;
+	uint32_t chainLength, bestLength, niceLength, maxLength, limit, length;
+
+	scan = deflate->window + deflate->strStart;
+	bestLength = deflate->prevLength;
+	chainLength = deflate->maxChain;
+	maxLength = (deflate->lookahead < MAX_MATCH) ? deflate->lookahead : MAX_MATCH;
+	niceLength = (deflate->niceLength < maxLength) ? deflate->niceLength : maxLength;
+	limit = (deflate->strStart > MAX_DIST) ? deflate->strStart - MAX_DIST : 0;
+
+	if (bestLength >= maxLength) {
+		return maxLength;
+	}
+
+	// Do not waste too much time if we already have a good match
+	if (bestLength >= deflate->goodLength) {
+		chainLength >>= 2;
+	}
+
+	do {
+		match = deflate->window + curMatch;
+
+		// Skip the candidate unless it can beat the best match so far
+		if (match[bestLength] != scan[bestLength] || *(uint16_t*)match != *(uint16_t*)scan) {
+			continue;
+		}
+
+		// Compare eight bytes at a time; the window slack covers the overrun
+		length = 2;
+		while (length < maxLength) {
+			diff = *(uint64_t*)(match + length) ^ *(uint64_t*)(scan + length);
+
+			if (diff != 0) {
+				length += __builtin_ctzll(diff) >> 3;
+				break;
+			}
+
+			length += 8;
+		}
+
+		if (length > maxLength) {
+			length = maxLength;
+		}
+
+		if (length > bestLength) {
+			deflate->matchStart = curMatch;
+			bestLength = length;
+
+			if (length >= niceLength) {
+				break;
+			}
+		}
+	} while ((curMatch = deflate->hashPrev[curMatch & WINDOW_MASK]) > limit && --chainLength != 0);
+
+	return bestLength;
+}
+
+static inline uint32_t getLengthCode(uint32_t length) {
+	uint32_t value, numBits;
+
+	value = length - MIN_MATCH;
+
+	if (value < 8) {
+		return value;
+	} else if (value == MAX_MATCH - MIN_MATCH) {
+		return 28;
+	}
+
+	numBits = 31 - __builtin_clz(value);
+
+	return ((numBits - 1) << 2) | ((value >> (numBits - 2)) & 0x03);
+}
+
+static inline uint32_t getDistCode(uint32_t dist) {
+	uint32_t value, numBits;
+
+	value = dist - 1;
+
+	if (value < 4) {
+		return value;
+	}
+
+	numBits = 31 - __builtin_clz(value);
+
+	return (numBits << 1) | ((value >> (numBits - 1)) & 0x01);
+}
+
+static inline uint32_t getLengthExtraBits(uint32_t lengthCode) {
+	return (lengthCode < 8 || lengthCode == 28) ? 0 : (lengthCode >> 2) - 1;
+}
+
+static inline uint32_t getDistExtraBits(uint32_t distCode) {
+	return (distCode < 4) ? 0 : (distCode >> 1) - 1;
+}
+
+static void tallyLiteral(Deflate *deflate, uint32_t literal, uint32_t inputEnd) {
+	deflate->symbolList[deflate->numSymbols++] = literal;
+	deflate->litlenFreq[literal]++;
+
+	if (deflate->numSymbols == SYMBOL_LIST_SIZE) {
+		emitBlock(deflate, deflate->numSymbols, deflate->litlenFreq, deflate->distFreq, deflate->blockStart, inputEnd, false);
+		resetBlock(deflate, inputEnd);
+	} else if ((deflate->numSymbols & (SPLIT_INTERVAL - 1)) == 0) {
+		checkBlockSplit(deflate, inputEnd);
+	}
+}
+
+static void tallyMatch(Deflate *deflate, uint32_t dist, uint32_t length, uint32_t inputEnd) {
+	deflate->symbolList[deflate->numSymbols++] = (dist << 16) | length;
+	deflate->litlenFreq[LITLEN_TBL_OFFSET + getLengthCode(length)]++;
+	deflate->distFreq[getDistCode(dist)]++;
+
+	if (deflate->numSymbols == SYMBOL_LIST_SIZE) {
+		emitBlock(deflate, deflate->numSymbols, deflate->litlenFreq, deflate->distFreq, deflate->blockStart, inputEnd, false);
+		resetBlock(deflate, inputEnd);
+	} else if ((deflate->numSymbols & (SPLIT_INTERVAL - 1)) == 0) {
+		checkBlockSplit(deflate, inputEnd);
+	}
+}
+
+static void checkBlockSplit(Deflate *deflate, uint32_t inputEnd) {
+	uint32_t litlenFreq[DEFLATE_NUM_LITLENS];
+	uint32_t distFreq[DEFLATE_NUM_DISTS];
+	float firstCost, secondCost, blockCost;
+	uint32_t i;
+
+	// 1. Compare the estimated cost of the block against two separate blocks
+	//    split at the previous checkpoint
+	if (deflate->numSplitSymbols > 0) {
+		for (i=0; i < DEFLATE_NUM_LITLENS; i++) {
+			litlenFreq[i] = deflate->litlenFreq[i] - deflate->splitLitlenFreq[i];
+		}
+
+		for (i=0; i < DEFLATE_NUM_DISTS; i++) {
+			distFreq[i] = deflate->distFreq[i] - deflate->splitDistFreq[i];
+		}
+
+		blockCost = estimateCost(deflate->litlenFreq, DEFLATE_NUM_LITLENS) + estimateCost(deflate->distFreq, DEFLATE_NUM_DISTS);
+		firstCost = estimateCost(deflate->splitLitlenFreq, DEFLATE_NUM_LITLENS) + estimateCost(deflate->splitDistFreq, DEFLATE_NUM_DISTS);
+		secondCost = estimateCost(litlenFreq, DEFLATE_NUM_LITLENS) + estimateCost(distFreq, DEFLATE_NUM_DISTS);
+
+		// 2. Emit the first part as its own block if the statistics changed enough
+		if (firstCost + secondCost + SPLIT_BLOCK_COST < blockCost) {
+			emitBlock(deflate, deflate->numSplitSymbols, deflate->splitLitlenFreq, deflate->splitDistFreq,
+			          deflate->blockStart, deflate->splitStart, false);
+
+			deflate->numSymbols -= deflate->numSplitSymbols;
+			memmove(deflate->symbolList, deflate->symbolList + deflate->numSplitSymbols, deflate->numSymbols * sizeof(uint32_t));
+
+			f668c4bd_memcopy(litlenFreq, deflate->litlenFreq, sizeof(litlenFreq));
+			f668c4bd_memcopy(distFreq, deflate->distFreq, sizeof(distFreq));
+			deflate->blockStart = deflate->splitStart;
+		}
+	}
+
+	// 3. The current position becomes the next split checkpoint
+	f668c4bd_memcopy(deflate->litlenFreq, deflate->splitLitlenFreq, sizeof(deflate->litlenFreq));
+	f668c4bd_memcopy(deflate->distFreq, deflate->splitDistFreq, sizeof(deflate->distFreq));
+	deflate->numSplitSymbols = deflate->numSymbols;
+	deflate->splitStart = inputEnd;
+}
+
+static void resetBlock(Deflate *deflate, uint32_t inputEnd) {
+	f668c4bd_meminit(deflate->litlenFreq, sizeof(deflate->litlenFreq));
+	f668c4bd_meminit(deflate->distFreq, sizeof(deflate->distFreq));
+
+	deflate->numSymbols = 0;
+	deflate->numSplitSymbols = 0;
+	deflate->blockStart = inputEnd;
+	deflate->splitStart = inputEnd;
+}
+
+static inline float fastLog2(float value) {
+	uint32_t bits;
+	int exponent;
+
+	f668c4bd_memcopy(&value, &bits, sizeof(float));
+	exponent = ((bits >> 23) & 0xFF) - 128;
+	bits = (bits & 0x007FFFFF) | 0x3F800000;
+	f668c4bd_memcopy(&bits, &value, sizeof(float));
+
+	return ((-1.0f / 3) * value + 2) * value - (2.0f / 3) + exponent;
+}
+
+static float estimateCost(uint32_t *freqList, uint32_t numFreqs) {
+	float cost;
+	uint32_t total;
+
+	// Entropy estimate: total * log2(total) - sum(freq * log2(freq))
+	total = 0;
+	cost = 0;
+
+	for (uint32_t i=0; i < numFreqs; i++) {
+		if (freqList[i] > 1) {
+			cost -= freqList[i] * fastLog2(freqList[i]);
+		}
+
+		total += freqList[i];
+	}
+
+	if (total > 1) {
+		cost += total * fastLog2(total);
+	}
+
+	return cost;
+}
+
+static void emitBlock(Deflate *deflate, uint32_t numSymbols, uint32_t *litlenFreq, uint32_t *distFreq,
+                      int64_t blockStart, int64_t blockEnd, bool isFinal) {
+	uint32_t freqList[NUM_FIXED_LITLENS];
+	uint32_t codelenFreq[NUM_CODELENS];
+	uint16_t codelenList[DEFLATE_NUM_LITLENS + DEFLATE_NUM_DISTS];
+	uint8_t lengthList[DEFLATE_NUM_LITLENS + DEFLATE_NUM_DISTS];
+	uint8_t codelenLengths[NUM_CODELENS];
+	HuffmanCode litlenCodes[NUM_FIXED_LITLENS];
+	HuffmanCode distCodes[DEFLATE_NUM_DISTS];
+	HuffmanCode codelenCodes[NUM_CODELENS];
+	uint64_t dynamicCost, fixedCost, storedCost, extraCost;
+	uint32_t numLitlens, numDists, numCodelens, numCodelenOps;
+	uint32_t blockLength, runLength, symbol, i, j;
+	uint8_t *distLengths;
+
+	// 1. Build the dynamic literal/length and distance code lengths
+	f668c4bd_memcopy(litlenFreq, freqList, DEFLATE_NUM_LITLENS * sizeof(uint32_t));
+	freqList[LITLEN_EOB] = 1;
+
+	distLengths = lengthList + DEFLATE_NUM_LITLENS;
+	buildCodeLengths(freqList, DEFLATE_NUM_LITLENS, MAX_CODE_LENGTH, lengthList);
+	buildCodeLengths(distFreq, DEFLATE_NUM_DISTS, MAX_CODE_LENGTH, distLengths);
+
+	for (numLitlens = DEFLATE_NUM_LITLENS; numLitlens > LITLEN_TBL_OFFSET && lengthList[numLitlens - 1] == 0; numLitlens--);
+	for (numDists = DEFLATE_NUM_DISTS; numDists > 1 && distLengths[numDists - 1] == 0; numDists--);
+
+	// The distance lengths directly follow the literal/length lengths in the header
+	if (numLitlens < DEFLATE_NUM_LITLENS) {
+		memmove(lengthList + numLitlens, distLengths, numDists);
+	}
+
+	// 2. Run-length encode the code lengths into code length symbols
+	f668c4bd_meminit(codelenFreq, sizeof(codelenFreq));
+	numCodelenOps = 0;
+
+	for (i=0; i < numLitlens + numDists; i += runLength) {
+		symbol = lengthList[i];
+
+		for (runLength = 1; i + runLength < numLitlens + numDists && lengthList[i + runLength] == symbol; runLength++);
+
+		j = runLength;
+
+		if (symbol == 0) {
+			while (j >= 11) {
+				uint32_t numZeros = (j > 138) ? 138 : j;
+				codelenList[numCodelenOps++] = CODELEN_ZEROS2 | ((numZeros - 11) << 8);
+				codelenFreq[CODELEN_ZEROS2]++;
+				j -= numZeros;
+			}
+
+			if (j >= 3) {
+				codelenList[numCodelenOps++] = CODELEN_ZEROS | ((j - 3) << 8);
+				codelenFreq[CODELEN_ZEROS]++;
+				j = 0;
+			}
+		} else {
+			codelenList[numCodelenOps++] = symbol;
+			codelenFreq[symbol]++;
+			j--;
+
+			while (j >= 3) {
+				uint32_t numCopies = (j > 6) ? 6 : j;
+				codelenList[numCodelenOps++] = CODELEN_COPY | ((numCopies - 3) << 8);
+				codelenFreq[CODELEN_COPY]++;
+				j -= numCopies;
+			}
+		}
+
+		while (j > 0) {
+			codelenList[numCodelenOps++] = symbol;
+			codelenFreq[symbol]++;
+			j--;
+		}
+	}
+
+	buildCodeLengths(codelenFreq, NUM_CODELENS, MAX_CODELEN_LENGTH, codelenLengths);
+
+	for (numCodelens = NUM_CODELENS; numCodelens > 4 && codelenLengths[codelenLengthsOrder[numCodelens - 1]] == 0; numCodelens--);
+
+	// 3. Compute the size of the block for each encoding
+	extraCost = 0;
+	dynamicCost = 3 + 5 + 5 + 4 + (3 * numCodelens);
+	fixedCost = 3;
+
+	for (i=0; i < NUM_CODELENS; i++) {
+		dynamicCost += (uint64_t) codelenFreq[i] * codelenLengths[i];
+	}
+
+	dynamicCost += (2 * codelenFreq[CODELEN_COPY]) + (3 * codelenFreq[CODELEN_ZEROS]) + (7 * codelenFreq[CODELEN_ZEROS2]);
+
+	for (i=0; i < numLitlens; i++) {
+		dynamicCost += (uint64_t) freqList[i] * lengthList[i];
+		fixedCost += (uint64_t) freqList[i] * ((i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8);
+	}
+
+	for (i=0; i < 29; i++) {
+		extraCost += (uint64_t) freqList[LITLEN_TBL_OFFSET + i] * getLengthExtraBits(i);
+	}
+
+	for (i=0; i < DEFLATE_NUM_DISTS; i++) {
+		dynamicCost += (uint64_t) distFreq[i] * ((i < numDists) ? lengthList[numLitlens + i] : 0);
+		fixedCost += (uint64_t) distFreq[i] * 5;
+		extraCost += (uint64_t) distFreq[i] * getDistExtraBits(i);
+	}
+
+	dynamicCost += extraCost;
+	fixedCost += extraCost;
+
+	storedCost = UINT64_MAX;
+	blockLength = blockEnd - blockStart;
+
+	if (blockStart >= 0) {
+		storedCost = ((uint64_t) blockLength << 3) + (((blockLength / STORED_MAX_LENGTH) + 1) * 40);
+	}
+
+	// 4. Emit the smallest encoding
+	if (storedCost <= fixedCost && storedCost <= dynamicCost) {
+		emitStoredBlocks(deflate, deflate->window + blockStart, blockLength, isFinal);
+	} else if (fixedCost <= dynamicCost) {
+		for (i=0; i < NUM_FIXED_LITLENS; i++) {
+			lengthList[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+		}
+
+		buildCodes(lengthList, NUM_FIXED_LITLENS, litlenCodes);
+
+		for (i=0; i < DEFLATE_NUM_DISTS; i++) {
+			lengthList[i] = 5;
+		}
+
+		buildCodes(lengthList, DEFLATE_NUM_DISTS, distCodes);
+
+		putBits(deflate, isFinal ? 0x03 : 0x02, 3);
+		emitSymbols(deflate, numSymbols, litlenCodes, distCodes);
+	} else {
+		buildCodes(lengthList, numLitlens, litlenCodes);
+		buildCodes(lengthList + numLitlens, numDists, distCodes);
+		buildCodes(codelenLengths, NUM_CODELENS, codelenCodes);
+
+		// Block header, HLIT, HDIST and HCLEN
+		putBits(deflate, isFinal ? 0x05 : 0x04, 3);
+		putBits(deflate, numLitlens - LITLEN_TBL_OFFSET, 5);
+		putBits(deflate, numDists - 1, 5);
+		putBits(deflate, numCodelens - 4, 4);
+
+		for (i=0; i < numCodelens; i++) {
+			putBits(deflate, codelenLengths[codelenLengthsOrder[i]], 3);
+		}
+
+		for (i=0; i < numCodelenOps; i++) {
+			symbol = codelenList[i] & 0xFF;
+			putBits(deflate, codelenCodes[symbol].code, codelenCodes[symbol].length);
+
+			if (symbol == CODELEN_COPY) {
+				putBits(deflate, codelenList[i] >> 8, 2);
+			} else if (symbol == CODELEN_ZEROS) {
+				putBits(deflate, codelenList[i] >> 8, 3);
+			} else if (symbol == CODELEN_ZEROS2) {
+				putBits(deflate, codelenList[i] >> 8, 7);
+			}
+		}
+
+		emitSymbols(deflate, numSymbols, litlenCodes, distCodes);
+	}
+}
+
+static void emitStoredBlocks(Deflate *deflate, uint8_t *data, uint32_t length, bool isFinal) {
+	uint32_t blockLength;
+
+	// A stored block holds at most 65535 bytes; an empty final block is allowed
+	do {
+		blockLength = (length > STORED_MAX_LENGTH) ? STORED_MAX_LENGTH : length;
+		length -= blockLength;
+
+		putBits(deflate, (isFinal && length == 0) ? 0x01 : 0x00, 3);
+		alignBits(deflate);
+
+		writeByte(deflate, blockLength & 0xFF);
+		writeByte(deflate, blockLength >> 8);
+		writeByte(deflate, ~blockLength & 0xFF);
+		writeByte(deflate, (~blockLength >> 8) & 0xFF);
+		writeData(deflate, data, blockLength);
+
+		data += blockLength;
+	} while (length > 0);
+}
+
+static void emitSymbols(Deflate *deflate, uint32_t numSymbols, HuffmanCode *litlenCodes, HuffmanCode *distCodes) {
+	HuffmanCode *huffmanCode;
+	uint32_t symbol, dist, length, code, numExtraBits;
+
+	for (uint32_t i=0; i < numSymbols; i++) {
+		symbol = deflate->symbolList[i];
+		dist = symbol >> 16;
+
+		if (dist == 0) {
+			// Literal
+			putBits(deflate, litlenCodes[symbol].code, litlenCodes[symbol].length);
+		} else {
+			// Length code and extra bits
+			length = symbol & 0xFFFF;
+			code = getLengthCode(length);
+			numExtraBits = getLengthExtraBits(code);
+			huffmanCode = &litlenCodes[LITLEN_TBL_OFFSET + code];
+
+			putBits(deflate, huffmanCode->code | ((uint64_t) ((length - MIN_MATCH) & ((1 << numExtraBits) - 1)) << huffmanCode->length),
+			        huffmanCode->length + numExtraBits);
+
+			// Distance code and extra bits
+			code = getDistCode(dist);
+			numExtraBits = getDistExtraBits(code);
+			huffmanCode = &distCodes[code];
+
+			putBits(deflate, huffmanCode->code | ((uint64_t) ((dist - 1) & ((1 << numExtraBits) - 1)) << huffmanCode->length),
+			        huffmanCode->length + numExtraBits);
+		}
+	}
+
+	// End of block
+	putBits(deflate, litlenCodes[LITLEN_EOB].code, litlenCodes[LITLEN_EOB].length);
+}
+
+static void buildCodeLengths(uint32_t *freqList, uint32_t numSymbols, uint32_t maxLength, uint8_t *lengthList) {
+	SymbolFreq symbolFreqList[NUM_FIXED_LITLENS];
+	uint32_t numCodes[MAX_CODE_LENGTH + 2];
+	uint32_t numLeaves, root, leaf, next, avail, used, depth, total;
+	bool isOverflow;
+
+	f668c4bd_meminit(lengthList, numSymbols);
+
+	// 1. Collect the used symbols, sorted by ascending frequency
+	numLeaves = 0;
+	for (uint32_t i=0; i < numSymbols; i++) {
+		if (freqList[i] > 0) {
+			symbolFreqList[numLeaves].freq = freqList[i];
+			symbolFreqList[numLeaves].symbol = i;
+			numLeaves++;
+		}
+	}
+
+	// A code needs at least two symbols to be complete
+	if (numLeaves == 0) {
+		lengthList[0] = 1;
+		lengthList[1] = 1;
+		return;
+	} else if (numLeaves == 1) {
+		lengthList[symbolFreqList[0].symbol] = 1;
+		lengthList[(symbolFreqList[0].symbol == 0) ? 1 : 0] = 1;
+		return;
+	}
+
+	qsort(symbolFreqList, numLeaves, sizeof(SymbolFreq), compareSymbolFreq);
+
+	// 2. Compute the Huffman code lengths in place (Moffat and Katajainen)
+	symbolFreqList[0].freq += symbolFreqList[1].freq;
+	root = 0;
+	leaf = 2;
+
+	for (next=1; next < numLeaves - 1; next++) {
+		if (leaf >= numLeaves || symbolFreqList[root].freq < symbolFreqList[leaf].freq) {
+			symbolFreqList[next].freq = symbolFreqList[root].freq;
+			symbolFreqList[root++].freq = next;
+		} else {
+			symbolFreqList[next].freq = symbolFreqList[leaf++].freq;
+		}
+
+		if (leaf >= numLeaves || (root < next && symbolFreqList[root].freq < symbolFreqList[leaf].freq)) {
+			symbolFreqList[next].freq += symbolFreqList[root].freq;
+			symbolFreqList[root++].freq = next;
+		} else {
+			symbolFreqList[next].freq += symbolFreqList[leaf++].freq;
+		}
+	}
+
+	symbolFreqList[numLeaves - 2].freq = 0;
+
+	for (int i = numLeaves - 3; i >= 0; i--) {
+		symbolFreqList[i].freq = symbolFreqList[symbolFreqList[i].freq].freq + 1;
+	}
+
+	avail = 1;
+	used = 0;
+	depth = 0;
+	root = numLeaves - 2;
+	next = numLeaves - 1;
+
+	while (avail > 0) {
+		while ((int) root >= 0 && symbolFreqList[root].freq == depth) {
+			used++;
+			root--;
+		}
+
+		while (avail > used) {
+			symbolFreqList[next--].freq = depth;
+			avail--;
+		}
+
+		avail = 2 * used;
+		depth++;
+		used = 0;
+	}
+
+	// 3. Count the codes of each length, folding the overlong ones into the maximum
+	f668c4bd_meminit(numCodes, sizeof(numCodes));
+	isOverflow = false;
+
+	for (uint32_t i=0; i < numLeaves; i++) {
+		if (symbolFreqList[i].freq > maxLength) {
+			numCodes[maxLength]++;
+			isOverflow = true;
+		} else {
+			numCodes[symbolFreqList[i].freq]++;
+		}
+	}
+
+	// 4. Restore the Kraft equality by lengthening the deepest short codes
+	if (isOverflow) {
+		total = 0;
+		for (uint32_t i=1; i <= maxLength; i++) {
+			total += numCodes[i] << (maxLength - i);
+		}
+
+		while (total != (1U << maxLength)) {
+			numCodes[maxLength]--;
+
+			for (uint32_t i = maxLength - 1; i > 0; i--) {
+				if (numCodes[i] > 0) {
+					numCodes[i]--;
+					numCodes[i + 1] += 2;
+					break;
+				}
+			}
+
+			total--;
+		}
+	}
+
+	// 5. The least frequent symbols get the longest codes
+	next = 0;
+	for (uint32_t length = maxLength; length > 0; length--) {
+		for (uint32_t i = numCodes[length]; i > 0; i--) {
+			lengthList[symbolFreqList[next++].symbol] = length;
+		}
+	}
+}
+
+static void buildCodes(uint8_t *lengthList, uint32_t numSymbols, HuffmanCode *codeList) {
+	uint32_t lengthCount[MAX_CODE_LENGTH + 1];
+	uint32_t nextCode[MAX_CODE_LENGTH + 1];
+	uint32_t code, length;
+
+	// 1. Count the number of codes of each length
+	f668c4bd_meminit(lengthCount, sizeof(lengthCount));
+
+	for (uint32_t i=0; i < numSymbols; i++) {
+		lengthCount[lengthList[i]]++;
+	}
+
+	lengthCount[0] = 0;
+
+	// 2. Compute the first canonical code of each length
+	code = 0;
+	for (length=1; length <= MAX_CODE_LENGTH; length++) {
+		code = (code + lengthCount[length - 1]) << 1;
+		nextCode[length] = code;
+	}
+
+	// 3. Assign the codes, bit-reversed for the LSB-first bit stream
+	for (uint32_t i=0; i < numSymbols; i++) {
+		length = lengthList[i];
+		codeList[i].length = length;
+
+		if (length > 0) {
+			codeList[i].code = e474415b_reverse16(nextCode[length]++, length);
+		} else {
+			codeList[i].code = 0;
+		}
+	}
+}
+
+static int compareSymbolFreq(const void *first, const void *second) {
+	const SymbolFreq *firstFreq = first;
+	const SymbolFreq *secondFreq = second;
+
+	if (firstFreq->freq != secondFreq->freq) {
+		return (firstFreq->freq > secondFreq->freq) - (firstFreq->freq < secondFreq->freq);
+	}
+
+	return (firstFreq->symbol > secondFreq->symbol) - (firstFreq->symbol < secondFreq->symbol);
+}
+
+static inline void putBits(Deflate *deflate, uint64_t value, uint32_t numBits) {
+	OutputBuffer *outputBuffer;
+
+	deflate->bitBuffer |= value << deflate->bitCount;
+	deflate->bitCount += numBits;
+
+	// Flush whole 32-bit words while at least four bytes are free in the slab
+	if (deflate->bitCount >= 32) {
+		outputBuffer = deflate->outputBuffer;
+
+		if (outputBuffer->length + 4 <= SLABPOOL_SLAB_SIZE) {
+			*(uint32_t*)(outputBuffer->buffer + outputBuffer->length) = (uint32_t) deflate->bitBuffer;
+			outputBuffer->length += 4;
+			deflate->totalOut += 4;
+		} else {
+			for (uint32_t i=0; i < 4; i++) {
+				writeByte(deflate, (deflate->bitBuffer >> (i << 3)) & 0xFF);
+			}
+		}
+
+		deflate->bitBuffer >>= 32;
+		deflate->bitCount -= 32;
+	}
+}
+
+static void alignBits(Deflate *deflate) {
+	while (deflate->bitCount > 0) {
+		writeByte(deflate, deflate->bitBuffer & 0xFF);
+		deflate->bitBuffer >>= 8;
+		deflate->bitCount = (deflate->bitCount > 8) ? deflate->bitCount - 8 : 0;
+	}
+
+	deflate->bitBuffer = 0;
+}
+
+static void writeByte(Deflate *deflate, uint8_t value) {
+	OutputBuffer *outputBuffer;
+	OutputBuffer *nextBuffer;
+
+	outputBuffer = deflate->outputBuffer;
+
+	// Chain another OutputBuffer slab once the current one is full
+	if (outputBuffer->length == SLABPOOL_SLAB_SIZE) {
+		nextBuffer = c49f5b0d_createOutputBuffer();
+		nextBuffer->prev = outputBuffer;
+		outputBuffer->next = nextBuffer;
+		outputBuffer = nextBuffer;
+		deflate->outputBuffer = nextBuffer;
+	}
+
+	outputBuffer->buffer[outputBuffer->length++] = value;
+	deflate->totalOut++;
+}
+
+static void writeData(Deflate *deflate, uint8_t *data, uint32_t length) {
+	deflate->outputBuffer = c49f5b0d_append(deflate->outputBuffer, data, length);
+	deflate->totalOut += length;
+}
@@ -0,0 +1,227 @@
+/*
+ * deflate.h - DevOpsBroker C header file for the org.devopsbroker.compress.Deflate struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_COMPRESS_DEFLATE | md5sum | cut -c 25-32
+ *
+ * The Deflate encoder follows the same levels as zlib:
+ *
+ *   Level 0    Stored blocks only
+ *   Level 1-3  Greedy matching; the match is taken as soon as it is found
+ *   Level 4-9  Lazy matching; a match is deferred if the next position has a
+ *              longer one
+ *
+ * Matches are found with hash chains over a 32KB sliding window. Symbols are
+ * collected until the symbol list is full or the statistics of the input
+ * change enough to warrant a new block, and each block is emitted as the
+ * smallest of the stored, fixed Huffman and dynamic Huffman encodings.
+ *
+ * A stream can also be compressed in independent pieces: each piece is primed
+ * with the last 32KB of the input before it via a8a82d35_setDictionary and
+ * ended with a8a82d35_syncFlush, so the pieces concatenate into one stream.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_COMPRESS_DEFLATE_H
+#define ORG_DEVOPSBROKER_COMPRESS_DEFLATE_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "iobuffer.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define DEFLATE_WINDOW_SIZE    32768
+#define DEFLATE_NUM_LITLENS    286
+#define DEFLATE_NUM_DISTS      30
+
+#define DEFLATE_MIN_LEVEL      0
+#define DEFLATE_DEFAULT_LEVEL  6
+#define DEFLATE_MAX_LEVEL      9
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+/*
+ * Deflate
+ *   - Sliding window of twice the window size plus match lookahead slack
+ *   - Hash chain heads and previous links, indexed by window position
+ *   - List of literal and (length, distance) symbols for the current block
+ *   - OutputBuffer the compressed data is appended to; new slabs are chained
+ *     to it as it fills
+ *   - Literal/length and distance frequencies of the current block and of the
+ *     part of the block before the last split checkpoint
+ *   - Match parameters for the compression level
+ */
+typedef struct Deflate {
+	uint8_t      *window;
+	uint16_t     *hashHead;
+	uint16_t     *hashPrev;
+	uint32_t     *symbolList;
+	OutputBuffer *outputBuffer;
+	uint64_t      bitBuffer;
+	int64_t       totalIn;
+	int64_t       totalOut;
+	int64_t       blockStart;
+	int64_t       splitStart;
+	uint32_t      litlenFreq[DEFLATE_NUM_LITLENS];
+	uint32_t      distFreq[DEFLATE_NUM_DISTS];
+	uint32_t      splitLitlenFreq[DEFLATE_NUM_LITLENS];
+	uint32_t      splitDistFreq[DEFLATE_NUM_DISTS];
+	uint32_t      strStart;
+	uint32_t      lookahead;
+	uint32_t      matchStart;
+	uint32_t      matchLength;
+	uint32_t      prevMatch;
+	uint32_t      prevLength;
+	uint32_t      numSymbols;
+	uint32_t      numSplitSymbols;
+	uint32_t      bitCount;
+	uint32_t      crc32;
+	uint32_t      goodLength;
+	uint32_t      maxLazy;
+	uint32_t      niceLength;
+	uint32_t      maxChain;
+	int           level;
+	bool          isLazy;
+	bool          isMatchAvailable;
+	bool          isFinished;
+} Deflate;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(Deflate) == 2672, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(Deflate) == 2652, "Check your assumptions");
+#endif
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_createDeflate
+ * Description: Creates a Deflate struct instance
+ *
+ * Parameters:
+ *   level          The compression level from 0 (stored) to 9 (best)
+ *   outputBuffer   The OutputBuffer to append the compressed data to
+ * Returns:     A Deflate struct instance
+ * ----------------------------------------------------------------------------
+ */
+Deflate *a8a82d35_createDeflate(int level, OutputBuffer *outputBuffer);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_destroyDeflate
+ * Description: Frees the memory allocated to the Deflate struct pointer
+ *
+ * Parameters:
+ *   deflate    A pointer to the Deflate instance to destroy
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_destroyDeflate(Deflate *deflate);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_cleanUpDeflate
+ * Description: Frees the window, hash chains and symbol list of the Deflate
+ *              instance; the OutputBuffer belongs to the caller
+ *
+ * Parameters:
+ *   deflate    A pointer to the Deflate instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_cleanUpDeflate(Deflate *deflate);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_initDeflate
+ * Description: Initializes an existing Deflate struct
+ *
+ * Parameters:
+ *   deflate        A pointer to the Deflate instance to initialize
+ *   level          The compression level from 0 (stored) to 9 (best)
+ *   outputBuffer   The OutputBuffer to append the compressed data to
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_initDeflate(Deflate *deflate, int level, OutputBuffer *outputBuffer);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_resetDeflate
+ * Description: Resets the Deflate instance for a new stream while keeping its
+ *              window, hash chains and symbol list allocated
+ *
+ * Parameters:
+ *   deflate        A pointer to the Deflate instance to reset
+ *   outputBuffer   The OutputBuffer to append the compressed data to
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_resetDeflate(Deflate *deflate, OutputBuffer *outputBuffer);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_deflate
+ * Description: Compresses the input and appends any completed blocks to the
+ *              OutputBuffer chain. The input may be passed in chunks of any
+ *              size; the final chunk terminates the stream on a byte boundary.
+ *
+ * Parameters:
+ *   deflate    A pointer to the Deflate instance
+ *   input      The input data to compress
+ *   length     The length of the input data
+ *   isFinal    True if this is the last of the input data
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_deflate(Deflate *deflate, void *input, uint32_t length, bool isFinal);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_setDictionary
+ * Description: Preloads the window with data that matches may refer back to
+ *              without it being compressed itself. Only the last 32KB of the
+ *              dictionary is used, and it is ignored by level 0. Must be
+ *              called after a reset and before any input is compressed.
+ *
+ * Parameters:
+ *   deflate        A pointer to the Deflate instance
+ *   dictionary     The data preceding the input to compress
+ *   length         The length of the dictionary
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_setDictionary(Deflate *deflate, void *dictionary, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a8a82d35_syncFlush
+ * Description: Compresses all of the pending input and emits it as non-final
+ *              blocks followed by an empty stored block, leaving the output on
+ *              a byte boundary. More input may be compressed afterwards.
+ *
+ * Parameters:
+ *   deflate    A pointer to the Deflate instance
+ * ----------------------------------------------------------------------------
+ */
+void a8a82d35_syncFlush(Deflate *deflate);
+
+#endif /* ORG_DEVOPSBROKER_COMPRESS_DEFLATE_H */
@@ -0,0 +1,1003 @@
+/*
+ * gzip.c - DevOpsBroker C source file for the org.devopsbroker.compress.Gzip struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * Inflate only reports where the DEFLATE bitstream of a member ended once the
+ * member has been inflated. By then every byte read so far has been fed to it,
+ * so the trailer and whatever follows it are found by counting back from the
+ * end of the last chunk fed. Inflate decodes each symbol as soon as its bits
+ * are available, so the end of the bitstream is always inside that chunk.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "gzip.h"
+
+#include "../hash/crc32.h"
+#include "../io/file.h"
+#include "../lang/error.h"
+#include "../lang/memory.h"
+#include "../lang/string.h"
+#include "../lang/stringbuilder.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+// Extra flags of the header for the fastest and the best compression levels
+#define GZIP_XFL_BEST     2
+#define GZIP_XFL_FASTEST  4
+
+// Number of blocks read per worker thread before the workers are started
+#define GZIP_BLOCKS_PER_THREAD  8
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+/*
+ * GzipBlock
+ *   - Input data of the block and the data preceding it used as a dictionary
+ *   - Compressed block copied out by the worker; the output buffer is owned
+ *     by the main thread and reused by every batch
+ *   - CRC-32 of the input data
+ *   - isFinal is true if the block ends the DEFLATE bitstream
+ */
+typedef struct GzipBlock {
+	uint8_t  *input;
+	uint8_t  *dictionary;
+	uint8_t  *output;
+	uint32_t  length;
+	uint32_t  dictLength;
+	uint32_t  outputLength;
+	uint32_t  outputSize;
+	uint32_t  crc32;
+	bool      isFinal;
+} GzipBlock;
+
+/*
+ * GzipWorker
+ *   - Deflate encoder of the worker
+ *   - Blocks of the current batch and the index of the next one to compress,
+ *     both shared by all of the workers
+ *   - isThreaded is false if the worker thread could not be created
+ */
+typedef struct GzipWorker {
+	Deflate    deflate;
+	GzipBlock *blockList;
+	uint32_t  *nextBlock;
+	pthread_t  thread;
+	uint32_t   numBlocks;
+	bool       isThreaded;
+} GzipWorker;
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static bool advanceGzipReader(GzipReader *gzipReader);
+static void compressGzipBlocks(GzipWorker *gzipWorker);
+static bool fillInput(GzipReader *gzipReader, uint32_t numBytes);
+static bool finishInflate(GzipReader *gzipReader);
+static bool flushGzipWriter(GzipWriter *gzipWriter, bool isFinished);
+static uint32_t getModTime(int fd);
+static bool inflateMember(GzipReader *gzipReader);
+static bool printGzipError(GzipReader *gzipReader, char *message);
+static ssize_t readInput(GzipReader *gzipReader);
+static uint32_t readBatch(int inputFd, uint8_t *buffer, uint32_t length, bool *isEnd);
+static bool readMemberHeader(GzipReader *gzipReader);
+static bool readString(GzipReader *gzipReader, uint32_t *crc32, char **value);
+static void *runGzipWorker(void *gzipWorkerPtr);
+static void runGzipWorkers(GzipWorker *workerList, uint32_t numThreads, uint32_t numBlocks);
+static bool skipInput(GzipReader *gzipReader, uint32_t numBytes, uint32_t *crc32);
+static uint8_t *takeInput(GzipReader *gzipReader, uint32_t numBytes, uint32_t *crc32);
+static bool writeOutput(GzipWriter *gzipWriter, void *buffer, uint32_t length);
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void aadb6d78_cleanUpGzipReader(GzipReader *gzipReader) {
+	d592eb82_cleanUpInflate(&gzipReader->inflate);
+	f668c4bd_free(gzipReader->input);
+
+	if (gzipReader->fileName != NULL) {
+		f668c4bd_free(gzipReader->fileName);
+	}
+}
+
+void aadb6d78_initGzipReader(GzipReader *gzipReader, int fd, char *pathName) {
+	// Input is pushed into Inflate, so it starts out without a FileBuffer
+	d592eb82_initInflate(&gzipReader->inflate, NULL, 0);
+
+	gzipReader->input = f668c4bd_malloc(GZIP_INPUT_LENGTH);
+	gzipReader->pathName = pathName;
+	gzipReader->fileName = NULL;
+	gzipReader->output = NULL;
+	gzipReader->sink = NULL;
+	gzipReader->sinkData = NULL;
+	gzipReader->outputLength = 0;
+	gzipReader->inputPos = 0;
+	gzipReader->inputLength = 0;
+	gzipReader->feedLength = 0;
+	gzipReader->modTime = 0;
+	gzipReader->numMembers = 0;
+	gzipReader->fd = fd;
+	gzipReader->state = GZIP_STATE_HEADER;
+}
+
+void aadb6d78_cleanUpGzipWriter(GzipWriter *gzipWriter) {
+	a8a82d35_cleanUpDeflate(&gzipWriter->deflate);
+
+	if (gzipWriter->headBuffer != NULL) {
+		c49f5b0d_destroyOutputBuffer(gzipWriter->headBuffer);
+	}
+}
+
+void aadb6d78_initGzipWriter(GzipWriter *gzipWriter, int fd, char *pathName, int level) {
+	gzipWriter->headBuffer = c49f5b0d_createOutputBuffer();
+	gzipWriter->pathName = pathName;
+	gzipWriter->fd = fd;
+	gzipWriter->isOk = true;
+
+	a8a82d35_initDeflate(&gzipWriter->deflate, level, gzipWriter->headBuffer);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ssize_t aadb6d78_readGzip(GzipReader *gzipReader, void *buffer, uint32_t length) {
+	uint32_t numBytes, numRead;
+
+	numRead = 0;
+
+	while (numRead < length) {
+		// 1. Copy out what is left of the current output chunk
+		if (gzipReader->outputLength > 0) {
+			numBytes = length - numRead;
+			numBytes = (numBytes > gzipReader->outputLength) ? gzipReader->outputLength : numBytes;
+
+			f668c4bd_memcopy(gzipReader->output, buffer + numRead, numBytes);
+			gzipReader->output += numBytes;
+			gzipReader->outputLength -= numBytes;
+			numRead += numBytes;
+
+			continue;
+		}
+
+		if (gzipReader->state == GZIP_STATE_END) {
+			break;
+		}
+
+		// 2. Parse the next member header or inflate the next output chunk
+		if (!advanceGzipReader(gzipReader)) {
+			// Return what was read so far; the next call reports the error
+			return (numRead > 0) ? (ssize_t) numRead : SYSTEM_ERROR_CODE;
+		}
+	}
+
+	return numRead;
+}
+
+ssize_t aadb6d78_populateFileBuffer(GzipReader *gzipReader, FileBuffer *fileBuffer, uint32_t size) {
+	uint32_t numUnread;
+	ssize_t numBytes;
+
+	// 1. Move the unread bytes to the start of the FileBuffer
+	numUnread = fileBuffer->numBytes - fileBuffer->dataOffset;
+	memmove(fileBuffer->buffer, fileBuffer->buffer + fileBuffer->dataOffset, numUnread);
+
+	fileBuffer->dataOffset = 0;
+	fileBuffer->numBytes = numUnread;
+
+	// 2. Fill the rest of it, leaving room for the null terminator
+	numBytes = aadb6d78_readGzip(gzipReader, fileBuffer->buffer + numUnread, size - numUnread - 1);
+
+	if (numBytes == SYSTEM_ERROR_CODE) {
+		return SYSTEM_ERROR_CODE;
+	}
+
+	fileBuffer->numBytes += numBytes;
+	((char*) fileBuffer->buffer)[fileBuffer->numBytes] = '\0';
+
+	return numBytes;
+}
+
+int aadb6d78_populateLineBuffer(GzipReader *gzipReader, LineBuffer *lineBuffer) {
+	ssize_t numBytes;
+
+	numBytes = aadb6d78_readGzip(gzipReader, lineBuffer->buffer + lineBuffer->size, C196BC72_BUFFER_SIZE - lineBuffer->size);
+
+	if (numBytes > 0) {
+		lineBuffer->size += numBytes;
+	}
+
+	return numBytes;
+}
+
+bool aadb6d78_gunzip(int inputFd, int outputFd, char *pathName) {
+	GzipReader gzipReader;
+	bool isOk;
+
+	// 1. Pass each output chunk straight to the output file descriptor
+	aadb6d78_initGzipReader(&gzipReader, inputFd, pathName);
+	gzipReader.sink = d592eb82_fileSink;
+	gzipReader.sinkData = &outputFd;
+
+	// 2. Decompress every member
+	while (gzipReader.state != GZIP_STATE_END && advanceGzipReader(&gzipReader));
+
+	isOk = (gzipReader.state == GZIP_STATE_END);
+	aadb6d78_cleanUpGzipReader(&gzipReader);
+
+	return isOk;
+}
+
+void aadb6d78_startMember(GzipWriter *gzipWriter, char *fileName, uint32_t modTime) {
+	Deflate *deflate;
+	OutputBuffer *tailBuffer;
+	uint8_t header[GZIP_HEADER_SIZE];
+
+	deflate = &gzipWriter->deflate;
+
+	// 1. Build the member header
+	header[0] = GZIP_ID1;
+	header[1] = GZIP_ID2;
+	header[2] = GZIP_METHOD_DEFLATE;
+	header[3] = (fileName == NULL) ? 0 : GZIP_FLAG_NAME;
+	*(uint32_t*)(header + 4) = modTime;
+	header[8] = (deflate->level == DEFLATE_MAX_LEVEL) ? GZIP_XFL_BEST : (deflate->level == 1) ? GZIP_XFL_FASTEST : 0;
+	header[9] = GZIP_OS_UNIX;
+
+	// 2. Append the header and the null-terminated FNAME after the previous member
+	tailBuffer = c49f5b0d_append(deflate->outputBuffer, header, GZIP_HEADER_SIZE);
+
+	if (fileName != NULL) {
+		tailBuffer = c49f5b0d_append(tailBuffer, fileName, f6215943_getLength(fileName) + 1);
+	}
+
+	// 3. The DEFLATE bitstream follows the header
+	a8a82d35_resetDeflate(deflate, tailBuffer);
+}
+
+bool aadb6d78_writeGzip(GzipWriter *gzipWriter, void *buffer, uint32_t length) {
+	a8a82d35_deflate(&gzipWriter->deflate, buffer, length, false);
+
+	return flushGzipWriter(gzipWriter, false);
+}
+
+bool aadb6d78_finishMember(GzipWriter *gzipWriter) {
+	Deflate *deflate;
+	uint32_t trailer[2];
+
+	deflate = &gzipWriter->deflate;
+
+	// 1. Emit the final block
+	a8a82d35_deflate(deflate, NULL, 0, true);
+
+	// 2. Append the CRC-32 and ISIZE trailer
+	trailer[0] = deflate->crc32;
+	trailer[1] = (uint32_t) deflate->totalIn;
+	deflate->outputBuffer = c49f5b0d_append(deflate->outputBuffer, trailer, GZIP_TRAILER_SIZE);
+
+	// 3. Write out the whole member
+	return flushGzipWriter(gzipWriter, true);
+}
+
+bool aadb6d78_gzip(int inputFd, int outputFd, char *pathName, int level) {
+	GzipWriter gzipWriter;
+	uint8_t *buffer;
+	ssize_t numBytes;
+	bool isOk;
+
+	// 1. Record the modification time of a regular input file as gzip does
+	aadb6d78_initGzipWriter(&gzipWriter, outputFd, pathName, level);
+	aadb6d78_startMember(&gzipWriter, NULL, getModTime(inputFd));
+
+	// 2. Compress the input one read at a time
+	buffer = f668c4bd_malloc(GZIP_INPUT_LENGTH);
+	isOk = true;
+
+	while (isOk) {
+		numBytes = read(inputFd, buffer, GZIP_INPUT_LENGTH);
+
+		if (numBytes == SYSTEM_ERROR_CODE) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			c7c88e52_printLibError("Cannot read the data to compress", errno);
+			isOk = false;
+		} else if (numBytes == 0) {
+			break;
+		} else {
+			isOk = aadb6d78_writeGzip(&gzipWriter, buffer, numBytes);
+		}
+	}
+
+	// 3. Finish the member and write out the rest of the gzip file
+	if (isOk) {
+		isOk = aadb6d78_finishMember(&gzipWriter);
+	}
+
+	f668c4bd_free(buffer);
+	aadb6d78_cleanUpGzipWriter(&gzipWriter);
+
+	return isOk;
+}
+
+bool aadb6d78_gzipParallel(int inputFd, int outputFd, char *pathName, int level, uint32_t numThreads) {
+	GzipWriter gzipWriter;
+	GzipWorker *workerList;
+	GzipBlock *blockList;
+	GzipBlock *gzipBlock;
+	uint8_t *buffer;
+	uint8_t *batch;
+	uint32_t trailer[2];
+	uint32_t maxBlocks, batchLength, historyLength, numBlocks, offset, crc32, inputSize;
+	bool isOk, isEnd, isFinished;
+
+	if (numThreads <= 1) {
+		return aadb6d78_gzip(inputFd, outputFd, pathName, level);
+	}
+
+	// 1. Write the member header; the blocks are compressed by the workers
+	aadb6d78_initGzipWriter(&gzipWriter, outputFd, pathName, level);
+	aadb6d78_startMember(&gzipWriter, NULL, getModTime(inputFd));
+	isOk = flushGzipWriter(&gzipWriter, true);
+
+	// 2. Each worker gets its own Deflate encoder
+	maxBlocks = numThreads * GZIP_BLOCKS_PER_THREAD;
+	workerList = f668c4bd_mallocArray(sizeof(GzipWorker), numThreads);
+	blockList = f668c4bd_mallocArray(sizeof(GzipBlock), maxBlocks);
+
+	for (uint32_t i=0; i < numThreads; i++) {
+		a8a82d35_initDeflate(&workerList[i].deflate, level, NULL);
+		workerList[i].blockList = blockList;
+	}
+
+	for (uint32_t i=0; i < maxBlocks; i++) {
+		blockList[i].output = NULL;
+		blockList[i].outputSize = 0;
+	}
+
+	// 3. The batch is read after room for the last 32KB of the previous batch
+	buffer = f668c4bd_malloc(DEFLATE_WINDOW_SIZE + (maxBlocks * GZIP_BLOCK_SIZE));
+	batch = buffer + DEFLATE_WINDOW_SIZE;
+	historyLength = 0;
+	crc32 = 0;
+	inputSize = 0;
+	isEnd = false;
+	isFinished = false;
+
+	while (isOk && !isEnd) {
+		batchLength = readBatch(inputFd, batch, maxBlocks * GZIP_BLOCK_SIZE, &isEnd);
+
+		if (batchLength == 0) {
+			isOk = isEnd;
+			break;
+		}
+
+		// 4. Split the batch into blocks; the last block of the input ends the bitstream
+		numBlocks = 0;
+
+		for (offset=0; offset < batchLength; offset += GZIP_BLOCK_SIZE) {
+			gzipBlock = &blockList[numBlocks++];
+			gzipBlock->input = batch + offset;
+			gzipBlock->dictionary = batch - historyLength;
+			gzipBlock->length = (batchLength - offset > GZIP_BLOCK_SIZE) ? GZIP_BLOCK_SIZE : batchLength - offset;
+			gzipBlock->dictLength = historyLength + offset;
+			gzipBlock->isFinal = false;
+		}
+
+		blockList[numBlocks - 1].isFinal = isEnd;
+		isFinished = isEnd;
+
+		// 5. Compress the blocks on the worker threads
+		runGzipWorkers(workerList, numThreads, numBlocks);
+
+		// 6. Write out the blocks in order and combine their CRC-32 values
+		for (uint32_t i=0; i < numBlocks; i++) {
+			gzipBlock = &blockList[i];
+
+			writeOutput(&gzipWriter, gzipBlock->output, gzipBlock->outputLength);
+			crc32 = b7e0468d_crc32Combine(crc32, gzipBlock->crc32, gzipBlock->length);
+		}
+
+		inputSize += batchLength;
+		isOk = gzipWriter.isOk;
+
+		// 7. Keep the last 32KB of the batch as the dictionary of the next one
+		if (!isEnd) {
+			f668c4bd_memcopy(batch + batchLength - DEFLATE_WINDOW_SIZE, buffer, DEFLATE_WINDOW_SIZE);
+			historyLength = DEFLATE_WINDOW_SIZE;
+		}
+	}
+
+	// 8. End the bitstream with an empty final block if the input ended on a batch boundary
+	if (isOk) {
+		if (!isFinished) {
+			a8a82d35_deflate(&gzipWriter.deflate, NULL, 0, true);
+		}
+
+		trailer[0] = crc32;
+		trailer[1] = inputSize;
+		gzipWriter.deflate.outputBuffer = c49f5b0d_append(gzipWriter.deflate.outputBuffer, trailer, GZIP_TRAILER_SIZE);
+
+		isOk = flushGzipWriter(&gzipWriter, true);
+	}
+
+	for (uint32_t i=0; i < numThreads; i++) {
+		a8a82d35_cleanUpDeflate(&workerList[i].deflate);
+	}
+
+	for (uint32_t i=0; i < maxBlocks; i++) {
+		if (blockList[i].output != NULL) {
+			f668c4bd_free(blockList[i].output);
+		}
+	}
+
+	f668c4bd_free(buffer);
+	f668c4bd_free(blockList);
+	f668c4bd_free(workerList);
+	aadb6d78_cleanUpGzipWriter(&gzipWriter);
+
+	return isOk;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static bool advanceGzipReader(GzipReader *gzipReader) {
+	if (gzipReader->state == GZIP_STATE_HEADER) {
+		return readMemberHeader(gzipReader);
+	}
+
+	if (gzipReader->state == GZIP_STATE_DATA) {
+		return inflateMember(gzipReader);
+	}
+
+	return (gzipReader->state == GZIP_STATE_END);
+}
+
+static void compressGzipBlocks(GzipWorker *gzipWorker) {
+	Deflate *deflate;
+	GzipBlock *gzipBlock;
+	OutputBuffer *headBuffer;
+	OutputBuffer *outputBuffer;
+	uint32_t index, outputLength;
+
+	deflate = &gzipWorker->deflate;
+
+	// The slabs of the OutputBuffer chain never leave the SlabPool of this thread
+	headBuffer = c49f5b0d_createOutputBuffer();
+
+	// Workers take the next block until none are left
+	while ((index = __atomic_fetch_add(gzipWorker->nextBlock, 1, __ATOMIC_ACQ_REL)) < gzipWorker->numBlocks) {
+		gzipBlock = &gzipWorker->blockList[index];
+
+		// 1. Start a new bitstream primed with the input preceding the block
+		a8a82d35_resetDeflate(deflate, headBuffer);
+		a8a82d35_setDictionary(deflate, gzipBlock->dictionary, gzipBlock->dictLength);
+
+		// 2. Every block but the last ends on a byte boundary so the blocks can be concatenated
+		a8a82d35_deflate(deflate, gzipBlock->input, gzipBlock->length, gzipBlock->isFinal);
+
+		if (!gzipBlock->isFinal) {
+			a8a82d35_syncFlush(deflate);
+		}
+
+		gzipBlock->crc32 = deflate->crc32;
+
+		// 3. Copy the compressed block into the output buffer of the block
+		outputLength = 0;
+
+		for (outputBuffer = headBuffer; outputBuffer != NULL; outputBuffer = outputBuffer->next) {
+			outputLength += outputBuffer->length;
+		}
+
+		if (outputLength > gzipBlock->outputSize) {
+			gzipBlock->output = f668c4bd_realloc_void_size(gzipBlock->output, outputLength);
+			gzipBlock->outputSize = outputLength;
+		}
+
+		gzipBlock->outputLength = 0;
+
+		for (outputBuffer = headBuffer; outputBuffer != NULL; outputBuffer = outputBuffer->next) {
+			f668c4bd_memcopy(outputBuffer->buffer, gzipBlock->output + gzipBlock->outputLength, outputBuffer->length);
+			gzipBlock->outputLength += outputBuffer->length;
+		}
+
+		// 4. Release the chained slabs and reuse the head slab for the next block
+		if (headBuffer->next != NULL) {
+			c49f5b0d_destroyOutputBuffer(headBuffer->next);
+			headBuffer->next = NULL;
+		}
+
+		headBuffer->length = 0;
+	}
+
+	c49f5b0d_destroyOutputBuffer(headBuffer);
+}
+
+static bool fillInput(GzipReader *gzipReader, uint32_t numBytes) {
+	uint32_t numUnparsed;
+
+	numUnparsed = gzipReader->inputLength - gzipReader->inputPos;
+
+	if (numUnparsed >= numBytes) {
+		return true;
+	}
+
+	// 1. Move the unparsed bytes to the start of the input buffer
+	memmove(gzipReader->input, gzipReader->input + gzipReader->inputPos, numUnparsed);
+	gzipReader->inputPos = 0;
+	gzipReader->inputLength = numUnparsed;
+
+	// 2. Read until numBytes are available or the end of file is reached
+	while (gzipReader->inputLength < numBytes) {
+		if (readInput(gzipReader) <= 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool finishInflate(GzipReader *gzipReader) {
+	Inflate *inflate;
+	InputBuffer *inputBuffer;
+	uint8_t *trailer;
+	uint64_t numRemaining;
+
+	inflate = &gzipReader->inflate;
+	inputBuffer = &inflate->inputBuffer;
+
+	// 1. The bytes after the last byte of the bitstream are at the end of the last chunk fed
+	numRemaining = (inputBuffer->totalNumBits - ((inputBuffer->bitPos + 7) & ~0x07ULL)) >> 3;
+
+	if (numRemaining > gzipReader->feedLength) {
+		return printGzipError(gzipReader, "Invalid DEFLATE data");
+	}
+
+	gzipReader->inputPos = gzipReader->inputLength - numRemaining;
+
+	// 2. The last output chunk has yet to be read unless it went to the sink
+	if (gzipReader->sink == NULL) {
+		gzipReader->output = inflate->output;
+		gzipReader->outputLength = inflate->outputLength;
+	}
+
+	// 3. Check the trailer against the inflated data
+	trailer = takeInput(gzipReader, GZIP_TRAILER_SIZE, NULL);
+
+	if (trailer == NULL) {
+		return printGzipError(gzipReader, "Unexpected end of file");
+	}
+
+	if (*(uint32_t*)trailer != inflate->crc32) {
+		return printGzipError(gzipReader, "CRC-32 does not match");
+	}
+
+	if (*(uint32_t*)(trailer + 4) != (uint32_t) inflate->totalOut) {
+		return printGzipError(gzipReader, "Uncompressed size does not match");
+	}
+
+	gzipReader->state = GZIP_STATE_HEADER;
+
+	return true;
+}
+
+static bool flushGzipWriter(GzipWriter *gzipWriter, bool isFinished) {
+	OutputBuffer *outputBuffer;
+	OutputBuffer *tailBuffer;
+	OutputBuffer *nextBuffer;
+
+	outputBuffer = gzipWriter->headBuffer;
+	tailBuffer = gzipWriter->deflate.outputBuffer;
+
+	// 1. Write out and release the full slabs ahead of the one Deflate is filling
+	while (outputBuffer != tailBuffer) {
+		writeOutput(gzipWriter, outputBuffer->buffer, outputBuffer->length);
+
+		nextBuffer = outputBuffer->next;
+		nextBuffer->prev = NULL;
+		outputBuffer->next = NULL;
+
+		c49f5b0d_destroyOutputBuffer(outputBuffer);
+		outputBuffer = nextBuffer;
+	}
+
+	gzipWriter->headBuffer = outputBuffer;
+
+	// 2. Write out the tail once the member is finished; its slab is reused by the next one
+	if (isFinished) {
+		writeOutput(gzipWriter, outputBuffer->buffer, outputBuffer->length);
+		outputBuffer->length = 0;
+	}
+
+	return gzipWriter->isOk;
+}
+
+static uint32_t getModTime(int fd) {
+	FileStatus fileStatus;
+
+	if (e2f74138_getDescriptorStatus(fd, &fileStatus) && S_ISREG(fileStatus.st_mode)) {
+		return (uint32_t) fileStatus.st_mtime;
+	}
+
+	return 0;
+}
+
+static bool inflateMember(GzipReader *gzipReader) {
+	Inflate *inflate;
+	ssize_t numBytes;
+	bool isInflated;
+
+	inflate = &gzipReader->inflate;
+
+	if (inflate->status == INFLATE_OUTPUT_FULL) {
+		// 1. The previous output chunk has been read, so resume inflation
+		isInflated = d592eb82_inflateFeed(inflate, NULL, 0);
+	} else {
+		// 2. Feed the unparsed input, reading more once all of it has been fed
+		if (gzipReader->inputPos == gzipReader->inputLength) {
+			gzipReader->inputPos = 0;
+			gzipReader->inputLength = 0;
+
+			numBytes = readInput(gzipReader);
+
+			if (numBytes <= 0) {
+				return (numBytes == 0) ? printGzipError(gzipReader, "Unexpected end of file") : false;
+			}
+		}
+
+		gzipReader->feedLength = gzipReader->inputLength - gzipReader->inputPos;
+		isInflated = d592eb82_inflateFeed(inflate, gzipReader->input + gzipReader->inputPos, gzipReader->feedLength);
+		gzipReader->inputPos = gzipReader->inputLength;
+	}
+
+	if (isInflated) {
+		return finishInflate(gzipReader);
+	}
+
+	// 3. Hand out the output chunk, or wait for more input
+	if (inflate->status == INFLATE_OUTPUT_FULL) {
+		gzipReader->output = inflate->output;
+		gzipReader->outputLength = inflate->outputLength;
+
+		return true;
+	}
+
+	if (inflate->status == INFLATE_NEED_INPUT) {
+		return true;
+	}
+
+	if (inflate->status == INFLATE_OUTPUT_ERROR) {
+		c7c88e52_printLibError("Cannot write the decompressed data", errno);
+		gzipReader->state = GZIP_STATE_ERROR;
+
+		return false;
+	}
+
+	return printGzipError(gzipReader, "Invalid DEFLATE data");
+}
+
+static bool printGzipError(GzipReader *gzipReader, char *message) {
+	StringBuilder errorMessage;
+	c598a24c_initStringBuilder(&errorMessage);
+
+	c598a24c_append_string(&errorMessage, message);
+	c598a24c_append_string(&errorMessage, " in '");
+	c598a24c_append_string(&errorMessage, gzipReader->pathName);
+	c598a24c_append_char(&errorMessage, '\'');
+
+	c7c88e52_printError_string(errorMessage.buffer);
+	c598a24c_cleanUpStringBuilder(&errorMessage);
+
+	gzipReader->state = GZIP_STATE_ERROR;
+
+	return false;
+}
+
+static ssize_t readInput(GzipReader *gzipReader) {
+	ssize_t numBytes;
+
+	do {
+		numBytes = read(gzipReader->fd, gzipReader->input + gzipReader->inputLength, GZIP_INPUT_LENGTH - gzipReader->inputLength);
+	} while (numBytes == SYSTEM_ERROR_CODE && errno == EINTR);
+
+	if (numBytes == SYSTEM_ERROR_CODE) {
+		c7c88e52_printLibError(gzipReader->pathName, errno);
+		gzipReader->state = GZIP_STATE_ERROR;
+	} else {
+		gzipReader->inputLength += numBytes;
+	}
+
+	return numBytes;
+}
+
+static uint32_t readBatch(int inputFd, uint8_t *buffer, uint32_t length, bool *isEnd) {
+	uint32_t batchLength;
+	ssize_t numBytes;
+
+	batchLength = 0;
+
+	// Read until the batch is full or the end of file is reached
+	while (batchLength < length) {
+		numBytes = read(inputFd, buffer + batchLength, length - batchLength);
+
+		if (numBytes == SYSTEM_ERROR_CODE) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			c7c88e52_printLibError("Cannot read the data to compress", errno);
+			return 0;
+		}
+
+		if (numBytes == 0) {
+			*isEnd = true;
+			break;
+		}
+
+		batchLength += numBytes;
+	}
+
+	return batchLength;
+}
+
+static bool readMemberHeader(GzipReader *gzipReader) {
+	uint8_t *header;
+	uint32_t crc32;
+	uint8_t flags;
+
+	// 1. A clean end of file after the last member ends the stream
+	if (!fillInput(gzipReader, 1)) {
+		if (gzipReader->state == GZIP_STATE_ERROR) {
+			return false;
+		}
+
+		if (gzipReader->numMembers == 0) {
+			return printGzipError(gzipReader, "Not in gzip format");
+		}
+
+		gzipReader->state = GZIP_STATE_END;
+		return true;
+	}
+
+	// 2. Anything after the last member that is not another member is ignored, as gzip does
+	if (gzipReader->input[gzipReader->inputPos] != GZIP_ID1
+	        || !fillInput(gzipReader, 2)
+	        || gzipReader->input[gzipReader->inputPos + 1] != GZIP_ID2) {
+		if (gzipReader->state == GZIP_STATE_ERROR) {
+			return false;
+		}
+
+		if (gzipReader->numMembers == 0) {
+			return printGzipError(gzipReader, "Not in gzip format");
+		}
+
+		c7c88e52_printNotice("Trailing garbage ignored after the last gzip member");
+		gzipReader->state = GZIP_STATE_END;
+		return true;
+	}
+
+	// 3. Parse the fixed part of the header
+	crc32 = 0;
+	header = takeInput(gzipReader, GZIP_HEADER_SIZE, &crc32);
+
+	if (header == NULL) {
+		return (gzipReader->state == GZIP_STATE_ERROR) ? false : printGzipError(gzipReader, "Unexpected end of file");
+	}
+
+	if (header[2] != GZIP_METHOD_DEFLATE) {
+		return printGzipError(gzipReader, "Unknown compression method");
+	}
+
+	flags = header[3];
+	gzipReader->modTime = *(uint32_t*)(header + 4);
+
+	if (flags & GZIP_FLAG_RESERVED) {
+		return printGzipError(gzipReader, "Reserved gzip header flags are set");
+	}
+
+	// 4. Parse the optional fields in the order they are stored
+	if (gzipReader->fileName != NULL) {
+		f668c4bd_free(gzipReader->fileName);
+		gzipReader->fileName = NULL;
+	}
+
+	if (flags & GZIP_FLAG_EXTRA) {
+		header = takeInput(gzipReader, 2, &crc32);
+
+		if (header == NULL || !skipInput(gzipReader, *(uint16_t*)header, &crc32)) {
+			return (gzipReader->state == GZIP_STATE_ERROR) ? false : printGzipError(gzipReader, "Unexpected end of file");
+		}
+	}
+
+	if ((flags & GZIP_FLAG_NAME) && !readString(gzipReader, &crc32, &gzipReader->fileName)) {
+		return false;
+	}
+
+	if ((flags & GZIP_FLAG_COMMENT) && !readString(gzipReader, &crc32, NULL)) {
+		return false;
+	}
+
+	if (flags & GZIP_FLAG_HCRC) {
+		header = takeInput(gzipReader, 2, NULL);
+
+		if (header == NULL) {
+			return (gzipReader->state == GZIP_STATE_ERROR) ? false : printGzipError(gzipReader, "Unexpected end of file");
+		}
+
+		if (*(uint16_t*)header != (uint16_t) crc32) {
+			return printGzipError(gzipReader, "Header CRC-16 does not match");
+		}
+	}
+
+	// 5. Reset Inflate for the DEFLATE bitstream of the member
+	d592eb82_resetInflate(&gzipReader->inflate, NULL, 0);
+	d592eb82_setSink(&gzipReader->inflate, gzipReader->sink, gzipReader->sinkData);
+
+	gzipReader->numMembers++;
+	gzipReader->state = GZIP_STATE_DATA;
+
+	return true;
+}
+
+static bool readString(GzipReader *gzipReader, uint32_t *crc32, char **value) {
+	uint8_t *string;
+	uint8_t *terminator;
+	uint32_t searchPos, length;
+
+	searchPos = 0;
+
+	while (true) {
+		// 1. Search the input not yet searched for the null terminator
+		string = gzipReader->input + gzipReader->inputPos;
+		length = gzipReader->inputLength - gzipReader->inputPos;
+		terminator = memchr(string + searchPos, '\0', length - searchPos);
+
+		if (terminator != NULL) {
+			break;
+		}
+
+		// 2. Read more input; the string must fit in the input buffer
+		if (length == GZIP_INPUT_LENGTH) {
+			return printGzipError(gzipReader, "Gzip header string is too long");
+		}
+
+		searchPos = length;
+
+		if (!fillInput(gzipReader, length + 1)) {
+			return (gzipReader->state == GZIP_STATE_ERROR) ? false : printGzipError(gzipReader, "Unexpected end of file");
+		}
+	}
+
+	// 3. Consume the string along with its null terminator
+	length = terminator - string;
+	takeInput(gzipReader, length + 1, crc32);
+
+	if (value != NULL) {
+		*value = f668c4bd_stralloc(length);
+		f6215943_copyToBuffer((char*) string, *value, length);
+	}
+
+	return true;
+}
+
+static void *runGzipWorker(void *gzipWorkerPtr) {
+	GzipWorker *gzipWorker;
+
+	gzipWorker = (GzipWorker *) gzipWorkerPtr;
+	compressGzipBlocks(gzipWorker);
+
+	// The worker released its OutputBuffer chain, so its thread pools are empty
+	ce97d170_destroyThreadPools(false);
+
+	return NULL;
+}
+
+static void runGzipWorkers(GzipWorker *workerList, uint32_t numThreads, uint32_t numBlocks) {
+	uint32_t nextBlock;
+
+	// 1. Start no more workers than there are blocks to compress
+	nextBlock = 0;
+	numThreads = (numBlocks < numThreads) ? numBlocks : numThreads;
+
+	for (uint32_t i=0; i < numThreads; i++) {
+		workerList[i].nextBlock = &nextBlock;
+		workerList[i].numBlocks = numBlocks;
+		workerList[i].isThreaded = (pthread_create(&workerList[i].thread, NULL, runGzipWorker, &workerList[i]) == 0);
+	}
+
+	// 2. Wait for the workers to finish
+	for (uint32_t i=0; i < numThreads; i++) {
+		if (workerList[i].isThreaded) {
+			pthread_join(workerList[i].thread, NULL);
+		} else {
+			// Fall back to compressing the remaining blocks on this thread
+			compressGzipBlocks(&workerList[i]);
+		}
+	}
+}
+
+static bool skipInput(GzipReader *gzipReader, uint32_t numBytes, uint32_t *crc32) {
+	uint32_t length;
+
+	while (numBytes > 0) {
+		// Consume the buffered input first, then one input buffer at a time
+		length = gzipReader->inputLength - gzipReader->inputPos;
+		length = (length == 0) ? GZIP_INPUT_LENGTH : length;
+		length = (length > numBytes) ? numBytes : length;
+
+		if (takeInput(gzipReader, length, crc32) == NULL) {
+			return false;
+		}
+
+		numBytes -= length;
+	}
+
+	return true;
+}
+
+static uint8_t *takeInput(GzipReader *gzipReader, uint32_t numBytes, uint32_t *crc32) {
+	uint8_t *bytes;
+
+	if (!fillInput(gzipReader, numBytes)) {
+		return NULL;
+	}
+
+	bytes = gzipReader->input + gzipReader->inputPos;
+	gzipReader->inputPos += numBytes;
+
+	// The FHCRC covers every header byte before it
+	if (crc32 != NULL) {
+		*crc32 = b7e0468d_crc32(bytes, numBytes, *crc32);
+	}
+
+	return bytes;
+}
+
+static bool writeOutput(GzipWriter *gzipWriter, void *buffer, uint32_t length) {
+	ssize_t numBytes;
+
+	// Nothing more is written once a write has failed
+	while (gzipWriter->isOk && length > 0) {
+		numBytes = e2f74138_writeFile(gzipWriter->fd, buffer, length, gzipWriter->pathName);
+
+		if (numBytes == SYSTEM_ERROR_CODE) {
+			gzipWriter->isOk = false;
+			break;
+		}
+
+		buffer += numBytes;
+		length -= numBytes;
+	}
+
+	return gzipWriter->isOk;
+}
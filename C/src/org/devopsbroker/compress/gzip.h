@@ -0,0 +1,341 @@
+/*
+ * gzip.h - DevOpsBroker C header file for the org.devopsbroker.compress.Gzip struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_COMPRESS_GZIP_H | md5sum | cut -c 25-32
+ *
+ * A gzip file (RFC 1952) is a series of members, each of which is a header,
+ * a DEFLATE bitstream and a trailer:
+ *
+ *   +---+---+---+---+---+---+---+---+---+---+
+ *   |ID1|ID2|CM |FLG|     MTIME     |XFL|OS |
+ *   +---+---+---+---+---+---+---+---+---+---+
+ *   (FEXTRA: XLEN and XLEN bytes) (FNAME: zero-terminated file name)
+ *   (FCOMMENT: zero-terminated comment) (FHCRC: CRC-16 of the header)
+ *   ... DEFLATE bitstream ...
+ *   +---+---+---+---+---+---+---+---+
+ *   |     CRC32     |     ISIZE     |
+ *   +---+---+---+---+---+---+---+---+
+ *
+ * The GzipReader pushes the compressed input into Inflate with
+ * d592eb82_inflateFeed() one read at a time, so a file of any size is
+ * decompressed in constant memory. The members are decompressed one after the
+ * other as a single stream, with the CRC-32 and ISIZE of each one checked
+ * against its trailer.
+ *
+ * aadb6d78_gzipParallel() splits the input into GZIP_BLOCK_SIZE blocks that
+ * are compressed on worker threads, each primed with the 32KB of input before
+ * it. Every block but the last ends with a sync flush, so the blocks are
+ * simply concatenated into one DEFLATE bitstream and the CRC-32 values of the
+ * blocks are combined for the trailer.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_COMPRESS_GZIP_H
+#define ORG_DEVOPSBROKER_COMPRESS_GZIP_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <assert.h>
+#include <sys/types.h>
+
+#include "deflate.h"
+#include "inflate.h"
+#include "iobuffer.h"
+
+#include "../io/filebuffer.h"
+#include "../text/linebuffer.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define GZIP_ID1               0x1f
+#define GZIP_ID2               0x8b
+#define GZIP_METHOD_DEFLATE    8
+#define GZIP_OS_UNIX           3
+
+#define GZIP_FLAG_TEXT         0x01
+#define GZIP_FLAG_HCRC         0x02
+#define GZIP_FLAG_EXTRA        0x04
+#define GZIP_FLAG_NAME         0x08
+#define GZIP_FLAG_COMMENT      0x10
+#define GZIP_FLAG_RESERVED     0xE0
+
+#define GZIP_HEADER_SIZE       10
+#define GZIP_TRAILER_SIZE      8
+
+#define GZIP_INPUT_LENGTH      65536
+#define GZIP_BLOCK_SIZE        131072
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef enum GzipState {
+	GZIP_STATE_HEADER,            // Next is a member header or the end of file
+	GZIP_STATE_DATA,              // Inside the DEFLATE bitstream of a member
+	GZIP_STATE_END,               // All members processed
+	GZIP_STATE_ERROR              // Invalid input or I/O error
+} GzipState;
+
+/*
+ * GzipReader
+ *   - Inflate engine, reset for each member
+ *   - Input buffer of GZIP_INPUT_LENGTH bytes read from the file descriptor;
+ *     inputPos is the next byte not yet parsed or fed to Inflate
+ *   - Length of the last chunk fed to Inflate, to find where the member ended
+ *   - The FNAME and MTIME of the current member, if any
+ *   - Unread part of the current output chunk
+ *   - Optional sink the output is passed to instead of being read
+ */
+typedef struct GzipReader {
+	Inflate          inflate;
+	uint8_t         *input;
+	char            *pathName;
+	char            *fileName;
+	uint8_t         *output;
+	InflateSinkFunc  sink;
+	void            *sinkData;
+	uint32_t         outputLength;
+	uint32_t         inputPos;
+	uint32_t         inputLength;
+	uint32_t         feedLength;
+	uint32_t         modTime;
+	uint32_t         numMembers;
+	int              fd;
+	GzipState        state;
+} GzipReader;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(GzipReader) == 360, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(GzipReader) == 264, "Check your assumptions");
+#endif
+
+/*
+ * GzipWriter
+ *   - Deflate encoder, reset for each member
+ *   - OutputBuffer chain of the compressed member; full slabs are written to
+ *     the file descriptor as they fill and the tail one is kept until the
+ *     member is finished
+ */
+typedef struct GzipWriter {
+	Deflate       deflate;
+	OutputBuffer *headBuffer;
+	char         *pathName;
+	int           fd;
+	bool          isOk;
+} GzipWriter;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(GzipWriter) == 2696, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(GzipWriter) == 2668, "Check your assumptions");
+#endif
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_cleanUpGzipReader
+ * Description: Frees the input buffer and Inflate engine of the GzipReader;
+ *              the file descriptor is left open
+ *
+ * Parameters:
+ *   gzipReader     A pointer to the GzipReader instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void aadb6d78_cleanUpGzipReader(GzipReader *gzipReader);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_initGzipReader
+ * Description: Initializes a GzipReader struct over an open file descriptor
+ *
+ * Parameters:
+ *   gzipReader     A pointer to the GzipReader instance to initalize
+ *   fd             The file descriptor of the gzip file, open for reading
+ *   pathName       The name of the gzip file (used for error handling)
+ * ----------------------------------------------------------------------------
+ */
+void aadb6d78_initGzipReader(GzipReader *gzipReader, int fd, char *pathName);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_cleanUpGzipWriter
+ * Description: Frees the Deflate encoder and any unwritten OutputBuffer slabs
+ *              of the GzipWriter; the file descriptor is left open
+ *
+ * Parameters:
+ *   gzipWriter     A pointer to the GzipWriter instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void aadb6d78_cleanUpGzipWriter(GzipWriter *gzipWriter);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_initGzipWriter
+ * Description: Initializes a GzipWriter struct over an open file descriptor
+ *
+ * Parameters:
+ *   gzipWriter     A pointer to the GzipWriter instance to initalize
+ *   fd             The file descriptor to write the gzip file to
+ *   pathName       The name of the gzip file (used for error handling)
+ *   level          The compression level, DEFLATE_MIN_LEVEL to DEFLATE_MAX_LEVEL
+ * ----------------------------------------------------------------------------
+ */
+void aadb6d78_initGzipWriter(GzipWriter *gzipWriter, int fd, char *pathName, int level);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_readGzip
+ * Description: Reads up to length bytes of decompressed data, continuing
+ *              across member boundaries
+ *
+ * Parameters:
+ *   gzipReader     A pointer to the GzipReader instance
+ *   buffer         The buffer to read into
+ *   length         The maximum number of bytes to read
+ * Returns:         The number of bytes read, zero at the end of the last
+ *                  member, or SYSTEM_ERROR_CODE on invalid input or I/O error
+ * ----------------------------------------------------------------------------
+ */
+ssize_t aadb6d78_readGzip(GzipReader *gzipReader, void *buffer, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_populateFileBuffer
+ * Description: Moves the unread bytes of the FileBuffer to its start and
+ *              fills the rest of it with decompressed data; dataOffset is
+ *              reset to zero and the data is null-terminated, so lines can be
+ *              read with c196bc72_getLineFromFileBuffer()
+ *
+ * Parameters:
+ *   gzipReader     A pointer to the GzipReader instance
+ *   fileBuffer     A pointer to the FileBuffer instance to populate
+ *   size           The size of the FileBuffer buffer, including the null
+ *                  terminator
+ * Returns:         The number of bytes populated (zero == end of file), or
+ *                  SYSTEM_ERROR_CODE on invalid input or I/O error
+ * ----------------------------------------------------------------------------
+ */
+ssize_t aadb6d78_populateFileBuffer(GzipReader *gzipReader, FileBuffer *fileBuffer, uint32_t size);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_populateLineBuffer
+ * Description: Populates the LineBuffer with decompressed data, the same as
+ *              c196bc72_populateLineBuffer() does from a file descriptor
+ *
+ * Parameters:
+ *   gzipReader     A pointer to the GzipReader instance
+ *   lineBuffer     A pointer to the LineBuffer instance to populate
+ * Returns:         The number of bytes populated (zero == end of file), or
+ *                  SYSTEM_ERROR_CODE on invalid input or I/O error
+ * ----------------------------------------------------------------------------
+ */
+int aadb6d78_populateLineBuffer(GzipReader *gzipReader, LineBuffer *lineBuffer);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_gunzip
+ * Description: Decompresses every member of a gzip file to another file
+ *              descriptor, without copying the output through a read buffer
+ *
+ * Parameters:
+ *   inputFd        The file descriptor of the gzip file, open for reading
+ *   outputFd       The file descriptor to write the decompressed data to
+ *   pathName       The name of the gzip file (used for error handling)
+ * Returns:         True if every member was decompressed and verified, false
+ *                  otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aadb6d78_gunzip(int inputFd, int outputFd, char *pathName);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_startMember
+ * Description: Writes the header of a new gzip member and resets the Deflate
+ *              encoder for its data
+ *
+ * Parameters:
+ *   gzipWriter     A pointer to the GzipWriter instance
+ *   fileName       The FNAME of the member, or NULL for none
+ *   modTime        The MTIME of the member, or zero if not available
+ * ----------------------------------------------------------------------------
+ */
+void aadb6d78_startMember(GzipWriter *gzipWriter, char *fileName, uint32_t modTime);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_writeGzip
+ * Description: Compresses the data into the current member, writing out the
+ *              OutputBuffer slabs that fill up
+ *
+ * Parameters:
+ *   gzipWriter     A pointer to the GzipWriter instance
+ *   buffer         The data to compress
+ *   length         The length of the data
+ * Returns:         True if the slabs were written, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aadb6d78_writeGzip(GzipWriter *gzipWriter, void *buffer, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_finishMember
+ * Description: Emits the final DEFLATE block and the trailer of the current
+ *              member, and writes out the rest of the member
+ *
+ * Parameters:
+ *   gzipWriter     A pointer to the GzipWriter instance
+ * Returns:         True if the whole member was written, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aadb6d78_finishMember(GzipWriter *gzipWriter);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_gzip
+ * Description: Compresses everything read from a file descriptor into a
+ *              single gzip member written to another file descriptor
+ *
+ * Parameters:
+ *   inputFd        The file descriptor to read the data from
+ *   outputFd       The file descriptor to write the gzip file to
+ *   pathName       The name of the gzip file (used for error handling)
+ *   level          The compression level, DEFLATE_MIN_LEVEL to DEFLATE_MAX_LEVEL
+ * Returns:         True if the gzip file was written, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aadb6d78_gzip(int inputFd, int outputFd, char *pathName, int level);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aadb6d78_gzipParallel
+ * Description: Compresses everything read from a file descriptor like
+ *              aadb6d78_gzip() using numThreads worker threads, each of which
+ *              compresses GZIP_BLOCK_SIZE blocks of the input
+ *
+ * Parameters:
+ *   inputFd        The file descriptor to read the data from
+ *   outputFd       The file descriptor to write the gzip file to
+ *   pathName       The name of the gzip file (used for error handling)
+ *   level          The compression level, DEFLATE_MIN_LEVEL to DEFLATE_MAX_LEVEL
+ *   numThreads     The number of worker threads; one compresses serially
+ * Returns:         True if the gzip file was written, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aadb6d78_gzipParallel(int inputFd, int outputFd, char *pathName, int level, uint32_t numThreads);
+
+#endif /* ORG_DEVOPSBROKER_COMPRESS_GZIP_H */
@@ -38,29 +38,124 @@
 #include "huffman.h"
 #include "bits.h"
 
-#include "../lang/error.h"
-
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
+#define LITLEN_EOB         256
+#define LITLEN_TBL_OFFSET  257
+#define LITLEN_MAX         285
+#define DISTSYM_MAX        29
+
+#define ENTRY(type, numBits, extraBits, value) \
+	((uint32_t)(numBits) | ((uint32_t)(type) << 5) | ((uint32_t)(extraBits) << 8) | ((uint32_t)(value) << 16))
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
+/*
+ * Table of litlen symbol values minus 257 with corresponding base length and
+ * number of extra bits.
+ */
+typedef struct LitlenSymbol {
+	uint16_t baseLength : 9;
+	uint16_t extraBits : 7;
+} LitlenSymbol;
+
+static_assert(sizeof(LitlenSymbol) == 2, "Check your assumptions");
+
+/*
+ * Table of dist symbol values with corresponding base distance and number of
+ * extra bits.
+ */
+typedef struct DistSymbol {
+	uint32_t baseDist : 16;
+	uint32_t extraBits : 16;
+} DistSymbol;
+
+static_assert(sizeof(DistSymbol) == 4, "Check your assumptions");
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
+static const struct LitlenSymbol litlen_tbl[29] = {
+	{ 3, 0 },                     // 257
+	{ 4, 0 },                     // 258
+	{ 5, 0 },                     // 259
+	{ 6, 0 },                     // 260
+	{ 7, 0 },                     // 261
+	{ 8, 0 },                     // 262
+	{ 9, 0 },                     // 263
+	{ 10, 0 },                    // 264
+	{ 11, 1 },                    // 265
+	{ 13, 1 },                    // 266
+	{ 15, 1 },                    // 267
+	{ 17, 1 },                    // 268
+	{ 19, 2 },                    // 269
+	{ 23, 2 },                    // 270
+	{ 27, 2 },                    // 271
+	{ 31, 2 },                    // 272
+	{ 35, 3 },                    // 273
+	{ 43, 3 },                    // 274
+	{ 51, 3 },                    // 275
+	{ 59, 3 },                    // 276
+	{ 67, 4 },                    // 277
+	{ 83, 4 },                    // 278
+	{ 99, 4 },                    // 279
+	{ 115, 4 },                   // 280
+	{ 131, 5 },                   // 281
+	{ 163, 5 },                   // 282
+	{ 195, 5 },                   // 283
+	{ 227, 5 },                   // 284
+	{ 258, 0 }                    // 285
+};
+
+static const struct DistSymbol dist_tbl[30] = {
+	{ 1, 0 },                      // 0
+	{ 2, 0 },                      // 1
+	{ 3, 0 },                      // 2
+	{ 4, 0 },                      // 3
+	{ 5, 1 },                      // 4
+	{ 7, 1 },                      // 5
+	{ 9, 2 },                      // 6
+	{ 13, 2 },                     // 7
+	{ 17, 3 },                     // 8
+	{ 25, 3 },                     // 9
+	{ 33, 4 },                     // 10
+	{ 49, 4 },                     // 11
+	{ 65, 5 },                     // 12
+	{ 97, 5 },                     // 13
+	{ 129, 6 },                    // 14
+	{ 193, 6 },                    // 15
+	{ 257, 7 },                    // 16
+	{ 385, 7 },                    // 17
+	{ 513, 8 },                    // 18
+	{ 769, 8 },                    // 19
+	{ 1025, 9 },                   // 20
+	{ 1537, 9 },                   // 21
+	{ 2049, 10 },                  // 22
+	{ 3073, 10 },                  // 23
+	{ 4097, 11 },                  // 24
+	{ 6145, 11 },                  // 25
+	{ 8193, 12 },                  // 26
+	{ 12289, 12 },                 // 27
+	{ 16385, 13 },                 // 28
+	{ 24577, 13 }                  // 29
+};
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
-static void table_insert(HuffmanDecoder *decoder, uint32_t symbol, uint32_t length, uint16_t codeword);
+static uint32_t createEntry(HuffmanAlphabet alphabet, uint32_t symbol, uint32_t length);
+static void fillPrimaryTable(HuffmanDecoder *decoder, uint32_t entry, uint32_t codeword, uint32_t length);
+static void packLiterals(HuffmanDecoder *decoder);
 
 // ═════════════════════════ Function Implementations ═════════════════════════
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
-HuffmanDecoder *f173ab5a_createHuffmanDecoder(uint8_t *lengthArray, uint32_t numElements) {
+HuffmanDecoder *f173ab5a_createHuffmanDecoder(uint8_t *lengthArray, uint32_t numElements, HuffmanAlphabet alphabet) {
 	HuffmanDecoder *decoder = f668c4bd_malloc(sizeof(HuffmanDecoder));
 
-	f173ab5a_initHuffmanDecoder(decoder, lengthArray, numElements);
+	if (!f173ab5a_initHuffmanDecoder(decoder, lengthArray, numElements, alphabet)) {
+		f668c4bd_free(decoder);
+		return NULL;
+	}
 
 	return decoder;
 }
@@ -71,118 +166,205 @@ void f173ab5a_destroyHuffmanDecoder(HuffmanDecoder *decoder) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-void f173ab5a_initHuffmanDecoder(HuffmanDecoder *decoder, uint8_t *lengthArray, uint32_t numElements) {
-	uint16_t next_code[16] = {0};
-	uint16_t sym_idx[16] = {0};
-	uint8_t count[16] = {0};
-	uint32_t i, l, s;
-
-	// Keep track of the number of symbols
-	decoder->numSymbols = numElements;
-
-	// Initialize the HuffmanDecoder memory to zeroes
-	f668c4bd_meminit(decoder, sizeof(HuffmanDecoder));
-
-	// Count the number of codes for each code length
+bool f173ab5a_initHuffmanDecoder(HuffmanDecoder *decoder, uint8_t *lengthArray, uint32_t numElements, HuffmanAlphabet alphabet) {
+	uint16_t count[MAX_HUFFMAN_BITS + 1] = {0};
+	uint16_t offset[MAX_HUFFMAN_BITS + 1];
+	uint16_t sortedSymbols[MAX_HUFFMAN_SYMBOLS];
+	uint32_t tableBits, tableEnd, subtableBits, subtableStart, subPrefix;
+	uint32_t codeword, reversed, symbol, entry, length, maxLength, numCodes;
+	uint32_t i;
+	int32_t left;
+
+	tableBits = (alphabet == HUFFMAN_LITLEN) ? HUFFMAN_LITLEN_TABLE_BITS
+	          : (alphabet == HUFFMAN_DIST) ? HUFFMAN_DIST_TABLE_BITS : HUFFMAN_CODELEN_TABLE_BITS;
+	decoder->tableBits = tableBits;
+	decoder->tableMask = (1U << tableBits) - 1;
+
+	// 1. Count the number of codes for each code length
 	for (i=0; i < numElements; i++) {
 		count[lengthArray[i]]++;
 	}
 
-//	printf("Count codewords lengths: ");
-//	d9352b73_printByteArray(count, 16);
-//	printf("\n");
-
-	// Find the numerical value of the smallest code for each code length
 	count[0] = 0;
-//	printf("Sentinal bits: \n");
-	for (i=0, l=1; l <= MAX_HUFFMAN_BITS; i++, l++) {
-		next_code[l] = (uint16_t) ((next_code[i] + count[i]) << 1);
+	numCodes = 0;
+	maxLength = 0;
+	for (length=1; length <= MAX_HUFFMAN_BITS; length++) {
+		numCodes += count[length];
+		maxLength = (count[length] != 0) ? length : maxLength;
+	}
 
-		s = (uint32_t)((next_code[l] + count[l]) << (MAX_HUFFMAN_BITS - l));
-		decoder->sentinel_bits[l] = (uint16_t)s;
-		sym_idx[l] = sym_idx[i] + count[i];
-		decoder->offset_first_sym_idx[l] = sym_idx[l] - next_code[l];
+	// 2. Reject over-subscribed codes, and incomplete ones other than a single one-bit code
+	left = 1;
+	for (length=1; length <= MAX_HUFFMAN_BITS; length++) {
+		left = (left << 1) - count[length];
 
-//		printf("\tLength: %d  Code[l]: %u  Count[l]: %u  Sentinal Bits: %u  Sym_idx[l]: %u  Offset[l]: %u\n", l, next_code[l], count[l], s, sym_idx[l], decoder->offset_first_sym_idx[l]);
+		if (left < 0) {
+			return false;
+		}
 	}
-//	printf("\n");
 
-//	printf("Codes for the codelengths: ");
-//	a4b6dbea_printShortArray(next_code, MAX_HUFFMAN_BITS + 1);
-//	printf("\n");
+	if (left > 0) {
+		if (numCodes > 1 || (numCodes == 1 && (maxLength != 1 || alphabet == HUFFMAN_CODELEN))) {
+			return false;
+		}
 
-//	printf("Symbol indexes: ");
-//	a4b6dbea_printShortArray(sym_idx, MAX_HUFFMAN_BITS + 1);
-//	printf("\n");
+		// Unused codewords decode to invalid entries
+		f668c4bd_meminit(decoder->table, (1U << tableBits) * sizeof(uint32_t));
+	}
 
-	// Build mapping from index to symbol and populate the lookup table
-//	printf("Symbols: \n");
-	for (i = 0; i < numElements; i++) {
-		l = lengthArray[i];
-		if (l == 0) {
-			continue;
-		}
+	// 3. Sort the symbols by code length, then by symbol value
+	offset[1] = 0;
+	for (length=1; length < MAX_HUFFMAN_BITS; length++) {
+		offset[length + 1] = offset[length] + count[length];
+	}
 
-		decoder->syms[sym_idx[l]] = (uint16_t)i;
-//		printf("\tIndex: %d  Length[i]: %u  Syms[sym_idx[l]]: %u  Code[l]: %u\n", i, l, decoder->syms[sym_idx[l]], next_code[l]);
-		sym_idx[l]++;
+	for (i=0; i < numElements; i++) {
+		if (lengthArray[i] != 0) {
+			sortedSymbols[offset[lengthArray[i]]++] = (uint16_t)i;
+		}
+	}
 
-		if (l <= HUFFMAN_LOOKUP_TABLE_BITS) {
-			table_insert(decoder, i, l, next_code[l]);
-			next_code[l]++;
+	// 4. Assign the canonical codewords in order and fill the tables
+	tableEnd = (1U << tableBits);
+	subtableBits = 0;
+	subtableStart = 0;
+	subPrefix = UINT32_MAX;
+	codeword = 0;
+	i = 0;
+
+	for (length=1; length <= maxLength; length++) {
+		while (count[length] != 0) {
+			symbol = sortedSymbols[i++];
+			entry = createEntry(alphabet, symbol, length);
+			reversed = e474415b_reverse16((uint16_t)codeword, length);
+
+			if (length <= tableBits) {
+				fillPrimaryTable(decoder, entry, reversed, length);
+			} else {
+				// Start a new subtable when the first tableBits of the codeword change
+				if ((reversed & decoder->tableMask) != subPrefix) {
+					subPrefix = reversed & decoder->tableMask;
+					subtableBits = length - tableBits;
+					left = (1 << subtableBits);
+
+					// Size the subtable to hold the remaining codes sharing the prefix
+					while (subtableBits + tableBits < maxLength) {
+						left -= count[subtableBits + tableBits];
+
+						if (left <= 0) {
+							break;
+						}
+
+						subtableBits++;
+						left <<= 1;
+					}
+
+					subtableStart = tableEnd;
+					tableEnd += (1U << subtableBits);
+
+					if (tableEnd > HUFFMAN_TABLE_SIZE) {
+						return false;
+					}
+
+					decoder->table[subPrefix] = ENTRY(HUFFMAN_ENTRY_SUBTABLE, tableBits, subtableBits, subtableStart);
+				}
+
+				for (uint32_t j = (reversed >> tableBits); j < (1U << subtableBits); j += (1U << (length - tableBits))) {
+					decoder->table[subtableStart + j] = entry;
+				}
+			}
+
+			count[length]--;
+			codeword++;
 		}
+
+		codeword <<= 1;
 	}
-//	printf("\n");
-}
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// 5. Pack pairs of short literal codewords into single entries
+	if (alphabet == HUFFMAN_LITLEN) {
+		packLiterals(decoder);
+	}
 
-int f173ab5a_huffmanDecode(InputBuffer *inputBuffer, HuffmanDecoder *decoder, size_t *numBitsUsed) {
-	uint16_t lookupBits;
-	uint16_t bits;
-	uint32_t l;
-	uint32_t symbolIndex;
+	return true;
+}
 
-	bits = (uint16_t) inputBuffer->bits;
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-	// First try the lookup table
-	lookupBits = bits & 0xFF;
-	if (decoder->table[lookupBits].len != 0) {
-		(*numBitsUsed) = decoder->table[lookupBits].len;
-		return decoder->table[lookupBits].sym;
+static uint32_t createEntry(HuffmanAlphabet alphabet, uint32_t symbol, uint32_t length) {
+	if (alphabet == HUFFMAN_LITLEN) {
+		if (symbol < LITLEN_EOB) {
+			return ENTRY(HUFFMAN_ENTRY_LITERAL, length, length, symbol);
+		} else if (symbol == LITLEN_EOB) {
+			return ENTRY(HUFFMAN_ENTRY_EOB, length, 0, 0);
+		} else if (symbol <= LITLEN_MAX) {
+			symbol -= LITLEN_TBL_OFFSET;
+			return ENTRY(HUFFMAN_ENTRY_LENGTH, length, litlen_tbl[symbol].extraBits, litlen_tbl[symbol].baseLength);
+		}
+	} else if (alphabet == HUFFMAN_DIST) {
+		if (symbol <= DISTSYM_MAX) {
+			return ENTRY(HUFFMAN_ENTRY_DIST, length, dist_tbl[symbol].extraBits, dist_tbl[symbol].baseDist);
+		}
+	} else {
+		return ENTRY(HUFFMAN_ENTRY_SYMBOL, length, 0, symbol);
 	}
 
-	// Then do canonical decoding with the bits in MSB-first order
-	bits = e474415b_reverse16(bits, MAX_HUFFMAN_BITS);
-	for (l = HUFFMAN_LOOKUP_TABLE_BITS + 1; l <= MAX_HUFFMAN_BITS; l++) {
-		if (bits < decoder->sentinel_bits[l]) {
-			bits >>= MAX_HUFFMAN_BITS - l;
+	return ENTRY(HUFFMAN_ENTRY_INVALID, length, 0, 0);
+}
 
-			symbolIndex = (uint16_t)(decoder->offset_first_sym_idx[l] + bits);
-			(*numBitsUsed) = l;
+static void fillPrimaryTable(HuffmanDecoder *decoder, uint32_t entry, uint32_t codeword, uint32_t length) {
+	uint32_t tableSize, extraBits, numBits, type, value;
 
-			return decoder->syms[symbolIndex];
+	tableSize = (1U << decoder->tableBits);
+	type = HUFFMAN_ENTRY_TYPE(entry);
+	extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+	value = HUFFMAN_ENTRY_VALUE(entry);
+	numBits = length + extraBits;
+
+	// Resolve the extra bits of lengths and distances when they fit in the table
+	if ((type == HUFFMAN_ENTRY_LENGTH || type == HUFFMAN_ENTRY_DIST) && extraBits != 0 && numBits <= decoder->tableBits) {
+		for (uint32_t extra=0; extra < (1U << extraBits); extra++) {
+			entry = ENTRY(type, numBits, 0, value + extra);
+
+			for (uint32_t i = codeword | (extra << length); i < tableSize; i += (1U << numBits)) {
+				decoder->table[i] = entry;
+			}
+		}
+	} else {
+		for (uint32_t i = codeword; i < tableSize; i += (1U << length)) {
+			decoder->table[i] = entry;
 		}
 	}
+}
 
-	return SYSTEM_ERROR_CODE;
+static void packLiterals(HuffmanDecoder *decoder) {
+	uint32_t tableSize, entry, nextEntry, length, nextLength, type;
 
-}
+	tableSize = (1U << decoder->tableBits);
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	/*
+	 * The bits after the first literal index the table again. Entries already
+	 * packed keep the first literal and its length in the same fields, so the
+	 * table can be updated in place.
+	 */
+	for (uint32_t i=0; i < tableSize; i++) {
+		entry = decoder->table[i];
 
-static void table_insert(HuffmanDecoder *decoder, uint32_t symbol, uint32_t length, uint16_t codeword) {
-	int padLength;
-	uint16_t padding, index;
+		if (HUFFMAN_ENTRY_TYPE(entry) != HUFFMAN_ENTRY_LITERAL) {
+			continue;
+		}
 
-	// Make the codeword LSB-first
-	codeword = e474415b_reverse16(codeword, length);
-	padLength = (1U << (HUFFMAN_LOOKUP_TABLE_BITS - length));
+		length = HUFFMAN_ENTRY_NUM_BITS(entry);
+		nextEntry = decoder->table[i >> length];
+		type = HUFFMAN_ENTRY_TYPE(nextEntry);
 
-	// Pad the pad_len upper bits with all bit combinations
-	for (padding = 0; padding < padLength; padding++) {
-		index = (uint16_t)(codeword | (padding << length));
-		decoder->table[index].sym = (uint16_t)symbol;
-		decoder->table[index].len = (uint16_t)length;
+		if (type == HUFFMAN_ENTRY_LITERAL || type == HUFFMAN_ENTRY_LITERAL2) {
+			nextLength = HUFFMAN_ENTRY_EXTRA_BITS(nextEntry);
+
+			if (length + nextLength <= decoder->tableBits) {
+				decoder->table[i] = ENTRY(HUFFMAN_ENTRY_LITERAL2, length + nextLength, length,
+				                          HUFFMAN_ENTRY_VALUE(entry) | ((HUFFMAN_ENTRY_VALUE(nextEntry) & 0xFF) << 8));
+			}
+		}
 	}
 }
@@ -19,6 +19,21 @@
  * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-53
  *
  * echo ORG_DEVOPSBROKER_COMPRESS_HUFFMAN | md5sum | cut -c 25-32
+ *
+ * A HuffmanDecoder is a primary lookup table indexed by the next tableBits of
+ * the LSB-first bit stream, followed by subtables for the longer codewords.
+ * Each table entry is a 32-bit value:
+ *
+ *   Bits 0-4    Number of bits the entry consumes from the bit stream
+ *   Bits 5-7    HuffmanEntryType
+ *   Bits 8-12   Number of extra bits still to be read after the entry, or the
+ *               length of the first codeword for literals, or the number of
+ *               index bits of a subtable
+ *   Bits 16-31  Literal(s), base length, base distance, symbol or subtable
+ *               offset
+ *
+ * Literal/length entries pack two literals when both codewords fit in the
+ * primary table, and a length together with its extra bits when they fit.
  * -----------------------------------------------------------------------------
  */
 
@@ -28,41 +43,64 @@
 // ═════════════════════════════════ Includes ═════════════════════════════════
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <assert.h>
 
-#include "iobuffer.h"
-
 #include "../lang/memory.h"
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
 #define MAX_HUFFMAN_BITS  15               // Deflate uses max 15-bit codewords
 #define MAX_HUFFMAN_SYMBOLS  288           // Deflate uses max 288 symbols
-#define HUFFMAN_LOOKUP_TABLE_BITS  8       // Seems a good trade-off
-
-// ═════════════════════════════════ Typedefs ═════════════════════════════════
-
-typedef struct HuffmanDecoder {
-	// Lookup table for fast decoding of short codewords
-	struct {
-		uint16_t sym : 9;              // Wide enough to fit the max symbol nbr
-		uint16_t len : 7;              // 0 means no symbol
-	} table[1U << HUFFMAN_LOOKUP_TABLE_BITS];
 
-	// "Sentinel bits" value for each codeword length
-	uint16_t sentinel_bits[MAX_HUFFMAN_BITS + 1];
+// Primary table bits for each alphabet; the litlen table may use 10-12 bits
+#define HUFFMAN_LITLEN_TABLE_BITS   11
+#define HUFFMAN_DIST_TABLE_BITS     8
+#define HUFFMAN_CODELEN_TABLE_BITS  7
+
+// Worst-case primary table plus subtable entries for 288 symbols of 15 bits
+#if HUFFMAN_LITLEN_TABLE_BITS == 10
+#define HUFFMAN_TABLE_SIZE  1334
+#elif HUFFMAN_LITLEN_TABLE_BITS == 11
+#define HUFFMAN_TABLE_SIZE  2342
+#elif HUFFMAN_LITLEN_TABLE_BITS == 12
+#define HUFFMAN_TABLE_SIZE  4390
+#else
+#error "HUFFMAN_LITLEN_TABLE_BITS must be between 10 and 12"
+#endif
+
+#define HUFFMAN_ENTRY_NUM_BITS(entry)    ((entry) & 0x1F)
+#define HUFFMAN_ENTRY_TYPE(entry)        (((entry) >> 5) & 0x07)
+#define HUFFMAN_ENTRY_EXTRA_BITS(entry)  (((entry) >> 8) & 0x1F)
+#define HUFFMAN_ENTRY_VALUE(entry)       ((entry) >> 16)
 
-	// First symbol index minus first codeword mod 2**16 for each length
-	uint16_t offset_first_sym_idx[MAX_HUFFMAN_BITS + 1];
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
 
-	// Map from symbol index to symbol
-	uint16_t syms[MAX_HUFFMAN_SYMBOLS];
+typedef enum HuffmanAlphabet {
+	HUFFMAN_LITLEN,                // Literal/length alphabet
+	HUFFMAN_DIST,                  // Distance alphabet
+	HUFFMAN_CODELEN                // Code length alphabet
+} HuffmanAlphabet;
+
+typedef enum HuffmanEntryType {
+	HUFFMAN_ENTRY_INVALID,         // Codeword is not used or symbol is invalid
+	HUFFMAN_ENTRY_LITERAL,         // One literal byte
+	HUFFMAN_ENTRY_LITERAL2,        // Two literal bytes, the first in the low byte
+	HUFFMAN_ENTRY_LENGTH,          // Base length plus extra bits
+	HUFFMAN_ENTRY_DIST,            // Base distance plus extra bits
+	HUFFMAN_ENTRY_SYMBOL,          // Code length alphabet symbol
+	HUFFMAN_ENTRY_EOB,             // End of block
+	HUFFMAN_ENTRY_SUBTABLE         // Offset of the subtable for longer codewords
+} HuffmanEntryType;
 
-	uint64_t numSymbols;
+typedef struct HuffmanDecoder {
+	uint32_t table[HUFFMAN_TABLE_SIZE];
+	uint32_t tableBits;
+	uint32_t tableMask;
 } HuffmanDecoder;
 
-static_assert(sizeof(HuffmanDecoder) == 1160, "Check your assumptions");
+static_assert(sizeof(HuffmanDecoder) == (HUFFMAN_TABLE_SIZE * 4) + 8, "Check your assumptions");
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
@@ -78,10 +116,12 @@ static_assert(sizeof(HuffmanDecoder) == 1160, "Check your assumptions");
  * Parameters:
  *   lengthArray    The array of lengths to use to initialize the decoder
  *   numElements    The number of elements in the length array
- * Returns:     A HuffmanDecoder struct instance
+ *   alphabet       The Deflate alphabet the lengths describe
+ * Returns:     A HuffmanDecoder struct instance, or NULL if the lengths do not
+ *              describe a valid code
  * ----------------------------------------------------------------------------
  */
-HuffmanDecoder *f173ab5a_createHuffmanDecoder(uint8_t *lengthArray, uint32_t numElements);
+HuffmanDecoder *f173ab5a_createHuffmanDecoder(uint8_t *lengthArray, uint32_t numElements, HuffmanAlphabet alphabet);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f173ab5a_destroyHuffmanDecoder
@@ -97,32 +137,45 @@ void f173ab5a_destroyHuffmanDecoder(HuffmanDecoder *decoder);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f173ab5a_initHuffmanDecoder
- * Description: Initializes an existing HuffmanDecoder struct
+ * Description: Initializes an existing HuffmanDecoder struct. Over-subscribed
+ *              codes are rejected, as are incomplete codes other than a single
+ *              one-bit codeword.
  *
  * Parameters:
  *   decoder        A pointer to the HuffmanDecoder instance to initalize
  *   lengthArray    The array of lengths to use to initialize the decoder
  *   numElements    The number of elements in the length array
+ *   alphabet       The Deflate alphabet the lengths describe
+ * Returns:     True if the lengths describe a valid code, false otherwise
  * ----------------------------------------------------------------------------
  */
-void f173ab5a_initHuffmanDecoder(HuffmanDecoder *decoder, uint8_t *lengthArray, uint32_t numElements);
+bool f173ab5a_initHuffmanDecoder(HuffmanDecoder *decoder, uint8_t *lengthArray, uint32_t numElements, HuffmanAlphabet alphabet);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f173ab5a_huffmanDecode
- * Description: Use the decoder d to decode a symbol from the LSB-first
- *              zero-padded bits. Returns the decoded symbol number or -1 if
- *              no symbol could be decoded. *num_used_bits will be set to the
- *              number of bits used to decode the symbol, or zero if no symbol
- *              could be decoded.
+ * Description: Looks up the table entry for the next codeword of the LSB-first
+ *              bits, following a subtable entry if the codeword is longer
+ *              than the primary table
  *
  * Parameters:
- *   inputBuffer    The input buffer instance
- *   decoder        A pointer to the HuffmanDecoder instance to initalize
- *   numBitsUsed    The number of bits used during Huffman decoding
+ *   decoder    A pointer to the HuffmanDecoder instance
+ *   bits       The next bits of the bit stream, at least MAX_HUFFMAN_BITS
+ * Returns:     The table entry for the codeword
  * ----------------------------------------------------------------------------
  */
-int f173ab5a_huffmanDecode(InputBuffer *inputBuffer, HuffmanDecoder *decoder, size_t *numBitsUsed);
+static inline uint32_t f173ab5a_huffmanDecode(HuffmanDecoder *decoder, uint64_t bits) {
+	uint32_t entry;
+
+	entry = decoder->table[bits & decoder->tableMask];
+
+	if (HUFFMAN_ENTRY_TYPE(entry) == HUFFMAN_ENTRY_SUBTABLE) {
+		bits >>= decoder->tableBits;
+		entry = decoder->table[HUFFMAN_ENTRY_VALUE(entry) + (bits & ((1U << HUFFMAN_ENTRY_EXTRA_BITS(entry)) - 1))];
+	}
+
+	return entry;
+}
 
 #endif /* ORG_DEVOPSBROKER_COMPRESS_HUFFMAN_H */
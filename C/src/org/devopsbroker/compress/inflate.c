@@ -34,13 +34,25 @@
 // ═════════════════════════════════ Includes ═════════════════════════════════
 
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include <assert.h>
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #include "inflate.h"
 #include "bits.h"
+#include "gzip.h"
 #include "huffman.h"
+#include "lz77.h"
 
+#include "../hash/adler32.h"
+#include "../hash/crc32.h"
 #include "../lang/byte.h"
 #include "../lang/error.h"
 #include "../lang/memory.h"
@@ -50,16 +62,18 @@
 
 #define ISTREAM_MIN_BITS (64 - 7)
 
-#define LITLEN_EOB 256
-#define LITLEN_MAX 285
-#define LITLEN_TBL_OFFSET 257
 #define MIN_LEN 3
 #define MAX_LEN 258
 
-#define DISTSYM_MAX 29
 #define MIN_DISTANCE 1
 #define MAX_DISTANCE 32768
 
+// Bits needed for a litlen codeword, its extra bits, a dist codeword and its extra bits
+#define MAX_BACKREF_BITS (15 + 5 + 15 + 13)
+
+// Output room the fast loop needs for a backref and its copy slack
+#define FAST_LOOP_OUTPUT_MIN (MAX_LEN + LZ77_COPY_SLACK)
+
 #define MIN_CODELEN_LENS 4
 #define MAX_CODELEN_LENS 19
 
@@ -83,152 +97,99 @@
 #define CODELEN_ZEROS2_MIN 11
 #define CODELEN_ZEROS2_MAX 138
 
-// ═════════════════════════════════ Typedefs ═════════════════════════════════
+#define FIXED_LITLEN_LENS 288
+#define FIXED_DIST_LENS 32
 
-/*
- * Table of litlen symbol values minus 257 with corresponding base length and
- * number of extra bits.
- */
-typedef struct LitlenSymbol {
-	uint16_t baseLength : 9;
-	uint16_t extraBits : 7;
-} LitlenSymbol;
+// Largest piece of the input an InputBuffer reads a block header from
+#define BUFFER_HEADER_WINDOW 0x10000000
 
-static_assert(sizeof(LitlenSymbol) == 2, "Check your assumptions");
+#define ZLIB_HEADER_SIZE 2
+#define ZLIB_TRAILER_SIZE 4
+#define ZLIB_METHOD_DEFLATE 8
+#define ZLIB_MAX_WINDOW_BITS 7
+#define ZLIB_FLAG_DICT 0x20
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
 
 /*
- * Table of dist symbol values with corresponding base distance and number of
- * extra bits.
+ * BufferInflate
+ *   - Contiguous input and output of d592eb82_inflateBuffer()
+ *   - Dynamic Huffman decoders
+ *   - Bit position of the next input and byte position of the next output
+ *   - Length of the input and size of the output
  */
-typedef struct DistSymbol {
-	uint32_t baseDist : 16;
-	uint32_t extraBits : 16;
-} DistSymbol;
+typedef struct BufferInflate {
+	uint8_t        *input;
+	uint8_t        *output;
+	HuffmanDecoder *dynamicDecoders;
+	uint64_t        bitPos;
+	uint32_t        outputPos;
+	uint32_t        inputLength;
+	uint32_t        outputSize;
+} BufferInflate;
 
-static_assert(sizeof(DistSymbol) == 4, "Check your assumptions");
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
 static const int codelenLengthsOrder[MAX_CODELEN_LENS] =
 { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
 
-const struct LitlenSymbol litlen_tbl[29] = {
-	{ 3, 0 },                     // 257
-	{ 4, 0 },                     // 258
-	{ 5, 0 },                     // 259
-	{ 6, 0 },                     // 260
-	{ 7, 0 },                     // 261
-	{ 8, 0 },                     // 262
-	{ 9, 0 },                     // 263
-	{ 10, 0 },                    // 264
-	{ 11, 1 },                    // 265
-	{ 13, 1 },                    // 266
-	{ 15, 1 },                    // 267
-	{ 17, 1 },                    // 268
-	{ 19, 2 },                    // 269
-	{ 23, 2 },                    // 270
-	{ 27, 2 },                    // 271
-	{ 31, 2 },                    // 272
-	{ 35, 3 },                    // 273
-	{ 43, 3 },                    // 274
-	{ 51, 3 },                    // 275
-	{ 59, 3 },                    // 276
-	{ 67, 4 },                    // 277
-	{ 83, 4 },                    // 278
-	{ 99, 4 },                    // 279
-	{ 115, 4 },                   // 280
-	{ 131, 5 },                   // 281
-	{ 163, 5 },                   // 282
-	{ 195, 5 },                   // 283
-	{ 227, 5 },                   // 284
-	{ 258, 0 }                    // 285
-};
-
-const struct DistSymbol dist_tbl[30] = {
-	{ 1, 0 },                      // 0
-	{ 2, 0 },                      // 1
-	{ 3, 0 },                      // 2
-	{ 4, 0 },                      // 3
-	{ 5, 1 },                      // 4
-	{ 7, 1 },                      // 5
-	{ 9, 2 },                      // 6
-	{ 13, 2 },                     // 7
-	{ 17, 3 },                     // 8
-	{ 25, 3 },                     // 9
-	{ 33, 4 },                     // 10
-	{ 49, 4 },                     // 11
-	{ 65, 5 },                     // 12
-	{ 97, 5 },                     // 13
-	{ 129, 6 },                    // 14
-	{ 193, 6 },                    // 15
-	{ 257, 7 },                    // 16
-	{ 385, 7 },                    // 17
-	{ 513, 8 },                    // 18
-	{ 769, 8 },                    // 19
-	{ 1025, 9 },                   // 20
-	{ 1537, 9 },                   // 21
-	{ 2049, 10 },                  // 22
-	{ 3073, 10 },                  // 23
-	{ 4097, 11 },                  // 24
-	{ 6145, 11 },                  // 25
-	{ 8193, 12 },                  // 26
-	{ 12289, 12 },                 // 27
-	{ 16385, 13 },                 // 28
-	{ 24577, 13 }                  // 29
-};
-
-
-// ════════════════════════════ Function Prototypes ═══════════════════════════
-
-static bool processNonCompressionBlock(Inflate *inflate);
-static bool processFixedDeflateBlock(Inflate *inflate);
-static bool processDynamicDeflateBlock(Inflate *inflate);
-static bool processLiteralBackrefBlock(Inflate *inflate, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder);
-
-static bool initDynamicDecoder(Inflate *inflate, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder);
-
-
-
-
-
-// Move to somewhere else, or code in assembly
-
-/* Round x up to the next multiple of m, which must be a power of 2. */
-static inline size_t round_up(size_t x, size_t m) {
-	return (x + m - 1) & (size_t)(-m); /* Hacker's Delight (2nd), 3-1. */
-}
-
+// Fixed Huffman decoders, built once by initFixedDecoders()
+static HuffmanDecoder fixedLitlenDecoder;
+static HuffmanDecoder fixedDistDecoder;
+static pthread_once_t fixedDecoderOnce = PTHREAD_ONCE_INIT;
 
+// True if the CPU supports the BMI2 fast loop, set once by initFastLoop()
+static bool isFastLoopSupported = false;
 
+// True if the fast loop is in use; see d592eb82_setFastLoop()
+static bool hasFastLoop = false;
+static pthread_once_t fastLoopOnce = PTHREAD_ONCE_INIT;
 
+// ════════════════════════════ Function Prototypes ═══════════════════════════
 
-// Move to lz77.h
-static void output_backref64(OutputBuffer *outputBuffer, size_t dist, size_t length);
-static void lz77_output_backref(OutputBuffer *outputBuffer, size_t dist, size_t length);
+static void handOutChunk(Inflate *inflate);
+static void nextChunk(Inflate *inflate);
+static bool saveCarry(Inflate *inflate);
+static bool initStoredBlock(Inflate *inflate);
+static bool processStoredBlock(Inflate *inflate);
+static bool processLiteralBackrefBlock(Inflate *inflate);
+
+static InflationStatus initDynamicDecoder(InputBuffer *inputBuffer, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder);
+static uint32_t getBackrefBits(HuffmanDecoder *distDecoder, uint32_t entry, uint64_t bits);
+static void initFixedDecoders();
+
+#if defined(__x86_64__)
+static bool processFastLoop(Inflate *inflate, uint32_t *outputPos);
+#endif
+static void initFastLoop();
+
+static InflationStatus inflateBufferBlocks(BufferInflate *bufferInflate);
+static InflationStatus inflateBufferHuffman(BufferInflate *bufferInflate, HuffmanDecoder *litlenDecoder,
+                                            HuffmanDecoder *distDecoder);
+static InflationStatus inflateBufferGzip(BufferInflate *bufferInflate);
+static InflationStatus inflateBufferZlib(BufferInflate *bufferInflate);
+static InflationStatus skipGzipHeader(BufferInflate *bufferInflate, uint32_t *position);
+static uint8_t *findBufferString(BufferInflate *bufferInflate, uint32_t position);
+
+static void lz77_output_backref(uint8_t *outputBuf, size_t dist, size_t length);
+static void output_wrapped_backref(uint8_t *window, uint32_t outputPos, uint32_t dist, uint32_t length);
 
 // ═════════════════════════ Function Implementations ═════════════════════════
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
-Inflate *d592eb82_createInflate(FileBuffer *fileBuffer, uint32_t compressSize) {
+Inflate *d592eb82_createInflate(FileBuffer *fileBuffer, uint64_t compressSize) {
 	Inflate *inflate = f668c4bd_malloc(sizeof(Inflate));
 
-	// Initialize InputBuffer
-	c49f5b0d_initInputBuffer(&inflate->inputBuffer, fileBuffer, compressSize);
-
-	// Initialize OutputBuffer
-	c49f5b0d_initOutputBuffer(&inflate->outputBuffer);
-
-	// Initialize status
-	inflate->inputBlockStart = 0;
-	inflate->status = INFLATE_SUCCESS;
+	d592eb82_initInflate(inflate, fileBuffer, compressSize);
 
 	return inflate;
 }
 
 void d592eb82_destroyInflate(Inflate *inflate) {
-	// Clean up OutputBuffer
-	c49f5b0d_cleanUpOutputBuffer(&inflate->outputBuffer);
+	// Free the output window and dynamic Huffman decoders
+	d592eb82_cleanUpInflate(inflate);
 
 	// Free Inflate
 	f668c4bd_free(inflate);
@@ -237,176 +198,448 @@ void d592eb82_destroyInflate(Inflate *inflate) {
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 void d592eb82_cleanUpInflate(Inflate *inflate) {
-	// Clean up OutputBuffer struct
-	c49f5b0d_cleanUpOutputBuffer(&inflate->outputBuffer);
+	f668c4bd_free(inflate->window);
+	f668c4bd_free(inflate->dynamicDecoders);
+	f668c4bd_free(inflate->carry);
 }
 
-void d592eb82_initInflate(Inflate *inflate, FileBuffer *fileBuffer, uint32_t compressSize) {
+void d592eb82_initInflate(Inflate *inflate, FileBuffer *fileBuffer, uint64_t compressSize) {
+	// Build the fixed Huffman decoders the first time through
+	pthread_once(&fixedDecoderOnce, initFixedDecoders);
+	pthread_once(&fastLoopOnce, initFastLoop);
+
+	// Page-aligned window so each output chunk can be written with O_DIRECT
+	inflate->window = f668c4bd_alignedAlloc(MEMORY_PAGE_SIZE, INFLATE_RING_SIZE);
+	inflate->dynamicDecoders = f668c4bd_malloc(sizeof(HuffmanDecoder) * 2);
+	inflate->carry = f668c4bd_malloc(INFLATE_INPUT_LENGTH);
+
+	d592eb82_resetInflate(inflate, fileBuffer, compressSize);
+}
+
+void d592eb82_resetInflate(Inflate *inflate, FileBuffer *fileBuffer, uint64_t compressSize) {
+	// Initialize the carry buffer; fed input starts out in the empty carry buffer
+	f668c4bd_meminit(&inflate->carryBuffer, sizeof(FileBuffer));
+	f668c4bd_meminit(&inflate->feedBuffer, sizeof(FileBuffer));
+	inflate->carryBuffer.buffer = inflate->carry;
+	inflate->totalIn = 0;
+
 	// Initialize InputBuffer
-	c49f5b0d_initInputBuffer(&inflate->inputBuffer, fileBuffer, compressSize);
+	if (fileBuffer == NULL) {
+		c49f5b0d_initInputBuffer(&inflate->inputBuffer, &inflate->carryBuffer, 0);
+	} else {
+		c49f5b0d_initInputBuffer(&inflate->inputBuffer, fileBuffer, compressSize);
+	}
 
-	// Initialize OutputBuffer
-	c49f5b0d_initOutputBuffer(&inflate->outputBuffer);
+	inflate->blockInput = inflate->inputBuffer;
+
+	// Initialize the block decoders and output sink
+	inflate->litlenDecoder = NULL;
+	inflate->distDecoder = NULL;
+	inflate->sink = NULL;
+	inflate->sinkData = NULL;
+
+	// Initialize the output window
+	inflate->output = inflate->window;
+	inflate->totalOut = 0;
+	inflate->outputLength = 0;
+	inflate->outputPos = 0;
+	inflate->chunkStart = 0;
+	inflate->storedLength = 0;
+	inflate->copyLength = 0;
+	inflate->copyDist = 0;
+	inflate->crc32 = 0;
 
 	// Initialize status
-	inflate->inputBlockStart = 0;
+	inflate->state = INFLATE_STATE_HEADER;
 	inflate->status = INFLATE_SUCCESS;
+	inflate->isFinalBlock = false;
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 bool d592eb82_inflate(Inflate *inflate) {
+	InputBuffer *inputBuffer;
 	uint32_t blockType;
-	bool isFinalBlock;
 	bool okStatus;
 
-	okStatus = true;
+	inputBuffer = &inflate->inputBuffer;
 
-	do {
-		// Read the 3-bit block header value
-		if (!c49f5b0d_useNumBits(&inflate->inputBuffer, 3)) {
-			inflate->status = INFLATE_INPUT_ERROR;
+	// 1. The caller is done with the chunk returned along with INFLATE_OUTPUT_FULL
+	if (inflate->status == INFLATE_OUTPUT_FULL) {
+		nextChunk(inflate);
+		inflate->status = INFLATE_SUCCESS;
+	}
+
+	// 2. Process blocks until the final one is done; resumes inside a block
+	while (inflate->state != INFLATE_STATE_DONE) {
+		if (inflate->state == INFLATE_STATE_HEADER) {
+			if (inflate->isFinalBlock) {
+				inflate->state = INFLATE_STATE_DONE;
+				break;
+			}
+
+			// Remember where the block starts in case its header is cut off
+			inflate->blockInput = *inputBuffer;
+
+			// Read the 3-bit block header value
+			if (!c49f5b0d_useNumBits(inputBuffer, 3)) {
+				inflate->status = INFLATE_NEED_INPUT;
+				return false;
+			}
+			inflate->isFinalBlock = inputBuffer->bits & 0x01;
+			blockType = inputBuffer->bits & 0x06;
+			inputBuffer->bits >>= 3;
+
+			if (blockType == 0) {
+				// No compression
+				okStatus = initStoredBlock(inflate);
+			} else if (blockType == 2) {
+				// Compression with fixed Huffman codes
+				inflate->litlenDecoder = &fixedLitlenDecoder;
+				inflate->distDecoder = &fixedDistDecoder;
+				inflate->state = INFLATE_STATE_HUFFMAN;
+				okStatus = true;
+			} else if (blockType == 4) {
+				// Compression with dynamic Huffman codes
+				inflate->litlenDecoder = &inflate->dynamicDecoders[0];
+				inflate->distDecoder = &inflate->dynamicDecoders[1];
+				inflate->status = initDynamicDecoder(inputBuffer, inflate->litlenDecoder, inflate->distDecoder);
+				okStatus = (inflate->status == INFLATE_SUCCESS);
+
+				if (okStatus) {
+					inflate->state = INFLATE_STATE_HUFFMAN;
+				}
+			} else {
+				// Invalid block type
+				inflate->status = INFLATE_INPUT_ERROR;
+				return false;
+			}
+		} else if (inflate->state == INFLATE_STATE_STORED) {
+			okStatus = processStoredBlock(inflate);
+		} else {
+			okStatus = processLiteralBackrefBlock(inflate);
+		}
+
+		if (!okStatus) {
+			if (inflate->status != INFLATE_OUTPUT_FULL) {
+				// Decode a cut off block header again from its start
+				if (inflate->status == INFLATE_NEED_INPUT && inflate->state == INFLATE_STATE_HEADER) {
+					*inputBuffer = inflate->blockInput;
+					inflate->isFinalBlock = false;
+				}
+
+				return false;
+			}
+
+			// Hand the full chunk to the sink, or return it to the caller
+			handOutChunk(inflate);
+
+			if (inflate->sink == NULL) {
+				return false;
+			}
+
+			if (!inflate->sink(inflate->sinkData, inflate->output, inflate->outputLength)) {
+				inflate->status = INFLATE_OUTPUT_ERROR;
+				return false;
+			}
+
+			nextChunk(inflate);
+			inflate->status = INFLATE_SUCCESS;
+		}
+	}
+
+	// 3. Hand out the last chunk of the stream
+	handOutChunk(inflate);
+
+	if (inflate->sink != NULL && inflate->outputLength > 0) {
+		if (!inflate->sink(inflate->sinkData, inflate->output, inflate->outputLength)) {
+			inflate->status = INFLATE_OUTPUT_ERROR;
 			return false;
 		}
-		isFinalBlock = inflate->inputBuffer.bits & 0x01;
-		blockType = inflate->inputBuffer.bits & 0x06;
-		inflate->inputBuffer.bits >>= 3;
+	}
 
-		if (blockType == 0) {
-			// No compression
-			okStatus = processNonCompressionBlock(inflate);
-		} else if (blockType == 2) {
-			// Compression with fixed Huffman codes
-			okStatus = processFixedDeflateBlock(inflate);
-		} else if (blockType == 4) {
-			// Compression with dynamic Huffman codes
-			okStatus = processDynamicDeflateBlock(inflate);
+	nextChunk(inflate);
+	inflate->status = INFLATE_SUCCESS;
+
+	return true;
+}
+
+bool d592eb82_inflateFeed(Inflate *inflate, void *bytes, uint32_t length) {
+	InputBuffer *inputBuffer;
+	FileBuffer *carryBuffer;
+
+	inputBuffer = &inflate->inputBuffer;
+	carryBuffer = &inflate->carryBuffer;
+
+	// 1. Copy small chunks onto the carry buffer, otherwise chain the chunk after it
+	if (length > 0) {
+		if (carryBuffer->numBytes + length <= INFLATE_INPUT_LENGTH) {
+			memcpy(inflate->carry + carryBuffer->numBytes, bytes, length);
+			carryBuffer->numBytes += length;
 		} else {
-			// Invalid block type
-			inflate->status = INFLATE_INPUT_ERROR;
+			inflate->feedBuffer.buffer = bytes;
+			inflate->feedBuffer.numBytes = length;
+			carryBuffer->next = &inflate->feedBuffer;
+		}
+
+		inflate->totalIn += length;
+		inputBuffer->totalNumBits = inflate->totalIn << 3;
+	}
+
+	// 2. Inflate as much of the input as possible
+	if (d592eb82_inflate(inflate)) {
+		return true;
+	}
+
+	// 3. Keep the unused input in the carry buffer until the next chunk is fed
+	if (inflate->status == INFLATE_NEED_INPUT && !saveCarry(inflate)) {
+		inflate->status = INFLATE_INPUT_ERROR;
+	}
+
+	return false;
+}
+
+InflationStatus d592eb82_inflateBuffer(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity,
+                                       uint32_t *numProduced, InflateFormat format) {
+	BufferInflate bufferInflate;
+	InflationStatus status;
+
+	// Build the fixed Huffman decoders the first time through
+	pthread_once(&fixedDecoderOnce, initFixedDecoders);
+
+	bufferInflate.input = source;
+	bufferInflate.output = dest;
+	bufferInflate.dynamicDecoders = f668c4bd_malloc(sizeof(HuffmanDecoder) * 2);
+	bufferInflate.bitPos = 0;
+	bufferInflate.outputPos = 0;
+	bufferInflate.inputLength = sourceLength;
+	bufferInflate.outputSize = destCapacity;
+
+	if (format == INFLATE_FORMAT_GZIP) {
+		status = inflateBufferGzip(&bufferInflate);
+	} else if (format == INFLATE_FORMAT_ZLIB) {
+		status = inflateBufferZlib(&bufferInflate);
+	} else {
+		status = inflateBufferBlocks(&bufferInflate);
+	}
+
+	f668c4bd_free(bufferInflate.dynamicDecoders);
+	*numProduced = bufferInflate.outputPos;
+
+	return status;
+}
+
+void d592eb82_setSink(Inflate *inflate, InflateSinkFunc sink, void *sinkData) {
+	inflate->sink = sink;
+	inflate->sinkData = sinkData;
+}
+
+bool d592eb82_setFastLoop(bool isEnabled) {
+	// Detect BMI2 first so initFastLoop() cannot undo the setting later
+	pthread_once(&fastLoopOnce, initFastLoop);
+
+	hasFastLoop = isEnabled && isFastLoopSupported;
+
+	return hasFastLoop;
+}
+
+bool d592eb82_fileSink(void *fdPtr, void *buffer, uint32_t length) {
+	ssize_t numBytes;
+	int fd;
+
+	fd = *(int*)fdPtr;
+
+	while (length > 0) {
+		numBytes = write(fd, buffer, length);
+
+		if (numBytes == SYSTEM_ERROR_CODE) {
+			if (errno == EINTR) {
+				continue;
+			}
+
 			return false;
 		}
-	} while (!isFinalBlock && okStatus);
 
-	if (okStatus) {
-		inflate->status = INFLATE_SUCCESS;
+		buffer += numBytes;
+		length -= numBytes;
 	}
 
-	return okStatus;
+	return true;
+}
+
+bool d592eb82_outputBufferSink(void *tailPtr, void *buffer, uint32_t length) {
+	OutputBuffer **tailBuffer = tailPtr;
+
+	*tailBuffer = c49f5b0d_append(*tailBuffer, buffer, length);
+
+	return true;
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-static bool processNonCompressionBlock(Inflate *inflate) {
-//	uint16_t blockLength, checksum;
+static void handOutChunk(Inflate *inflate) {
+	inflate->output = inflate->window + inflate->chunkStart;
+	inflate->outputLength = inflate->outputPos - inflate->chunkStart;
 
-	puts("Non-compression deflate block!");
-/*
-	// 1. Move input position to the next byte
-	inflate->inputStream.buffer++;
-	//inflate->inputBufPos++;
+	// Update the CRC-32 while the chunk that was just inflated is still in the cache
+	inflate->crc32 = b7e0468d_crc32(inflate->output, inflate->outputLength, inflate->crc32);
+}
 
-	// 2. Read block length and checksum
-	if ((inflate->inputBufPos + 4) >= inflate->inputBufLen) {
-		inflate->status = INFLATE_NEED_INPUT;
-		return false;
+static void nextChunk(Inflate *inflate) {
+	// Account for the chunk that was handed out and start the next one
+	inflate->totalOut += inflate->outputLength;
+
+	if (inflate->outputPos == INFLATE_RING_SIZE) {
+		inflate->outputPos = 0;
 	}
 
-	blockLength = (*(uint16_t*)inflate->inputStream.buffer);
-	inflate->inputStream.buffer += 2;
-	checksum = (*(uint16_t*)inflate->inputStream.buffer);
-	inflate->inputStream.buffer += 2;
-	//inflate->inputBufPos += 4;
+	inflate->chunkStart = inflate->outputPos;
+}
 
-	printf("Block Length: %u\nChecksum: %u\n", blockLength, checksum);
+static bool saveCarry(Inflate *inflate) {
+	InputBuffer *inputBuffer;
+	FileBuffer *fileBuffer;
+	uint32_t offset, numBytes;
 
-	// 3. Compare the length to the checksum
-	if (blockLength != ~checksum) {
-		inflate->status = INFLATE_INPUT_ERROR;
+	inputBuffer = &inflate->inputBuffer;
+	fileBuffer = inputBuffer->fileBuffer;
+	offset = inputBuffer->offsetBitPos >> 3;
+
+	// 1. Move the unused bytes of the current buffer to the start of the carry buffer
+	numBytes = fileBuffer->numBytes - offset;
+	memmove(inflate->carry, fileBuffer->buffer + offset, numBytes);
+
+	// 2. Append the bytes of the fed chunk that follows it
+	if (fileBuffer->next != NULL) {
+		fileBuffer = fileBuffer->next;
+
+		// Only a cut off block header or symbol is left unused
+		if (numBytes + fileBuffer->numBytes > INFLATE_INPUT_LENGTH) {
+			return false;
+		}
+
+		memcpy(inflate->carry + numBytes, fileBuffer->buffer, fileBuffer->numBytes);
+		numBytes += fileBuffer->numBytes;
+	}
+
+	// 3. Resume from the carry buffer
+	inflate->carryBuffer.numBytes = numBytes;
+	inflate->carryBuffer.next = NULL;
+
+	inputBuffer->fileBuffer = &inflate->carryBuffer;
+	inputBuffer->buffer = inflate->carry;
+	inputBuffer->offsetBitPos &= 0x07;
+
+	return true;
+}
+
+static bool initStoredBlock(Inflate *inflate) {
+	InputBuffer *inputBuffer;
+	uint8_t header[4];
+	uint32_t blockLength, checksum;
+
+	inputBuffer = &inflate->inputBuffer;
+
+	// 1. Move input position to the next byte
+	if (!c49f5b0d_skipBits(inputBuffer, (8 - (inputBuffer->bitPos & 0x07)) & 0x07)) {
+		inflate->status = INFLATE_NEED_INPUT;
 		return false;
 	}
 
-	// 4. Make sure we have enough input to read uncompressed data block
-	if ((inflate->inputBufPos + blockLength) >= inflate->inputBufLen) {
+	// 2. Read block length and its one's complement
+	if (!c49f5b0d_copyBytes(inputBuffer, header, 4)) {
 		inflate->status = INFLATE_NEED_INPUT;
 		return false;
 	}
 
-	// 5. Make sure there is enough room in the output for the uncompressed data block
-	if ((inflate->outputBufPos + blockLength) >= INFLATE_OUTPUT_LENGTH) {
-		inflate->status = INFLATE_OUTPUT_FULL;
+	blockLength = header[0] | (header[1] << 8);
+	checksum = header[2] | (header[3] << 8);
+
+	// 3. Compare the length to the checksum
+	if (blockLength != (~checksum & 0xFFFF)) {
+		inflate->status = INFLATE_INPUT_ERROR;
 		return false;
 	}
 
-	f668c4bd_memcopy(inflate->inputStream.buffer, inflate->outputPtr, blockLength);
-	//inflate->inputBufPos += blockLength;
-	inflate->outputBufPos += blockLength;
-*/
+	inflate->storedLength = blockLength;
+	inflate->state = INFLATE_STATE_STORED;
+
 	return true;
 }
 
-static bool processFixedDeflateBlock(Inflate *inflate) {
-	puts("Fixed deflate block!");
+static bool processStoredBlock(Inflate *inflate) {
+	InputBuffer *inputBuffer;
+	uint64_t numInputBytes;
+	uint32_t numBytes;
 
-	return true;
-}
+	inputBuffer = &inflate->inputBuffer;
 
-static bool processDynamicDeflateBlock(Inflate *inflate) {
-	HuffmanDecoder litlenDecoder, distDecoder;
-	bool isSuccess = false;
+	while (inflate->storedLength > 0) {
+		// 1. Make sure there is room in the output chunk and input to copy
+		numBytes = inflate->chunkStart + INFLATE_OUTPUT_LENGTH - inflate->outputPos;
 
-	// printf("Dynamic deflate block!\n");
+		if (numBytes == 0) {
+			inflate->status = INFLATE_OUTPUT_FULL;
+			return false;
+		}
 
-	// 1. Initialize the dynamic litlen and dist Huffman decoders
-	isSuccess = initDynamicDecoder(inflate, &litlenDecoder, &distDecoder);
+		numInputBytes = (inputBuffer->totalNumBits - inputBuffer->bitPos) >> 3;
 
-	if (!isSuccess) {
-		return false;
+		if (numInputBytes == 0) {
+			inflate->status = INFLATE_NEED_INPUT;
+			return false;
+		}
+
+		numBytes = (numBytes > inflate->storedLength) ? inflate->storedLength : numBytes;
+		numBytes = (numBytes > numInputBytes) ? numInputBytes : numBytes;
+
+		// 2. Copy the uncompressed data into the window
+		if (!c49f5b0d_copyBytes(inputBuffer, inflate->window + inflate->outputPos, numBytes)) {
+			inflate->status = INFLATE_NEED_INPUT;
+			return false;
+		}
+
+		inflate->outputPos += numBytes;
+		inflate->storedLength -= numBytes;
 	}
 
-	// 2. Process the literals and backrefs block
-	isSuccess = processLiteralBackrefBlock(inflate, &litlenDecoder, &distDecoder);
+	inflate->state = INFLATE_STATE_HEADER;
 
-	return isSuccess;
+	return true;
 }
 
-static bool initDynamicDecoder(Inflate *inflate, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder) {
+static InflationStatus initDynamicDecoder(InputBuffer *inputBuffer, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder) {
 	HuffmanDecoder codelenDecoder;
 	uint8_t codelenLengthArray[MAX_CODELEN_LENS];
 	uint8_t codeLengthArray[MAX_LITLEN_LENS + MAX_DIST_LENS];
 	uint32_t numCodelenLens, numLitlenLens, numDistLens;
-	size_t numBitsUsed;
+	uint32_t numBitsUsed, entry, symbol;
 	uint32_t i, j;
-	int symbol;
 
 	// Read the 14-bit dynamic Huffman codes
-	if (!c49f5b0d_useNumBits(&inflate->inputBuffer, 14)) {
-		inflate->status = INFLATE_NEED_INPUT;
-		return false;
+	if (!c49f5b0d_useNumBits(inputBuffer, 14)) {
+		return INFLATE_NEED_INPUT;
 	}
 
 	// Number of litlen codeword lengths (5 bits + 257)
-	numLitlenLens = ((inflate->inputBuffer.bits & 0x1F) + MIN_LITLEN_LENS);
-	inflate->inputBuffer.bits >>= 5;
+	numLitlenLens = ((inputBuffer->bits & 0x1F) + MIN_LITLEN_LENS);
+	inputBuffer->bits >>= 5;
 	if (numLitlenLens > MAX_LITLEN_LENS) {
-		inflate->status = INFLATE_INPUT_ERROR;
-		return false;
+		return INFLATE_INPUT_ERROR;
 	}
 
 	// Number of dist codeword lengths (5 bits + 1)
-	numDistLens = ((inflate->inputBuffer.bits & 0x1F) + MIN_DIST_LENS);
-	inflate->inputBuffer.bits >>= 5;
+	numDistLens = ((inputBuffer->bits & 0x1F) + MIN_DIST_LENS);
+	inputBuffer->bits >>= 5;
 	if (numDistLens > MAX_DIST_LENS) {
-		inflate->status = INFLATE_INPUT_ERROR;
-		return false;
+		return INFLATE_INPUT_ERROR;
 	}
 
 	// Number of code length lengths (4 bits + 4)
-	numCodelenLens = ((inflate->inputBuffer.bits & 0x0F) + MIN_CODELEN_LENS);
-	inflate->inputBuffer.bits >>= 4;
+	numCodelenLens = ((inputBuffer->bits & 0x0F) + MIN_CODELEN_LENS);
+	inputBuffer->bits >>= 4;
 	if (numCodelenLens > MAX_CODELEN_LENS) {
-		inflate->status = INFLATE_INPUT_ERROR;
-		return false;
+		return INFLATE_INPUT_ERROR;
 	}
 
 //	printf("Num Litlen Lengths: %u\n", numLitlenLens);
@@ -415,13 +648,12 @@ static bool initDynamicDecoder(Inflate *inflate, HuffmanDecoder *litlenDecoder,
 
 	// Initialize the codelen decoder by reading the 3-bit codelen codeword lengths
 	for (i=0; i < numCodelenLens; i++) {
-		if (!c49f5b0d_useNumBits(&inflate->inputBuffer, 3)) {
-			inflate->status = INFLATE_NEED_INPUT;
-			return false;
+		if (!c49f5b0d_useNumBits(inputBuffer, 3)) {
+			return INFLATE_NEED_INPUT;
 		}
 
-		codelenLengthArray[codelenLengthsOrder[i]] = (uint8_t) (inflate->inputBuffer.bits & 0x07);
-		inflate->inputBuffer.bits >>= 3;
+		codelenLengthArray[codelenLengthsOrder[i]] = (uint8_t) (inputBuffer->bits & 0x07);
+		inputBuffer->bits >>= 3;
 	}
 
 	for (; i < MAX_CODELEN_LENS; i++) {
@@ -431,32 +663,43 @@ static bool initDynamicDecoder(Inflate *inflate, HuffmanDecoder *litlenDecoder,
 //	d9352b73_printByteArray(codelenLengthArray, MAX_CODELEN_LENS);
 //	printf("\n");
 
-	f173ab5a_initHuffmanDecoder(&codelenDecoder, codelenLengthArray, MAX_CODELEN_LENS);
+	if (!f173ab5a_initHuffmanDecoder(&codelenDecoder, codelenLengthArray, MAX_CODELEN_LENS, HUFFMAN_CODELEN)) {
+		return INFLATE_INPUT_ERROR;
+	}
 
 	// Read the litlen and dist codeword lengths
 	i = 0;
 	while (i < numLitlenLens + numDistLens) {
-		c49f5b0d_getNextBits(&inflate->inputBuffer);
-		symbol = f173ab5a_huffmanDecode(&inflate->inputBuffer, &codelenDecoder, &numBitsUsed);
-		inflate->inputBuffer.bits >>= numBitsUsed;
+		c49f5b0d_getNextBits(inputBuffer);
+		entry = f173ab5a_huffmanDecode(&codelenDecoder, inputBuffer->bits);
+		numBitsUsed = HUFFMAN_ENTRY_NUM_BITS(entry);
+		inputBuffer->bits >>= numBitsUsed;
 
-		if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, numBitsUsed)) {
-			inflate->status = INFLATE_NEED_INPUT;
-			return false;
+		if (!c49f5b0d_advanceNumBits(inputBuffer, numBitsUsed)) {
+			return INFLATE_NEED_INPUT;
 		}
 
-		if (symbol >= 0 && symbol <= CODELEN_MAX_LIT) {
+		if (HUFFMAN_ENTRY_TYPE(entry) != HUFFMAN_ENTRY_SYMBOL) {
+			return INFLATE_INPUT_ERROR;
+		}
+
+		symbol = HUFFMAN_ENTRY_VALUE(entry);
+
+		if (symbol <= CODELEN_MAX_LIT) {
 			// A literal codeword length
 			codeLengthArray[i++] = (uint8_t)symbol;
 		} else if (symbol == CODELEN_COPY) {
 			// Copy the previous codeword length 3--6 times
 
 			// 2 bits + 3
-			if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, 2)) {
-				inflate->status = INFLATE_NEED_INPUT;
-				return false;
+			if (!c49f5b0d_advanceNumBits(inputBuffer, 2)) {
+				return INFLATE_NEED_INPUT;
+			}
+			j = ((inputBuffer->bits & 0x03) + CODELEN_COPY_MIN);
+
+			if (i == 0 || i + j > numLitlenLens + numDistLens) {
+				return INFLATE_INPUT_ERROR;
 			}
-			j = ((inflate->inputBuffer.bits & 0x03) + CODELEN_COPY_MIN);
 
 			while (j--) {
 				codeLengthArray[i] = codeLengthArray[i - 1];
@@ -464,179 +707,817 @@ static bool initDynamicDecoder(Inflate *inflate, HuffmanDecoder *litlenDecoder,
 			}
 		} else if (symbol == CODELEN_ZEROS) {
 			// 3--10 zeros; 3 bits + 3
-			if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, 3)) {
-				inflate->status = INFLATE_NEED_INPUT;
-				return false;
+			if (!c49f5b0d_advanceNumBits(inputBuffer, 3)) {
+				return INFLATE_NEED_INPUT;
+			}
+			j = ((inputBuffer->bits & 0x07) + CODELEN_ZEROS_MIN);
+
+			if (i + j > numLitlenLens + numDistLens) {
+				return INFLATE_INPUT_ERROR;
 			}
-			j = ((inflate->inputBuffer.bits & 0x07) + CODELEN_ZEROS_MIN);
 
 			while (j--) {
 				codeLengthArray[i++] = 0;
 			}
 		} else if (symbol == CODELEN_ZEROS2) {
 			// 11--138 zeros; 7 bits + 138
-			if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, 7)) {
-				inflate->status = INFLATE_NEED_INPUT;
-				return false;
+			if (!c49f5b0d_advanceNumBits(inputBuffer, 7)) {
+				return INFLATE_NEED_INPUT;
+			}
+			j = ((inputBuffer->bits & 0x7F) + CODELEN_ZEROS2_MIN);
+
+			if (i + j > numLitlenLens + numDistLens) {
+				return INFLATE_INPUT_ERROR;
 			}
-			j = ((inflate->inputBuffer.bits & 0x7F) + CODELEN_ZEROS2_MIN);
 
 			while (j--) {
 				codeLengthArray[i++] = 0;
 			}
 		} else {
 			// Invalid symbol
-			inflate->status = INFLATE_INPUT_ERROR;
-			return false;
+			return INFLATE_INPUT_ERROR;
 		}
 	}
 
-	// Initialize the litlen decoder
-	f173ab5a_initHuffmanDecoder(litlenDecoder, &codeLengthArray[0], numLitlenLens);
+	// Initialize the litlen and dist decoders
+	if (!f173ab5a_initHuffmanDecoder(litlenDecoder, &codeLengthArray[0], numLitlenLens, HUFFMAN_LITLEN)
+	        || !f173ab5a_initHuffmanDecoder(distDecoder, &codeLengthArray[numLitlenLens], numDistLens, HUFFMAN_DIST)) {
+		return INFLATE_INPUT_ERROR;
+	}
 
-	// Initialize the dist decoder
-	f173ab5a_initHuffmanDecoder(distDecoder, &codeLengthArray[numLitlenLens], numDistLens);
+	return INFLATE_SUCCESS;
+}
 
-	return true;
+static uint32_t getBackrefBits(HuffmanDecoder *distDecoder, uint32_t entry, uint64_t bits) {
+	uint32_t numBits;
+
+	// Litlen codeword and length extra bits
+	numBits = HUFFMAN_ENTRY_NUM_BITS(entry) + HUFFMAN_ENTRY_EXTRA_BITS(entry);
+
+	// Dist codeword and distance extra bits
+	entry = f173ab5a_huffmanDecode(distDecoder, bits >> numBits);
+
+	return numBits + HUFFMAN_ENTRY_NUM_BITS(entry) + HUFFMAN_ENTRY_EXTRA_BITS(entry);
 }
 
-static bool processLiteralBackrefBlock(Inflate *inflate, HuffmanDecoder *litlenDecoder, HuffmanDecoder *distDecoder) {
-	uint8_t *outputBuf;
-	size_t numBitsUsed, totalBitsUsed, dist, length;
-	int litlen, distSymbol;
-	uint16_t extraBits;
+static void initFixedDecoders() {
+	uint8_t codeLengthArray[FIXED_LITLEN_LENS];
+	uint32_t i;
 
-	outputBuf = (uint8_t *) inflate->outputBuffer.buffer;
+	// Fixed litlen codeword lengths from RFC 1951 section 3.2.6
+	for (i=0; i < 144; i++) {
+		codeLengthArray[i] = 8;
+	}
 
-	while (true) {
-		// Read a litlen symbol
-		c49f5b0d_getNextBits(&inflate->inputBuffer);
-		litlen = f173ab5a_huffmanDecode(&inflate->inputBuffer, litlenDecoder, &numBitsUsed);
-		inflate->inputBuffer.bits >>= numBitsUsed;
-		totalBitsUsed = numBitsUsed;
+	for (; i < 256; i++) {
+		codeLengthArray[i] = 9;
+	}
 
-		if (litlen < 0 || litlen > LITLEN_MAX) {
-			// Failed to decode, or invalid symbol
-			inflate->status = INFLATE_INPUT_ERROR;
-			return false;
-		} else if (litlen <= UINT8_MAX) {
-			// Literal
-			if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, totalBitsUsed)) {
-				inflate->status = INFLATE_NEED_INPUT;
+	for (; i < 280; i++) {
+		codeLengthArray[i] = 7;
+	}
+
+	for (; i < FIXED_LITLEN_LENS; i++) {
+		codeLengthArray[i] = 8;
+	}
+
+	f173ab5a_initHuffmanDecoder(&fixedLitlenDecoder, codeLengthArray, FIXED_LITLEN_LENS, HUFFMAN_LITLEN);
+
+	// Fixed dist codewords are all five bits
+	for (i=0; i < FIXED_DIST_LENS; i++) {
+		codeLengthArray[i] = 5;
+	}
+
+	f173ab5a_initHuffmanDecoder(&fixedDistDecoder, codeLengthArray, FIXED_DIST_LENS, HUFFMAN_DIST);
+}
+
+static bool processLiteralBackrefBlock(Inflate *inflate) {
+	HuffmanDecoder *litlenDecoder, *distDecoder;
+	InputBuffer *inputBuffer;
+	uint8_t *window;
+	uint64_t bits;
+	uint32_t entry, type, numBits, bitsLeft, startBits;
+	uint32_t extraBits, length, dist, outputPos, outputEnd;
+	bool isOutputFull, isInputEnd;
+
+	litlenDecoder = inflate->litlenDecoder;
+	distDecoder = inflate->distDecoder;
+	inputBuffer = &inflate->inputBuffer;
+	window = inflate->window;
+
+	// Keep the output position in a register; byte stores to the window may alias the Inflate
+	outputPos = inflate->outputPos;
+	outputEnd = inflate->chunkStart + INFLATE_OUTPUT_LENGTH;
+
+	// 1. Finish the backref that did not fit in the previous output chunk
+	if (inflate->copyLength > 0) {
+		output_wrapped_backref(window, outputPos, inflate->copyDist, inflate->copyLength);
+		outputPos += inflate->copyLength;
+		inflate->copyLength = 0;
+	}
+
+	while (true) {
+#if defined(__x86_64__)
+		// 2. Use the fast loop while there is room for a full backref in the output chunk
+		if (hasFastLoop && outputEnd - outputPos >= FAST_LOOP_OUTPUT_MIN) {
+			if (!processFastLoop(inflate, &outputPos)) {
 				return false;
 			}
 
-			if (inflate->outputBuffer.length == INFLATE_OUTPUT_LENGTH) {
-				inflate->status = INFLATE_OUTPUT_FULL;
-				return false;
+			if (inflate->state == INFLATE_STATE_HEADER) {
+				return true;
 			}
+		}
+#endif
 
-			outputBuf[inflate->outputBuffer.length++] = (uint8_t)litlen;
-			continue;
-		} else if (litlen == LITLEN_EOB) {
-			// End of block
-			if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, totalBitsUsed)) {
-				inflate->status = INFLATE_NEED_INPUT;
+		// 3. Refill the bits; ISTREAM_MIN_BITS unless near the end of the input
+		bits = c49f5b0d_peekBits(inputBuffer);
+		startBits = ISTREAM_MIN_BITS;
+		isOutputFull = false;
+		isInputEnd = false;
+
+		if (inputBuffer->totalNumBits - inputBuffer->bitPos < ISTREAM_MIN_BITS) {
+			startBits = inputBuffer->totalNumBits - inputBuffer->bitPos;
+			isInputEnd = true;
+		}
+
+		bitsLeft = startBits;
+
+		// 4. Decode symbols from the bits while their codewords are complete
+		while (true) {
+			entry = f173ab5a_huffmanDecode(litlenDecoder, bits);
+			numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+			type = HUFFMAN_ENTRY_TYPE(entry);
+
+			// Only codewords inside the bits left are decoded correctly
+			if (numBits > bitsLeft) {
+				break;
+			}
+
+			if (type == HUFFMAN_ENTRY_LITERAL2 && outputPos + 2 <= outputEnd) {
+				// Two literals
+				window[outputPos] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+				window[outputPos + 1] = (uint8_t) (HUFFMAN_ENTRY_VALUE(entry) >> 8);
+				outputPos += 2;
+			} else if (type == HUFFMAN_ENTRY_LITERAL || type == HUFFMAN_ENTRY_LITERAL2) {
+				// Literal; only the first literal of a pair if the output chunk is nearly full
+				if (outputPos == outputEnd) {
+					isOutputFull = true;
+					break;
+				}
+
+				window[outputPos++] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+				numBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+			} else if (type == HUFFMAN_ENTRY_LENGTH) {
+				// Refill first unless the length and distance are sure to fit in the bits
+				if (bitsLeft < MAX_BACKREF_BITS) {
+					// Unless the rest of the backref is past the end of the input
+					if (!isInputEnd || getBackrefBits(distDecoder, entry, bits) > bitsLeft) {
+						break;
+					}
+				}
+
+				// Back reference length plus any extra bits not resolved by the table
+				extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+				length = HUFFMAN_ENTRY_VALUE(entry) + ((bits >> numBits) & ((1U << extraBits) - 1));
+				numBits += extraBits;
+				bits >>= numBits;
+				bitsLeft -= numBits;
+
+				// Back reference distance
+				entry = f173ab5a_huffmanDecode(distDecoder, bits);
+				numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+
+				if (HUFFMAN_ENTRY_TYPE(entry) != HUFFMAN_ENTRY_DIST) {
+					inflate->outputPos = outputPos;
+					inflate->status = INFLATE_INPUT_ERROR;
+					return false;
+				}
+
+				extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+				dist = HUFFMAN_ENTRY_VALUE(entry) + ((bits >> numBits) & ((1U << extraBits) - 1));
+				numBits += extraBits;
+
+				// Backref before the start of the stream
+				if (dist > outputPos && inflate->totalOut == 0) {
+					inflate->outputPos = outputPos;
+					inflate->status = INFLATE_INPUT_ERROR;
+					return false;
+				}
+
+				// Output what fits and finish the backref in the next output chunk
+				if (length > outputEnd - outputPos) {
+					inflate->copyLength = length - (outputEnd - outputPos);
+					inflate->copyDist = dist;
+					output_wrapped_backref(window, outputPos, dist, outputEnd - outputPos);
+					outputPos = outputEnd;
+
+					bits >>= numBits;
+					bitsLeft -= numBits;
+					isOutputFull = true;
+					break;
+				}
+
+				if (dist > outputPos) {
+					// The backref starts in the other half of the window
+					output_wrapped_backref(window, outputPos, dist, length);
+				} else if (length + LZ77_COPY_SLACK <= outputEnd - outputPos) {
+					// Wide copy; the slack stays inside the output chunk
+					b4f6eb7b_copyBackref(window + outputPos, dist, length);
+				} else {
+					lz77_output_backref(window + outputPos, dist, length);
+				}
+
+				outputPos += length;
+			} else if (type == HUFFMAN_ENTRY_EOB) {
+				// End of block
+				inflate->outputPos = outputPos;
+
+				if (!c49f5b0d_skipBits(inputBuffer, startBits - bitsLeft + numBits)) {
+					inflate->status = INFLATE_NEED_INPUT;
+					return false;
+				}
+
+				inflate->state = INFLATE_STATE_HEADER;
+				return true;
+			} else {
+				// Failed to decode, or invalid symbol
+				inflate->outputPos = outputPos;
+				inflate->status = INFLATE_INPUT_ERROR;
 				return false;
 			}
 
-			inflate->status = INFLATE_SUCCESS;
-			return true;
+			bits >>= numBits;
+			bitsLeft -= numBits;
 		}
 
-		// It is a back reference so figure out the length
-		length = litlen_tbl[litlen - LITLEN_TBL_OFFSET].baseLength;
-		extraBits = litlen_tbl[litlen - LITLEN_TBL_OFFSET].extraBits;
-		if (extraBits != 0) {
-			// length += lsb(bits, extraBits);
-			length += (inflate->inputBuffer.bits & ((1UL << extraBits) - 1));
-			inflate->inputBuffer.bits >>= extraBits;
-			totalBitsUsed += extraBits;
+		// 5. Advance the InputBuffer past the decoded symbols
+		if (!c49f5b0d_skipBits(inputBuffer, startBits - bitsLeft)) {
+			inflate->outputPos = outputPos;
+			inflate->status = INFLATE_NEED_INPUT;
+			return false;
 		}
 
-		// Get the distance
-		distSymbol = f173ab5a_huffmanDecode(&inflate->inputBuffer, distDecoder, &numBitsUsed);
-		inflate->inputBuffer.bits >>= numBitsUsed;
-		totalBitsUsed += numBitsUsed;
+		if (isOutputFull) {
+			inflate->outputPos = outputPos;
+			inflate->status = INFLATE_OUTPUT_FULL;
+			return false;
+		}
 
-		if (distSymbol < 0 || distSymbol > DISTSYM_MAX) {
-			// Failed to decode, or invalid symbol
-			inflate->status = INFLATE_INPUT_ERROR;
+		if (isInputEnd) {
+			inflate->outputPos = outputPos;
+			inflate->status = INFLATE_NEED_INPUT;
 			return false;
 		}
+	}
+}
 
-		dist = dist_tbl[distSymbol].baseDist;
-		extraBits = dist_tbl[distSymbol].extraBits;
+#if defined(__x86_64__)
+/*
+ * Decodes symbols while the output chunk has room for a full backref and at
+ * least 8 bytes of input are left in the current FileBuffer. The bit buffer
+ * is refilled without branches before each symbol, and BMI2 shrx/bzhi are
+ * used for the variable shifts and the extra bits. Returns to the C loop
+ * near the end of the output chunk or of the FileBuffer.
+ */
+__attribute__ ((target ("bmi2")))
+static bool processFastLoop(Inflate *inflate, uint32_t *outputPos) {
+	HuffmanDecoder *litlenDecoder, *distDecoder;
+	InputBuffer *inputBuffer;
+	const uint8_t *input, *inputPtr, *inputEnd;
+	uint8_t *window;
+	uint64_t bitBuffer, word, numInputBytes;
+	uint32_t entry, type, numBits, bitsLeft, extraBits;
+	uint32_t length, dist, outPos, outputEnd;
+	bool isInputError;
+
+	litlenDecoder = inflate->litlenDecoder;
+	distDecoder = inflate->distDecoder;
+	inputBuffer = &inflate->inputBuffer;
+	window = inflate->window;
+
+	// 1. Read no further than the current FileBuffer or the end of the stream
+	input = inputBuffer->buffer;
+	inputPtr = input + (inputBuffer->offsetBitPos >> 3);
+	inputEnd = input + inputBuffer->fileBuffer->numBytes;
+	numInputBytes = (inputBuffer->totalNumBits - inputBuffer->bitPos) >> 3;
+
+	if ((uint64_t)(inputEnd - inputPtr) > numInputBytes) {
+		inputEnd = inputPtr + numInputBytes;
+	}
 
-		if (extraBits != 0) {
-			// dist += lsb(bits, extraBits);
-			dist += (inflate->inputBuffer.bits & ((1UL << extraBits) - 1));
-			inflate->inputBuffer.bits >>= extraBits;
-			totalBitsUsed += extraBits;
+	// Each refill reads 8 bytes
+	if (inputEnd - inputPtr < 2 * (int64_t) sizeof(uint64_t)) {
+		return true;
+	}
+
+	inputEnd -= sizeof(uint64_t);
+	outPos = *outputPos;
+	outputEnd = inflate->chunkStart + INFLATE_OUTPUT_LENGTH - FAST_LOOP_OUTPUT_MIN;
+
+	// 2. Load the first bits and drop the bits already used from the first byte
+	memcpy(&bitBuffer, inputPtr, sizeof(uint64_t));
+	inputPtr += sizeof(uint64_t) - 1;
+	bitsLeft = 56 - (inputBuffer->offsetBitPos & 0x07);
+	bitBuffer >>= (inputBuffer->offsetBitPos & 0x07);
+	isInputError = false;
+
+	while (inputPtr <= inputEnd && outPos <= outputEnd) {
+		// 3. Branchless refill to at least 56 bits; whole bytes are consumed
+		memcpy(&word, inputPtr, sizeof(uint64_t));
+		bitBuffer |= word << bitsLeft;
+		inputPtr += (63 - bitsLeft) >> 3;
+		bitsLeft |= 56;
+
+		// 4. Decode one literal, literal pair or backref; a backref needs at most 48 bits
+		entry = f173ab5a_huffmanDecode(litlenDecoder, bitBuffer);
+		numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+		type = HUFFMAN_ENTRY_TYPE(entry);
+
+		if (type == HUFFMAN_ENTRY_LITERAL2) {
+			window[outPos] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+			window[outPos + 1] = (uint8_t) (HUFFMAN_ENTRY_VALUE(entry) >> 8);
+			outPos += 2;
+		} else if (type == HUFFMAN_ENTRY_LITERAL) {
+			window[outPos++] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+		} else if (type == HUFFMAN_ENTRY_LENGTH) {
+			extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+			length = HUFFMAN_ENTRY_VALUE(entry) + _bzhi_u64(bitBuffer >> numBits, extraBits);
+			numBits += extraBits;
+			bitBuffer >>= numBits;
+			bitsLeft -= numBits;
+
+			entry = f173ab5a_huffmanDecode(distDecoder, bitBuffer);
+			numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+
+			if (HUFFMAN_ENTRY_TYPE(entry) != HUFFMAN_ENTRY_DIST) {
+				isInputError = true;
+				break;
+			}
+
+			extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+			dist = HUFFMAN_ENTRY_VALUE(entry) + _bzhi_u64(bitBuffer >> numBits, extraBits);
+			numBits += extraBits;
+
+			if (dist <= outPos) {
+				b4f6eb7b_copyBackref(window + outPos, dist, length);
+			} else if (inflate->totalOut > 0) {
+				// The backref starts in the other half of the window
+				output_wrapped_backref(window, outPos, dist, length);
+			} else {
+				// Backref before the start of the stream
+				isInputError = true;
+				break;
+			}
+
+			outPos += length;
+		} else if (type == HUFFMAN_ENTRY_EOB) {
+			bitBuffer >>= numBits;
+			bitsLeft -= numBits;
+			inflate->state = INFLATE_STATE_HEADER;
+			break;
+		} else {
+			// Failed to decode, or invalid symbol
+			isInputError = true;
+			break;
 		}
 
-		if (!c49f5b0d_advanceNumBits(&inflate->inputBuffer, totalBitsUsed)) {
-			inflate->status = INFLATE_NEED_INPUT;
-			return false;
+		bitBuffer >>= numBits;
+		bitsLeft -= numBits;
+	}
+
+	*outputPos = outPos;
+	inflate->outputPos = outPos;
+
+	if (isInputError) {
+		inflate->status = INFLATE_INPUT_ERROR;
+		return false;
+	}
+
+	// 5. Advance the InputBuffer past the consumed bits
+	c49f5b0d_skipBits(inputBuffer, ((inputPtr - input) << 3) - bitsLeft - inputBuffer->offsetBitPos);
+
+	return true;
+}
+#endif
+
+static void initFastLoop() {
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	isFastLoopSupported = __builtin_cpu_supports("bmi2");
+	hasFastLoop = isFastLoopSupported;
+#endif
+}
+
+static InflationStatus inflateBufferBlocks(BufferInflate *bufferInflate) {
+	FileBuffer fileBuffer;
+	InputBuffer inputBuffer;
+	HuffmanDecoder *litlenDecoder, *distDecoder;
+	uint64_t headerStart;
+	uint32_t blockType, blockLength, position;
+	InflationStatus status;
+	bool isFinalBlock;
+
+	f668c4bd_meminit(&fileBuffer, sizeof(FileBuffer));
+
+	do {
+		// 1. Read the block header through an InputBuffer starting at its first byte
+		headerStart = bufferInflate->bitPos & ~0x07ULL;
+
+		if ((headerStart >> 3) >= bufferInflate->inputLength) {
+			return INFLATE_NEED_INPUT;
 		}
 
-		// Bounds check and output the backref
-		if (dist > inflate->outputBuffer.length) {
-			inflate->status = INFLATE_INPUT_ERROR;
-			return false;
+		fileBuffer.buffer = bufferInflate->input + (headerStart >> 3);
+		fileBuffer.numBytes = bufferInflate->inputLength - (headerStart >> 3);
+
+		if (fileBuffer.numBytes > BUFFER_HEADER_WINDOW) {
+			fileBuffer.numBytes = BUFFER_HEADER_WINDOW;
+		}
+
+		c49f5b0d_initInputBuffer(&inputBuffer, &fileBuffer, fileBuffer.numBytes);
+
+		if (!c49f5b0d_skipBits(&inputBuffer, bufferInflate->bitPos & 0x07)
+		        || !c49f5b0d_useNumBits(&inputBuffer, 3)) {
+			return INFLATE_NEED_INPUT;
 		}
 
-		if (round_up(length, 8) <= INFLATE_OUTPUT_LENGTH - inflate->outputBuffer.length) {
-			output_backref64(&inflate->outputBuffer, dist, length);
-		} else if (length <= INFLATE_OUTPUT_LENGTH - inflate->outputBuffer.length) {
-			lz77_output_backref(&inflate->outputBuffer, dist, length);
+		isFinalBlock = inputBuffer.bits & 0x01;
+		blockType = inputBuffer.bits & 0x06;
+		inputBuffer.bits >>= 3;
+
+		if (blockType == 0) {
+			// 2. Copy a stored block straight from the input to the output
+			uint8_t header[4];
+
+			if (!c49f5b0d_skipBits(&inputBuffer, (8 - (inputBuffer.bitPos & 0x07)) & 0x07)
+			        || !c49f5b0d_copyBytes(&inputBuffer, header, 4)) {
+				return INFLATE_NEED_INPUT;
+			}
+
+			blockLength = header[0] | (header[1] << 8);
+
+			if (blockLength != (~(header[2] | (header[3] << 8)) & 0xFFFF)) {
+				return INFLATE_INPUT_ERROR;
+			}
+
+			position = (headerStart + inputBuffer.bitPos) >> 3;
+
+			if (blockLength > bufferInflate->inputLength - position) {
+				return INFLATE_NEED_INPUT;
+			}
+
+			if (blockLength > bufferInflate->outputSize - bufferInflate->outputPos) {
+				return INFLATE_OUTPUT_FULL;
+			}
+
+			f668c4bd_memcopy(bufferInflate->input + position, bufferInflate->output + bufferInflate->outputPos, blockLength);
+			bufferInflate->outputPos += blockLength;
+			bufferInflate->bitPos = (uint64_t)(position + blockLength) << 3;
+			continue;
+		}
+
+		// 3. Load the fixed or dynamic Huffman decoders of the block
+		if (blockType == 2) {
+			litlenDecoder = &fixedLitlenDecoder;
+			distDecoder = &fixedDistDecoder;
+		} else if (blockType == 4) {
+			litlenDecoder = &bufferInflate->dynamicDecoders[0];
+			distDecoder = &bufferInflate->dynamicDecoders[1];
+			status = initDynamicDecoder(&inputBuffer, litlenDecoder, distDecoder);
+
+			if (status != INFLATE_SUCCESS) {
+				return status;
+			}
 		} else {
-			inflate->status = INFLATE_OUTPUT_FULL;
-			return false;
+			// Invalid block type
+			return INFLATE_INPUT_ERROR;
 		}
 
-		inflate->outputBuffer.length += length;
-	}
+		// 4. Decode the symbols of the block from the contiguous input
+		bufferInflate->bitPos = headerStart + inputBuffer.bitPos;
+		status = inflateBufferHuffman(bufferInflate, litlenDecoder, distDecoder);
+
+		if (status != INFLATE_SUCCESS) {
+			return status;
+		}
+	} while (!isFinalBlock);
+
+	return INFLATE_SUCCESS;
 }
 
 /*
- * Output the (dist,len) backref at dst_pos in dst using 64-bit wide writes.
- * There must be enough room for len bytes rounded to the next multiple of 8.
+ * Decodes the symbols of a Huffman block directly from the contiguous input
+ * into the output buffer. The bit buffer is refilled with one unaligned load
+ * per symbol, a byte at a time only within 8 bytes of the end of the input.
+ * Backrefs use the wide copy while there is room for its slack.
  */
-static void output_backref64(OutputBuffer *outputBuffer, size_t dist, size_t length) {
-	uint8_t *outputBuf;
-	uint8_t *backref;
-//	size_t i;
-//	uint64_t tmp;
+static InflationStatus inflateBufferHuffman(BufferInflate *bufferInflate, HuffmanDecoder *litlenDecoder,
+                                            HuffmanDecoder *distDecoder) {
+	const uint8_t *inputPtr, *inputEnd;
+	uint8_t *output;
+	uint64_t bitBuffer, word;
+	uint32_t entry, type, numBits, bitsLeft, extraBits, skipBits;
+	uint32_t length, dist, outputPos, outputSize, wideOutputEnd;
+	InflationStatus status;
+
+	inputPtr = bufferInflate->input + (bufferInflate->bitPos >> 3);
+	inputEnd = bufferInflate->input + bufferInflate->inputLength;
+	output = bufferInflate->output;
+	outputPos = bufferInflate->outputPos;
+	outputSize = bufferInflate->outputSize;
+	wideOutputEnd = (outputSize > FAST_LOOP_OUTPUT_MIN) ? outputSize - FAST_LOOP_OUTPUT_MIN : 0;
+
+	bitBuffer = 0;
+	bitsLeft = 0;
+	skipBits = bufferInflate->bitPos & 0x07;
+	status = INFLATE_NEED_INPUT;
+
+	while (true) {
+		// 1. Refill to at least 56 bits; bits past the end of the input are zero
+		if (inputEnd - inputPtr >= (int64_t) sizeof(uint64_t)) {
+			memcpy(&word, inputPtr, sizeof(uint64_t));
+			bitBuffer |= word << bitsLeft;
+			inputPtr += (63 - bitsLeft) >> 3;
+			bitsLeft |= 56;
+		} else {
+			while (bitsLeft <= 56 && inputPtr < inputEnd) {
+				bitBuffer |= (uint64_t) *inputPtr++ << bitsLeft;
+				bitsLeft += 8;
+			}
+		}
+
+		// Drop the bits of the first byte used by the block header
+		if (skipBits > 0) {
+			bitBuffer >>= skipBits;
+			bitsLeft -= skipBits;
+			skipBits = 0;
+			continue;
+		}
+
+		// 2. Decode one literal, literal pair or backref; codewords cut off by the end of the input stop it
+		entry = f173ab5a_huffmanDecode(litlenDecoder, bitBuffer);
+		numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+		type = HUFFMAN_ENTRY_TYPE(entry);
+
+		if (type == HUFFMAN_ENTRY_LITERAL2 && numBits <= bitsLeft && outputPos + 2 <= outputSize) {
+			output[outputPos] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+			output[outputPos + 1] = (uint8_t) (HUFFMAN_ENTRY_VALUE(entry) >> 8);
+			outputPos += 2;
+		} else if (type == HUFFMAN_ENTRY_LITERAL || type == HUFFMAN_ENTRY_LITERAL2) {
+			// Only the first literal of a pair at the end of the input or output
+			numBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+
+			if (numBits > bitsLeft) {
+				break;
+			}
+
+			if (outputPos == outputSize) {
+				status = INFLATE_OUTPUT_FULL;
+				break;
+			}
+
+			output[outputPos++] = (uint8_t) HUFFMAN_ENTRY_VALUE(entry);
+		} else if (type == HUFFMAN_ENTRY_LENGTH) {
+			extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+			length = HUFFMAN_ENTRY_VALUE(entry) + ((bitBuffer >> numBits) & ((1U << extraBits) - 1));
+			numBits += extraBits;
 
-	if (length > dist) {
-		// Self-overlapping backref; fall back to byte-by-byte copy
-		lz77_output_backref(outputBuffer, dist, length);
-		return;
+			if (numBits > bitsLeft) {
+				break;
+			}
+
+			bitBuffer >>= numBits;
+			bitsLeft -= numBits;
+
+			entry = f173ab5a_huffmanDecode(distDecoder, bitBuffer);
+			numBits = HUFFMAN_ENTRY_NUM_BITS(entry);
+
+			if (HUFFMAN_ENTRY_TYPE(entry) != HUFFMAN_ENTRY_DIST) {
+				status = INFLATE_INPUT_ERROR;
+				break;
+			}
+
+			extraBits = HUFFMAN_ENTRY_EXTRA_BITS(entry);
+			dist = HUFFMAN_ENTRY_VALUE(entry) + ((bitBuffer >> numBits) & ((1U << extraBits) - 1));
+			numBits += extraBits;
+
+			if (numBits > bitsLeft) {
+				break;
+			}
+
+			// Backref before the start of the output
+			if (dist > outputPos) {
+				status = INFLATE_INPUT_ERROR;
+				break;
+			}
+
+			if (outputPos <= wideOutputEnd) {
+				b4f6eb7b_copyBackref(output + outputPos, dist, length);
+			} else if (length <= outputSize - outputPos) {
+				lz77_output_backref(output + outputPos, dist, length);
+			} else {
+				status = INFLATE_OUTPUT_FULL;
+				break;
+			}
+
+			outputPos += length;
+		} else if (type == HUFFMAN_ENTRY_EOB) {
+			if (numBits <= bitsLeft) {
+				bitBuffer >>= numBits;
+				bitsLeft -= numBits;
+				status = INFLATE_SUCCESS;
+			}
+
+			break;
+		} else {
+			// Failed to decode, or invalid symbol
+			status = INFLATE_INPUT_ERROR;
+			break;
+		}
+
+		bitBuffer >>= numBits;
+		bitsLeft -= numBits;
 	}
 
-//	length >>= 3;
-	outputBuf = (uint8_t *)outputBuffer->buffer + outputBuffer->length;
-	backref = outputBuf - dist;
-	f668c4bd_memcopy(backref, outputBuf, length);
-/*
-	i = 0;
+	// 3. The next block starts at the first bit not used
+	bufferInflate->bitPos = ((uint64_t)(inputPtr - bufferInflate->input) << 3) - bitsLeft;
+	bufferInflate->outputPos = outputPos;
+
+	return status;
+}
+
+static InflationStatus inflateBufferGzip(BufferInflate *bufferInflate) {
+	uint8_t *trailer;
+	uint32_t position, memberStart, memberLength;
+	InflationStatus status;
+
+	position = 0;
+
 	do {
-		memcpy(&tmp, &dst[dst_pos - dist + i], 8);
-		memcpy(&dst[dst_pos + i], &tmp, 8);
-		i += 8;
-	} while (i < len);
-*/
+		// 1. Skip the member header
+		status = skipGzipHeader(bufferInflate, &position);
+
+		if (status != INFLATE_SUCCESS) {
+			return status;
+		}
+
+		// 2. Inflate the DEFLATE bitstream of the member
+		memberStart = bufferInflate->outputPos;
+		bufferInflate->bitPos = (uint64_t) position << 3;
+		status = inflateBufferBlocks(bufferInflate);
+
+		if (status != INFLATE_SUCCESS) {
+			return status;
+		}
+
+		// 3. Check the CRC-32 and ISIZE of the trailer against the member output
+		position = (bufferInflate->bitPos + 7) >> 3;
+
+		if (bufferInflate->inputLength - position < GZIP_TRAILER_SIZE) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		trailer = bufferInflate->input + position;
+		memberLength = bufferInflate->outputPos - memberStart;
+
+		if (*(uint32_t*)trailer != b7e0468d_crc32(bufferInflate->output + memberStart, memberLength, 0)
+		        || *(uint32_t*)(trailer + 4) != memberLength) {
+			return INFLATE_INPUT_ERROR;
+		}
+
+		position += GZIP_TRAILER_SIZE;
+
+		// 4. Continue while another member follows
+	} while (bufferInflate->inputLength - position >= GZIP_HEADER_SIZE
+	            && bufferInflate->input[position] == GZIP_ID1 && bufferInflate->input[position + 1] == GZIP_ID2);
+
+	return INFLATE_SUCCESS;
+}
+
+static InflationStatus inflateBufferZlib(BufferInflate *bufferInflate) {
+	uint8_t *trailer;
+	uint32_t method, flags, position, adler32;
+	InflationStatus status;
+
+	// 1. Check the compression method and header checksum; preset dictionaries are not supported
+	if (bufferInflate->inputLength < ZLIB_HEADER_SIZE) {
+		return INFLATE_NEED_INPUT;
+	}
+
+	method = bufferInflate->input[0];
+	flags = bufferInflate->input[1];
+
+	if ((method & 0x0F) != ZLIB_METHOD_DEFLATE || (method >> 4) > ZLIB_MAX_WINDOW_BITS
+	        || ((method << 8) | flags) % 31 != 0 || (flags & ZLIB_FLAG_DICT)) {
+		return INFLATE_INPUT_ERROR;
+	}
+
+	// 2. Inflate the DEFLATE bitstream
+	bufferInflate->bitPos = ZLIB_HEADER_SIZE << 3;
+	status = inflateBufferBlocks(bufferInflate);
+
+	if (status != INFLATE_SUCCESS) {
+		return status;
+	}
+
+	// 3. Check the big-endian Adler-32 of the trailer
+	position = (bufferInflate->bitPos + 7) >> 3;
+
+	if (bufferInflate->inputLength - position < ZLIB_TRAILER_SIZE) {
+		return INFLATE_NEED_INPUT;
+	}
+
+	trailer = bufferInflate->input + position;
+	adler32 = ((uint32_t) trailer[0] << 24) | (trailer[1] << 16) | (trailer[2] << 8) | trailer[3];
+
+	if (adler32 != c6725c09_adler32(bufferInflate->output, bufferInflate->outputPos, ADLER32_INITIAL_VALUE)) {
+		return INFLATE_INPUT_ERROR;
+	}
+
+	return INFLATE_SUCCESS;
+}
+
+static InflationStatus skipGzipHeader(BufferInflate *bufferInflate, uint32_t *position) {
+	uint8_t *header, *stringEnd;
+	uint32_t headerStart, flags, extraLength;
+
+	headerStart = *position;
+	header = bufferInflate->input + headerStart;
+
+	// 1. Check the fixed part of the header
+	if (bufferInflate->inputLength - headerStart < GZIP_HEADER_SIZE) {
+		return INFLATE_NEED_INPUT;
+	}
+
+	flags = header[3];
+
+	if (header[0] != GZIP_ID1 || header[1] != GZIP_ID2 || header[2] != GZIP_METHOD_DEFLATE
+	        || (flags & GZIP_FLAG_RESERVED)) {
+		return INFLATE_INPUT_ERROR;
+	}
+
+	*position += GZIP_HEADER_SIZE;
+
+	// 2. Skip the optional FEXTRA, FNAME and FCOMMENT fields
+	if (flags & GZIP_FLAG_EXTRA) {
+		if (bufferInflate->inputLength - *position < 2) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		extraLength = *(uint16_t*)(bufferInflate->input + *position);
+		*position += 2;
+
+		if (bufferInflate->inputLength - *position < extraLength) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		*position += extraLength;
+	}
+
+	if (flags & GZIP_FLAG_NAME) {
+		if ((stringEnd = findBufferString(bufferInflate, *position)) == NULL) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		*position = stringEnd - bufferInflate->input + 1;
+	}
+
+	if (flags & GZIP_FLAG_COMMENT) {
+		if ((stringEnd = findBufferString(bufferInflate, *position)) == NULL) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		*position = stringEnd - bufferInflate->input + 1;
+	}
+
+	// 3. Check the FHCRC against the low 16 bits of the CRC-32 of the header
+	if (flags & GZIP_FLAG_HCRC) {
+		if (bufferInflate->inputLength - *position < 2) {
+			return INFLATE_NEED_INPUT;
+		}
+
+		if (*(uint16_t*)(bufferInflate->input + *position) != (b7e0468d_crc32(header, *position - headerStart, 0) & 0xFFFF)) {
+			return INFLATE_INPUT_ERROR;
+		}
+
+		*position += 2;
+	}
+
+	return INFLATE_SUCCESS;
+}
+
+static uint8_t *findBufferString(BufferInflate *bufferInflate, uint32_t position) {
+	// The zero terminator of the string starting at position
+	return memchr(bufferInflate->input + position, '\0', bufferInflate->inputLength - position);
 }
 
 /*
- * Output the (dist,len) backref at dst_pos in dst.
+ * Output the (dist,len) backref at outputBuf.
  */
-static void lz77_output_backref(OutputBuffer *outputBuffer, size_t dist, size_t length) {
-	uint8_t *outputBuf;
+static void lz77_output_backref(uint8_t *outputBuf, size_t dist, size_t length) {
 	uint8_t *backref;
 
-	outputBuf = (uint8_t *)outputBuffer->buffer + outputBuffer->length;
 	backref = outputBuf - dist;
 
 	for (uint32_t i=0; i < length; i++) {
@@ -645,3 +1526,21 @@ static void lz77_output_backref(OutputBuffer *outputBuffer, size_t dist, size_t
 		backref++;
 	}
 }
+
+/*
+ * Output the (dist,len) backref at window[outputPos] of the circular window,
+ * wrapping the backref position around the end of the window.
+ */
+static void output_wrapped_backref(uint8_t *window, uint32_t outputPos, uint32_t dist, uint32_t length) {
+	uint32_t backrefPos;
+
+	backrefPos = (outputPos + INFLATE_RING_SIZE - dist) & (INFLATE_RING_SIZE - 1);
+
+	for (uint32_t i=0; i < length; i++) {
+		window[outputPos++] = window[backrefPos++];
+
+		if (backrefPos == INFLATE_RING_SIZE) {
+			backrefPos = 0;
+		}
+	}
+}
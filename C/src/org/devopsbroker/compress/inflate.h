@@ -32,6 +32,23 @@
  *      01: A static Huffman compressed block, using a pre-agreed Huffman tree defined in the RFC
  *      10: A compressed block complete with the Huffman table supplied
  *      11: Reserved—don't use
+ *
+ * Output is decoded into a circular window of two INFLATE_OUTPUT_LENGTH halves.
+ * Back references reach at most INFLATE_WINDOW_SIZE bytes into the half that
+ * was filled before the current one, so each full half is handed to the sink
+ * and then reused. This bounds the memory needed to inflate a stream of any
+ * size.
+ *
+ * Input can either be a FileBuffer chain covering the whole compressed stream,
+ * or be pushed with d592eb82_inflateFeed() in chunks of any size. Between
+ * feeds the unused tail of the input is kept in a small carry buffer, and a
+ * block header that is cut off is decoded again from its start once more
+ * input arrives.
+ *
+ * d592eb82_inflateBuffer() inflates a stream already held in memory straight
+ * into the caller's buffer. The input is read through a plain pointer instead
+ * of an InputBuffer, and back references are copied within the output buffer
+ * instead of through the circular window.
  * -----------------------------------------------------------------------------
  */
 
@@ -46,12 +63,15 @@
 #include <assert.h>
 
 #include "iobuffer.h"
+#include "huffman.h"
 #include "../memory/slabpool.h"
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
-#define INFLATE_INPUT_LENGTH  8192
+#define INFLATE_INPUT_LENGTH   8192
 #define INFLATE_OUTPUT_LENGTH  32768
+#define INFLATE_WINDOW_SIZE    32768
+#define INFLATE_RING_SIZE      (INFLATE_OUTPUT_LENGTH * 2)
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -59,20 +79,82 @@ typedef enum InflationStatus {
 	INFLATE_SUCCESS,              // Inflation was a success
 	INFLATE_NEED_INPUT,           // Need more input
 	INFLATE_OUTPUT_FULL,          // Output buffer is full
-	INFLATE_INPUT_ERROR           // Input data error
+	INFLATE_INPUT_ERROR,          // Input data error
+	INFLATE_OUTPUT_ERROR          // Output sink error
 } InflationStatus;
 
+typedef enum InflateFormat {
+	INFLATE_FORMAT_RAW,           // Raw DEFLATE bitstream (RFC 1951)
+	INFLATE_FORMAT_ZLIB,          // zlib header and Adler-32 trailer (RFC 1950)
+	INFLATE_FORMAT_GZIP           // One or more gzip members (RFC 1952)
+} InflateFormat;
+
+typedef enum InflateState {
+	INFLATE_STATE_HEADER,         // Next is a block header
+	INFLATE_STATE_STORED,         // Inside a stored block
+	INFLATE_STATE_HUFFMAN,        // Inside a fixed or dynamic Huffman block
+	INFLATE_STATE_DONE            // Final block processed
+} InflateState;
+
+/*
+ * Called with each chunk of inflated output. The chunk stays valid until the
+ * next call to the sink returns, so an asynchronous write of the chunk only
+ * has to complete before the sink returns from the following call. Returns
+ * false to stop inflation with INFLATE_OUTPUT_ERROR.
+ */
+typedef bool (*InflateSinkFunc)(void *sinkData, void *buffer, uint32_t length);
+
+/*
+ * Inflate
+ *   - InputBuffer over the compressed data
+ *   - Circular output window of INFLATE_RING_SIZE bytes
+ *   - Dynamic Huffman decoders, and the decoders of the current block
+ *   - Optional output sink; without one d592eb82_inflate() returns
+ *     INFLATE_OUTPUT_FULL for each chunk and resumes on the next call
+ *   - The last output chunk and its length
+ *   - Total bytes of output handed out before the current chunk
+ *   - Ring offsets of the next output byte and of the current chunk
+ *   - Remaining length of the current stored block
+ *   - Remaining length and distance of a backref split across output chunks
+ *   - Carry buffer holding the unused input between calls to
+ *     d592eb82_inflateFeed(), and the FileBuffer of the bytes being fed
+ *   - InputBuffer position of the current block header, to decode the header
+ *     again when it was cut off by the end of the fed input
+ *   - Total bytes of input fed so far
+ *   - CRC-32 of the output handed out so far, updated as each chunk is handed
+ *     out while it is still in the cache
+ */
 typedef struct Inflate {
 	InputBuffer       inputBuffer;
-	OutputBuffer      outputBuffer;
-	uint32_t          inputBlockStart;
+	uint8_t          *window;
+	HuffmanDecoder   *dynamicDecoders;
+	HuffmanDecoder   *litlenDecoder;
+	HuffmanDecoder   *distDecoder;
+	InflateSinkFunc   sink;
+	void             *sinkData;
+	uint8_t          *output;
+	uint8_t          *carry;
+	FileBuffer        carryBuffer;
+	FileBuffer        feedBuffer;
+	InputBuffer       blockInput;
+	uint64_t          totalIn;
+	uint64_t          totalOut;
+	uint32_t          outputLength;
+	uint32_t          outputPos;
+	uint32_t          chunkStart;
+	uint32_t          storedLength;
+	uint32_t          copyLength;
+	uint32_t          copyDist;
+	uint32_t          crc32;
+	InflateState      state;
 	InflationStatus   status;
+	bool              isFinalBlock;
 } Inflate;
 
 #if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(Inflate) == 88, "Check your assumptions");
+static_assert(sizeof(Inflate) == 280, "Check your assumptions");
 #elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(Inflate) == 72, "Check your assumptions");
+static_assert(sizeof(Inflate) == 208, "Check your assumptions");
 #endif
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
@@ -84,7 +166,8 @@ static_assert(sizeof(Inflate) == 72, "Check your assumptions");
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d592eb82_createInflate
- * Description: Creates an initialized Inflate struct
+ * Description: Creates an initialized Inflate struct along with its output
+ *              window and dynamic Huffman decoders
  *
  * Parameters:
  *   fileBuffer     The FileBuffer instance
@@ -92,7 +175,7 @@ static_assert(sizeof(Inflate) == 72, "Check your assumptions");
  * Returns:         An initialized Inflate struct
  * ----------------------------------------------------------------------------
  */
-Inflate *d592eb82_createInflate(FileBuffer *fileBuffer, uint32_t compressSize);
+Inflate *d592eb82_createInflate(FileBuffer *fileBuffer, uint64_t compressSize);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d592eb82_destroyInflate
@@ -108,7 +191,8 @@ void d592eb82_destroyInflate(Inflate *inflate);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d592eb82_cleanUpInflate
- * Description: Frees dynamically allocated memory within the Inflate instance
+ * Description: Frees the output window and dynamic Huffman decoders of the
+ *              Inflate instance
  *
  * Parameters:
  *   inflate    A pointer to the Inflate instance to clean up
@@ -126,7 +210,23 @@ void d592eb82_cleanUpInflate(Inflate *inflate);
  *   compressSize   The compressed size of the input file
  * ----------------------------------------------------------------------------
  */
-void d592eb82_initInflate(Inflate *inflate, FileBuffer *fileBuffer, uint32_t compressSize);
+void d592eb82_initInflate(Inflate *inflate, FileBuffer *fileBuffer, uint64_t compressSize);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_resetInflate
+ * Description: Resets the Inflate instance for a new stream while keeping its
+ *              output window and dynamic Huffman decoders allocated; the sink
+ *              is cleared
+ *
+ * Parameters:
+ *   inflate        A pointer to the Inflate instance to reset
+ *   fileBuffer     The FileBuffer instance, or NULL if the input will be pushed
+ *                  with d592eb82_inflateFeed()
+ *   compressSize   The compressed size of the input file, or zero if the input
+ *                  will be pushed with d592eb82_inflateFeed()
+ * ----------------------------------------------------------------------------
+ */
+void d592eb82_resetInflate(Inflate *inflate, FileBuffer *fileBuffer, uint64_t compressSize);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -134,10 +234,116 @@ void d592eb82_initInflate(Inflate *inflate, FileBuffer *fileBuffer, uint32_t com
  * Function:    d592eb82_inflate
  * Description: Inflates a previously DEFLATE bitstream
  *
+ *              With a sink, every chunk of output is passed to the sink and
+ *              the whole stream is inflated in one call. Without one, false is
+ *              returned with INFLATE_OUTPUT_FULL each time a chunk is ready in
+ *              output/outputLength; calling again resumes inflation. On
+ *              success the last chunk is in output/outputLength.
+ *
  * Parameters:
  *   inflate	A pointer to the Inflate instance
+ * Returns:     True if the stream was inflated, false otherwise
  * ----------------------------------------------------------------------------
  */
 bool d592eb82_inflate(Inflate *inflate);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_inflateFeed
+ * Description: Pushes the next chunk of a DEFLATE bitstream and inflates as
+ *              much of it as possible; the Inflate instance must have been
+ *              reset with a NULL FileBuffer
+ *
+ *              Returns false with INFLATE_NEED_INPUT once the chunk is used
+ *              up; the unused tail of the chunk has been copied, so the next
+ *              chunk can be read into the same memory. Otherwise the chunk
+ *              must stay valid until then. Without a sink, false is returned
+ *              with INFLATE_OUTPUT_FULL for each chunk of output as with
+ *              d592eb82_inflate(); call again with a NULL chunk to resume.
+ *              On success, inputBuffer.bitPos is where the stream ended.
+ *
+ * Parameters:
+ *   inflate    A pointer to the Inflate instance
+ *   bytes      The next chunk of the bitstream, or NULL to resume
+ *   length     The length of the chunk
+ * Returns:     True if the stream was inflated, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool d592eb82_inflateFeed(Inflate *inflate, void *bytes, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_inflateBuffer
+ * Description: Inflates a whole compressed stream held in memory into the
+ *              output buffer, checking the trailer of the zlib or gzip format.
+ *              Any data after the end of the stream is ignored.
+ *
+ * Parameters:
+ *   source         The compressed stream
+ *   sourceLength   The length of the compressed stream
+ *   dest           The buffer to inflate the stream into
+ *   destCapacity   The size of the output buffer
+ *   numProduced    Set to the number of bytes written to the output buffer
+ *   format         The framing of the compressed stream
+ * Returns:         INFLATE_SUCCESS, INFLATE_OUTPUT_FULL if the output buffer
+ *                  is too small, INFLATE_NEED_INPUT if the stream is cut off,
+ *                  or INFLATE_INPUT_ERROR
+ * ----------------------------------------------------------------------------
+ */
+InflationStatus d592eb82_inflateBuffer(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity,
+                                       uint32_t *numProduced, InflateFormat format);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_setSink
+ * Description: Sets the sink the inflated output is passed to
+ *
+ * Parameters:
+ *   inflate    A pointer to the Inflate instance
+ *   sink       The sink function, or NULL to return each chunk to the caller
+ *   sinkData   The data passed to the sink function
+ * ----------------------------------------------------------------------------
+ */
+void d592eb82_setSink(Inflate *inflate, InflateSinkFunc sink, void *sinkData);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_setFastLoop
+ * Description: Turns the BMI2 fast decode loop on or off for every Inflate
+ *              instance so the portable decoder can be tested on any CPU; it
+ *              is on by default where the CPU supports BMI2. Must not be
+ *              called while another thread is inflating.
+ *
+ * Parameters:
+ *   isEnabled  True to use the fast loop where supported, false to use only
+ *              the portable decoder
+ * Returns:     True if the fast loop is now in use, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool d592eb82_setFastLoop(bool isEnabled);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_fileSink
+ * Description: InflateSinkFunc that writes each chunk to a file descriptor
+ *
+ * Parameters:
+ *   fdPtr      A pointer to the int file descriptor to write to
+ *   buffer     The chunk of inflated output
+ *   length     The length of the chunk
+ * Returns:     True if the chunk was written, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool d592eb82_fileSink(void *fdPtr, void *buffer, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d592eb82_outputBufferSink
+ * Description: InflateSinkFunc that appends each chunk to an OutputBuffer
+ *              chain, chaining new slabs as each one fills
+ *
+ * Parameters:
+ *   tailPtr    A pointer to the OutputBuffer pointer of the chain tail, which
+ *              is updated as slabs are chained
+ *   buffer     The chunk of inflated output
+ *   length     The length of the chunk
+ * Returns:     True
+ * ----------------------------------------------------------------------------
+ */
+bool d592eb82_outputBufferSink(void *tailPtr, void *buffer, uint32_t length);
+
 #endif /* ORG_DEVOPSBROKER_COMPRESS_INFLATE_H */
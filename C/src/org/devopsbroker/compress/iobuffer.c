@@ -44,8 +44,7 @@
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
-#define OFFSET_BIT_END_POS   MEMORY_PAGE_SIZE << 3
-#define OFFSET_BIT_MIN       57
+#define OFFSET_BIT_END_POS(fileBuffer)  ((fileBuffer)->numBytes << 3)
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -60,7 +59,7 @@
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
-InputBuffer *c49f5b0d_createInputBuffer(FileBuffer *fileBuffer, uint32_t length) {
+InputBuffer *c49f5b0d_createInputBuffer(FileBuffer *fileBuffer, uint64_t length) {
 	InputBuffer *inputBuffer = f668c4bd_malloc(sizeof(InputBuffer));
 
 	inputBuffer->fileBuffer = fileBuffer;
@@ -102,7 +101,7 @@ void c49f5b0d_destroyOutputBuffer(OutputBuffer *outputBuffer) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-void c49f5b0d_initInputBuffer(InputBuffer *inputBuffer, FileBuffer *fileBuffer, uint32_t length) {
+void c49f5b0d_initInputBuffer(InputBuffer *inputBuffer, FileBuffer *fileBuffer, uint64_t length) {
 	inputBuffer->fileBuffer = fileBuffer;
 	inputBuffer->buffer = fileBuffer->buffer;
 	inputBuffer->bits = 0;
@@ -112,13 +111,14 @@ void c49f5b0d_initInputBuffer(InputBuffer *inputBuffer, FileBuffer *fileBuffer,
 }
 
 void c49f5b0d_cleanUpOutputBuffer(OutputBuffer *outputBuffer) {
-	OutputBuffer *nextOutputBuffer;
+	// Release the slab of the OutputBuffer being cleaned up
+	b426145b_releaseSlab(outputBuffer->buffer);
 
-	do {
-		nextOutputBuffer = outputBuffer->next;
-		b426145b_releaseSlab(outputBuffer->buffer);
-		outputBuffer = nextOutputBuffer;
-	} while (outputBuffer != NULL);
+	// Chained OutputBuffer instances were created with c49f5b0d_createOutputBuffer
+	if (outputBuffer->next != NULL) {
+		c49f5b0d_destroyOutputBuffer(outputBuffer->next);
+		outputBuffer->next = NULL;
+	}
 }
 
 void c49f5b0d_initOutputBuffer(OutputBuffer *outputBuffer) {
@@ -131,6 +131,32 @@ void c49f5b0d_initOutputBuffer(OutputBuffer *outputBuffer) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+OutputBuffer *c49f5b0d_append(OutputBuffer *outputBuffer, void *data, uint32_t length) {
+	OutputBuffer *nextBuffer;
+	uint32_t numBytes;
+
+	while (length > 0) {
+		// Chain another OutputBuffer slab once the current one is full
+		if (outputBuffer->length == SLABPOOL_SLAB_SIZE) {
+			nextBuffer = c49f5b0d_createOutputBuffer();
+			nextBuffer->prev = outputBuffer;
+			outputBuffer->next = nextBuffer;
+			outputBuffer = nextBuffer;
+		}
+
+		numBytes = SLABPOOL_SLAB_SIZE - outputBuffer->length;
+		numBytes = (numBytes > length) ? length : numBytes;
+
+		f668c4bd_memcopy(data, outputBuffer->buffer + outputBuffer->length, numBytes);
+		outputBuffer->length += numBytes;
+
+		data += numBytes;
+		length -= numBytes;
+	}
+
+	return outputBuffer;
+}
+
 uint32_t c49f5b0d_crc32(OutputBuffer *outputBuffer, uint32_t length) {
 	uint32_t bufferLength;
 	uint32_t crc32 = 0;
@@ -148,6 +174,7 @@ uint32_t c49f5b0d_crc32(OutputBuffer *outputBuffer, uint32_t length) {
 }
 
 bool c49f5b0d_advanceNumBits(InputBuffer *inputBuffer, uint32_t numBits) {
+	FileBuffer *fileBuffer;
 	uint64_t nextBitPos;
 	uint32_t nextOffsetBitPos;
 
@@ -158,139 +185,111 @@ bool c49f5b0d_advanceNumBits(InputBuffer *inputBuffer, uint32_t numBits) {
 		return false;
 	}
 
-	inputBuffer->bitPos = nextBitPos;
-
-	// 2. Check if we are past the end of the offset bit position
+	// 2. Move on to the next FileBuffer while past the end of the current one
+	fileBuffer = inputBuffer->fileBuffer;
 	nextOffsetBitPos = inputBuffer->offsetBitPos + numBits;
 
-	if (nextOffsetBitPos > OFFSET_BIT_END_POS) {
+	while (nextOffsetBitPos > OFFSET_BIT_END_POS(fileBuffer)) {
 		// Cannot advance if we reached the end of the FileBuffer
-		if (inputBuffer->fileBuffer->next == NULL) {
+		if (fileBuffer->next == NULL) {
 			return false;
 		}
 
-		// Adjust the FileBuffer to the next one
-		inputBuffer->fileBuffer = inputBuffer->fileBuffer->next;
-		inputBuffer->buffer = inputBuffer->fileBuffer->buffer;
-
-		// Set the offset bit position
-		nextOffsetBitPos -= OFFSET_BIT_END_POS;
+		nextOffsetBitPos -= OFFSET_BIT_END_POS(fileBuffer);
+		fileBuffer = fileBuffer->next;
 	}
 
+	inputBuffer->fileBuffer = fileBuffer;
+	inputBuffer->buffer = fileBuffer->buffer;
+	inputBuffer->bitPos = nextBitPos;
 	inputBuffer->offsetBitPos = nextOffsetBitPos;
 
 	return true;
 }
 
-void c49f5b0d_getNextBits(InputBuffer *inputBuffer) {
-	const uint8_t *next;
-	uint64_t bits;
-	uint32_t minOffsetBitPos;
-
-	next = inputBuffer->buffer + (inputBuffer->offsetBitPos / 8);
-	minOffsetBitPos = inputBuffer->offsetBitPos + OFFSET_BIT_MIN;
-
-	// Perform a normal bit read
-	if (minOffsetBitPos <= OFFSET_BIT_END_POS || inputBuffer->fileBuffer->next == NULL) {
-		bits = ((uint64_t)next[0] << 0)  |
-		       ((uint64_t)next[1] << 8)  |
-			   ((uint64_t)next[2] << 16) |
-			   ((uint64_t)next[3] << 24) |
-			   ((uint64_t)next[4] << 32) |
-			   ((uint64_t)next[5] << 40) |
-			   ((uint64_t)next[6] << 48) |
-			   ((uint64_t)next[7] << 56);
-	} else {
-		uint32_t endCurrentBuf;
-		uint32_t i, j;
+bool c49f5b0d_copyBytes(InputBuffer *inputBuffer, void *dest, uint32_t length) {
+	FileBuffer *fileBuffer;
+	uint32_t offset, numBytes;
 
-		endCurrentBuf = MEMORY_PAGE_SIZE - (inputBuffer->offsetBitPos / 8);
+	// 1. Check if we are past the end of the bit stream
+	if (inputBuffer->bitPos + ((uint64_t)length << 3) > inputBuffer->totalNumBits) {
+		return false;
+	}
 
-		bits = 0;
-		for (i = 0; i < endCurrentBuf; i++) {
-			bits |= (uint64_t)next[i] << (i * 8);
-		}
+	fileBuffer = inputBuffer->fileBuffer;
 
-		next = inputBuffer->fileBuffer->next->buffer;
+	// 2. Copy the bytes one FileBuffer at a time
+	while (length > 0) {
+		offset = inputBuffer->offsetBitPos >> 3;
 
-		for (j=0; i < 8; i++, j++) {
-			bits |= (uint64_t)next[j] << (i * 8);
-		}
-	}
+		if (offset == fileBuffer->numBytes) {
+			// Cannot copy if we reached the end of the FileBuffer
+			if (fileBuffer->next == NULL) {
+				return false;
+			}
 
-	inputBuffer->bits = bits >> (inputBuffer->offsetBitPos % 8);
-}
+			fileBuffer = fileBuffer->next;
+			inputBuffer->fileBuffer = fileBuffer;
+			inputBuffer->buffer = fileBuffer->buffer;
+			inputBuffer->offsetBitPos = 0;
+			offset = 0;
+		}
 
-bool c49f5b0d_useNumBits(InputBuffer *inputBuffer, uint32_t numBits) {
-	const uint8_t *next;
-	uint64_t bits;
-	uint32_t minOffsetBitPos;
-	uint64_t nextBitPos;
-	uint32_t nextOffsetBitPos;
+		numBytes = fileBuffer->numBytes - offset;
+		numBytes = (numBytes > length) ? length : numBytes;
 
-	// 1. Check if we are past the end of the bit stream
-	nextBitPos = inputBuffer->bitPos + numBits;
+		f668c4bd_memcopy(inputBuffer->buffer + offset, dest, numBytes);
+		inputBuffer->offsetBitPos += numBytes << 3;
+		inputBuffer->bitPos += numBytes << 3;
 
-	if (nextBitPos > inputBuffer->totalNumBits) {
-		return false;
+		dest += numBytes;
+		length -= numBytes;
 	}
 
-	inputBuffer->bitPos = nextBitPos;
+	return true;
+}
 
-	next = inputBuffer->buffer + (inputBuffer->offsetBitPos / 8);
-	minOffsetBitPos = inputBuffer->offsetBitPos + OFFSET_BIT_MIN;
-
-	// 2. Perform a normal bit read
-	if (minOffsetBitPos <= OFFSET_BIT_END_POS || inputBuffer->fileBuffer->next == NULL) {
-		bits = ((uint64_t)next[0] << 0)  |
-			   ((uint64_t)next[1] << 8)  |
-			   ((uint64_t)next[2] << 16) |
-			   ((uint64_t)next[3] << 24) |
-			   ((uint64_t)next[4] << 32) |
-			   ((uint64_t)next[5] << 40) |
-			   ((uint64_t)next[6] << 48) |
-			   ((uint64_t)next[7] << 56);
-
-	// 3. Perform a cross-page bit read
-	} else {
-		uint32_t endCurrentBuf;
-		uint32_t i, j;
+void c49f5b0d_getNextBits(InputBuffer *inputBuffer) {
+	FileBuffer *fileBuffer;
+	uint64_t bits;
+	uint32_t offset, numBytes, i;
 
-		endCurrentBuf = MEMORY_PAGE_SIZE - (inputBuffer->offsetBitPos / 8);
+	fileBuffer = inputBuffer->fileBuffer;
+	offset = inputBuffer->offsetBitPos >> 3;
 
+	if (offset + sizeof(uint64_t) <= fileBuffer->numBytes) {
+		// 1. Perform a normal bit read
+		memcpy(&bits, inputBuffer->buffer + offset, sizeof(uint64_t));
+	} else {
+		// 2. Gather the bytes from as many FileBuffers as needed; bytes past the end read as zero
 		bits = 0;
-		for (i = 0; i < endCurrentBuf; i++) {
-			bits |= (uint64_t)next[i] << (i * 8);
-		}
+		i = 0;
 
-		next = inputBuffer->fileBuffer->next->buffer;
-
-		for (j=0; i < 8; i++, j++) {
-			bits |= (uint64_t)next[j] << (i * 8);
-		}
-	}
+		while (i < sizeof(uint64_t) && fileBuffer != NULL) {
+			numBytes = fileBuffer->numBytes - offset;
+			numBytes = (numBytes > sizeof(uint64_t) - i) ? sizeof(uint64_t) - i : numBytes;
 
-	// 4. Check if we are past the end of the offset bit position
-	nextOffsetBitPos = inputBuffer->offsetBitPos + numBits;
+			memcpy(((uint8_t*) &bits) + i, fileBuffer->buffer + offset, numBytes);
+			i += numBytes;
 
-	if (nextOffsetBitPos > OFFSET_BIT_END_POS) {
-		// Cannot advance if we reached the end of the FileBuffer
-		if (inputBuffer->fileBuffer->next == NULL) {
-			return false;
+			fileBuffer = fileBuffer->next;
+			offset = 0;
 		}
+	}
 
-		// Adjust the FileBuffer to the next one
-		inputBuffer->fileBuffer = inputBuffer->fileBuffer->next;
-		inputBuffer->buffer = inputBuffer->fileBuffer->buffer;
+	inputBuffer->bits = bits >> (inputBuffer->offsetBitPos & 0x07);
+}
 
-		// Set the offset bit position
-		nextOffsetBitPos -= OFFSET_BIT_END_POS;
+bool c49f5b0d_useNumBits(InputBuffer *inputBuffer, uint32_t numBits) {
+	// 1. Check if we are past the end of the bit stream
+	if (inputBuffer->bitPos + numBits > inputBuffer->totalNumBits) {
+		return false;
 	}
 
-	inputBuffer->bits = bits >> (inputBuffer->offsetBitPos % 8);
-	inputBuffer->offsetBitPos = nextOffsetBitPos;
+	// 2. Read the next bits and advance past numBits of them
+	c49f5b0d_getNextBits(inputBuffer);
 
-	return true;
+	return c49f5b0d_advanceNumBits(inputBuffer, numBits);
 }
 
 void c49f5b0d_write(OutputBuffer *outputBuffer, int fd, char *pathName) {
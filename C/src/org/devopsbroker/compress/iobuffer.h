@@ -29,6 +29,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include <assert.h>
 
@@ -86,7 +87,7 @@ static_assert(sizeof(OutputBuffer) == 20, "Check your assumptions");
  * Returns:     An InputBuffer struct instance
  * ----------------------------------------------------------------------------
  */
-InputBuffer *c49f5b0d_createInputBuffer(FileBuffer *fileBuffer, uint32_t length);
+InputBuffer *c49f5b0d_createInputBuffer(FileBuffer *fileBuffer, uint64_t length);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    c49f5b0d_destroyInputBuffer
@@ -129,7 +130,7 @@ void c49f5b0d_destroyOutputBuffer(OutputBuffer *outputBuffer);
  *   length         The length of the input data
  * ----------------------------------------------------------------------------
  */
-void c49f5b0d_initInputBuffer(InputBuffer *inputBuffer, FileBuffer *fileBuffer, uint32_t length);
+void c49f5b0d_initInputBuffer(InputBuffer *inputBuffer, FileBuffer *fileBuffer, uint64_t length);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    c49f5b0d_cleanUpOutputBuffer
@@ -153,6 +154,20 @@ void c49f5b0d_initOutputBuffer(OutputBuffer *outputBuffer);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    c49f5b0d_append
+ * Description: Appends data to the last OutputBuffer of a chain, chaining new
+ *              OutputBuffer slabs as each one fills
+ *
+ * Parameters:
+ *   outputBuffer   A pointer to the last OutputBuffer of the chain
+ *   data           The data to append
+ *   length         The length of the data to append
+ * Returns:     The last OutputBuffer of the chain after the data is appended
+ * ----------------------------------------------------------------------------
+ */
+OutputBuffer *c49f5b0d_append(OutputBuffer *outputBuffer, void *data, uint32_t length);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    c49f5b0d_crc32
  * Description: Calculates the CRC-32 of the OutputBuffer for length bytes
@@ -177,9 +192,25 @@ uint32_t c49f5b0d_crc32(OutputBuffer *outputBuffer, uint32_t length);
  */
 bool c49f5b0d_advanceNumBits(InputBuffer *inputBuffer, uint32_t numBits);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    c49f5b0d_copyBytes
+ * Description: Copies length bytes from a byte-aligned InputBuffer, moving on
+ *              to the next FileBuffer as each one is exhausted
+ *
+ * Parameters:
+ *   inputBuffer    A pointer to the InputBuffer instance
+ *   dest           The destination buffer
+ *   length         The number of bytes to copy
+ * Returns:     True if there were enough bytes in the buffer, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool c49f5b0d_copyBytes(InputBuffer *inputBuffer, void *dest, uint32_t length);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    c49f5b0d_getNextBits
- * Description: Sets the next bits from the InputBuffer
+ * Description: Sets the next 64 bits from the InputBuffer, gathered across as
+ *              many chained FileBuffers as needed; bits past the end of the
+ *              last FileBuffer are zero
  *
  * Parameters:
  *   inputBuffer    A pointer to the InputBuffer instance
@@ -199,6 +230,52 @@ void c49f5b0d_getNextBits(InputBuffer *inputBuffer);
  */
 bool c49f5b0d_useNumBits(InputBuffer *inputBuffer, uint32_t numBits);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    c49f5b0d_peekBits
+ * Description: Returns at least the next 57 bits of the InputBuffer without
+ *              advancing it; reads inside the current FileBuffer are inlined
+ *
+ * Parameters:
+ *   inputBuffer    A pointer to the InputBuffer instance
+ * Returns:     The next bits of the InputBuffer, LSB-first
+ * ----------------------------------------------------------------------------
+ */
+static inline uint64_t c49f5b0d_peekBits(InputBuffer *inputBuffer) {
+	uint64_t bits;
+
+	if (inputBuffer->offsetBitPos + 64 > (inputBuffer->fileBuffer->numBytes << 3)) {
+		c49f5b0d_getNextBits(inputBuffer);
+		return inputBuffer->bits;
+	}
+
+	memcpy(&bits, inputBuffer->buffer + (inputBuffer->offsetBitPos >> 3), sizeof(uint64_t));
+
+	return bits >> (inputBuffer->offsetBitPos & 0x07);
+}
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    c49f5b0d_skipBits
+ * Description: Advances the InputBuffer numBits; advances that stay inside the
+ *              current FileBuffer are inlined
+ *
+ * Parameters:
+ *   inputBuffer    A pointer to the InputBuffer instance
+ *   numBits        The number of bits to advance the InputBuffer
+ * Returns:     True if there were enough bits in the buffer, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+static inline bool c49f5b0d_skipBits(InputBuffer *inputBuffer, uint32_t numBits) {
+	if (inputBuffer->bitPos + numBits > inputBuffer->totalNumBits
+	        || inputBuffer->offsetBitPos + numBits > (inputBuffer->fileBuffer->numBytes << 3)) {
+		return c49f5b0d_advanceNumBits(inputBuffer, numBits);
+	}
+
+	inputBuffer->bitPos += numBits;
+	inputBuffer->offsetBitPos += numBits;
+
+	return true;
+}
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_write
  * Description: Writes an OutputBuffer instance to the specified file descriptor
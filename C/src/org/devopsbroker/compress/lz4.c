@@ -0,0 +1,869 @@
+/*
+ * lz4.c - DevOpsBroker C source file for the LZ4 block and frame formats
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The encoder and decoder follow the block and frame format specifications at
+ * https://github.com/lz4/lz4/tree/dev/doc; compressed output differs from the
+ * reference encoder but decodes with any LZ4 decoder.
+ *
+ * Input is consumed in whole units: the magic number, the frame descriptor, a
+ * block length, a block with its checksum, or the content checksum. A unit
+ * held entirely in the fed chunk is decoded in place, and one that is split
+ * across chunks is collected in the carry buffer first.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <assert.h>
+
+#include "lz4.h"
+#include "lz77.h"
+
+#include "../lang/error.h"
+#include "../lang/memory.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define LZ4_MIN_MATCH          4
+#define LZ4_MFLIMIT            12
+#define LZ4_LAST_LITERALS      5
+#define LZ4_MIN_INPUT_LENGTH   (LZ4_MFLIMIT + 1)
+#define LZ4_MAX_DISTANCE       65535
+#define LZ4_RUN_MASK           15
+#define LZ4_WILDCOPY_SIZE      16
+#define LZ4_FAST_MARGIN        32
+
+#define LZ4_HASH_BITS          12
+#define LZ4_MIN_HASH_BITS      8
+#define LZ4_HASH_PRIME         2654435761U
+#define LZ4_SKIP_TRIGGER       6
+
+#define LZ4_FRAME_MAGIC        0x184D2204U
+#define LZ4_SKIPPABLE_MAGIC    0x184D2A50U
+#define LZ4_SKIPPABLE_MASK     0xFFFFFFF0U
+#define LZ4_UNCOMPRESSED_BIT   0x80000000U
+
+#define LZ4_FLG_VERSION           0x40
+#define LZ4_FLG_VERSION_MASK      0xC0
+#define LZ4_FLG_BLOCK_INDEP       0x20
+#define LZ4_FLG_BLOCK_CHECKSUM    0x10
+#define LZ4_FLG_CONTENT_SIZE      0x08
+#define LZ4_FLG_CONTENT_CHECKSUM  0x04
+#define LZ4_FLG_RESERVED          0x02
+#define LZ4_FLG_DICT_ID           0x01
+
+#define LZ4_BD_64KB            0x40
+#define LZ4_BD_RESERVED        0x8F
+#define LZ4_BD_MIN_BLOCK_ID    4
+
+// Frame descriptor of the Lz4Encoder: independent blocks, content checksum
+#define LZ4_ENCODER_FLG  (LZ4_FLG_VERSION | LZ4_FLG_BLOCK_INDEP | LZ4_FLG_CONTENT_CHECKSUM)
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static inline uint32_t readPrefix(const uint8_t *bytePtr);
+static inline uint32_t hashPrefix(const uint8_t *bytePtr, uint32_t hashBits);
+static inline uint32_t countMatch(const uint8_t *inputPtr, const uint8_t *match, const uint8_t *matchLimit);
+static inline uint8_t *writeLength(uint8_t *outputPtr, uint32_t length);
+static inline bool readLength(const uint8_t **inputPtr, const uint8_t *inputEnd, size_t *length);
+static inline uint8_t *writeSequence(uint8_t *outputPtr, uint8_t *outputEnd, const uint8_t *literals,
+                                     uint32_t literalLength, uint32_t offset, uint32_t matchLength);
+
+static uint32_t encodeBlock(const uint8_t *source, uint32_t sourceLength, uint8_t *dest, uint32_t destCapacity,
+                            uint32_t *hashTable, uint32_t hashBits);
+static int32_t decodeBlock(const uint8_t *source, uint32_t sourceLength, uint8_t *dest, uint32_t destCapacity,
+                           const uint8_t *windowStart);
+
+static bool writeFrameHeader(Lz4Encoder *encoder);
+static bool writeFrameBlock(Lz4Encoder *encoder, uint8_t *block, uint32_t length);
+static bool writeFrameEnd(Lz4Encoder *encoder);
+
+static bool decodeUnit(Lz4Decoder *decoder, uint8_t *unit);
+static bool decodeDescriptor(Lz4Decoder *decoder, uint8_t *unit);
+static bool decodeHeader(Lz4Decoder *decoder, uint8_t *unit);
+static bool decodeFrameBlock(Lz4Decoder *decoder, uint8_t *unit);
+static bool emitOutput(Lz4Decoder *decoder, uint8_t *output, uint32_t length);
+static void endFrame(Lz4Decoder *decoder);
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void aa7e0bd8_cleanUpLz4Encoder(Lz4Encoder *encoder) {
+	f668c4bd_free(encoder->block);
+	f668c4bd_free(encoder->output);
+	f668c4bd_free(encoder->hashTable);
+}
+
+void aa7e0bd8_initLz4Encoder(Lz4Encoder *encoder, InflateSinkFunc sink, void *sinkData) {
+	encoder->sink = sink;
+	encoder->sinkData = sinkData;
+	encoder->block = f668c4bd_malloc(LZ4_BLOCK_SIZE);
+	encoder->output = f668c4bd_malloc(LZ4_BLOCK_SIZE + sizeof(uint32_t));
+	encoder->hashTable = f668c4bd_malloc(sizeof(uint32_t) << LZ4_HASH_BITS);
+	encoder->totalIn = 0;
+	encoder->totalOut = 0;
+	encoder->blockLength = 0;
+	encoder->isHeaderWritten = false;
+
+	f668c4bd_meminit(encoder->hashTable, sizeof(uint32_t) << LZ4_HASH_BITS);
+	e0ee98a1_initXXHash32(&encoder->contentHash, 0);
+}
+
+void aa7e0bd8_cleanUpLz4Decoder(Lz4Decoder *decoder) {
+	f668c4bd_free(decoder->window);
+	f668c4bd_free(decoder->carry);
+}
+
+void aa7e0bd8_initLz4Decoder(Lz4Decoder *decoder, InflateSinkFunc sink, void *sinkData) {
+	decoder->sink = sink;
+	decoder->sinkData = sinkData;
+	decoder->window = f668c4bd_malloc(LZ4_WINDOW_SIZE + LZ4_BLOCK_SIZE);
+	decoder->carry = f668c4bd_malloc(LZ4_BLOCK_SIZE + sizeof(uint32_t));
+	decoder->contentSize = 0;
+	decoder->frameOut = 0;
+	decoder->totalIn = 0;
+	decoder->totalOut = 0;
+	decoder->bufferSize = LZ4_BLOCK_SIZE;
+	decoder->maxBlockSize = LZ4_BLOCK_SIZE;
+	decoder->windowPos = 0;
+	decoder->unitLength = sizeof(uint32_t);
+	decoder->carryLength = 0;
+	decoder->blockSize = 0;
+	decoder->skipLength = 0;
+	decoder->state = LZ4_STATE_MAGIC;
+	decoder->status = INFLATE_SUCCESS;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+uint32_t aa7e0bd8_compressBlock(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity) {
+	uint32_t hashTable[1 << LZ4_HASH_BITS];
+	uint32_t hashBits = LZ4_HASH_BITS;
+
+	// Small inputs use a smaller hash table, so clearing it costs less than compressing them
+	while (hashBits > LZ4_MIN_HASH_BITS && (1U << (hashBits - 1)) >= sourceLength) {
+		hashBits--;
+	}
+
+	f668c4bd_meminit(hashTable, sizeof(uint32_t) << hashBits);
+
+	return encodeBlock(source, sourceLength, dest, destCapacity, hashTable, hashBits);
+}
+
+int32_t aa7e0bd8_decompressBlock(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity) {
+	return decodeBlock(source, sourceLength, dest, destCapacity, dest);
+}
+
+bool aa7e0bd8_lz4Compress(Lz4Encoder *encoder, void *input, uint32_t length, bool isFinal) {
+	uint8_t *inputPtr = input;
+	uint32_t numBytes;
+
+	// 1. Write the frame header ahead of the first block
+	if (!encoder->isHeaderWritten) {
+		if (!writeFrameHeader(encoder)) {
+			return false;
+		}
+
+		encoder->isHeaderWritten = true;
+	}
+
+	// 2. Compress whole blocks straight from the input and collect the rest in the block buffer
+	while (length > 0) {
+		if (encoder->blockLength == 0 && length >= LZ4_BLOCK_SIZE) {
+			numBytes = LZ4_BLOCK_SIZE;
+
+			if (!writeFrameBlock(encoder, inputPtr, numBytes)) {
+				return false;
+			}
+		} else {
+			numBytes = LZ4_BLOCK_SIZE - encoder->blockLength;
+
+			if (numBytes > length) {
+				numBytes = length;
+			}
+
+			f668c4bd_memcopy(inputPtr, encoder->block + encoder->blockLength, numBytes);
+			encoder->blockLength += numBytes;
+
+			if (encoder->blockLength == LZ4_BLOCK_SIZE) {
+				encoder->blockLength = 0;
+
+				if (!writeFrameBlock(encoder, encoder->block, LZ4_BLOCK_SIZE)) {
+					return false;
+				}
+			}
+		}
+
+		inputPtr += numBytes;
+		length -= numBytes;
+	}
+
+	// 3. Flush the last partial block and end the frame
+	if (isFinal) {
+		if (encoder->blockLength > 0) {
+			numBytes = encoder->blockLength;
+			encoder->blockLength = 0;
+
+			if (!writeFrameBlock(encoder, encoder->block, numBytes)) {
+				return false;
+			}
+		}
+
+		return writeFrameEnd(encoder);
+	}
+
+	return true;
+}
+
+bool aa7e0bd8_lz4Feed(Lz4Decoder *decoder, void *bytes, uint32_t length) {
+	uint8_t *inputPtr, *inputEnd, *unit;
+	uint32_t numBytes;
+
+	// A stream that failed stays failed
+	if (decoder->status == INFLATE_INPUT_ERROR || decoder->status == INFLATE_OUTPUT_ERROR) {
+		return false;
+	}
+
+	inputPtr = bytes;
+	inputEnd = inputPtr + length;
+	decoder->totalIn += length;
+
+	while (inputPtr < inputEnd) {
+		numBytes = inputEnd - inputPtr;
+
+		// 1. Pass over the contents of a skippable frame
+		if (decoder->state == LZ4_STATE_SKIP) {
+			if (numBytes > decoder->skipLength) {
+				numBytes = decoder->skipLength;
+			}
+
+			inputPtr += numBytes;
+			decoder->skipLength -= numBytes;
+
+			if (decoder->skipLength == 0) {
+				endFrame(decoder);
+			}
+
+			continue;
+		}
+
+		// 2. Decode the unit in place if the chunk holds all of it, otherwise collect it first
+		if (decoder->carryLength == 0 && numBytes >= decoder->unitLength) {
+			unit = inputPtr;
+			inputPtr += decoder->unitLength;
+		} else {
+			if (numBytes > decoder->unitLength - decoder->carryLength) {
+				numBytes = decoder->unitLength - decoder->carryLength;
+			}
+
+			f668c4bd_memcopy(inputPtr, decoder->carry + decoder->carryLength, numBytes);
+			inputPtr += numBytes;
+			decoder->carryLength += numBytes;
+
+			if (decoder->carryLength < decoder->unitLength) {
+				break;
+			}
+
+			unit = decoder->carry;
+			decoder->carryLength = 0;
+		}
+
+		if (!decodeUnit(decoder, unit)) {
+			return false;
+		}
+	}
+
+	// 3. The chunk ended at the end of a frame if nothing of the next one has been read
+	if (decoder->state == LZ4_STATE_MAGIC && decoder->carryLength == 0 && decoder->totalIn > 0) {
+		decoder->status = INFLATE_SUCCESS;
+		return true;
+	}
+
+	decoder->status = INFLATE_NEED_INPUT;
+	return false;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline uint32_t readPrefix(const uint8_t *bytePtr) {
+	uint32_t prefix;
+
+	memcpy(&prefix, bytePtr, sizeof(uint32_t));
+
+	return prefix;
+}
+
+static inline uint32_t hashPrefix(const uint8_t *bytePtr, uint32_t hashBits) {
+	return (readPrefix(bytePtr) * LZ4_HASH_PRIME) >> (32 - hashBits);
+}
+
+static inline uint32_t countMatch(const uint8_t *inputPtr, const uint8_t *match, const uint8_t *matchLimit) {
+	const uint8_t *start = inputPtr;
+	uint64_t inputWord, matchWord, diff;
+
+	// 1. Compare eight bytes at a time; the first differing byte is the lowest set bit of the XOR
+	while (inputPtr + sizeof(uint64_t) <= matchLimit) {
+		memcpy(&inputWord, inputPtr, sizeof(uint64_t));
+		memcpy(&matchWord, match, sizeof(uint64_t));
+		diff = inputWord ^ matchWord;
+
+		if (diff != 0) {
+			return (inputPtr - start) + (__builtin_ctzll(diff) >> 3);
+		}
+
+		inputPtr += sizeof(uint64_t);
+		match += sizeof(uint64_t);
+	}
+
+	// 2. Compare the last bytes before the limit one at a time
+	while (inputPtr < matchLimit && *inputPtr == *match) {
+		inputPtr++;
+		match++;
+	}
+
+	return inputPtr - start;
+}
+
+static inline uint8_t *writeLength(uint8_t *outputPtr, uint32_t length) {
+	uint32_t numBytes = length / 255;
+
+	memset(outputPtr, 255, numBytes);
+	outputPtr += numBytes;
+	*outputPtr++ = length % 255;
+
+	return outputPtr;
+}
+
+static inline bool readLength(const uint8_t **inputPtr, const uint8_t *inputEnd, size_t *length) {
+	uint32_t lengthByte;
+
+	do {
+		if (*inputPtr == inputEnd) {
+			return false;
+		}
+
+		lengthByte = *(*inputPtr)++;
+		*length += lengthByte;
+	} while (lengthByte == 255);
+
+	return true;
+}
+
+static uint32_t encodeBlock(const uint8_t *source, uint32_t sourceLength, uint8_t *dest, uint32_t destCapacity,
+                            uint32_t *hashTable, uint32_t hashBits) {
+	const uint8_t *inputPtr, *anchor, *match, *inputLimit, *matchLimit, *sourceEnd;
+	uint8_t *outputPtr, *outputEnd;
+	uint32_t hash, position, matchPos, matchLength, numProbes;
+
+	sourceEnd = source + sourceLength;
+	inputPtr = source;
+	anchor = source;
+	outputPtr = dest;
+	outputEnd = dest + destCapacity;
+
+	// Matches start at least LZ4_MFLIMIT bytes and end at least LZ4_LAST_LITERALS bytes before the end
+	if (sourceLength >= LZ4_MIN_INPUT_LENGTH) {
+		inputLimit = sourceEnd - LZ4_MFLIMIT;
+		matchLimit = sourceEnd - LZ4_LAST_LITERALS;
+		numProbes = 1 << LZ4_SKIP_TRIGGER;
+
+		while (inputPtr <= inputLimit) {
+			// 1. Probe the hash table once; entries left over from earlier input are only hints
+			hash = hashPrefix(inputPtr, hashBits);
+			position = inputPtr - source;
+			matchPos = hashTable[hash];
+			hashTable[hash] = position;
+
+			if (matchPos >= position || position - matchPos > LZ4_MAX_DISTANCE
+			        || readPrefix(source + matchPos) != readPrefix(inputPtr)) {
+				// Step further ahead the longer no match is found
+				inputPtr += numProbes++ >> LZ4_SKIP_TRIGGER;
+				continue;
+			}
+
+			// 2. Extend the match backwards over the pending literals, then forwards
+			match = source + matchPos;
+
+			while (inputPtr > anchor && match > source && inputPtr[-1] == match[-1]) {
+				inputPtr--;
+				match--;
+			}
+
+			matchLength = LZ4_MIN_MATCH + countMatch(inputPtr + LZ4_MIN_MATCH, match + LZ4_MIN_MATCH, matchLimit);
+
+			// 3. Write the sequence
+			outputPtr = writeSequence(outputPtr, outputEnd, anchor, inputPtr - anchor, inputPtr - match, matchLength);
+
+			if (outputPtr == NULL) {
+				return 0;
+			}
+
+			inputPtr += matchLength;
+			anchor = inputPtr;
+			numProbes = 1 << LZ4_SKIP_TRIGGER;
+
+			// 4. Insert a position inside the match so the next search can find it
+			hashTable[hashPrefix(inputPtr - 2, hashBits)] = (inputPtr - 2) - source;
+		}
+	}
+
+	// 5. The last sequence holds the remaining literals
+	outputPtr = writeSequence(outputPtr, outputEnd, anchor, sourceEnd - anchor, 0, 0);
+
+	return (outputPtr == NULL) ? 0 : outputPtr - dest;
+}
+
+static inline uint8_t *writeSequence(uint8_t *outputPtr, uint8_t *outputEnd, const uint8_t *literals,
+                                     uint32_t literalLength, uint32_t offset, uint32_t matchLength) {
+	uint8_t *token;
+
+	// Token, offset, both lengths and the literals
+	if ((uint64_t) literalLength + (literalLength / 255) + (matchLength / 255) + 5 > (uint64_t) (outputEnd - outputPtr)) {
+		return NULL;
+	}
+
+	token = outputPtr++;
+
+	if (literalLength >= LZ4_RUN_MASK) {
+		*token = LZ4_RUN_MASK << 4;
+		outputPtr = writeLength(outputPtr, literalLength - LZ4_RUN_MASK);
+	} else {
+		*token = literalLength << 4;
+	}
+
+	// Literals before a match end at least LZ4_MFLIMIT bytes before the end of the input
+	if (matchLength > 0 && literalLength + LZ4_WILDCOPY_SIZE <= (uint64_t) (outputEnd - outputPtr)) {
+		uint32_t i = 0;
+
+		do {
+			memcpy(outputPtr + i, literals + i, sizeof(uint64_t));
+			i += sizeof(uint64_t);
+		} while (i < literalLength);
+	} else {
+		memcpy(outputPtr, literals, literalLength);
+	}
+
+	outputPtr += literalLength;
+
+	if (matchLength > 0) {
+		outputPtr[0] = offset;
+		outputPtr[1] = offset >> 8;
+		outputPtr += 2;
+		matchLength -= LZ4_MIN_MATCH;
+
+		if (matchLength >= LZ4_RUN_MASK) {
+			*token |= LZ4_RUN_MASK;
+			outputPtr = writeLength(outputPtr, matchLength - LZ4_RUN_MASK);
+		} else {
+			*token |= matchLength;
+		}
+	}
+
+	return outputPtr;
+}
+
+/*
+ * Decodes the block at dest. Matches may reach back to windowStart, which is
+ * dest itself for an independent block.
+ *
+ * While at least LZ4_FAST_MARGIN bytes from the end of the input and output,
+ * short literal runs are copied with one 16-byte store and short matches at
+ * least 8 bytes back with three 8-byte stores, the common case that needs no
+ * length bytes. Longer runs use 16-byte stores while that far from the ends,
+ * and exact copies otherwise.
+ */
+static int32_t decodeBlock(const uint8_t *source, uint32_t sourceLength, uint8_t *dest, uint32_t destCapacity,
+                           const uint8_t *windowStart) {
+	const uint8_t *inputPtr, *inputEnd, *match;
+	uint8_t *outputPtr, *outputEnd;
+	size_t literalLength, matchLength, i;
+	uint32_t token, offset;
+
+	inputPtr = source;
+	inputEnd = source + sourceLength;
+	outputPtr = dest;
+	outputEnd = dest + destCapacity;
+
+	while (true) {
+		// 1. Read the token
+		if (inputPtr == inputEnd) {
+			return SYSTEM_ERROR_CODE;
+		}
+
+		token = *inputPtr++;
+		literalLength = token >> 4;
+		matchLength = token & LZ4_RUN_MASK;
+
+		// 2. Copy the literals
+		if (literalLength < LZ4_RUN_MASK && (size_t) (inputEnd - inputPtr) >= LZ4_FAST_MARGIN
+		        && (size_t) (outputEnd - outputPtr) >= LZ4_FAST_MARGIN) {
+			memcpy(outputPtr, inputPtr, LZ4_WILDCOPY_SIZE);
+		} else {
+			if (literalLength == LZ4_RUN_MASK && !readLength(&inputPtr, inputEnd, &literalLength)) {
+				return SYSTEM_ERROR_CODE;
+			}
+
+			if (literalLength > (size_t) (inputEnd - inputPtr) || literalLength > (size_t) (outputEnd - outputPtr)) {
+				return SYSTEM_ERROR_CODE;
+			}
+
+			if (literalLength + LZ4_WILDCOPY_SIZE <= (size_t) (inputEnd - inputPtr)
+			        && literalLength + LZ4_WILDCOPY_SIZE <= (size_t) (outputEnd - outputPtr)) {
+				i = 0;
+
+				do {
+					memcpy(outputPtr + i, inputPtr + i, LZ4_WILDCOPY_SIZE);
+					i += LZ4_WILDCOPY_SIZE;
+				} while (i < literalLength);
+			} else {
+				memmove(outputPtr, inputPtr, literalLength);
+			}
+		}
+
+		inputPtr += literalLength;
+		outputPtr += literalLength;
+
+		// The last sequence has no match
+		if (inputPtr == inputEnd) {
+			return outputPtr - dest;
+		}
+
+		// 3. Read the offset
+		if (inputEnd - inputPtr < 2) {
+			return SYSTEM_ERROR_CODE;
+		}
+
+		offset = inputPtr[0] | (inputPtr[1] << 8);
+		inputPtr += 2;
+
+		if (offset == 0 || offset > (size_t) (outputPtr - windowStart)) {
+			return SYSTEM_ERROR_CODE;
+		}
+
+		// 4. Copy a short match at least 8 bytes back in three stores
+		match = outputPtr - offset;
+
+		if (matchLength < LZ4_RUN_MASK && offset >= sizeof(uint64_t)
+		        && (size_t) (outputEnd - outputPtr) >= LZ4_FAST_MARGIN) {
+			memcpy(outputPtr, match, sizeof(uint64_t));
+			memcpy(outputPtr + 8, match + 8, sizeof(uint64_t));
+			memcpy(outputPtr + 16, match + 16, sizeof(uint64_t));
+			outputPtr += matchLength + LZ4_MIN_MATCH;
+			continue;
+		}
+
+		// 5. Otherwise read the match length and check it against the output
+		if (matchLength == LZ4_RUN_MASK && !readLength(&inputPtr, inputEnd, &matchLength)) {
+			return SYSTEM_ERROR_CODE;
+		}
+
+		matchLength += LZ4_MIN_MATCH;
+
+		if (matchLength > (size_t) (outputEnd - outputPtr)) {
+			return SYSTEM_ERROR_CODE;
+		}
+
+		// Overlapping matches repeat the last offset bytes
+		if (matchLength + LZ77_COPY_SLACK <= (size_t) (outputEnd - outputPtr)) {
+			b4f6eb7b_copyBackref(outputPtr, offset, matchLength);
+		} else {
+			for (i=0; i < matchLength; i++) {
+				outputPtr[i] = match[i];
+			}
+		}
+
+		outputPtr += matchLength;
+	}
+}
+
+static bool writeFrameHeader(Lz4Encoder *encoder) {
+	uint8_t *header = encoder->output;
+
+	*(uint32_t*)header = LZ4_FRAME_MAGIC;
+	header[4] = LZ4_ENCODER_FLG;
+	header[5] = LZ4_BD_64KB;
+	header[6] = e0ee98a1_xxHash32(header + 4, 2, 0) >> 8;
+
+	encoder->totalOut += 7;
+
+	return encoder->sink(encoder->sinkData, header, 7);
+}
+
+static bool writeFrameBlock(Lz4Encoder *encoder, uint8_t *block, uint32_t length) {
+	uint32_t compressLength;
+
+	e0ee98a1_updateXXHash32(&encoder->contentHash, block, length);
+	encoder->totalIn += length;
+
+	// Keep the block as-is unless compressing it saves at least one byte
+	compressLength = encodeBlock(block, length, encoder->output + sizeof(uint32_t), length - 1,
+	                             encoder->hashTable, LZ4_HASH_BITS);
+
+	if (compressLength == 0) {
+		f668c4bd_memcopy(block, encoder->output + sizeof(uint32_t), length);
+		*(uint32_t*)encoder->output = length | LZ4_UNCOMPRESSED_BIT;
+		compressLength = length;
+	} else {
+		*(uint32_t*)encoder->output = compressLength;
+	}
+
+	compressLength += sizeof(uint32_t);
+	encoder->totalOut += compressLength;
+
+	return encoder->sink(encoder->sinkData, encoder->output, compressLength);
+}
+
+static bool writeFrameEnd(Lz4Encoder *encoder) {
+	uint32_t *trailer = (uint32_t*) encoder->output;
+
+	trailer[0] = 0;
+	trailer[1] = e0ee98a1_digestXXHash32(&encoder->contentHash);
+
+	encoder->totalOut += 8;
+
+	return encoder->sink(encoder->sinkData, encoder->output, 8);
+}
+
+static bool decodeUnit(Lz4Decoder *decoder, uint8_t *unit) {
+	uint32_t value;
+
+	switch (decoder->state) {
+		case LZ4_STATE_MAGIC:
+			value = *(uint32_t*)unit;
+
+			if (value == LZ4_FRAME_MAGIC) {
+				decoder->state = LZ4_STATE_DESCRIPTOR;
+				decoder->unitLength = 2;
+			} else if ((value & LZ4_SKIPPABLE_MASK) == LZ4_SKIPPABLE_MAGIC) {
+				decoder->state = LZ4_STATE_SKIP_SIZE;
+			} else {
+				decoder->status = INFLATE_INPUT_ERROR;
+				return false;
+			}
+
+			return true;
+
+		case LZ4_STATE_DESCRIPTOR:
+			return decodeDescriptor(decoder, unit);
+
+		case LZ4_STATE_HEADER:
+			return decodeHeader(decoder, unit);
+
+		case LZ4_STATE_SKIP_SIZE:
+			decoder->skipLength = *(uint32_t*)unit;
+			decoder->state = LZ4_STATE_SKIP;
+
+			if (decoder->skipLength == 0) {
+				endFrame(decoder);
+			}
+
+			return true;
+
+		case LZ4_STATE_BLOCK_SIZE:
+			value = *(uint32_t*)unit;
+
+			if (value != 0) {
+				// Block length, with room for its checksum
+				decoder->blockSize = value;
+				value &= ~LZ4_UNCOMPRESSED_BIT;
+
+				if (value > decoder->maxBlockSize) {
+					decoder->status = INFLATE_INPUT_ERROR;
+					return false;
+				}
+
+				decoder->state = LZ4_STATE_BLOCK;
+				decoder->unitLength = value + ((decoder->descriptor[0] & LZ4_FLG_BLOCK_CHECKSUM) ? 4 : 0);
+			} else if ((decoder->descriptor[0] & LZ4_FLG_CONTENT_SIZE) && decoder->frameOut != decoder->contentSize) {
+				// EndMark before or after the content size
+				decoder->status = INFLATE_INPUT_ERROR;
+				return false;
+			} else if (decoder->descriptor[0] & LZ4_FLG_CONTENT_CHECKSUM) {
+				decoder->state = LZ4_STATE_CHECKSUM;
+			} else {
+				endFrame(decoder);
+			}
+
+			return true;
+
+		case LZ4_STATE_BLOCK:
+			return decodeFrameBlock(decoder, unit);
+
+		case LZ4_STATE_CHECKSUM:
+			if (*(uint32_t*)unit != e0ee98a1_digestXXHash32(&decoder->contentHash)) {
+				decoder->status = INFLATE_INPUT_ERROR;
+				return false;
+			}
+
+			endFrame(decoder);
+			return true;
+
+		default:
+			// Skippable frame contents are passed over by aa7e0bd8_lz4Feed()
+			return true;
+	}
+}
+
+static bool decodeDescriptor(Lz4Decoder *decoder, uint8_t *unit) {
+	uint32_t flags = unit[0];
+	uint32_t blockId = (unit[1] >> 4) & 0x07;
+
+	// Preset dictionaries are not supported
+	if ((flags & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION || (flags & (LZ4_FLG_RESERVED | LZ4_FLG_DICT_ID))
+	        || (unit[1] & LZ4_BD_RESERVED) || blockId < LZ4_BD_MIN_BLOCK_ID) {
+		decoder->status = INFLATE_INPUT_ERROR;
+		return false;
+	}
+
+	decoder->descriptor[0] = unit[0];
+	decoder->descriptor[1] = unit[1];
+	decoder->maxBlockSize = 1U << (2 * blockId + 8);
+
+	// Optional content size and the header checksum
+	decoder->state = LZ4_STATE_HEADER;
+	decoder->unitLength = ((flags & LZ4_FLG_CONTENT_SIZE) ? sizeof(uint64_t) : 0) + 1;
+
+	return true;
+}
+
+static bool decodeHeader(Lz4Decoder *decoder, uint8_t *unit) {
+	uint32_t descriptorLength = decoder->unitLength + 1;
+
+	// 1. Check the header checksum over the descriptor
+	f668c4bd_memcopy(unit, decoder->descriptor + 2, decoder->unitLength);
+
+	if (decoder->descriptor[descriptorLength] != (uint8_t) (e0ee98a1_xxHash32(decoder->descriptor, descriptorLength, 0) >> 8)) {
+		decoder->status = INFLATE_INPUT_ERROR;
+		return false;
+	}
+
+	decoder->contentSize = (decoder->descriptor[0] & LZ4_FLG_CONTENT_SIZE) ? *(uint64_t*)(decoder->descriptor + 2) : 0;
+
+	// 2. Enlarge the window and carry buffer for larger blocks; the unit is no longer needed
+	if (decoder->maxBlockSize > decoder->bufferSize) {
+		f668c4bd_free(decoder->window);
+		f668c4bd_free(decoder->carry);
+
+		decoder->bufferSize = decoder->maxBlockSize;
+		decoder->window = f668c4bd_malloc(LZ4_WINDOW_SIZE + decoder->bufferSize);
+		decoder->carry = f668c4bd_malloc(decoder->bufferSize + sizeof(uint32_t));
+	}
+
+	// 3. Start the first block of the frame
+	e0ee98a1_initXXHash32(&decoder->contentHash, 0);
+	decoder->frameOut = 0;
+	decoder->windowPos = 0;
+	decoder->state = LZ4_STATE_BLOCK_SIZE;
+	decoder->unitLength = sizeof(uint32_t);
+
+	return true;
+}
+
+static bool decodeFrameBlock(Lz4Decoder *decoder, uint8_t *unit) {
+	uint8_t *output;
+	uint32_t blockLength;
+	int32_t outputLength;
+	bool isLinked;
+
+	blockLength = decoder->blockSize & ~LZ4_UNCOMPRESSED_BIT;
+	isLinked = !(decoder->descriptor[0] & LZ4_FLG_BLOCK_INDEP);
+
+	// 1. Check the block checksum
+	if ((decoder->descriptor[0] & LZ4_FLG_BLOCK_CHECKSUM)
+	        && *(uint32_t*)(unit + blockLength) != e0ee98a1_xxHash32(unit, blockLength, 0)) {
+		decoder->status = INFLATE_INPUT_ERROR;
+		return false;
+	}
+
+	// 2. Decode the block after the output of the blocks it is linked to
+	output = decoder->window + decoder->windowPos;
+
+	if (decoder->blockSize & LZ4_UNCOMPRESSED_BIT) {
+		if (isLinked) {
+			f668c4bd_memcopy(unit, output, blockLength);
+		} else {
+			output = unit;
+		}
+
+		outputLength = blockLength;
+	} else {
+		outputLength = decodeBlock(unit, blockLength, output, decoder->maxBlockSize,
+		                           isLinked ? decoder->window : output);
+
+		if (outputLength == SYSTEM_ERROR_CODE) {
+			decoder->status = INFLATE_INPUT_ERROR;
+			return false;
+		}
+	}
+
+	if (!emitOutput(decoder, output, outputLength)) {
+		return false;
+	}
+
+	// 3. Keep the last LZ4_WINDOW_SIZE bytes of output at the start of the window once the next block may not fit
+	if (isLinked) {
+		decoder->windowPos += outputLength;
+
+		if (decoder->windowPos + decoder->maxBlockSize > LZ4_WINDOW_SIZE + decoder->bufferSize) {
+			memmove(decoder->window, decoder->window + decoder->windowPos - LZ4_WINDOW_SIZE, LZ4_WINDOW_SIZE);
+			decoder->windowPos = LZ4_WINDOW_SIZE;
+		}
+	}
+
+	decoder->state = LZ4_STATE_BLOCK_SIZE;
+	decoder->unitLength = sizeof(uint32_t);
+
+	return true;
+}
+
+static bool emitOutput(Lz4Decoder *decoder, uint8_t *output, uint32_t length) {
+	if (decoder->descriptor[0] & LZ4_FLG_CONTENT_CHECKSUM) {
+		e0ee98a1_updateXXHash32(&decoder->contentHash, output, length);
+	}
+
+	decoder->frameOut += length;
+	decoder->totalOut += length;
+
+	if (!decoder->sink(decoder->sinkData, output, length)) {
+		decoder->status = INFLATE_OUTPUT_ERROR;
+		return false;
+	}
+
+	return true;
+}
+
+static void endFrame(Lz4Decoder *decoder) {
+	decoder->state = LZ4_STATE_MAGIC;
+	decoder->unitLength = sizeof(uint32_t);
+}
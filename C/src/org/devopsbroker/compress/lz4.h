@@ -0,0 +1,290 @@
+/*
+ * lz4.h - DevOpsBroker C header file for the LZ4 block and frame formats
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_COMPRESS_LZ4 | md5sum | cut -c 25-32
+ *
+ * An LZ4 block is a series of sequences, each made of a run of literals and a
+ * (offset, length) match:
+ *
+ *   Token          High nibble is the literal length, low nibble the match
+ *                  length minus 4; a nibble of 15 is continued by bytes of 255
+ *                  and a final byte below 255
+ *   Literals       The literal bytes copied as-is
+ *   Offset         Little-endian 16-bit distance back to the match, 1-65535
+ *
+ * The last sequence of a block has literals only. The encoder takes the first
+ * match found with a single probe of a hash table of 4-byte prefixes, and
+ * skips ahead faster the longer it goes without finding one. The decoder
+ * copies literals and matches in 16-byte stores while it is far enough from
+ * the end of the input and output, and checks every length and offset
+ * against the bounds of both.
+ *
+ * An LZ4 frame (https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md)
+ * wraps blocks of at most 64KB to 4MB, each preceded by its little-endian
+ * length with the high bit set if the block is stored uncompressed:
+ *
+ *   Magic          0x184D2204
+ *   Descriptor     FLG and BD bytes, optional content size and dictionary ID,
+ *                  and the second byte of the xxHash32 of the descriptor
+ *   Blocks         Length, data and optional xxHash32 of each block
+ *   EndMark        Zero length
+ *   Checksum       Optional xxHash32 of the content
+ *
+ * The Lz4Encoder writes frames of independent 64KB blocks with a content
+ * checksum. The Lz4Decoder reads frames of either independent or linked
+ * blocks, and skips skippable frames. Both hand their output to an
+ * InflateSinkFunc, the same as Inflate.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_COMPRESS_LZ4_H
+#define ORG_DEVOPSBROKER_COMPRESS_LZ4_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "inflate.h"
+#include "../hash/xxhash.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define LZ4_BLOCK_SIZE       65536
+#define LZ4_WINDOW_SIZE      65536
+#define LZ4_MAX_BLOCK_SIZE   (4 * 1024 * 1024)
+#define LZ4_HEADER_MAX_SIZE  19
+
+// Largest compressed size of an LZ4 block of the given length
+#define LZ4_COMPRESS_BOUND(length)  ((length) + ((length) / 255) + 16)
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef enum Lz4State {
+	LZ4_STATE_MAGIC,              // Magic number of the next frame
+	LZ4_STATE_DESCRIPTOR,         // FLG and BD bytes of the frame descriptor
+	LZ4_STATE_HEADER,             // Rest of the frame descriptor
+	LZ4_STATE_SKIP_SIZE,          // Length of a skippable frame
+	LZ4_STATE_SKIP,               // Contents of a skippable frame
+	LZ4_STATE_BLOCK_SIZE,         // Length of the next block or the EndMark
+	LZ4_STATE_BLOCK,              // Data and checksum of the block
+	LZ4_STATE_CHECKSUM            // Content checksum of the frame
+} Lz4State;
+
+/*
+ * Lz4Encoder
+ *   - Sink the compressed frame is handed to
+ *   - Block of input collected from chunks smaller than LZ4_BLOCK_SIZE
+ *   - Output of the block being compressed
+ *   - Hash table of 4-byte prefixes; its entries are only hints, so it is not
+ *     cleared between blocks
+ *   - xxHash32 of the content
+ *   - Total bytes of input and of compressed output
+ *   - Length of the collected block
+ */
+typedef struct Lz4Encoder {
+	InflateSinkFunc   sink;
+	void             *sinkData;
+	uint8_t          *block;
+	uint8_t          *output;
+	uint32_t         *hashTable;
+	XXHash32          contentHash;
+	uint64_t          totalIn;
+	uint64_t          totalOut;
+	uint32_t          blockLength;
+	bool              isHeaderWritten;
+} Lz4Encoder;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(Lz4Encoder) == 112, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(Lz4Encoder) == 92, "Check your assumptions");
+#endif
+
+/*
+ * Lz4Decoder
+ *   - Sink the decompressed content is handed to
+ *   - Output window; linked blocks are decoded after the last LZ4_WINDOW_SIZE
+ *     bytes of output, which their matches may reach back into
+ *   - Carry buffer collecting a header, block or checksum split across calls
+ *     to aa7e0bd8_lz4Feed()
+ *   - xxHash32 of the content of the frame
+ *   - Content size of the frame if present, and its output so far
+ *   - Total bytes of input fed and of output handed to the sink
+ *   - Allocated size of the window and carry buffer
+ *   - Maximum block size of the frame, window offset of the next block
+ *   - Bytes needed to complete the current unit, bytes of it in the carry
+ *     buffer, the length field of the current block, and the remaining
+ *     length of a skippable frame
+ *   - Frame descriptor without the magic number, kept for its checksum
+ */
+typedef struct Lz4Decoder {
+	InflateSinkFunc   sink;
+	void             *sinkData;
+	uint8_t          *window;
+	uint8_t          *carry;
+	XXHash32          contentHash;
+	uint64_t          contentSize;
+	uint64_t          frameOut;
+	uint64_t          totalIn;
+	uint64_t          totalOut;
+	uint32_t          bufferSize;
+	uint32_t          maxBlockSize;
+	uint32_t          windowPos;
+	uint32_t          unitLength;
+	uint32_t          carryLength;
+	uint32_t          blockSize;
+	uint32_t          skipLength;
+	uint8_t           descriptor[LZ4_HEADER_MAX_SIZE - 4];
+	Lz4State          state;
+	InflationStatus   status;
+} Lz4Decoder;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(Lz4Decoder) == 168, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(Lz4Decoder) == 148, "Check your assumptions");
+#endif
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_cleanUpLz4Encoder
+ * Description: Frees the block, output and hash table of the Lz4Encoder
+ *
+ * Parameters:
+ *   encoder    A pointer to the Lz4Encoder instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void aa7e0bd8_cleanUpLz4Encoder(Lz4Encoder *encoder);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_initLz4Encoder
+ * Description: Initializes an Lz4Encoder struct to write a new frame
+ *
+ * Parameters:
+ *   encoder    A pointer to the Lz4Encoder instance to initialize
+ *   sink       The sink function the compressed frame is handed to
+ *   sinkData   The data passed to the sink function
+ * ----------------------------------------------------------------------------
+ */
+void aa7e0bd8_initLz4Encoder(Lz4Encoder *encoder, InflateSinkFunc sink, void *sinkData);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_cleanUpLz4Decoder
+ * Description: Frees the output window and carry buffer of the Lz4Decoder
+ *
+ * Parameters:
+ *   decoder    A pointer to the Lz4Decoder instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void aa7e0bd8_cleanUpLz4Decoder(Lz4Decoder *decoder);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_initLz4Decoder
+ * Description: Initializes an Lz4Decoder struct to read a new stream of
+ *              frames. The buffers fit 64KB blocks, and are enlarged by a
+ *              frame header with a larger maximum block size.
+ *
+ * Parameters:
+ *   decoder    A pointer to the Lz4Decoder instance to initialize
+ *   sink       The sink function the decompressed content is handed to
+ *   sinkData   The data passed to the sink function
+ * ----------------------------------------------------------------------------
+ */
+void aa7e0bd8_initLz4Decoder(Lz4Decoder *decoder, InflateSinkFunc sink, void *sinkData);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_compressBlock
+ * Description: Compresses the input into a single LZ4 block
+ *
+ * Parameters:
+ *   source         The input data to compress
+ *   sourceLength   The length of the input data
+ *   dest           The buffer to write the block to
+ *   destCapacity   The size of the output buffer; a block always fits in
+ *                  LZ4_COMPRESS_BOUND(sourceLength) bytes
+ * Returns:         The length of the block, or zero if it did not fit
+ * ----------------------------------------------------------------------------
+ */
+uint32_t aa7e0bd8_compressBlock(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_decompressBlock
+ * Description: Decompresses a single LZ4 block into the output buffer
+ *
+ * Parameters:
+ *   source         The LZ4 block
+ *   sourceLength   The exact length of the block
+ *   dest           The buffer to decompress the block into
+ *   destCapacity   The size of the output buffer
+ * Returns:         The length of the decompressed data, or SYSTEM_ERROR_CODE
+ *                  if the block is malformed or does not fit
+ * ----------------------------------------------------------------------------
+ */
+int32_t aa7e0bd8_decompressBlock(void *source, uint32_t sourceLength, void *dest, uint32_t destCapacity);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_lz4Compress
+ * Description: Compresses the input into the LZ4 frame and hands each
+ *              completed block to the sink. The input may be passed in chunks
+ *              of any size; the final chunk writes the EndMark and content
+ *              checksum.
+ *
+ * Parameters:
+ *   encoder    A pointer to the Lz4Encoder instance
+ *   input      The input data to compress
+ *   length     The length of the input data
+ *   isFinal    True if this is the last of the input data
+ * Returns:     False if the sink failed, true otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aa7e0bd8_lz4Compress(Lz4Encoder *encoder, void *input, uint32_t length, bool isFinal);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    aa7e0bd8_lz4Feed
+ * Description: Pushes the next chunk of a stream of LZ4 frames, hands each
+ *              decompressed block to the sink and checks the block and
+ *              content checksums. The chunk is not needed after the call.
+ *
+ *              Returns true when the chunk ends exactly at the end of a frame.
+ *              Otherwise false is returned with INFLATE_NEED_INPUT if more
+ *              input is needed, INFLATE_INPUT_ERROR if the stream is
+ *              malformed, or INFLATE_OUTPUT_ERROR if the sink failed.
+ *
+ * Parameters:
+ *   decoder    A pointer to the Lz4Decoder instance
+ *   bytes      The next chunk of the stream
+ *   length     The length of the chunk
+ * Returns:     True if the chunk ended at the end of a frame, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool aa7e0bd8_lz4Feed(Lz4Decoder *decoder, void *bytes, uint32_t length);
+
+#endif /* ORG_DEVOPSBROKER_COMPRESS_LZ4_H */
@@ -0,0 +1,143 @@
+/*
+ * lz77.h - DevOpsBroker C header file for LZ77 back reference functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_COMPRESS_LZ77 | md5sum | cut -c 25-32
+ *
+ * A back reference (dist, length) repeats the length bytes that start dist
+ * bytes before the current output position. When length > dist the source
+ * overlaps the bytes being written, which repeats the last dist bytes as a
+ * pattern; runs of a single byte (dist 1) are the most common case.
+ *
+ * The copy is done in 16-byte stores, which may write up to LZ77_COPY_SLACK
+ * bytes past the end of the back reference. The bytes written past the end
+ * are overwritten by the output that follows.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_COMPRESS_LZ77_H
+#define ORG_DEVOPSBROKER_COMPRESS_LZ77_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define LZ77_COPY_SLACK  16
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b4f6eb7b_copyBackref
+ * Description: Outputs the (dist, length) back reference at dest with 16-byte
+ *              stores; there must be room for length + LZ77_COPY_SLACK bytes
+ *              at dest
+ *
+ *              Distances of 16 or more copy 16 bytes at a time, as the source
+ *              is always at least one store behind. Distances from 8 to 15
+ *              copy 8 bytes at a time. Shorter distances broadcast the pattern
+ *              of the last dist bytes into a 16-byte value and store it every
+ *              multiple of dist bytes.
+ *
+ * Parameters:
+ *   dest       The output position of the back reference
+ *   dist       The distance of the back reference, from 1 to 65535
+ *   length     The length of the back reference, at least 1
+ * ----------------------------------------------------------------------------
+ */
+static inline void b4f6eb7b_copyBackref(uint8_t *dest, uint32_t dist, uint32_t length) {
+	const uint8_t *backref;
+	const uint8_t *end;
+	uint8_t pattern[16];
+	uint64_t word;
+	uint32_t i, stride;
+
+	backref = dest - dist;
+	end = dest + length;
+
+	if (dist >= 16) {
+		// 1. Copy 16 bytes at a time
+		do {
+#if defined(__SSE2__)
+			_mm_storeu_si128((__m128i*) dest, _mm_loadu_si128((const __m128i*) backref));
+#else
+			memcpy(&word, backref, sizeof(uint64_t));
+			memcpy(dest, &word, sizeof(uint64_t));
+			memcpy(&word, backref + 8, sizeof(uint64_t));
+			memcpy(dest + 8, &word, sizeof(uint64_t));
+#endif
+			dest += 16;
+			backref += 16;
+		} while (dest < end);
+	} else if (dist >= 8) {
+		// 2. Copy 8 bytes at a time
+		do {
+			memcpy(&word, backref, sizeof(uint64_t));
+			memcpy(dest, &word, sizeof(uint64_t));
+			dest += 8;
+			backref += 8;
+		} while (dest < end);
+	} else {
+		// 3. Broadcast the pattern and store it every multiple of dist bytes
+		if (dist == 1) {
+			memset(pattern, backref[0], sizeof(pattern));
+			stride = 16;
+		} else {
+			for (i=0; i < dist; i++) {
+				pattern[i] = backref[i];
+			}
+
+			for (; i < 16; i++) {
+				pattern[i] = pattern[i - dist];
+			}
+
+			stride = 16 - (16 % dist);
+		}
+
+#if defined(__SSE2__)
+		__m128i value = _mm_loadu_si128((const __m128i*) pattern);
+
+		do {
+			_mm_storeu_si128((__m128i*) dest, value);
+			dest += stride;
+		} while (dest < end);
+#else
+		do {
+			memcpy(dest, pattern, sizeof(pattern));
+			dest += stride;
+		} while (dest < end);
+#endif
+	}
+}
+
+#endif /* ORG_DEVOPSBROKER_COMPRESS_LZ77_H */
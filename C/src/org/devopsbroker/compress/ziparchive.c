@@ -40,17 +40,32 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
+
+#include <fnmatch.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "ziparchive.h"
 #include "inflate.h"
+#include "iobuffer.h"
 
 #include "../fs/directory.h"
+#include "../hash/crc32.h"
 #include "../io/file.h"
 #include "../io/filebuffer.h"
+#include "../lang/error.h"
 #include "../lang/integer.h"
 #include "../lang/memory.h"
 #include "../lang/string.h"
+#include "../memory/hugepagepool.h"
+#include "../memory/memorypool.h"
 #include "../memory/pagepool.h"
+#include "../memory/slabpool.h"
 #include "../time/time.h"
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
@@ -64,8 +79,39 @@
 #define ZIP_END_OF_CDR_SIG   0x06054b50
 #define ZIP_END_OF_CDR_SIZE  22
 
+#define ZIP_DATA_DESCRIPTOR_SIG   0x08074b50
+#define ZIP_DATA_DESCRIPTOR_SIZE  16
+#define ZIP_DATA_DESCRIPTOR_FLAG  0x0008
+
+#define ZIP_VERSION_MADE_BY  0x0314
+#define ZIP_VERSION_NEEDED   20
+#define ZIP_MSDOS_DIRECTORY  0x10
+
 #define ZIP64_END_OF_CDR_SIGNATURE  0x06064b50
+#define ZIP64_END_OF_CDR_SIZE       56
 #define ZIP64_END_OF_CDL_SIGNATURE  0x07064b50
+#define ZIP64_END_OF_CDL_SIZE       20
+
+#define ZIP64_DATA_DESCRIPTOR_SIZE  24
+#define ZIP64_EXTRA_FIELD_ID        0x0001
+#define ZIP64_VERSION_NEEDED        45
+#define ZIP64_MARKER_32             0xFFFFFFFF
+#define ZIP64_MARKER_16             0xFFFF
+
+// Deflate can grow incompressible data slightly, so entries this large are written as Zip64
+#define ZIP64_ENTRY_THRESHOLD  0xFF000000
+
+// Entry data larger than this is streamed through the FileBufferList window
+#define ZIP_ENTRY_WINDOW_SIZE  (4 * 1024 * 1024)
+
+#define ZIP_BYTES_PER_MB  1000000.0
+
+#define ZIP_INDEX_MAGIC    0x495a4244
+#define ZIP_INDEX_VERSION  1
+
+#define ZIP_READ_MAX_OPERATIONS   64
+#define ZIP_WRITE_MAX_OPERATIONS  8
+#define ZIP_DIRECT_IO_MASK        511
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -112,10 +158,10 @@ typedef struct LocalFileHeader {
 	char       *fileName;
 	char       *extraField;
 	char       *fileData;
+	uint64_t    compressSize;
+	uint64_t    uncompressSize;
 	uint32_t    signature;
 	uint32_t    crc32;
-	uint32_t    compressSize;
-	uint32_t    uncompressSize;
 	uint16_t    needToExtractVersion;
 	uint16_t    bitFlags;
 	uint16_t    compressMethod;
@@ -125,11 +171,7 @@ typedef struct LocalFileHeader {
 	uint16_t    extraFieldLen;
 } LocalFileHeader __attribute__ ((aligned (16)));
 
-#if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(LocalFileHeader) == 56, "Check your assumptions");
-#elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(LocalFileHeader) == 44, "Check your assumptions");
-#endif
+static_assert(sizeof(LocalFileHeader) == 64, "Check your assumptions");
 
 /*
  * Data Descriptor
@@ -159,59 +201,6 @@ typedef struct Zip64DataDescriptor {
 
 static_assert(sizeof(Zip64DataDescriptor) == 24, "Check your assumptions");
 
-/*
- * File Header
- *   - central file header signature                      4 bytes  (0x02014b50)
- *   - version made by                                    2 bytes
- *   - version needed to extract                          2 bytes
- *   - general purpose bit flag                           2 bytes
- *   - compression method                                 2 bytes
- *   - last mod file time                                 2 bytes
- *   - last mod file date                                 2 bytes
- *   - crc-32                                             4 bytes
- *   - compressed size                                    4 bytes
- *   - uncompressed size                                  4 bytes
- *   - file name length                                   2 bytes
- *   - extra field length                                 2 bytes
- *   - file comment length                                2 bytes
- *   - disk number start                                  2 bytes
- *   - internal file attributes                           2 bytes
- *   - external file attributes                           4 bytes
- *   - relative offset of local header                    4 bytes
- *
- *   - file name                                          (variable size)
- *   - extra field                                        (variable size)
- *   - file comment                                       (variable size)
- */
-typedef struct FileHeader {
-	char*    fileName;
-	char*    extraField;
-	char*    fileComment;
-	uint32_t signature;
-	uint32_t crc32;
-	uint32_t compressSize;
-	uint32_t uncompressSize;
-	uint32_t externalFileAttribs;
-	uint32_t localHeaderOffset;
-	uint16_t madeByVersion;
-	uint16_t needToExtractVersion;
-	uint16_t bitFlags;
-	uint16_t compressMethod;
-	uint16_t lastModFileTime;
-	uint16_t lastModFileDate;
-	uint16_t fileNameLen;
-	uint16_t extraFieldLen;
-	uint16_t fileCommentLen;
-	uint16_t diskNumStart;
-	uint16_t internalFileAttribs;
-} FileHeader __attribute__ ((aligned (16)));
-
-#if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(FileHeader) == 72, "Check your assumptions");
-#elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(FileHeader) == 60, "Check your assumptions");
-#endif
-
 /*
  * Digital Signature
  *   - header signature                                   4 bytes  (0x05054b50)
@@ -359,16 +348,173 @@ typedef struct ZipFormat {
 	EndOfCDR         endOfCDR;
 } ZipFormat;
 
+/*
+ * Zip Output File
+ *   - AIOFile struct for the extracted file
+ *   - Modification time of the extracted file
+ *   - CRC-32 of the data written so far, computed as it is copied or inflated
+ *   - Each chunk is written with O_DIRECT while the next one is produced; the
+ *     unaligned tail of the last chunk is written through the page cache
+ */
+typedef struct ZipOutputFile {
+	AIOFile       aioFile;
+	time_t        timestamp;
+	uint32_t      crc32;
+	bool          isOpen;
+} ZipOutputFile;
+
+/*
+ * Zip Entry Buffer
+ *   - Caller buffer ce667b0d_readEntry() inflates the entry into
+ *   - Length of the caller buffer and the number of bytes filled so far
+ */
+typedef struct ZipEntryBuffer {
+	uint8_t  *buffer;
+	uint64_t  length;
+	uint64_t  offset;
+} ZipEntryBuffer;
+
+/*
+ * Zip Index Header
+ *   - magic number ("DBZI") and version of the sidecar index format
+ *   - size and modification time of the Zip archive the index was built from
+ *   - number of entries and number of hash table slots (a power of two that
+ *     keeps the hash table at most half full)
+ *   - file offsets of the entry table, hash table and name table
+ *   - total size of the index file
+ *
+ * The sidecar index is laid out as the header, the ZipIndexEntry table in
+ * Central Directory order, the hash table and the name table. Every hash
+ * table slot holds the index of an entry plus one, or zero if empty, and is
+ * probed linearly from the CRC-32 of the entry name. The name table holds the
+ * NUL-terminated entry names.
+ */
+typedef struct ZipIndexHeader {
+	uint32_t magic;
+	uint32_t version;
+	int64_t  archiveSize;
+	int64_t  archiveModTime;
+	int64_t  archiveModTimeNsec;
+	uint32_t numEntries;
+	uint32_t numSlots;
+	uint32_t entryOffset;
+	uint32_t slotOffset;
+	uint32_t nameOffset;
+	uint32_t indexSize;
+} ZipIndexHeader;
+
+static_assert(sizeof(ZipIndexHeader) == 56, "Check your assumptions");
+
+/*
+ * Zip Index Entry
+ *   - the Central Directory fields of the entry needed to read it
+ *   - CRC-32 of the entry name and its offset in the name table
+ */
+typedef struct ZipIndexEntry {
+	uint64_t compressSize;
+	uint64_t uncompressSize;
+	uint64_t localHeaderOffset;
+	uint32_t nameHashCode;
+	uint32_t nameOffset;
+	uint32_t crc32;
+	uint32_t externalFileAttribs;
+	uint16_t madeByVersion;
+	uint16_t needToExtractVersion;
+	uint16_t bitFlags;
+	uint16_t compressMethod;
+	uint16_t lastModFileTime;
+	uint16_t lastModFileDate;
+	uint16_t fileNameLen;
+	uint16_t internalFileAttribs;
+} ZipIndexEntry;
+
+static_assert(sizeof(ZipIndexEntry) == 56, "Check your assumptions");
+
+/*
+ * Zip Worker
+ *   - ZipArchive with its own file descriptor, FileBufferList and write
+ *     AIOContext so workers never share reader state
+ *   - AIOContext for the Linux AIO reads of the worker
+ *   - The FileHeader entries assigned to the worker, in archive order
+ *   - The ZipArchive the worker was started from
+ *   - Total compressed size of the assigned entries
+ *   - Number of entries that failed when testing instead of extracting
+ *   - isTest is true if the entries are only inflated and checked
+ *   - isThreaded is false if the worker thread could not be created
+ */
+typedef struct ZipWorker {
+	ZipArchive  zipArchive;
+	AIOContext  aioContext;
+	ListArray   fileHeaderList;
+	ZipArchive *parentArchive;
+	int64_t     compressSize;
+	pthread_t   thread;
+	uint32_t    numFailures;
+	bool        isTest;
+	bool        isThreaded;
+} ZipWorker;
+
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
 static bool findEndOfCDR(ZipFormat *zipFormat);
+static bool findZip64EndOfCDR(ZipFormat *zipFormat, int64_t endOfCDROffset);
+static void readZip64ExtraField(FileHeader *fileHeader);
 static void loadCentralDirectory(ZipFormat *zipFormat);
-static void processFileHeaderList(ZipArchive *zipArchive, CentralDirectory *centralDir);
+static bool loadZipReader(ZipReader *zipReader);
+static ListArray *selectFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList, ListArray *selectedList);
+static int64_t *createRangeEndList(ZipArchive *zipArchive, ListArray *fileHeaderList);
+static uint32_t getSelectionIOSize(ZipArchive *zipArchive, ListArray *fileHeaderList);
+static void processFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList, DirCache *dirCache);
+static uint32_t testFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList);
+static uint32_t runZipWorkers(ZipArchive *zipArchive, ListArray *fileHeaderList, uint32_t numThreads, bool isTest);
+
+static void makeDirectories(ListArray *fileHeaderList, DirCache *dirCache);
+static void partitionFileHeaderList(ListArray *fileHeaderList, ZipWorker *workerList, uint32_t numThreads);
+static void *runZipWorker(void *zipWorkerPtr);
+static int compareCompressSize(void *first, void *second);
+static int compareLocalHeaderOffset(void *first, void *second);
+static bool isDirectory(FileHeader *fileHeader);
+static char *getEntryName(FileHeader *fileHeader);
+static int64_t getEntryEnd(FileHeader *fileHeader);
+static bool matchGlob(char *entryName, void *pattern);
+static int64_t getMonotonicTime();
+static double getThroughput(uint64_t numBytes, int64_t elapsedTime);
+static uint32_t getCompressRatio(uint64_t uncompressSize, uint64_t compressSize);
+
+static bool findEntryData(ZipArchive *zipArchive, FileHeader *fileHeader, int64_t *dataOffset);
+static uint32_t getWindowLength(uint64_t length);
+static bool inflateEntryData(ZipArchive *zipArchive, Inflate *inflate, bool *isInflateInit, FileHeader *fileHeader,
+                             int64_t dataOffset, InflateSinkFunc sink, void *sinkData);
+static bool readEntryData(ZipArchive *zipArchive, Inflate *inflate, bool *isInflateInit, FileHeader *fileHeader,
+                          InflateSinkFunc sink, void *sinkData);
+static bool copyEntryChunk(void *entryBufferPtr, void *buffer, uint32_t length);
+static void printCrc32Error(FileHeader *fileHeader);
+
+static bool mapZipIndex(ZipReader *zipReader, char *indexName, FileStatus *archiveStatus);
+static bool isValidZipIndex(ZipIndexHeader *indexHeader, int64_t indexSize, FileStatus *archiveStatus);
+static FileHeader *findIndexEntry(ZipReader *zipReader, char *entryName);
+static void writeZipIndex(ZipReader *zipReader, char *indexName, FileStatus *archiveStatus);
+
+static bool copyStoredData(ZipArchive *zipArchive, int64_t offset, uint64_t length, ZipOutputFile *outputFile);
+static bool openOutputFile(ZipArchive *zipArchive, ZipOutputFile *outputFile, FileHeader *fileHeader);
+static void closeOutputFile(ZipOutputFile *outputFile);
+static void checkOutputFile(ZipOutputFile *outputFile, FileHeader *fileHeader);
+static bool writeOutputChunk(void *outputFilePtr, void *buffer, uint32_t length);
+static void waitOutputFile(ZipOutputFile *outputFile);
+
+static bool writeFileData(ZipWriter *zipWriter, FileHeader *fileHeader, char *pathName, int64_t fileSize);
+static void writeLocalFileHeader(ZipWriter *zipWriter, FileHeader *fileHeader);
+static void writeDataDescriptor(ZipWriter *zipWriter, FileHeader *fileHeader);
+static void writeCentralDirectory(ZipWriter *zipWriter);
+static void appendData(ZipWriter *zipWriter, void *data, uint32_t length);
+static void flushZipWriter(ZipWriter *zipWriter, bool isClosing);
+static void waitZipWriter(ZipWriter *zipWriter);
 
 static void printEndOfCDR(EndOfCDR *endOfCDR);
+static void printListEntry(FileHeader *fileHeader);
 static void printCentralDirectory(CentralDirectory *centralDir);
 static void printLocalFileHeader(LocalFileHeader *localFileHeader, FileHeader *fileHeader, uint32_t index);
 
@@ -402,21 +548,28 @@ void ce667b0d_cleanUpZipArchive(ZipArchive *zipArchive) {
 	f1207515_cleanUpAIOFile(&zipArchive->aioFile);
 
 	// 2. Clean up the FileBufferList struct
-	ce97d170_cleanUpFileBufferList(&zipArchive->bufferList, f502a409_releasePage);
+	ce97d170_cleanUpFileBufferList(&zipArchive->bufferList, ce97d170_getFreeBuffer(&zipArchive->bufferList));
+
+	// 3. Clean up the write AIOContext
+	f1207515_cleanUpAIOContext(&zipArchive->writeContext);
 }
 
 void ce667b0d_initZipArchive(ZipArchive *zipArchive, AIOContext *aioContext, char *fileName) {
 	FileStatus fileStatus;
 
-	// 1. Initialize the FileBufferList struct
+	// 1. Initialize the FileBufferList struct with 32KB reads
 	ce97d170_initFileBufferList(&zipArchive->bufferList);
+	ce97d170_setPreferredIOSize(&zipArchive->bufferList, SLABPOOL_SLAB_SIZE);
 
 	// 2. Initialize the AIOFile struct
 	f1207515_initAIOFile(aioContext, &zipArchive->aioFile, fileName);
 
-	// 3. Initialize the AIOContext and output directory
+	// 3. Initialize the AIOContexts and output directory
 	zipArchive->aioContext = aioContext;
 	zipArchive->outputDir = NULL;
+	zipArchive->entryFilter = NULL;
+	zipArchive->filterData = NULL;
+	f1207515_initAIOContext(&zipArchive->writeContext, ZIP_WRITE_MAX_OPERATIONS);
 
 	// 4. Open the file
 	f1207515_open(&zipArchive->aioFile, FOPEN_READONLY, 0);
@@ -426,6 +579,64 @@ void ce667b0d_initZipArchive(ZipArchive *zipArchive, AIOContext *aioContext, cha
 	zipArchive->aioFile.fileSize = fileStatus.st_size;
 }
 
+void ce667b0d_cleanUpZipWriter(ZipWriter *zipWriter) {
+	// 1. Clean up the Central Directory FileHeader list
+	b196167f_cleanUpListArray(&zipWriter->fileHeaderList, ce667b0d_destroyFileHeader);
+
+	// 2. Clean up the FileBufferList and Deflate structs
+	ce97d170_cleanUpFileBufferList(&zipWriter->bufferList, ce97d170_getFreeBuffer(&zipWriter->bufferList));
+	a8a82d35_cleanUpDeflate(&zipWriter->deflate);
+
+	// 3. Release any OutputBuffer slabs that were never written
+	if (zipWriter->headBuffer != NULL) {
+		c49f5b0d_destroyOutputBuffer(zipWriter->headBuffer);
+	}
+
+	if (zipWriter->pendingBuffer != NULL) {
+		c49f5b0d_destroyOutputBuffer(zipWriter->pendingBuffer);
+	}
+
+	// 4. Clean up the write AIOContext
+	f1207515_cleanUpAIOContext(&zipWriter->writeContext);
+}
+
+bool ce667b0d_initZipWriter(ZipWriter *zipWriter, AIOContext *aioContext, char *fileName, int level) {
+	AIOFile *aioFile;
+
+	aioFile = &zipWriter->aioFile;
+
+	// 1. Initialize the write AIOContext and the AIOFile struct
+	f1207515_initAIOContext(&zipWriter->writeContext, ZIP_WRITE_MAX_OPERATIONS);
+	f1207515_initAIOFile(&zipWriter->writeContext, aioFile, fileName);
+	f1207515_initAIOTicket(&aioFile->aioTicket);
+
+	// 2. Create the archive with O_DIRECT, falling back to the page cache if unsupported
+	if (f1207515_create(aioFile, FOPEN_WRITEONLY, O_TRUNC, FILE_DEFAULT_MODE) == SYSTEM_ERROR_CODE) {
+		aioFile->fd = e2f74138_createFile(fileName, FOPEN_WRITEONLY, O_TRUNC, FILE_DEFAULT_MODE);
+
+		if (aioFile->fd == SYSTEM_ERROR_CODE) {
+			f1207515_cleanUpAIOContext(&zipWriter->writeContext);
+			return false;
+		}
+	}
+
+	// 3. Initialize the archive OutputBuffer chain and the Deflate encoder
+	zipWriter->headBuffer = c49f5b0d_createOutputBuffer();
+	zipWriter->tailBuffer = zipWriter->headBuffer;
+	zipWriter->pendingBuffer = NULL;
+	zipWriter->offset = 0;
+
+	a8a82d35_initDeflate(&zipWriter->deflate, level, zipWriter->tailBuffer);
+
+	// 4. Initialize the Central Directory FileHeader list and the FileBufferList with 32KB reads
+	b196167f_initListArray(&zipWriter->fileHeaderList);
+	ce97d170_initFileBufferList(&zipWriter->bufferList);
+	ce97d170_setPreferredIOSize(&zipWriter->bufferList, SLABPOOL_SLAB_SIZE);
+	zipWriter->aioContext = aioContext;
+
+	return true;
+}
+
 static void cleanUpZipFormat(ZipFormat *zipFormat) {
 	// 1. Clean up the Central Directory FileHeader list
 	b196167f_cleanUpListArray(&zipFormat->centralDirectory.fileHeaderList, ce667b0d_destroyFileHeader);
@@ -452,13 +663,90 @@ static void initZipFormat(ZipFormat *zipFormat, ZipArchive *zipArchive) {
 	zipFormat->zipArchive = zipArchive;
 }
 
+void ce667b0d_closeZipReader(ZipReader *zipReader) {
+	ZipIndexHeader *indexHeader;
+
+	// 1. Unmap the sidecar index, or clean up the name index and the Central Directory FileHeader list
+	if (zipReader->indexData != NULL) {
+		indexHeader = zipReader->indexData;
+
+		if (zipReader->indexHeaderList != NULL) {
+			munmap(zipReader->indexHeaderList, indexHeader->numEntries * sizeof(FileHeader));
+		}
+
+		munmap(zipReader->indexData, indexHeader->indexSize);
+	} else {
+		c47905f7_cleanUpHashMap(&zipReader->fileHeaderMap);
+		b196167f_cleanUpListArray(&zipReader->fileHeaderList, ce667b0d_destroyFileHeader);
+	}
+
+	// 2. Free the Inflate output window and decoders
+	if (zipReader->isInflateInit) {
+		d592eb82_cleanUpInflate(&zipReader->inflate);
+	}
+
+	// 3. Close the Zip archive
+	ce667b0d_cleanUpZipArchive(&zipReader->zipArchive);
+}
+
+bool ce667b0d_openZipReader(ZipReader *zipReader, AIOContext *aioContext, char *fileName) {
+	// 1. Open the Zip archive
+	ce667b0d_initZipArchive(&zipReader->zipArchive, aioContext, fileName);
+
+	// 2. Load and index its Central Directory
+	if (!loadZipReader(zipReader)) {
+		ce667b0d_cleanUpZipArchive(&zipReader->zipArchive);
+		return false;
+	}
+
+	return true;
+}
+
+bool ce667b0d_openZipReaderIndex(ZipReader *zipReader, AIOContext *aioContext, char *fileName, char *indexName) {
+	FileStatus archiveStatus;
+
+	// 1. Open the Zip archive and retrieve its size and modification time
+	ce667b0d_initZipArchive(&zipReader->zipArchive, aioContext, fileName);
+
+	if (!e2f74138_getDescriptorStatus(zipReader->zipArchive.aioFile.fd, &archiveStatus)) {
+		ce667b0d_cleanUpZipArchive(&zipReader->zipArchive);
+		return false;
+	}
+
+	// 2. Map the sidecar index if it matches the Zip archive
+	if (mapZipIndex(zipReader, indexName, &archiveStatus)) {
+		zipReader->isInflateInit = false;
+		return true;
+	}
+
+	// 3. Otherwise load the Central Directory and rewrite the sidecar index
+	if (!loadZipReader(zipReader)) {
+		ce667b0d_cleanUpZipArchive(&zipReader->zipArchive);
+		return false;
+	}
+
+	writeZipIndex(zipReader, indexName, &archiveStatus);
+
+	return true;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 void ce667b0d_unzip(ZipArchive *zipArchive) {
+	ce667b0d_unzipParallel(zipArchive, 1);
+}
+
+void ce667b0d_unzipParallel(ZipArchive *zipArchive, uint32_t numThreads) {
 	ZipFormat zipFormat;
+	ListArray *fileHeaderList;
+	ListArray selectedList;
+	ListArray *entryList;
+	DirCache dirCache;
+	uint32_t ioSize;
 
 	// 1. Initialize the ZipFormat struct
 	initZipFormat(&zipFormat, zipArchive);
+	fileHeaderList = &zipFormat.centralDirectory.fileHeaderList;
 
 	// 2. Find the End of Central Directory Record
 	if (findEndOfCDR(&zipFormat)) {
@@ -469,51 +757,312 @@ void ce667b0d_unzip(ZipArchive *zipArchive) {
 
 		// printCentralDirectory(&zipFormat.centralDirectory);
 
-		// 4. Load up to the first 32KB of the file
-		if (zipArchive->bufferList.fileOffset > 0) {
-			uint32_t dataLength;
+		// 4. Process the selected entries of the FileHeader list obtained from the Central Directory
+		entryList = selectFileHeaderList(zipArchive, fileHeaderList, &selectedList);
+		ioSize = zipArchive->bufferList.ioSize;
+		d0059b5b_initDirCache(&dirCache);
 
-			// Release all currently held FileBuffers
-			ce97d170_resetFileBufferList(&zipArchive->bufferList, f502a409_releasePage);
+		if (entryList == &selectedList) {
+			ce97d170_setPreferredIOSize(&zipArchive->bufferList, getSelectionIOSize(zipArchive, entryList));
+		}
 
-			zipArchive->aioFile.offset = 0;
-			if (zipArchive->aioFile.fileSize > ASYNC_AIOTICKET_MAXSIZE) {
-				dataLength = ASYNC_AIOTICKET_MAXSIZE;
-			} else {
-				dataLength = zipArchive->aioFile.fileSize;
-			}
+		if (numThreads <= 1 || entryList->length <= 1) {
+			processFileHeaderList(zipArchive, entryList, &dirCache);
+		} else {
+			// Create every directory up front so the workers never race on them
+			makeDirectories(entryList, &dirCache);
+			runZipWorkers(zipArchive, entryList, numThreads, false);
+		}
+
+		d0059b5b_cleanUpDirCache(&dirCache);
+
+		if (entryList == &selectedList) {
+			ce97d170_setPreferredIOSize(&zipArchive->bufferList, ioSize);
+			b196167f_cleanUpListArray(&selectedList, NULL);
+		}
+	}
+
+	// 5. Clean up ZipFormat struct
+	cleanUpZipFormat(&zipFormat);
+}
+
+bool ce667b0d_test(ZipArchive *zipArchive) {
+	return ce667b0d_testParallel(zipArchive, 1);
+}
+
+bool ce667b0d_testParallel(ZipArchive *zipArchive, uint32_t numThreads) {
+	ZipFormat zipFormat;
+	ListArray *fileHeaderList;
+	ListArray selectedList;
+	ListArray *entryList;
+	FileHeader *fileHeader;
+	int64_t startTime, elapsedTime;
+	uint64_t totalSize;
+	uint32_t numEntries, numFailures;
+	bool isValid;
+
+	// 1. Initialize the ZipFormat struct
+	initZipFormat(&zipFormat, zipArchive);
+	fileHeaderList = &zipFormat.centralDirectory.fileHeaderList;
+
+	// 2. Find the End of Central Directory Record
+	if (!findEndOfCDR(&zipFormat)) {
+		cleanUpZipFormat(&zipFormat);
+		return false;
+	}
+
+	// 3. Load the Central Directory
+	loadCentralDirectory(&zipFormat);
 
-			ce97d170_readFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, dataLength);
+	// 4. Inflate every selected entry into a discard sink and verify its CRC-32
+	entryList = selectFileHeaderList(zipArchive, fileHeaderList, &selectedList);
+	startTime = getMonotonicTime();
+
+	if (numThreads <= 1 || entryList->length <= 1) {
+		numFailures = testFileHeaderList(zipArchive, entryList);
+	} else {
+		numFailures = runZipWorkers(zipArchive, entryList, numThreads, true);
+	}
+
+	elapsedTime = getMonotonicTime() - startTime;
+
+	// 5. Report the totals
+	numEntries = 0;
+	totalSize = 0;
+
+	for (uint32_t i=0; i < entryList->length; i++) {
+		fileHeader = b196167f_get(entryList, i);
+
+		if (!isDirectory(fileHeader)) {
+			numEntries++;
+			totalSize += fileHeader->uncompressSize;
 		}
+	}
+
+	printf("%u entries tested, %u failed: %.1f MB in %.3f s (%.1f MB/s)\n", numEntries, numFailures,
+	       totalSize / ZIP_BYTES_PER_MB, elapsedTime / 1e9, getThroughput(totalSize, elapsedTime));
 
-		// 5. Process the FileHeader list obtained from the Central Directory
-		processFileHeaderList(zipArchive, &zipFormat.centralDirectory);
+	// 6. Every entry in the End of Central Directory record must have been found and verified
+	isValid = (numFailures == 0 && fileHeaderList->length == zipFormat.zip64EndOfCDR.totalCentralDirEntries);
+
+	if (entryList == &selectedList) {
+		b196167f_cleanUpListArray(&selectedList, NULL);
+	}
+
+	cleanUpZipFormat(&zipFormat);
+
+	return isValid;
+}
+
+bool ce667b0d_list(ZipArchive *zipArchive) {
+	ZipFormat zipFormat;
+	ListArray *fileHeaderList;
+	ListArray selectedList;
+	ListArray *entryList;
+	FileHeader *fileHeader;
+	uint64_t uncompressSize, compressSize;
+	bool isValid;
+
+	// 1. Initialize the ZipFormat struct
+	initZipFormat(&zipFormat, zipArchive);
+	fileHeaderList = &zipFormat.centralDirectory.fileHeaderList;
+
+	// 2. Find the End of Central Directory Record
+	if (!findEndOfCDR(&zipFormat)) {
+		cleanUpZipFormat(&zipFormat);
+		return false;
+	}
+
+	// 3. Load the Central Directory; no entry data is read
+	loadCentralDirectory(&zipFormat);
+
+	// 4. Print one line per selected entry followed by the totals
+	entryList = selectFileHeaderList(zipArchive, fileHeaderList, &selectedList);
+
+	printf("    Length  Method          Size  Cmpr  Date        Time   CRC-32    Name\n");
+	printf("----------  ------  ----------  ----  ----------  -----  --------  ----\n");
+
+	uncompressSize = 0;
+	compressSize = 0;
+
+	for (uint32_t i=0; i < entryList->length; i++) {
+		fileHeader = b196167f_get(entryList, i);
+		printListEntry(fileHeader);
+
+		uncompressSize += fileHeader->uncompressSize;
+		compressSize += fileHeader->compressSize;
+	}
+
+	printf("----------          ----------  ----                             ----\n");
+	printf("%10llu          %10llu  %3u%%                             %u files\n", (unsigned long long) uncompressSize,
+	       (unsigned long long) compressSize, getCompressRatio(uncompressSize, compressSize), entryList->length);
+
+	// 5. Every entry in the End of Central Directory record must have been found
+	isValid = (fileHeaderList->length == zipFormat.zip64EndOfCDR.totalCentralDirEntries);
+
+	if (entryList == &selectedList) {
+		b196167f_cleanUpListArray(&selectedList, NULL);
 	}
 
-	// 6. Clean up ZipFormat struct
 	cleanUpZipFormat(&zipFormat);
+
+	return isValid;
+}
+
+void ce667b0d_setEntryFilter(ZipArchive *zipArchive, ZipEntryFilter entryFilter, void *filterData) {
+	zipArchive->entryFilter = entryFilter;
+	zipArchive->filterData = filterData;
+}
+
+void ce667b0d_setGlobFilter(ZipArchive *zipArchive, char *pattern) {
+	ce667b0d_setEntryFilter(zipArchive, matchGlob, pattern);
+}
+
+FileHeader *ce667b0d_findEntry(ZipReader *zipReader, char *entryName) {
+	if (zipReader->indexData != NULL) {
+		return findIndexEntry(zipReader, entryName);
+	}
+
+	return c47905f7_get(&zipReader->fileHeaderMap, entryName);
+}
+
+bool ce667b0d_readEntry(ZipReader *zipReader, FileHeader *fileHeader, void *buffer, uint64_t length) {
+	ZipEntryBuffer entryBuffer;
+
+	if (length < fileHeader->uncompressSize) {
+		return false;
+	}
+
+	entryBuffer.buffer = buffer;
+	entryBuffer.length = length;
+	entryBuffer.offset = 0;
+
+	return readEntryData(&zipReader->zipArchive, &zipReader->inflate, &zipReader->isInflateInit, fileHeader, copyEntryChunk, &entryBuffer)
+	       && entryBuffer.offset == fileHeader->uncompressSize;
+}
+
+bool ce667b0d_streamEntry(ZipReader *zipReader, FileHeader *fileHeader, InflateSinkFunc sink, void *sinkData) {
+	return readEntryData(&zipReader->zipArchive, &zipReader->inflate, &zipReader->isInflateInit, fileHeader, sink, sinkData);
+}
+
+bool ce667b0d_addFile(ZipWriter *zipWriter, char *pathName, char *entryName) {
+	FileStatus fileStatus;
+	FileHeader *fileHeader;
+	uint32_t nameLength;
+	int level;
+	bool isDirEntry;
+
+	// 1. Retrieve the file type, size and modification time
+	e2f74138_getFileStatus(pathName, &fileStatus);
+	isDirEntry = S_ISDIR(fileStatus.st_mode);
+
+	if (!isDirEntry && !S_ISREG(fileStatus.st_mode)) {
+		return false;
+	}
+
+	// 2. Entry names are relative and directory names end with a slash
+	if (entryName == NULL) {
+		entryName = pathName;
+	}
+
+	while (*entryName == '/') {
+		entryName++;
+	}
+
+	nameLength = f6215943_getLength(entryName);
+
+	fileHeader = ce667b0d_createFileHeader();
+	fileHeader->fileName = f668c4bd_stralloc(nameLength + 1);
+	f668c4bd_memcopy(entryName, fileHeader->fileName, nameLength);
+
+	if (isDirEntry && (nameLength == 0 || entryName[nameLength - 1] != '/')) {
+		fileHeader->fileName[nameLength++] = '/';
+	}
+
+	fileHeader->fileName[nameLength] = '\0';
+	fileHeader->fileNameLen = nameLength;
+
+	// 3. Fill in the FileHeader fields known before the data is written
+	level = zipWriter->deflate.level;
+
+	fileHeader->signature = ZIP_FILE_HEADER_SIG;
+	fileHeader->madeByVersion = ZIP_VERSION_MADE_BY;
+	fileHeader->needToExtractVersion = ZIP_VERSION_NEEDED;
+	fileHeader->externalFileAttribs = ((fileStatus.st_mode & 0xFFFF) << 16) | (isDirEntry ? ZIP_MSDOS_DIRECTORY : 0);
+	fileHeader->localHeaderOffset = zipWriter->offset;
+	a66923ff_convertTimeToDOS(fileStatus.st_mtime, &fileHeader->lastModFileDate, &fileHeader->lastModFileTime);
+
+	// Sizes are not known until the data is written, so large files get Zip64 local headers and data descriptors
+	if (fileStatus.st_size >= ZIP64_ENTRY_THRESHOLD) {
+		fileHeader->needToExtractVersion = ZIP64_VERSION_NEEDED;
+	}
+
+	if (isDirEntry || fileStatus.st_size == 0 || level == 0) {
+		fileHeader->compressMethod = ZIP_METHOD_STORED;
+	} else {
+		fileHeader->compressMethod = ZIP_METHOD_DEFLATE;
+		fileHeader->bitFlags = (level == 1) ? ZIP_DEFLATE_SUPERFAST : (level == 2) ? ZIP_DEFLATE_FAST
+		                     : (level >= 8) ? ZIP_DEFLATE_MAXIMUM : ZIP_DEFLATE_NORMAL;
+	}
+
+	// 4. Write the entry; file data is followed by a data descriptor
+	if (isDirEntry) {
+		writeLocalFileHeader(zipWriter, fileHeader);
+	} else {
+		fileHeader->bitFlags |= ZIP_DATA_DESCRIPTOR_FLAG;
+		writeLocalFileHeader(zipWriter, fileHeader);
+
+		if (!writeFileData(zipWriter, fileHeader, pathName, fileStatus.st_size)) {
+			ce667b0d_destroyFileHeader(fileHeader);
+			return false;
+		}
+
+		writeDataDescriptor(zipWriter, fileHeader);
+	}
+
+	// 5. Write out the full OutputBuffer slabs and remember the entry
+	flushZipWriter(zipWriter, false);
+	b196167f_add(&zipWriter->fileHeaderList, fileHeader);
+
+	return true;
+}
+
+void ce667b0d_closeZipWriter(ZipWriter *zipWriter) {
+	// 1. Write the Central Directory and End of Central Directory record
+	writeCentralDirectory(zipWriter);
+
+	// 2. Write out the remaining OutputBuffer slabs and wait for the writes
+	flushZipWriter(zipWriter, true);
+
+	// 3. Close the archive file descriptor
+	f1207515_cleanUpAIOFile(&zipWriter->aioFile);
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 static bool findEndOfCDR(ZipFormat *zipFormat) {
+	FileBufferList *bufferList;
 	FileBuffer *fileBuffer;
 	AIOFile *aioFile;
-	uint32_t length;
+	int64_t offset;
 	void *bufPtr;
 
-	// 1. Set the initial offset
+	// 1. Set the initial offset to the last I/O size unit of the file
 	aioFile = &zipFormat->zipArchive->aioFile;
-	if (aioFile->fileSize > MEMORY_PAGE_SIZE) {
-		aioFile->offset = aioFile->fileSize - MEMORY_PAGE_SIZE;
-		aioFile->offset = ((aioFile->offset + 511) >> 9) << 9;
-	}
+	bufferList = &zipFormat->zipArchive->bufferList;
+	offset = 0;
 
-	length = aioFile->fileSize - aioFile->offset;
+	if (aioFile->fileSize > bufferList->ioSize) {
+		offset = aioFile->fileSize - bufferList->ioSize;
+		offset = ((offset + 511) >> 9) << 9;
+	}
 
 	// 2. Read end of Zip archive
-	fileBuffer = ce97d170_readFileBuffer(aioFile, length);
-	ce97d170_addBuffer(&zipFormat->zipArchive->bufferList, fileBuffer);
+	fileBuffer = ce97d170_slideFileBufferList(aioFile, bufferList, offset, aioFile->fileSize - offset);
+
+	if (fileBuffer == NULL) {
+		return false;
+	}
 
 	bufPtr = fileBuffer->buffer + fileBuffer->numBytes;
 
@@ -521,6 +1070,15 @@ static bool findEndOfCDR(ZipFormat *zipFormat) {
 		for (bufPtr -= ZIP_END_OF_CDR_SIZE; bufPtr >= fileBuffer->buffer; bufPtr--) {
 			if ( (*(uint32_t*)bufPtr) == ZIP_END_OF_CDR_SIG) {
 				ce667b0d_mapEndOfCDR(&zipFormat->endOfCDR, bufPtr);
+				offset = fileBuffer->fileOffset + (bufPtr - fileBuffer->buffer);
+
+				// 3. The Zip64 record supersedes the End of Central Directory values
+				zipFormat->zip64EndOfCDR.totalCentralDirEntriesOnThisDisk = zipFormat->endOfCDR.totalEntriesOnDisk;
+				zipFormat->zip64EndOfCDR.totalCentralDirEntries = zipFormat->endOfCDR.totalEntries;
+				zipFormat->zip64EndOfCDR.centralDirSize = zipFormat->endOfCDR.size;
+				zipFormat->zip64EndOfCDR.centralDirStartOffset = zipFormat->endOfCDR.startOffset;
+
+				findZip64EndOfCDR(zipFormat, offset);
 /*
 				zipFormat->endOfCDR.signature = (*(uint32_t*)bufPtr);
 				bufPtr += 4;
@@ -547,41 +1105,167 @@ static bool findEndOfCDR(ZipFormat *zipFormat) {
 	return false;
 }
 
-static void loadCentralDirectory(ZipFormat *zipFormat) {
+static bool findZip64EndOfCDR(ZipFormat *zipFormat, int64_t endOfCDROffset) {
+	Zip64EndOfCDR *zip64EndOfCDR;
+	Zip64EndOfCDL *zip64EndOfCDL;
+	FileBufferList *bufferList;
 	FileBuffer *fileBuffer;
-	FileHeader *fileHeader;
-	ZipArchive *zipArchive;
-	EndOfCDR *endOfCDR;
 	AIOFile *aioFile;
+	uint8_t recordBuf[ZIP64_END_OF_CDR_SIZE];
 	void *bufPtr;
 
-	endOfCDR = &zipFormat->endOfCDR;
-	zipArchive = zipFormat->zipArchive;
-	fileBuffer = ce97d170_containsData(&zipArchive->bufferList, endOfCDR->startOffset, endOfCDR->size);
+	zip64EndOfCDR = &zipFormat->zip64EndOfCDR;
+	zip64EndOfCDL = &zipFormat->zip64EndOfCDL;
+	aioFile = &zipFormat->zipArchive->aioFile;
+	bufferList = &zipFormat->zipArchive->bufferList;
 
-	if (fileBuffer == NULL) {
-		uint32_t dataLength;
+	// 1. The Zip64 End of Central Directory Locator immediately precedes the End of Central Directory record
+	if (endOfCDROffset < ZIP64_END_OF_CDR_SIZE + ZIP64_END_OF_CDL_SIZE) {
+		return false;
+	}
+
+	fileBuffer = ce97d170_slideFileBufferList(aioFile, bufferList, endOfCDROffset - ZIP64_END_OF_CDL_SIZE, ZIP64_END_OF_CDL_SIZE);
 
-		// Release all currently held FileBuffers
-		ce97d170_resetFileBufferList(&zipArchive->bufferList, f502a409_releasePage);
+	if (fileBuffer == NULL) {
+		return false;
+	}
 
-		// Calculate the Direct I/O file offset and number of blocks to read
-		aioFile = &zipArchive->aioFile;
-		aioFile->offset = (endOfCDR->startOffset >> 9) << 9;
-		dataLength = endOfCDR->startOffset - aioFile->offset + endOfCDR->size;
+	ce97d170_copyData(fileBuffer, recordBuf, ZIP64_END_OF_CDL_SIZE);
+	bufPtr = recordBuf;
 
-		// Read the data
-		ce97d170_readFileBufferList(aioFile, &zipArchive->bufferList, dataLength);
-		fileBuffer = ce97d170_containsData(&zipArchive->bufferList, endOfCDR->startOffset, dataLength);
+	if ( (*(uint32_t*)bufPtr) != ZIP64_END_OF_CDL_SIGNATURE) {
+		return false;
 	}
 
-	bufPtr = fileBuffer->buffer + fileBuffer->dataOffset;
+	bufPtr += 4;
+	zip64EndOfCDL->zip64EndOfCDRStartDiskNum = (*(uint32_t*)bufPtr);
+	bufPtr += 4;
+	zip64EndOfCDL->zip64EndOfCDRStartOffset = (*(uint64_t*)bufPtr);
+	bufPtr += 8;
+	zip64EndOfCDL->totalNumDisks = (*(uint32_t*)bufPtr);
 
-	for (uint32_t i=0; i < endOfCDR->totalEntries; i++) {
-		if ( (*(uint32_t*)bufPtr) == ZIP_FILE_HEADER_SIG) {
-			fileHeader = ce667b0d_createFileHeader();
+	// 2. Read the fixed fields of the Zip64 End of Central Directory record
+	if (zip64EndOfCDL->zip64EndOfCDRStartOffset > (uint64_t) endOfCDROffset - ZIP64_END_OF_CDL_SIZE - ZIP64_END_OF_CDR_SIZE) {
+		return false;
+	}
 
-			fileHeader->signature = (*(uint32_t*)bufPtr);
+	fileBuffer = ce97d170_slideFileBufferList(aioFile, bufferList, zip64EndOfCDL->zip64EndOfCDRStartOffset, ZIP64_END_OF_CDR_SIZE);
+
+	if (fileBuffer == NULL) {
+		return false;
+	}
+
+	ce97d170_copyData(fileBuffer, recordBuf, ZIP64_END_OF_CDR_SIZE);
+	bufPtr = recordBuf;
+
+	if ( (*(uint32_t*)bufPtr) != ZIP64_END_OF_CDR_SIGNATURE) {
+		return false;
+	}
+
+	zip64EndOfCDR->signature = (*(uint32_t*)bufPtr);
+	bufPtr += 4;
+	zip64EndOfCDR->recordSize = (*(uint64_t*)bufPtr);
+	bufPtr += 8;
+	zip64EndOfCDR->madeByVersion = (*(uint16_t*)bufPtr);
+	bufPtr += 2;
+	zip64EndOfCDR->needToExtractVersion = (*(uint16_t*)bufPtr);
+	bufPtr += 2;
+	zip64EndOfCDR->diskNum = (*(uint32_t*)bufPtr);
+	bufPtr += 4;
+	zip64EndOfCDR->centralDirStartDiskNum = (*(uint32_t*)bufPtr);
+	bufPtr += 4;
+	zip64EndOfCDR->totalCentralDirEntriesOnThisDisk = (*(uint64_t*)bufPtr);
+	bufPtr += 8;
+	zip64EndOfCDR->totalCentralDirEntries = (*(uint64_t*)bufPtr);
+	bufPtr += 8;
+	zip64EndOfCDR->centralDirSize = (*(uint64_t*)bufPtr);
+	bufPtr += 8;
+	zip64EndOfCDR->centralDirStartOffset = (*(uint64_t*)bufPtr);
+
+	return true;
+}
+
+static void readZip64ExtraField(FileHeader *fileHeader) {
+	void *bufPtr, *fieldPtr;
+	uint16_t fieldId, fieldSize;
+	uint32_t remaining;
+
+	bufPtr = fileHeader->extraField;
+	remaining = fileHeader->extraFieldLen;
+
+	// Find the Zip64 extended information block among the extra field blocks
+	while (remaining >= 4) {
+		fieldId = (*(uint16_t*)bufPtr);
+		fieldSize = (*(uint16_t*)(bufPtr + 2));
+		bufPtr += 4;
+		remaining -= 4;
+
+		if (fieldSize > remaining) {
+			return;
+		}
+
+		if (fieldId == ZIP64_EXTRA_FIELD_ID) {
+			// Only the fields set to the marker value in the header are present, in this order
+			fieldPtr = bufPtr;
+
+			if (fileHeader->uncompressSize == ZIP64_MARKER_32 && fieldPtr + 8 <= bufPtr + fieldSize) {
+				fileHeader->uncompressSize = (*(uint64_t*)fieldPtr);
+				fieldPtr += 8;
+			}
+
+			if (fileHeader->compressSize == ZIP64_MARKER_32 && fieldPtr + 8 <= bufPtr + fieldSize) {
+				fileHeader->compressSize = (*(uint64_t*)fieldPtr);
+				fieldPtr += 8;
+			}
+
+			if (fileHeader->localHeaderOffset == ZIP64_MARKER_32 && fieldPtr + 8 <= bufPtr + fieldSize) {
+				fileHeader->localHeaderOffset = (*(uint64_t*)fieldPtr);
+			}
+
+			return;
+		}
+
+		bufPtr += fieldSize;
+		remaining -= fieldSize;
+	}
+}
+
+static void loadCentralDirectory(ZipFormat *zipFormat) {
+	Zip64EndOfCDR *zip64EndOfCDR;
+	FileBuffer *fileBuffer;
+	FileHeader *fileHeader;
+	ZipArchive *zipArchive;
+	AIOFile *aioFile;
+	void *centralDirBuf;
+	void *bufPtr;
+
+	zip64EndOfCDR = &zipFormat->zip64EndOfCDR;
+	zipArchive = zipFormat->zipArchive;
+	aioFile = &zipArchive->aioFile;
+
+	// Slide the FileBufferList window over the Central Directory
+	fileBuffer = ce97d170_slideFileBufferList(aioFile, &zipArchive->bufferList, zip64EndOfCDR->centralDirStartOffset,
+	                                          zip64EndOfCDR->centralDirSize);
+
+	if (fileBuffer == NULL) {
+		return;
+	}
+
+	// Copy the Central Directory if it spans more than one FileBuffer
+	if (fileBuffer->dataOffset + zip64EndOfCDR->centralDirSize <= fileBuffer->numBytes) {
+		centralDirBuf = NULL;
+		bufPtr = fileBuffer->buffer + fileBuffer->dataOffset;
+	} else {
+		centralDirBuf = f668c4bd_malloc(zip64EndOfCDR->centralDirSize);
+		ce97d170_copyData(fileBuffer, centralDirBuf, zip64EndOfCDR->centralDirSize);
+		bufPtr = centralDirBuf;
+	}
+
+	for (uint64_t i=0; i < zip64EndOfCDR->totalCentralDirEntries; i++) {
+		if ( (*(uint32_t*)bufPtr) == ZIP_FILE_HEADER_SIG) {
+			fileHeader = ce667b0d_createFileHeader();
+
+			fileHeader->signature = (*(uint32_t*)bufPtr);
 			bufPtr += 4;
 			fileHeader->madeByVersion = (*(uint16_t*)bufPtr);
 			bufPtr += 2;
@@ -644,6 +1328,8 @@ static void loadCentralDirectory(ZipFormat *zipFormat) {
 				f668c4bd_memcopy(bufPtr, fileHeader->extraField, fileHeader->extraFieldLen);
 				fileHeader->extraField[fileHeader->extraFieldLen] = '\0';
 				bufPtr += fileHeader->extraFieldLen;
+
+				readZip64ExtraField(fileHeader);
 			}
 
 			if (fileHeader->fileCommentLen > 0) {
@@ -656,48 +1342,152 @@ static void loadCentralDirectory(ZipFormat *zipFormat) {
 			b196167f_add(&zipFormat->centralDirectory.fileHeaderList, fileHeader);
 		}
 	}
+
+	if (centralDirBuf != NULL) {
+		f668c4bd_free(centralDirBuf);
+	}
+}
+
+static ListArray *selectFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList, ListArray *selectedList) {
+	FileHeader *fileHeader;
+
+	if (zipArchive->entryFilter == NULL) {
+		return fileHeaderList;
+	}
+
+	// The selected list only borrows the FileHeaders of the Central Directory
+	b196167f_initListArray(selectedList);
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		if (fileHeader->fileNameLen > 0 && zipArchive->entryFilter(getEntryName(fileHeader), zipArchive->filterData)) {
+			b196167f_add(selectedList, fileHeader);
+		}
+	}
+
+	return selectedList;
+}
+
+static int64_t *createRangeEndList(ZipArchive *zipArchive, ListArray *fileHeaderList) {
+	FileHeader *fileHeader, *nextHeader;
+	int64_t *rangeEndList;
+	int64_t entryEnd;
+	uint32_t i;
+
+	rangeEndList = f668c4bd_mallocArray(sizeof(int64_t), fileHeaderList->length + 1);
+	nextHeader = NULL;
+
+	// Walking backwards, an entry joins the range of the next entry when the gap between them is
+	// smaller than one I/O size unit, since reading the gap costs no extra AIO request
+	for (i = fileHeaderList->length; i > 0; i--) {
+		fileHeader = b196167f_get(fileHeaderList, i - 1);
+		entryEnd = getEntryEnd(fileHeader);
+
+		if (nextHeader != NULL && (int64_t) nextHeader->localHeaderOffset >= entryEnd - zipArchive->bufferList.ioSize
+		                       && (int64_t) nextHeader->localHeaderOffset <= entryEnd + zipArchive->bufferList.ioSize
+		                       && nextHeader->localHeaderOffset > fileHeader->localHeaderOffset) {
+			rangeEndList[i - 1] = (rangeEndList[i] > entryEnd) ? rangeEndList[i] : entryEnd;
+		} else {
+			rangeEndList[i - 1] = entryEnd;
+		}
+
+		nextHeader = fileHeader;
+	}
+
+	return rangeEndList;
+}
+
+static uint32_t getSelectionIOSize(ZipArchive *zipArchive, ListArray *fileHeaderList) {
+	FileHeader *fileHeader;
+	int64_t *rangeEndList;
+	int64_t selectedSize;
+	uint32_t numRanges;
+
+	rangeEndList = createRangeEndList(zipArchive, fileHeaderList);
+	selectedSize = 0;
+	numRanges = 0;
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+		selectedSize += getEntryEnd(fileHeader) - fileHeader->localHeaderOffset;
+
+		if (i + 1 == fileHeaderList->length || rangeEndList[i] != rangeEndList[i + 1]) {
+			numRanges++;
+		}
+	}
+
+	f668c4bd_free(rangeEndList);
+
+	// Scattered small entries would each cost a whole I/O size unit; read them a page at a time
+	if (numRanges > 0 && selectedSize / numRanges < zipArchive->bufferList.ioSize) {
+		return MEMORY_PAGE_SIZE;
+	}
+
+	return zipArchive->bufferList.ioSize;
 }
 
-static void processFileHeaderList(ZipArchive *zipArchive, CentralDirectory *centralDir) {
+static void processFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList, DirCache *dirCache) {
 	LocalFileHeader *localFileHeader;
+	ZipOutputFile outputFile;
 	FileBuffer *fileBuffer;
 	FileHeader *fileHeader;
 	Inflate inflateData;
 	uint32_t dataLength;
 	AIOFile *inputFile;
 	time_t timestamp;
-	uint32_t crc32;
+	int64_t *rangeEndList;
+	int64_t prefetchLength;
+	uint8_t localHeaderBuf[ZIP_FILE_LOCAL_HEADER_SIZE];
+	bool isInflateInit;
 	void *bufPtr;
 	int fd;
 
 	inputFile = &zipArchive->aioFile;
+	outputFile.isOpen = false;
+	isInflateInit = false;
 
-	for (uint32_t i=0; i < centralDir->fileHeaderList.length; i++) {
-		fileHeader = b196167f_get(&centralDir->fileHeaderList, i);
+	// Merge the byte ranges of the entries before reading any of them
+	rangeEndList = createRangeEndList(zipArchive, fileHeaderList);
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
 
-		if (fileHeader->compressMethod == ZIP_METHOD_STORED && fileHeader->compressSize == 0) {
+		if (isDirectory(fileHeader)) {
 
-			// Create directory
-			d0059b5b_makeDirectory(fileHeader->fileName, DIR_DEFAULT_MODE, false);
+			// Create directory, unless makeDirectories() already did
+			if (dirCache != NULL) {
+				d0059b5b_makeCachedDirectory(dirCache, fileHeader->fileName, DIR_DEFAULT_MODE, false);
+			}
 
 		} else {
 			dataLength = ZIP_FILE_LOCAL_HEADER_SIZE + fileHeader->fileNameLen + fileHeader->extraFieldLen;
-			fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset, dataLength);
+			fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset,
+			                                   dataLength + getWindowLength(fileHeader->compressSize));
 
 			if (fileBuffer == NULL) {
-				// Release all currently held FileBuffers
-				ce97d170_resetFileBufferList(&zipArchive->bufferList, f502a409_releasePage);
+				// Read the merged range of the entry in one batch of AIO requests, up to one window at a time
+				prefetchLength = rangeEndList[i] - fileHeader->localHeaderOffset;
+
+				if (prefetchLength > ZIP_ENTRY_WINDOW_SIZE) {
+					prefetchLength = ZIP_ENTRY_WINDOW_SIZE;
+				}
+
+				if (prefetchLength < dataLength + getWindowLength(fileHeader->compressSize)) {
+					prefetchLength = dataLength + getWindowLength(fileHeader->compressSize);
+				}
 
-				// Calculate the Direct I/O file offset and length of data to read
-				inputFile->offset = (fileHeader->localHeaderOffset >> 9) << 9;
-				dataLength += (fileHeader->localHeaderOffset - inputFile->offset);
+				fileBuffer = ce97d170_prefetchFileBufferList(inputFile, &zipArchive->bufferList, fileHeader->localHeaderOffset,
+				                                             prefetchLength);
 
-				// Read the data
-				ce97d170_readFileBufferList(inputFile, &zipArchive->bufferList, dataLength);
-				fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset, dataLength);
+				if (fileBuffer == NULL) {
+					continue;
+				}
 			}
 
-			bufPtr = fileBuffer->buffer + fileBuffer->dataOffset;
+			// The fixed local header fields may span two FileBuffers
+			ce97d170_copyData(fileBuffer, localHeaderBuf, ZIP_FILE_LOCAL_HEADER_SIZE);
+			bufPtr = localHeaderBuf;
 
 			if ( (*(uint32_t*)bufPtr) == ZIP_FILE_LOCAL_HEADER_SIG) {
 				localFileHeader = ce667b0d_createLocalFileHeader();
@@ -723,46 +1513,38 @@ static void processFileHeaderList(ZipArchive *zipArchive, CentralDirectory *cent
 				localFileHeader->fileNameLen = (*(uint16_t*)bufPtr);
 				bufPtr += 2;
 				localFileHeader->extraFieldLen = (*(uint16_t*)bufPtr);
-				bufPtr += 2;
+
+				// The local extra field length can differ from the Central Directory
+				dataLength = ZIP_FILE_LOCAL_HEADER_SIZE + localFileHeader->fileNameLen + localFileHeader->extraFieldLen;
+				fileBuffer = ce97d170_slideFileBufferList(inputFile, &zipArchive->bufferList, fileHeader->localHeaderOffset,
+				                                          dataLength + getWindowLength(fileHeader->compressSize));
 
 				if (localFileHeader->fileNameLen > 0) {
 					localFileHeader->fileName = f668c4bd_stralloc(localFileHeader->fileNameLen);
-					f668c4bd_memcopy(bufPtr, localFileHeader->fileName, localFileHeader->fileNameLen);
+					fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset + ZIP_FILE_LOCAL_HEADER_SIZE, localFileHeader->fileNameLen);
+					ce97d170_copyData(fileBuffer, localFileHeader->fileName, localFileHeader->fileNameLen);
 					localFileHeader->fileName[localFileHeader->fileNameLen] = '\0';
-					bufPtr += localFileHeader->fileNameLen;
 				}
 
 				if (localFileHeader->extraFieldLen > 0) {
 					localFileHeader->extraField = f668c4bd_stralloc(localFileHeader->extraFieldLen);
-					f668c4bd_memcopy(bufPtr, localFileHeader->extraField, localFileHeader->extraFieldLen);
+					fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset + dataLength - localFileHeader->extraFieldLen, localFileHeader->extraFieldLen);
+					ce97d170_copyData(fileBuffer, localFileHeader->extraField, localFileHeader->extraFieldLen);
 					localFileHeader->extraField[localFileHeader->extraFieldLen] = '\0';
-					bufPtr += localFileHeader->extraFieldLen;
 				}
 
-				// Create any subdirectories to the file
-				d0059b5b_makeDirectory(fileHeader->fileName, DIR_DEFAULT_MODE, true);
+				// Create any subdirectories to the file, unless makeDirectories() already did
+				if (dirCache != NULL) {
+					d0059b5b_makeCachedDirectory(dirCache, fileHeader->fileName, DIR_DEFAULT_MODE, true);
+				}
 
 				if (fileHeader->compressMethod == ZIP_METHOD_STORED) {
-					fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset + dataLength, fileHeader->compressSize);
-
-					// Check CRC-32 of the FileBuffer
-					crc32 = ce97d170_crc32(fileBuffer, fileHeader->uncompressSize);
-
-					if (crc32 == fileHeader->crc32) {
-						// Create the file
-						fd = e2f74138_createFile(fileHeader->fileName, FOPEN_WRITEONLY, 0, FILE_DEFAULT_MODE);
-
-						// Write out FileBuffer
-						ce97d170_write(fileBuffer, fd, fileHeader->uncompressSize, fileHeader->fileName);
-
-						// Modify the file timestamp
-						timestamp = a66923ff_convertTimeFromDOS(fileHeader->lastModFileDate, fileHeader->lastModFileTime);
-						e2f74138_setTimestamp(fd, fileHeader->fileName, timestamp, timestamp);
+					// Copy the stored data through page-aligned slabs for O_DIRECT
+					if (openOutputFile(zipArchive, &outputFile, fileHeader)) {
+						copyStoredData(zipArchive, fileHeader->localHeaderOffset + dataLength, fileHeader->uncompressSize, &outputFile);
 
-						// Close the file descriptor
-						e2f74138_closeFile(fd, fileHeader->fileName);
-					} else {
-						// TODO: CRC-32 does not match the one in the archive
+						closeOutputFile(&outputFile);
+						checkOutputFile(&outputFile, fileHeader);
 					}
 
 				} else if (fileHeader->compressMethod == ZIP_METHOD_DEFLATE) {
@@ -776,54 +1558,1370 @@ static void processFileHeaderList(ZipArchive *zipArchive, CentralDirectory *cent
 
 						// Close the file descriptor
 						e2f74138_closeFile(fd, fileHeader->fileName);
-					} else {
+					} else if (openOutputFile(zipArchive, &outputFile, fileHeader)) {
 						// printLocalFileHeader(localFileHeader, fileHeader, i);
-						fileBuffer = ce97d170_containsData(&zipArchive->bufferList, fileHeader->localHeaderOffset + dataLength, fileHeader->compressSize);
 
-						d592eb82_initInflate(&inflateData, fileBuffer, fileHeader->compressSize);
-						d592eb82_inflate(&inflateData);
+						// The output window and decoders are allocated once per list of entries; each chunk
+						// is written while the next one is inflated
+						inflateEntryData(zipArchive, &inflateData, &isInflateInit, fileHeader, fileHeader->localHeaderOffset + dataLength,
+						                 writeOutputChunk, &outputFile);
 
-						// Check CRC-32 of the OutputBuffer
-						crc32 = c49f5b0d_crc32(&inflateData.outputBuffer, fileHeader->uncompressSize);
+						// Inflate updates the CRC-32 as each chunk is handed out
+						outputFile.crc32 = inflateData.crc32;
 
-						if (crc32 == fileHeader->crc32) {
-							// Create the file
-							fd = e2f74138_createFile(fileHeader->fileName, FOPEN_WRITEONLY, 0, FILE_DEFAULT_MODE);
+						closeOutputFile(&outputFile);
+						checkOutputFile(&outputFile, fileHeader);
+					}
+				}
 
-							// Write out OutputBuffer
-							c49f5b0d_write(&inflateData.outputBuffer, fd, fileHeader->fileName);
+				ce667b0d_destroyLocalFileHeader(localFileHeader);
+			}
+		}
+	}
 
-							// Modify the file timestamp
-							timestamp = a66923ff_convertTimeFromDOS(fileHeader->lastModFileDate, fileHeader->lastModFileTime);
-							e2f74138_setTimestamp(fd, fileHeader->fileName, timestamp, timestamp);
+	// Free the Inflate output window and decoders
+	if (isInflateInit) {
+		d592eb82_cleanUpInflate(&inflateData);
+	}
 
-							// Close the file descriptor
-							e2f74138_closeFile(fd, fileHeader->fileName);
-						} else {
-							printf("CRC-32 does not match!");
-						}
+	f668c4bd_free(rangeEndList);
+}
 
-						d592eb82_cleanUpInflate(&inflateData);
-					}
-				}
+static uint32_t testFileHeaderList(ZipArchive *zipArchive, ListArray *fileHeaderList) {
+	FileHeader *fileHeader;
+	Inflate inflateData;
+	int64_t startTime, elapsedTime;
+	uint32_t numFailures;
+	bool isInflateInit, isValid;
 
-				ce667b0d_destroyLocalFileHeader(localFileHeader);
+	isInflateInit = false;
+	numFailures = 0;
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		if (isDirectory(fileHeader)) {
+			continue;
+		}
+
+		// Without a sink nothing is written; readEntryData() verifies the CRC-32 of the inflated data
+		startTime = getMonotonicTime();
+		isValid = readEntryData(zipArchive, &inflateData, &isInflateInit, fileHeader, NULL, NULL);
+		elapsedTime = getMonotonicTime() - startTime;
+
+		if (isValid) {
+			printf("    testing: %-48s OK  %9.1f MB/s\n", fileHeader->fileName, getThroughput(fileHeader->uncompressSize, elapsedTime));
+		} else {
+			printf("    testing: %-48s FAILED\n", fileHeader->fileName);
+			numFailures++;
+		}
+	}
+
+	// Free the Inflate output window and decoders
+	if (isInflateInit) {
+		d592eb82_cleanUpInflate(&inflateData);
+	}
+
+	return numFailures;
+}
+
+static uint32_t runZipWorkers(ZipArchive *zipArchive, ListArray *fileHeaderList, uint32_t numThreads, bool isTest) {
+	ZipWorker *workerList;
+	uint32_t numFailures;
+
+	// 1. Partition the entries and start a worker thread for each partition
+	workerList = f668c4bd_malloc(sizeof(ZipWorker) * numThreads);
+	partitionFileHeaderList(fileHeaderList, workerList, numThreads);
+	numFailures = 0;
+
+	for (uint32_t i=0; i < numThreads; i++) {
+		workerList[i].parentArchive = zipArchive;
+		workerList[i].numFailures = 0;
+		workerList[i].isTest = isTest;
+		workerList[i].isThreaded = (pthread_create(&workerList[i].thread, NULL, runZipWorker, &workerList[i]) == 0);
+	}
+
+	// 2. Wait for the workers to finish
+	for (uint32_t i=0; i < numThreads; i++) {
+		if (workerList[i].isThreaded) {
+			pthread_join(workerList[i].thread, NULL);
+		} else if (isTest) {
+			// Fall back to testing the partition on this thread
+			workerList[i].numFailures = testFileHeaderList(zipArchive, &workerList[i].fileHeaderList);
+		} else {
+			// Fall back to extracting the partition on this thread
+			processFileHeaderList(zipArchive, &workerList[i].fileHeaderList, NULL);
+		}
+
+		numFailures += workerList[i].numFailures;
+		b196167f_cleanUpListArray(&workerList[i].fileHeaderList, NULL);
+	}
+
+	f668c4bd_free(workerList);
+
+	return numFailures;
+}
+
+static void makeDirectories(ListArray *fileHeaderList, DirCache *dirCache) {
+	FileHeader *fileHeader;
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		if (fileHeader->fileNameLen > 0) {
+			d0059b5b_makeCachedDirectory(dirCache, fileHeader->fileName, DIR_DEFAULT_MODE, !isDirectory(fileHeader));
+		}
+	}
+}
+
+static void partitionFileHeaderList(ListArray *fileHeaderList, ZipWorker *workerList, uint32_t numThreads) {
+	ListArray sortedList;
+	FileHeader *fileHeader;
+	ZipWorker *zipWorker;
+
+	// 1. Sort the file entries from the largest compressed size to the smallest
+	b196167f_initListArrayWithSize(&sortedList, fileHeaderList->length);
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		if (!isDirectory(fileHeader)) {
+			b196167f_add(&sortedList, fileHeader);
+		}
+	}
+
+	b196167f_sort(&sortedList, compareCompressSize);
+
+	// 2. Assign each entry to the least loaded worker (longest processing time first)
+	for (uint32_t i=0; i < numThreads; i++) {
+		b196167f_initListArray(&workerList[i].fileHeaderList);
+		workerList[i].compressSize = 0;
+	}
+
+	for (uint32_t i=0; i < sortedList.length; i++) {
+		fileHeader = b196167f_get(&sortedList, i);
+		zipWorker = &workerList[0];
+
+		for (uint32_t j=1; j < numThreads; j++) {
+			if (workerList[j].compressSize < zipWorker->compressSize) {
+				zipWorker = &workerList[j];
 			}
 		}
+
+		b196167f_add(&zipWorker->fileHeaderList, fileHeader);
+		zipWorker->compressSize += fileHeader->compressSize;
+	}
+
+	// 3. Each worker reads its entries in archive order to keep its window sliding forward
+	for (uint32_t i=0; i < numThreads; i++) {
+		b196167f_sort(&workerList[i].fileHeaderList, compareLocalHeaderOffset);
 	}
+
+	b196167f_cleanUpListArray(&sortedList, NULL);
 }
 
-static void printEndOfCDR(EndOfCDR *endOfCDR) {
-	printf("EndOfCDR Data:\n");
-	printf("\tsignature:          %#x\n", endOfCDR->signature);
-	printf("\tdiskNum:            %u\n", endOfCDR->diskNum);
-	printf("\tstartDiskNum:       %u\n", endOfCDR->startDiskNum);
-	printf("\ttotalEntriesOnDisk: %u\n", endOfCDR->totalEntriesOnDisk);
-	printf("\ttotalEntries:       %u\n", endOfCDR->totalEntries);
-	printf("\tsize:               %u\n", endOfCDR->size);
-	printf("\tstartOffset:        %u\n", endOfCDR->startOffset);
-	printf("\tcommentLength:      %u\n", endOfCDR->commentLength);
-	printf("\n");
+static void *runZipWorker(void *zipWorkerPtr) {
+	ZipWorker *zipWorker;
+	ZipArchive *parentArchive;
+
+	zipWorker = (ZipWorker *) zipWorkerPtr;
+	parentArchive = zipWorker->parentArchive;
+
+	// 1. Open the Zip archive with a reader of our own
+	f1207515_initAIOContext(&zipWorker->aioContext, ZIP_READ_MAX_OPERATIONS);
+	ce667b0d_initZipArchive(&zipWorker->zipArchive, &zipWorker->aioContext, parentArchive->aioFile.fileName);
+	ce97d170_setPreferredIOSize(&zipWorker->zipArchive.bufferList, parentArchive->bufferList.ioSize);
+	zipWorker->zipArchive.outputDir = parentArchive->outputDir;
+
+	// 2. Extract or test the assigned entries
+	if (zipWorker->isTest) {
+		zipWorker->numFailures = testFileHeaderList(&zipWorker->zipArchive, &zipWorker->fileHeaderList);
+	} else {
+		processFileHeaderList(&zipWorker->zipArchive, &zipWorker->fileHeaderList, NULL);
+	}
+
+	// 3. Clean up the reader and the thread-local pools
+	ce667b0d_cleanUpZipArchive(&zipWorker->zipArchive);
+	f1207515_cleanUpAIOContext(&zipWorker->aioContext);
+
+	ce97d170_destroyThreadPools(false);
+
+	return NULL;
+}
+
+static int compareCompressSize(void *first, void *second) {
+	uint64_t firstSize = ((FileHeader *)first)->compressSize;
+	uint64_t secondSize = ((FileHeader *)second)->compressSize;
+
+	return (firstSize < secondSize) - (firstSize > secondSize);
+}
+
+static int compareLocalHeaderOffset(void *first, void *second) {
+	uint64_t firstOffset = ((FileHeader *)first)->localHeaderOffset;
+	uint64_t secondOffset = ((FileHeader *)second)->localHeaderOffset;
+
+	return (firstOffset > secondOffset) - (firstOffset < secondOffset);
+}
+
+static bool isDirectory(FileHeader *fileHeader) {
+	return fileHeader->fileNameLen > 0 && fileHeader->fileName[f6215943_getLength(fileHeader->fileName) - 1] == '/';
+}
+
+static char *getEntryName(FileHeader *fileHeader) {
+	// Skip the output directory prepended by loadCentralDirectory()
+	return fileHeader->fileName + f6215943_getLength(fileHeader->fileName) - fileHeader->fileNameLen;
+}
+
+static int64_t getEntryEnd(FileHeader *fileHeader) {
+	int64_t entryEnd;
+
+	// The local extra field may differ from the Central Directory one; a short estimate only
+	// costs one extra read when the window slides over the entry
+	entryEnd = fileHeader->localHeaderOffset + ZIP_FILE_LOCAL_HEADER_SIZE + fileHeader->fileNameLen
+	         + fileHeader->extraFieldLen + fileHeader->compressSize;
+
+	if (fileHeader->bitFlags & ZIP_DATA_DESCRIPTOR_FLAG) {
+		entryEnd += (fileHeader->needToExtractVersion >= ZIP64_VERSION_NEEDED) ? ZIP64_DATA_DESCRIPTOR_SIZE
+		                                                                        : ZIP_DATA_DESCRIPTOR_SIZE;
+	}
+
+	return entryEnd;
+}
+
+static bool matchGlob(char *entryName, void *pattern) {
+	return fnmatch((char *) pattern, entryName, 0) == 0;
+}
+
+static int64_t getMonotonicTime() {
+	struct timespec timeSpec;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeSpec);
+
+	return (((int64_t) timeSpec.tv_sec) * 1000000000) + timeSpec.tv_nsec;
+}
+
+static double getThroughput(uint64_t numBytes, int64_t elapsedTime) {
+	// Entries read from the page cache can finish within the clock resolution
+	return (elapsedTime > 0) ? (numBytes / ZIP_BYTES_PER_MB) / (elapsedTime / 1e9) : 0.0;
+}
+
+static uint32_t getCompressRatio(uint64_t uncompressSize, uint64_t compressSize) {
+	// Incompressible data grows slightly when deflated; report those entries as zero
+	return (uncompressSize > compressSize) ? ((uncompressSize - compressSize) * 100) / uncompressSize : 0;
+}
+
+static bool loadZipReader(ZipReader *zipReader) {
+	ZipFormat zipFormat;
+	ListArray *fileHeaderList;
+	FileHeader *fileHeader;
+
+	// 1. Find the End of Central Directory Record
+	initZipFormat(&zipFormat, &zipReader->zipArchive);
+
+	if (!findEndOfCDR(&zipFormat)) {
+		cleanUpZipFormat(&zipFormat);
+		return false;
+	}
+
+	// 2. Load the Central Directory and keep its FileHeader list
+	loadCentralDirectory(&zipFormat);
+
+	fileHeaderList = &zipReader->fileHeaderList;
+	*fileHeaderList = zipFormat.centralDirectory.fileHeaderList;
+	b196167f_initListArray(&zipFormat.centralDirectory.fileHeaderList);
+	cleanUpZipFormat(&zipFormat);
+
+	// 3. Index the entries by name; a later duplicate replaces an earlier one
+	c47905f7_initHashMap(&zipReader->fileHeaderMap, f6215943_hashCode, f6215943_isEqual, fileHeaderList->length + 1);
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		if (fileHeader->fileNameLen > 0) {
+			c47905f7_put(&zipReader->fileHeaderMap, fileHeader->fileName, fileHeader);
+		}
+	}
+
+	zipReader->indexData = NULL;
+	zipReader->indexHeaderList = NULL;
+	zipReader->isInflateInit = false;
+
+	return true;
+}
+
+static bool findEntryData(ZipArchive *zipArchive, FileHeader *fileHeader, int64_t *dataOffset) {
+	FileBuffer *fileBuffer;
+	uint8_t localHeaderBuf[ZIP_FILE_LOCAL_HEADER_SIZE];
+	uint16_t fileNameLen, extraFieldLen;
+
+	// 1. Slide the FileBufferList window over the fixed local header fields
+	fileBuffer = ce97d170_slideFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, fileHeader->localHeaderOffset,
+	                                          ZIP_FILE_LOCAL_HEADER_SIZE);
+
+	if (fileBuffer == NULL) {
+		return false;
+	}
+
+	ce97d170_copyData(fileBuffer, localHeaderBuf, ZIP_FILE_LOCAL_HEADER_SIZE);
+
+	if ( (*(uint32_t*)localHeaderBuf) != ZIP_FILE_LOCAL_HEADER_SIG) {
+		return false;
+	}
+
+	// 2. The local extra field length can differ from the Central Directory
+	fileNameLen = (*(uint16_t*)(localHeaderBuf + 26));
+	extraFieldLen = (*(uint16_t*)(localHeaderBuf + 28));
+	*dataOffset = fileHeader->localHeaderOffset + ZIP_FILE_LOCAL_HEADER_SIZE + fileNameLen + extraFieldLen;
+
+	// 3. Slide the FileBufferList window forward over the file data, or its first window of a large entry
+	return ce97d170_slideFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, *dataOffset,
+	                                    getWindowLength(fileHeader->compressSize)) != NULL;
+}
+
+static uint32_t getWindowLength(uint64_t length) {
+	return (length > ZIP_ENTRY_WINDOW_SIZE) ? ZIP_ENTRY_WINDOW_SIZE : length;
+}
+
+static bool inflateEntryData(ZipArchive *zipArchive, Inflate *inflate, bool *isInflateInit, FileHeader *fileHeader,
+                             int64_t dataOffset, InflateSinkFunc sink, void *sinkData) {
+	FileBuffer *fileBuffer;
+	int64_t offset;
+	uint64_t length;
+	uint32_t bufferLength;
+	bool isInflated;
+
+	// 1. Entries that fit in the window are inflated straight from the FileBuffer pages
+	if (fileHeader->compressSize <= ZIP_ENTRY_WINDOW_SIZE) {
+		fileBuffer = ce97d170_containsData(&zipArchive->bufferList, dataOffset, fileHeader->compressSize);
+
+		if (fileBuffer == NULL) {
+			return false;
+		}
+
+		// The output window and decoders are allocated once and reset for each entry
+		if (*isInflateInit) {
+			d592eb82_resetInflate(inflate, fileBuffer, fileHeader->compressSize);
+		} else {
+			d592eb82_initInflate(inflate, fileBuffer, fileHeader->compressSize);
+			*isInflateInit = true;
+		}
+
+		d592eb82_setSink(inflate, sink, sinkData);
+		isInflated = d592eb82_inflate(inflate);
+
+		// Without a sink each full output chunk is dropped and inflation resumes
+		while (!isInflated && inflate->status == INFLATE_OUTPUT_FULL) {
+			isInflated = d592eb82_inflate(inflate);
+		}
+
+		return isInflated;
+	}
+
+	// 2. Larger entries are fed to Inflate one FileBuffer at a time as the window slides forward
+	if (*isInflateInit) {
+		d592eb82_resetInflate(inflate, NULL, 0);
+	} else {
+		d592eb82_initInflate(inflate, NULL, 0);
+		*isInflateInit = true;
+	}
+
+	d592eb82_setSink(inflate, sink, sinkData);
+
+	for (offset = dataOffset, length = fileHeader->compressSize; length > 0; ) {
+		fileBuffer = ce97d170_slideFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, offset, getWindowLength(length));
+
+		if (fileBuffer == NULL) {
+			return false;
+		}
+
+		bufferLength = fileBuffer->numBytes - fileBuffer->dataOffset;
+		bufferLength = (bufferLength > length) ? length : bufferLength;
+
+		isInflated = d592eb82_inflateFeed(inflate, fileBuffer->buffer + fileBuffer->dataOffset, bufferLength);
+
+		while (!isInflated && inflate->status == INFLATE_OUTPUT_FULL) {
+			isInflated = d592eb82_inflateFeed(inflate, NULL, 0);
+		}
+
+		if (isInflated) {
+			return true;
+		}
+
+		if (inflate->status != INFLATE_NEED_INPUT) {
+			return false;
+		}
+
+		offset += bufferLength;
+		length -= bufferLength;
+	}
+
+	return false;
+}
+
+static bool readEntryData(ZipArchive *zipArchive, Inflate *inflate, bool *isInflateInit, FileHeader *fileHeader,
+                          InflateSinkFunc sink, void *sinkData) {
+	FileBuffer *fileBuffer;
+	int64_t offset;
+	uint64_t length;
+	uint32_t bufferLength, crc32;
+	void *bufferPtr;
+	bool isSuccess;
+
+	crc32 = 0;
+
+	// 1. Directories and empty files have no data to read
+	if (fileHeader->uncompressSize == 0) {
+		return (fileHeader->crc32 == 0);
+	}
+
+	if (!findEntryData(zipArchive, fileHeader, &offset)) {
+		return false;
+	}
+
+	// 2. Pass the data to the sink straight from the FileBuffer pages or through Inflate
+	if (fileHeader->compressMethod == ZIP_METHOD_STORED) {
+		isSuccess = true;
+
+		for (length = fileHeader->uncompressSize; length > 0 && isSuccess; ) {
+			fileBuffer = ce97d170_slideFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, offset, getWindowLength(length));
+
+			if (fileBuffer == NULL) {
+				return false;
+			}
+
+			bufferPtr = fileBuffer->buffer + fileBuffer->dataOffset;
+			bufferLength = fileBuffer->numBytes - fileBuffer->dataOffset;
+			bufferLength = (bufferLength > length) ? length : bufferLength;
+
+			crc32 = b7e0468d_crc32(bufferPtr, bufferLength, crc32);
+			isSuccess = (sink == NULL || sink(sinkData, bufferPtr, bufferLength));
+			offset += bufferLength;
+			length -= bufferLength;
+		}
+	} else if (fileHeader->compressMethod == ZIP_METHOD_DEFLATE) {
+		isSuccess = inflateEntryData(zipArchive, inflate, isInflateInit, fileHeader, offset, sink, sinkData);
+		crc32 = inflate->crc32;
+	} else {
+		return false;
+	}
+
+	// 3. Verify the CRC-32 of the entry data
+	if (isSuccess && crc32 != fileHeader->crc32) {
+		printCrc32Error(fileHeader);
+		return false;
+	}
+
+	return isSuccess;
+}
+
+static bool copyEntryChunk(void *entryBufferPtr, void *buffer, uint32_t length) {
+	ZipEntryBuffer *entryBuffer = entryBufferPtr;
+
+	if (length > entryBuffer->length - entryBuffer->offset) {
+		return false;
+	}
+
+	f668c4bd_memcopy(buffer, entryBuffer->buffer + entryBuffer->offset, length);
+	entryBuffer->offset += length;
+
+	return true;
+}
+
+static bool copyStoredData(ZipArchive *zipArchive, int64_t offset, uint64_t length, ZipOutputFile *outputFile) {
+	FileBuffer *fileBuffer;
+	void *slabList[2];
+	uint32_t numBytes;
+	bool isSuccess;
+
+	// 1. Alternate between two slabs so one is filled while the other is written
+	slabList[0] = b426145b_acquireSlab();
+	slabList[1] = b426145b_acquireSlab();
+	isSuccess = true;
+
+	for (uint32_t i=0; length > 0 && isSuccess; i ^= 1) {
+		numBytes = (SLABPOOL_SLAB_SIZE > length) ? length : SLABPOOL_SLAB_SIZE;
+
+		// Slide the window forward over large entries; update the CRC-32 while the data is copied
+		fileBuffer = ce97d170_slideFileBufferList(&zipArchive->aioFile, &zipArchive->bufferList, offset, getWindowLength(length));
+
+		if (fileBuffer == NULL) {
+			isSuccess = false;
+			break;
+		}
+
+		outputFile->crc32 = ce97d170_copyDataCrc32(fileBuffer, slabList[i], numBytes, outputFile->crc32);
+		isSuccess = writeOutputChunk(outputFile, slabList[i], numBytes);
+
+		offset += numBytes;
+		length -= numBytes;
+	}
+
+	// 2. The last write must complete before its slab is released
+	waitOutputFile(outputFile);
+
+	b426145b_releaseSlab(slabList[0]);
+	b426145b_releaseSlab(slabList[1]);
+
+	return isSuccess;
+}
+
+static bool openOutputFile(ZipArchive *zipArchive, ZipOutputFile *outputFile, FileHeader *fileHeader) {
+	AIOFile *aioFile;
+
+	aioFile = &outputFile->aioFile;
+
+	// 1. Initialize the AIOFile struct with the write AIOContext
+	f1207515_initAIOFile(&zipArchive->writeContext, aioFile, fileHeader->fileName);
+	f1207515_initAIOTicket(&aioFile->aioTicket);
+
+	// 2. Create the file with O_DIRECT, falling back to the page cache if unsupported
+	if (f1207515_create(aioFile, FOPEN_WRITEONLY, O_TRUNC, FILE_DEFAULT_MODE) == SYSTEM_ERROR_CODE) {
+		aioFile->fd = e2f74138_createFile(fileHeader->fileName, FOPEN_WRITEONLY, O_TRUNC, FILE_DEFAULT_MODE);
+
+		if (aioFile->fd == SYSTEM_ERROR_CODE) {
+			return false;
+		}
+	}
+
+	// 3. Preallocate the file blocks since the file size is known up front
+	if (fileHeader->uncompressSize > 0) {
+		f1207515_allocate(aioFile, fileHeader->uncompressSize);
+	}
+
+	// 4. Initialize the remaining ZipOutputFile fields
+	outputFile->timestamp = a66923ff_convertTimeFromDOS(fileHeader->lastModFileDate, fileHeader->lastModFileTime);
+	outputFile->crc32 = 0;
+	outputFile->isOpen = true;
+
+	return true;
+}
+
+static void closeOutputFile(ZipOutputFile *outputFile) {
+	AIOFile *aioFile;
+
+	aioFile = &outputFile->aioFile;
+
+	// 1. Wait for the write of the last chunk
+	waitOutputFile(outputFile);
+
+	// 2. Modify the file timestamp
+	e2f74138_setTimestamp(aioFile->fd, aioFile->fileName, outputFile->timestamp, outputFile->timestamp);
+
+	// 3. Close the file descriptor
+	f1207515_cleanUpAIOFile(aioFile);
+
+	outputFile->isOpen = false;
+}
+
+static void checkOutputFile(ZipOutputFile *outputFile, FileHeader *fileHeader) {
+	// Remove the extracted file if its CRC-32 does not match the one in the archive
+	if (outputFile->crc32 != fileHeader->crc32) {
+		printCrc32Error(fileHeader);
+		unlink(fileHeader->fileName);
+	}
+}
+
+static void printCrc32Error(FileHeader *fileHeader) {
+	StringBuilder errorMessage;
+	c598a24c_initStringBuilder(&errorMessage);
+
+	c598a24c_append_string(&errorMessage, "CRC-32 does not match for '");
+	c598a24c_append_string(&errorMessage, fileHeader->fileName);
+	c598a24c_append_char(&errorMessage, '\'');
+
+	c7c88e52_printError_string(errorMessage.buffer);
+	c598a24c_cleanUpStringBuilder(&errorMessage);
+}
+
+static bool mapZipIndex(ZipReader *zipReader, char *indexName, FileStatus *archiveStatus) {
+	ZipIndexHeader *indexHeader;
+	FileStatus indexStatus;
+	void *indexData;
+	int fd;
+
+	// 1. Open the sidecar index, if there is one
+	fd = open(indexName, O_RDONLY | O_CLOEXEC);
+
+	if (fd == SYSTEM_ERROR_CODE) {
+		return false;
+	}
+
+	if (!e2f74138_getDescriptorStatus(fd, &indexStatus) || indexStatus.st_size < (int64_t) sizeof(ZipIndexHeader)) {
+		close(fd);
+		return false;
+	}
+
+	// 2. Memory map the index and check that it matches the Zip archive
+	indexData = mmap(NULL, indexStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (indexData == MAP_FAILED) {
+		return false;
+	}
+
+	indexHeader = indexData;
+
+	if (!isValidZipIndex(indexHeader, indexStatus.st_size, archiveStatus)) {
+		munmap(indexData, indexStatus.st_size);
+		return false;
+	}
+
+	// 3. Anonymous zero pages for the FileHeader views cost nothing until an entry is looked up
+	zipReader->indexHeaderList = NULL;
+
+	if (indexHeader->numEntries > 0) {
+		zipReader->indexHeaderList = mmap(NULL, indexHeader->numEntries * sizeof(FileHeader), PROT_READ | PROT_WRITE,
+		                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (zipReader->indexHeaderList == MAP_FAILED) {
+			munmap(indexData, indexStatus.st_size);
+			return false;
+		}
+	}
+
+	zipReader->indexData = indexData;
+
+	return true;
+}
+
+static bool isValidZipIndex(ZipIndexHeader *indexHeader, int64_t indexSize, FileStatus *archiveStatus) {
+	uint64_t slotOffset, nameOffset;
+
+	slotOffset = sizeof(ZipIndexHeader) + ((uint64_t) indexHeader->numEntries * sizeof(ZipIndexEntry));
+	nameOffset = slotOffset + ((uint64_t) indexHeader->numSlots * sizeof(uint32_t));
+
+	return indexHeader->magic == ZIP_INDEX_MAGIC
+	       && indexHeader->version == ZIP_INDEX_VERSION
+	       && indexHeader->archiveSize == archiveStatus->st_size
+	       && indexHeader->archiveModTime == archiveStatus->st_mtim.tv_sec
+	       && indexHeader->archiveModTimeNsec == archiveStatus->st_mtim.tv_nsec
+	       && indexHeader->indexSize == indexSize
+	       && indexHeader->numSlots > indexHeader->numEntries
+	       && (indexHeader->numSlots & (indexHeader->numSlots - 1)) == 0
+	       && indexHeader->entryOffset == sizeof(ZipIndexHeader)
+	       && indexHeader->slotOffset == slotOffset
+	       && indexHeader->nameOffset == nameOffset
+	       && nameOffset <= (uint64_t) indexSize;
+}
+
+static FileHeader *findIndexEntry(ZipReader *zipReader, char *entryName) {
+	ZipIndexHeader *indexHeader;
+	ZipIndexEntry *entryList;
+	ZipIndexEntry *indexEntry;
+	FileHeader *fileHeader;
+	uint32_t *slotList;
+	char *nameTable;
+	uint64_t nameTableSize;
+	uint32_t nameLength, nameHashCode, mask, slot, entryNum;
+
+	indexHeader = zipReader->indexData;
+	entryList = zipReader->indexData + indexHeader->entryOffset;
+	slotList = zipReader->indexData + indexHeader->slotOffset;
+	nameTable = zipReader->indexData + indexHeader->nameOffset;
+	nameTableSize = indexHeader->indexSize - indexHeader->nameOffset;
+
+	// 1. Probe the hash table from the slot of the CRC-32 of the entry name
+	nameLength = f6215943_getLength(entryName);
+	nameHashCode = b7e0468d_crc32(entryName, nameLength, 0);
+	mask = indexHeader->numSlots - 1;
+	slot = nameHashCode & mask;
+
+	for (uint32_t i=0; i < indexHeader->numSlots && slotList[slot] != 0; i++) {
+		entryNum = slotList[slot] - 1;
+
+		if (entryNum >= indexHeader->numEntries) {
+			return NULL;
+		}
+
+		indexEntry = &entryList[entryNum];
+
+		if (indexEntry->nameHashCode == nameHashCode && indexEntry->fileNameLen == nameLength
+		      && (uint64_t) indexEntry->nameOffset + nameLength < nameTableSize
+		      && nameTable[indexEntry->nameOffset + nameLength] == '\0'
+		      && f6215943_isEqual(nameTable + indexEntry->nameOffset, entryName)) {
+
+			// 2. Fill in the FileHeader view of the entry on its first lookup
+			fileHeader = &zipReader->indexHeaderList[entryNum];
+
+			if (fileHeader->signature == 0) {
+				fileHeader->fileName = nameTable + indexEntry->nameOffset;
+				fileHeader->signature = ZIP_FILE_HEADER_SIG;
+				fileHeader->crc32 = indexEntry->crc32;
+				fileHeader->compressSize = indexEntry->compressSize;
+				fileHeader->uncompressSize = indexEntry->uncompressSize;
+				fileHeader->externalFileAttribs = indexEntry->externalFileAttribs;
+				fileHeader->localHeaderOffset = indexEntry->localHeaderOffset;
+				fileHeader->madeByVersion = indexEntry->madeByVersion;
+				fileHeader->needToExtractVersion = indexEntry->needToExtractVersion;
+				fileHeader->bitFlags = indexEntry->bitFlags;
+				fileHeader->compressMethod = indexEntry->compressMethod;
+				fileHeader->lastModFileTime = indexEntry->lastModFileTime;
+				fileHeader->lastModFileDate = indexEntry->lastModFileDate;
+				fileHeader->fileNameLen = indexEntry->fileNameLen;
+				fileHeader->internalFileAttribs = indexEntry->internalFileAttribs;
+			}
+
+			return fileHeader;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	return NULL;
+}
+
+static void writeZipIndex(ZipReader *zipReader, char *indexName, FileStatus *archiveStatus) {
+	ListArray *fileHeaderList;
+	FileHeader *fileHeader;
+	ZipIndexHeader *indexHeader;
+	ZipIndexEntry *entryList;
+	ZipIndexEntry *indexEntry;
+	ZipIndexEntry *slotEntry;
+	StringBuilder tempName;
+	uint32_t *slotList;
+	char *nameTable;
+	uint64_t indexSize, nameTableSize;
+	uint32_t numSlots, mask, slot, nameOffset;
+	ssize_t numBytes;
+	int fd;
+
+	fileHeaderList = &zipReader->fileHeaderList;
+
+	// 1. Size the index so the hash table is at most half full
+	nameTableSize = 0;
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+		nameTableSize += fileHeader->fileNameLen + 1;
+	}
+
+	for (numSlots = 2; numSlots < (fileHeaderList->length << 1); numSlots <<= 1);
+
+	indexSize = sizeof(ZipIndexHeader) + ((uint64_t) fileHeaderList->length * sizeof(ZipIndexEntry))
+	            + ((uint64_t) numSlots * sizeof(uint32_t)) + nameTableSize;
+
+	if (indexSize > UINT32_MAX) {
+		return;
+	}
+
+	// 2. Fill in the index header
+	indexHeader = f668c4bd_malloc(indexSize);
+	f668c4bd_meminit(indexHeader, indexSize);
+
+	indexHeader->magic = ZIP_INDEX_MAGIC;
+	indexHeader->version = ZIP_INDEX_VERSION;
+	indexHeader->archiveSize = archiveStatus->st_size;
+	indexHeader->archiveModTime = archiveStatus->st_mtim.tv_sec;
+	indexHeader->archiveModTimeNsec = archiveStatus->st_mtim.tv_nsec;
+	indexHeader->numEntries = fileHeaderList->length;
+	indexHeader->numSlots = numSlots;
+	indexHeader->entryOffset = sizeof(ZipIndexHeader);
+	indexHeader->slotOffset = indexHeader->entryOffset + (fileHeaderList->length * sizeof(ZipIndexEntry));
+	indexHeader->nameOffset = indexHeader->slotOffset + (numSlots * sizeof(uint32_t));
+	indexHeader->indexSize = indexSize;
+
+	entryList = ((void*) indexHeader) + indexHeader->entryOffset;
+	slotList = ((void*) indexHeader) + indexHeader->slotOffset;
+	nameTable = ((void*) indexHeader) + indexHeader->nameOffset;
+
+	// 3. Fill in the entry, hash and name tables; a later duplicate name replaces an earlier one
+	mask = numSlots - 1;
+	nameOffset = 0;
+
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+		indexEntry = &entryList[i];
+
+		indexEntry->compressSize = fileHeader->compressSize;
+		indexEntry->uncompressSize = fileHeader->uncompressSize;
+		indexEntry->localHeaderOffset = fileHeader->localHeaderOffset;
+		indexEntry->nameOffset = nameOffset;
+		indexEntry->crc32 = fileHeader->crc32;
+		indexEntry->externalFileAttribs = fileHeader->externalFileAttribs;
+		indexEntry->madeByVersion = fileHeader->madeByVersion;
+		indexEntry->needToExtractVersion = fileHeader->needToExtractVersion;
+		indexEntry->bitFlags = fileHeader->bitFlags;
+		indexEntry->compressMethod = fileHeader->compressMethod;
+		indexEntry->lastModFileTime = fileHeader->lastModFileTime;
+		indexEntry->lastModFileDate = fileHeader->lastModFileDate;
+		indexEntry->fileNameLen = fileHeader->fileNameLen;
+		indexEntry->internalFileAttribs = fileHeader->internalFileAttribs;
+
+		nameOffset += fileHeader->fileNameLen + 1;
+
+		if (fileHeader->fileNameLen == 0) {
+			continue;
+		}
+
+		f668c4bd_memcopy(fileHeader->fileName, nameTable + indexEntry->nameOffset, fileHeader->fileNameLen);
+		indexEntry->nameHashCode = b7e0468d_crc32(fileHeader->fileName, fileHeader->fileNameLen, 0);
+
+		for (slot = indexEntry->nameHashCode & mask; slotList[slot] != 0; slot = (slot + 1) & mask) {
+			slotEntry = &entryList[slotList[slot] - 1];
+
+			if (slotEntry->nameHashCode == indexEntry->nameHashCode
+			      && f6215943_isEqual(nameTable + slotEntry->nameOffset, nameTable + indexEntry->nameOffset)) {
+				break;
+			}
+		}
+
+		slotList[slot] = i + 1;
+	}
+
+	// 4. Write a temporary file and rename it over the index so a partial index is never mapped
+	c598a24c_initStringBuilder(&tempName);
+	c598a24c_append_string(&tempName, indexName);
+	c598a24c_append_string(&tempName, ".XXXXXX");
+
+	fd = mkstemp(tempName.buffer);
+
+	if (fd != SYSTEM_ERROR_CODE) {
+		fchmod(fd, FILE_DEFAULT_MODE);
+		numBytes = e2f74138_writeFile(fd, indexHeader, indexSize, tempName.buffer);
+		close(fd);
+
+		if (numBytes != (ssize_t) indexSize || rename(tempName.buffer, indexName) == SYSTEM_ERROR_CODE) {
+			unlink(tempName.buffer);
+		}
+	}
+
+	c598a24c_cleanUpStringBuilder(&tempName);
+	f668c4bd_free(indexHeader);
+}
+
+static bool writeOutputChunk(void *outputFilePtr, void *buffer, uint32_t length) {
+	ZipOutputFile *outputFile;
+	AIOFile *aioFile;
+	uint32_t alignedLength;
+
+	outputFile = outputFilePtr;
+	aioFile = &outputFile->aioFile;
+
+	// 1. The buffer of the previous chunk is reused next; wait for its write
+	waitOutputFile(outputFile);
+
+	// 2. Queue the O_DIRECT write of the aligned part of the chunk
+	alignedLength = length & ~ZIP_DIRECT_IO_MASK;
+
+	if (alignedLength > 0) {
+		f1207515_write(aioFile, buffer, alignedLength);
+		f1207515_initAIOTicket(&aioFile->aioTicket);
+
+		if (!f1207515_submit(aioFile)) {
+			c7c88e52_printLibError(aioFile->fileName, errno);
+			f1207515_releaseAIORequest(b8da7268_dequeue(aioFile->aioContext->requestQueue));
+			f1207515_initAIOTicket(&aioFile->aioTicket);
+			return false;
+		}
+	}
+
+	// 3. Only the last chunk can have an unaligned tail; write it through the page cache
+	if (alignedLength < length) {
+		waitOutputFile(outputFile);
+
+		if (f1207515_writeBuffered(aioFile, buffer + alignedLength, length - alignedLength) == SYSTEM_ERROR_CODE) {
+			c7c88e52_printLibError(aioFile->fileName, errno);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void waitOutputFile(ZipOutputFile *outputFile) {
+	AIOTicket *aioTicket;
+	AIOFile *aioFile;
+
+	aioFile = &outputFile->aioFile;
+	aioTicket = &aioFile->aioTicket;
+
+	// 1. Reap the completions of the outstanding AIOTicket
+	while (aioTicket->numEvents < aioTicket->numRequests) {
+		if (f1207515_getEvents(aioFile) == SYSTEM_ERROR_CODE) {
+			c7c88e52_printLibError(aioFile->fileName, errno);
+			return;
+		}
+	}
+
+	// 2. Report any failed writes
+	for (uint32_t i=0; i < aioTicket->numEvents; i++) {
+		if (aioTicket->eventList[i].res < 0) {
+			c7c88e52_printLibError(aioFile->fileName, -aioTicket->eventList[i].res);
+		}
+	}
+
+	f1207515_cleanUpAIOTicket(aioTicket);
+	f1207515_initAIOTicket(aioTicket);
+}
+
+static bool writeFileData(ZipWriter *zipWriter, FileHeader *fileHeader, char *pathName, int64_t fileSize) {
+	FileBufferList *bufferList;
+	FileBuffer *fileBuffer;
+	AIOFile inputFile;
+	Deflate *deflate;
+	int64_t offset;
+	uint32_t numBytes, bufferLength, dataOffset, remaining;
+	uint32_t crc32;
+	void *bufPtr;
+	bool isDeflate, isFinal;
+
+	bufferList = &zipWriter->bufferList;
+	deflate = &zipWriter->deflate;
+	isDeflate = (fileHeader->compressMethod == ZIP_METHOD_DEFLATE);
+	crc32 = 0;
+
+	// 1. Open the file with a reader on the read AIOContext
+	f1207515_initAIOFile(zipWriter->aioContext, &inputFile, pathName);
+
+	if (f1207515_open(&inputFile, FOPEN_READONLY, 0) == SYSTEM_ERROR_CODE) {
+		c7c88e52_printLibError(pathName, errno);
+		return false;
+	}
+
+	if (isDeflate) {
+		a8a82d35_resetDeflate(deflate, zipWriter->tailBuffer);
+	}
+
+	// 2. Slide the FileBufferList over the file and compress one I/O unit at a time
+	for (offset = 0; offset < fileSize; offset += numBytes) {
+		numBytes = (fileSize - offset > bufferList->ioSize) ? bufferList->ioSize : fileSize - offset;
+		fileBuffer = ce97d170_slideFileBufferList(&inputFile, bufferList, offset, numBytes);
+
+		if (fileBuffer == NULL) {
+			break;
+		}
+
+		// Only the first FileBuffer starts at its data offset
+		dataOffset = fileBuffer->dataOffset;
+		remaining = numBytes;
+
+		while (remaining > 0) {
+			bufPtr = fileBuffer->buffer + dataOffset;
+			bufferLength = fileBuffer->numBytes - dataOffset;
+			bufferLength = (bufferLength > remaining) ? remaining : bufferLength;
+			remaining -= bufferLength;
+			dataOffset = 0;
+
+			if (isDeflate) {
+				isFinal = (offset + numBytes == fileSize && remaining == 0);
+				a8a82d35_deflate(deflate, bufPtr, bufferLength, isFinal);
+			} else {
+				crc32 = b7e0468d_crc32(bufPtr, bufferLength, crc32);
+				appendData(zipWriter, bufPtr, bufferLength);
+			}
+
+			fileBuffer = fileBuffer->next;
+		}
+
+		// 3. Queue the full OutputBuffer slabs while the next unit is compressed
+		if (isDeflate) {
+			zipWriter->tailBuffer = deflate->outputBuffer;
+		}
+
+		flushZipWriter(zipWriter, false);
+	}
+
+	// 4. Close the file and drop its FileBuffers
+	ce97d170_resetFileBufferList(bufferList, ce97d170_getFreeBuffer(bufferList));
+	f1207515_cleanUpAIOFile(&inputFile);
+
+	if (offset < fileSize) {
+		c7c88e52_printError_string("Cannot read the file data of an archive entry");
+		return false;
+	}
+
+	// 5. Record the checksum and sizes for the data descriptor
+	if (isDeflate) {
+		fileHeader->crc32 = deflate->crc32;
+		fileHeader->compressSize = deflate->totalOut;
+		zipWriter->offset += deflate->totalOut;
+	} else {
+		fileHeader->crc32 = crc32;
+		fileHeader->compressSize = fileSize;
+	}
+
+	fileHeader->uncompressSize = fileSize;
+
+	return true;
+}
+
+static void writeLocalFileHeader(ZipWriter *zipWriter, FileHeader *fileHeader) {
+	uint8_t headerBuf[ZIP_FILE_LOCAL_HEADER_SIZE + 20];
+	void *bufPtr;
+	bool isZip64;
+
+	// The CRC-32 and sizes follow in the data descriptor when the flag is set
+	isZip64 = (fileHeader->needToExtractVersion >= ZIP64_VERSION_NEEDED);
+	bufPtr = headerBuf;
+
+	(*(uint32_t*)bufPtr) = ZIP_FILE_LOCAL_HEADER_SIG;
+	bufPtr += 4;
+	(*(uint16_t*)bufPtr) = fileHeader->needToExtractVersion;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = fileHeader->bitFlags;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = fileHeader->compressMethod;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = fileHeader->lastModFileTime;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = fileHeader->lastModFileDate;
+	bufPtr += 2;
+	(*(uint32_t*)bufPtr) = fileHeader->crc32;
+	bufPtr += 4;
+	(*(uint32_t*)bufPtr) = isZip64 ? ZIP64_MARKER_32 : fileHeader->compressSize;
+	bufPtr += 4;
+	(*(uint32_t*)bufPtr) = isZip64 ? ZIP64_MARKER_32 : fileHeader->uncompressSize;
+	bufPtr += 4;
+	(*(uint16_t*)bufPtr) = fileHeader->fileNameLen;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = isZip64 ? 20 : 0;
+
+	appendData(zipWriter, headerBuf, ZIP_FILE_LOCAL_HEADER_SIZE);
+	appendData(zipWriter, fileHeader->fileName, fileHeader->fileNameLen);
+
+	// A Zip64 entry carries both sizes in its local Zip64 extra field; they are zero like the 32-bit ones
+	if (isZip64) {
+		bufPtr = headerBuf;
+
+		(*(uint16_t*)bufPtr) = ZIP64_EXTRA_FIELD_ID;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = 16;
+		bufPtr += 2;
+		(*(uint64_t*)bufPtr) = fileHeader->uncompressSize;
+		bufPtr += 8;
+		(*(uint64_t*)bufPtr) = fileHeader->compressSize;
+
+		appendData(zipWriter, headerBuf, 20);
+	}
+}
+
+static void writeDataDescriptor(ZipWriter *zipWriter, FileHeader *fileHeader) {
+	uint8_t descriptorBuf[ZIP64_DATA_DESCRIPTOR_SIZE];
+	void *bufPtr;
+
+	bufPtr = descriptorBuf;
+
+	(*(uint32_t*)bufPtr) = ZIP_DATA_DESCRIPTOR_SIG;
+	bufPtr += 4;
+	(*(uint32_t*)bufPtr) = fileHeader->crc32;
+	bufPtr += 4;
+
+	// Entries with a Zip64 local header have 8-byte sizes in the data descriptor
+	if (fileHeader->needToExtractVersion >= ZIP64_VERSION_NEEDED) {
+		(*(uint64_t*)bufPtr) = fileHeader->compressSize;
+		bufPtr += 8;
+		(*(uint64_t*)bufPtr) = fileHeader->uncompressSize;
+
+		appendData(zipWriter, descriptorBuf, ZIP64_DATA_DESCRIPTOR_SIZE);
+	} else {
+		(*(uint32_t*)bufPtr) = fileHeader->compressSize;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = fileHeader->uncompressSize;
+
+		appendData(zipWriter, descriptorBuf, ZIP_DATA_DESCRIPTOR_SIZE);
+	}
+}
+
+static void writeCentralDirectory(ZipWriter *zipWriter) {
+	uint8_t headerBuf[ZIP_FILE_HEADER_SIZE];
+	uint8_t extraBuf[28];
+	uint8_t recordBuf[ZIP64_END_OF_CDR_SIZE];
+	FileHeader *fileHeader;
+	ListArray *fileHeaderList;
+	int64_t startOffset, centralDirSize, zip64Offset;
+	uint16_t extraFieldLen;
+	void *bufPtr;
+
+	fileHeaderList = &zipWriter->fileHeaderList;
+	startOffset = zipWriter->offset;
+
+	// 1. Write a FileHeader record for every entry
+	for (uint32_t i=0; i < fileHeaderList->length; i++) {
+		fileHeader = b196167f_get(fileHeaderList, i);
+
+		// Values that do not fit in 32 bits move to the Zip64 extra field, in this order
+		bufPtr = extraBuf + 4;
+
+		if (fileHeader->uncompressSize >= ZIP64_MARKER_32) {
+			(*(uint64_t*)bufPtr) = fileHeader->uncompressSize;
+			bufPtr += 8;
+		}
+
+		if (fileHeader->compressSize >= ZIP64_MARKER_32) {
+			(*(uint64_t*)bufPtr) = fileHeader->compressSize;
+			bufPtr += 8;
+		}
+
+		if (fileHeader->localHeaderOffset >= ZIP64_MARKER_32) {
+			(*(uint64_t*)bufPtr) = fileHeader->localHeaderOffset;
+			bufPtr += 8;
+		}
+
+		extraFieldLen = (bufPtr == extraBuf + 4) ? 0 : (bufPtr - (void*) extraBuf);
+
+		if (extraFieldLen > 0) {
+			(*(uint16_t*)extraBuf) = ZIP64_EXTRA_FIELD_ID;
+			(*(uint16_t*)(extraBuf + 2)) = extraFieldLen - 4;
+			fileHeader->needToExtractVersion = ZIP64_VERSION_NEEDED;
+		}
+
+		bufPtr = headerBuf;
+
+		(*(uint32_t*)bufPtr) = ZIP_FILE_HEADER_SIG;
+		bufPtr += 4;
+		(*(uint16_t*)bufPtr) = fileHeader->madeByVersion;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->needToExtractVersion;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->bitFlags;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->compressMethod;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->lastModFileTime;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->lastModFileDate;
+		bufPtr += 2;
+		(*(uint32_t*)bufPtr) = fileHeader->crc32;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = (fileHeader->compressSize >= ZIP64_MARKER_32) ? ZIP64_MARKER_32 : fileHeader->compressSize;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = (fileHeader->uncompressSize >= ZIP64_MARKER_32) ? ZIP64_MARKER_32 : fileHeader->uncompressSize;
+		bufPtr += 4;
+		(*(uint16_t*)bufPtr) = fileHeader->fileNameLen;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = extraFieldLen;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->fileCommentLen;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->diskNumStart;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = fileHeader->internalFileAttribs;
+		bufPtr += 2;
+		(*(uint32_t*)bufPtr) = fileHeader->externalFileAttribs;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = (fileHeader->localHeaderOffset >= ZIP64_MARKER_32) ? ZIP64_MARKER_32 : fileHeader->localHeaderOffset;
+
+		appendData(zipWriter, headerBuf, ZIP_FILE_HEADER_SIZE);
+		appendData(zipWriter, fileHeader->fileName, fileHeader->fileNameLen);
+
+		if (extraFieldLen > 0) {
+			appendData(zipWriter, extraBuf, extraFieldLen);
+		}
+	}
+
+	centralDirSize = zipWriter->offset - startOffset;
+
+	// 2. Write the Zip64 End of Central Directory record and locator if a count or offset overflows
+	if (fileHeaderList->length >= ZIP64_MARKER_16 || centralDirSize >= ZIP64_MARKER_32 || startOffset >= ZIP64_MARKER_32) {
+		zip64Offset = zipWriter->offset;
+		bufPtr = recordBuf;
+
+		(*(uint32_t*)bufPtr) = ZIP64_END_OF_CDR_SIGNATURE;
+		bufPtr += 4;
+		(*(uint64_t*)bufPtr) = ZIP64_END_OF_CDR_SIZE - 12;
+		bufPtr += 8;
+		(*(uint16_t*)bufPtr) = ZIP_VERSION_MADE_BY;
+		bufPtr += 2;
+		(*(uint16_t*)bufPtr) = ZIP64_VERSION_NEEDED;
+		bufPtr += 2;
+		(*(uint32_t*)bufPtr) = 0;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = 0;
+		bufPtr += 4;
+		(*(uint64_t*)bufPtr) = fileHeaderList->length;
+		bufPtr += 8;
+		(*(uint64_t*)bufPtr) = fileHeaderList->length;
+		bufPtr += 8;
+		(*(uint64_t*)bufPtr) = centralDirSize;
+		bufPtr += 8;
+		(*(uint64_t*)bufPtr) = startOffset;
+
+		appendData(zipWriter, recordBuf, ZIP64_END_OF_CDR_SIZE);
+
+		bufPtr = recordBuf;
+
+		(*(uint32_t*)bufPtr) = ZIP64_END_OF_CDL_SIGNATURE;
+		bufPtr += 4;
+		(*(uint32_t*)bufPtr) = 0;
+		bufPtr += 4;
+		(*(uint64_t*)bufPtr) = zip64Offset;
+		bufPtr += 8;
+		(*(uint32_t*)bufPtr) = 1;
+
+		appendData(zipWriter, recordBuf, ZIP64_END_OF_CDL_SIZE);
+	}
+
+	// 3. Write the End of Central Directory record; overflowing values are set to the marker value
+	bufPtr = headerBuf;
+
+	(*(uint32_t*)bufPtr) = ZIP_END_OF_CDR_SIG;
+	bufPtr += 4;
+	(*(uint16_t*)bufPtr) = 0;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = 0;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = (fileHeaderList->length >= ZIP64_MARKER_16) ? ZIP64_MARKER_16 : fileHeaderList->length;
+	bufPtr += 2;
+	(*(uint16_t*)bufPtr) = (fileHeaderList->length >= ZIP64_MARKER_16) ? ZIP64_MARKER_16 : fileHeaderList->length;
+	bufPtr += 2;
+	(*(uint32_t*)bufPtr) = (centralDirSize >= ZIP64_MARKER_32) ? ZIP64_MARKER_32 : centralDirSize;
+	bufPtr += 4;
+	(*(uint32_t*)bufPtr) = (startOffset >= ZIP64_MARKER_32) ? ZIP64_MARKER_32 : startOffset;
+	bufPtr += 4;
+	(*(uint16_t*)bufPtr) = 0;
+
+	appendData(zipWriter, headerBuf, ZIP_END_OF_CDR_SIZE);
+}
+
+static void appendData(ZipWriter *zipWriter, void *data, uint32_t length) {
+	zipWriter->tailBuffer = c49f5b0d_append(zipWriter->tailBuffer, data, length);
+	zipWriter->offset += length;
+}
+
+static void flushZipWriter(ZipWriter *zipWriter, bool isClosing) {
+	OutputBuffer *outputBuffer;
+	OutputBuffer *lastBuffer;
+	AIOFile *aioFile;
+	uint32_t numBuffers, numRequests;
+
+	aioFile = &zipWriter->aioFile;
+
+	// 1. Count the full slabs; the tail slab is still being filled unless closing
+	numBuffers = 0;
+	for (outputBuffer = zipWriter->headBuffer; outputBuffer != NULL && outputBuffer->length == SLABPOOL_SLAB_SIZE; outputBuffer = outputBuffer->next) {
+		if (outputBuffer == zipWriter->tailBuffer && !isClosing) {
+			break;
+		}
+
+		numBuffers++;
+	}
+
+	while (numBuffers >= ZIP_WRITE_MAX_OPERATIONS || (isClosing && numBuffers > 0)) {
+		// 2. The previous batch must complete before its slabs are released
+		waitZipWriter(zipWriter);
+
+		// 3. Queue one O_DIRECT write per full slab, up to a full AIOTicket
+		outputBuffer = zipWriter->headBuffer;
+		lastBuffer = NULL;
+
+		for (numRequests = 0; numRequests < numBuffers && numRequests < ZIP_WRITE_MAX_OPERATIONS; numRequests++) {
+			f1207515_write(aioFile, outputBuffer->buffer, SLABPOOL_SLAB_SIZE);
+			lastBuffer = outputBuffer;
+			outputBuffer = outputBuffer->next;
+		}
+
+		numBuffers -= numRequests;
+
+		// 4. Detach the batch from the chain until its writes complete
+		lastBuffer->next = NULL;
+		zipWriter->pendingBuffer = zipWriter->headBuffer;
+		zipWriter->headBuffer = outputBuffer;
+
+		if (outputBuffer != NULL) {
+			outputBuffer->prev = NULL;
+		} else {
+			zipWriter->tailBuffer = NULL;
+		}
+
+		f1207515_initAIOTicket(&aioFile->aioTicket);
+		f1207515_submit(aioFile);
+	}
+
+	if (isClosing) {
+		waitZipWriter(zipWriter);
+
+		// 5. Write the unaligned tail through the page cache
+		if (zipWriter->headBuffer != NULL) {
+			if (zipWriter->headBuffer->length > 0
+			        && f1207515_writeBuffered(aioFile, zipWriter->headBuffer->buffer, zipWriter->headBuffer->length) == SYSTEM_ERROR_CODE) {
+				c7c88e52_printLibError(aioFile->fileName, errno);
+			}
+
+			c49f5b0d_destroyOutputBuffer(zipWriter->headBuffer);
+			zipWriter->headBuffer = NULL;
+			zipWriter->tailBuffer = NULL;
+		}
+	}
+}
+
+static void waitZipWriter(ZipWriter *zipWriter) {
+	QueueBounded *requestQueue;
+	AIOTicket *aioTicket;
+	AIOFile *aioFile;
+
+	if (zipWriter->pendingBuffer == NULL) {
+		return;
+	}
+
+	aioFile = &zipWriter->aioFile;
+	aioTicket = &aioFile->aioTicket;
+	requestQueue = aioFile->aioContext->requestQueue;
+
+	do {
+		// 1. Reap the completions of the outstanding AIOTicket
+		while (aioTicket->numEvents < aioTicket->numRequests) {
+			if (f1207515_getEvents(aioFile) == SYSTEM_ERROR_CODE) {
+				c7c88e52_printLibError(aioFile->fileName, errno);
+				return;
+			}
+		}
+
+		// 2. Report any failed writes
+		for (uint32_t i=0; i < aioTicket->numEvents; i++) {
+			if (aioTicket->eventList[i].res < 0) {
+				c7c88e52_printLibError(aioFile->fileName, -aioTicket->eventList[i].res);
+			}
+		}
+
+		f1207515_cleanUpAIOTicket(aioTicket);
+		f1207515_initAIOTicket(aioTicket);
+
+		// 3. Submit the writes io_submit() did not accept the first time around
+	} while (!b8da7268_isEmpty(requestQueue) && f1207515_submit(aioFile));
+
+	// 4. Drop the writes that still cannot be submitted before their slabs go away
+	if (!b8da7268_isEmpty(requestQueue)) {
+		c7c88e52_printLibError(aioFile->fileName, errno);
+
+		while (!b8da7268_isEmpty(requestQueue)) {
+			f1207515_releaseAIORequest(b8da7268_dequeue(requestQueue));
+		}
+	}
+
+	// 5. Release the written OutputBuffer slabs
+	c49f5b0d_destroyOutputBuffer(zipWriter->pendingBuffer);
+	zipWriter->pendingBuffer = NULL;
+}
+
+static void printEndOfCDR(EndOfCDR *endOfCDR) {
+	printf("EndOfCDR Data:\n");
+	printf("\tsignature:          %#x\n", endOfCDR->signature);
+	printf("\tdiskNum:            %u\n", endOfCDR->diskNum);
+	printf("\tstartDiskNum:       %u\n", endOfCDR->startDiskNum);
+	printf("\ttotalEntriesOnDisk: %u\n", endOfCDR->totalEntriesOnDisk);
+	printf("\ttotalEntries:       %u\n", endOfCDR->totalEntries);
+	printf("\tsize:               %u\n", endOfCDR->size);
+	printf("\tstartOffset:        %u\n", endOfCDR->startOffset);
+	printf("\tcommentLength:      %u\n", endOfCDR->commentLength);
+	printf("\n");
+}
+
+static void printListEntry(FileHeader *fileHeader) {
+	char timeBuf[32];
+	struct tm localTime;
+	time_t timestamp;
+	char *method;
+
+	method = (fileHeader->compressMethod == ZIP_METHOD_STORED) ? "Stored"
+	       : (fileHeader->compressMethod == ZIP_METHOD_DEFLATE) ? "Defl" : "Other";
+
+	timestamp = a66923ff_convertTimeFromDOS(fileHeader->lastModFileDate, fileHeader->lastModFileTime);
+	localtime_r(&timestamp, &localTime);
+	strftime(timeBuf, sizeof(timeBuf), "%Y-%m-%d  %H:%M", &localTime);
+
+	printf("%10llu  %-6s  %10llu  %3u%%  %s  %08x  %s\n", (unsigned long long) fileHeader->uncompressSize, method,
+	       (unsigned long long) fileHeader->compressSize, getCompressRatio(fileHeader->uncompressSize, fileHeader->compressSize),
+	       timeBuf, fileHeader->crc32, fileHeader->fileName);
 }
 
 static void printCentralDirectory(CentralDirectory *centralDir) {
@@ -887,15 +2985,15 @@ static void printCentralDirectory(CentralDirectory *centralDir) {
 		printf("\tlastModFileTime:      %u\n", fileHeader->lastModFileTime);
 		printf("\tlastModFileDate:      %u\n", fileHeader->lastModFileDate);
 		printf("\tcrc32:                %u\n", fileHeader->crc32);
-		printf("\tcompressSize:         %u\n", fileHeader->compressSize);
-		printf("\tuncompressSize:       %u\n", fileHeader->uncompressSize);
+		printf("\tcompressSize:         %llu\n", (unsigned long long) fileHeader->compressSize);
+		printf("\tuncompressSize:       %llu\n", (unsigned long long) fileHeader->uncompressSize);
 		printf("\tfileNameLen:          %u\n", fileHeader->fileNameLen);
 		printf("\textraFieldLen:        %u\n", fileHeader->extraFieldLen);
 		printf("\tfileCommentLen:       %u\n", fileHeader->fileCommentLen);
 		printf("\tdiskNumStart:         %u\n", fileHeader->diskNumStart);
 		printf("\tinternalFileAttribs:  %u\n", fileHeader->internalFileAttribs);
 		printf("\texternalFileAttribs:  %u\n", fileHeader->externalFileAttribs);
-		printf("\tlocalHeaderOffset:    %u\n", fileHeader->localHeaderOffset);
+		printf("\tlocalHeaderOffset:    %llu\n", (unsigned long long) fileHeader->localHeaderOffset);
 		printf("\n");
 	}
 }
@@ -910,8 +3008,8 @@ static void printLocalFileHeader(LocalFileHeader *localFileHeader, FileHeader *f
 	printf("\tlastModFileTime:      %u\n", localFileHeader->lastModFileTime);
 	printf("\tlastModFileDate:      %u\n", localFileHeader->lastModFileDate);
 	printf("\tcrc32:                %u\n", fileHeader->crc32);
-	printf("\tcompressSize:         %u\n", fileHeader->compressSize);
-	printf("\tuncompressSize:       %u\n", fileHeader->uncompressSize);
+	printf("\tcompressSize:         %llu\n", (unsigned long long) fileHeader->compressSize);
+	printf("\tuncompressSize:       %llu\n", (unsigned long long) fileHeader->uncompressSize);
 	printf("\tfileNameLen:          %u\n", localFileHeader->fileNameLen);
 	printf("\textraFieldLen:        %u\n", localFileHeader->extraFieldLen);
 	printf("\n");
@@ -31,6 +31,10 @@
 
 #include <assert.h>
 
+#include "deflate.h"
+#include "inflate.h"
+
+#include "../adt/hashmap.h"
 #include "../adt/listarray.h"
 #include "../io/async.h"
 #include "../io/filebuffer.h"
@@ -44,20 +48,146 @@
  * Zip Archive
  *    - List of FileBuffer structs
  *    - AIOFile struct for zip archive file
+ *    - AIOContext for Linux AIO writes of the extracted files; kept apart
+ *      from the read AIOContext so each reaps only its own completions
  *    - AIOContext for Linux AIO reads
  *    - Output directory for zip file artifacts
+ *    - Optional entry filter; when set only the entries it matches are
+ *      extracted, tested or listed
  */
+typedef bool (*ZipEntryFilter)(char *entryName, void *filterData);
+
 typedef struct ZipArchive {
 	AIOFile          aioFile;
 	FileBufferList   bufferList;
+	AIOContext       writeContext;
 	AIOContext      *aioContext;
 	char            *outputDir;
+	ZipEntryFilter   entryFilter;
+	void            *filterData;
 } ZipArchive;
 
 #if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(ZipArchive) == 432, "Check your assumptions");
+static_assert(sizeof(ZipArchive) == 528, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(ZipArchive) == 448, "Check your assumptions");
+#endif
+
+/*
+ * File Header
+ *   - central file header signature                      4 bytes  (0x02014b50)
+ *   - version made by                                    2 bytes
+ *   - version needed to extract                          2 bytes
+ *   - general purpose bit flag                           2 bytes
+ *   - compression method                                 2 bytes
+ *   - last mod file time                                 2 bytes
+ *   - last mod file date                                 2 bytes
+ *   - crc-32                                             4 bytes
+ *   - compressed size                                    4 bytes
+ *   - uncompressed size                                  4 bytes
+ *   - file name length                                   2 bytes
+ *   - extra field length                                 2 bytes
+ *   - file comment length                                2 bytes
+ *   - disk number start                                  2 bytes
+ *   - internal file attributes                           2 bytes
+ *   - external file attributes                           4 bytes
+ *   - relative offset of local header                    4 bytes
+ *
+ *   - file name                                          (variable size)
+ *   - extra field                                        (variable size)
+ *   - file comment                                       (variable size)
+ *
+ * The compressed size, uncompressed size and local header offset are 64-bit;
+ * a Zip64 extended information extra field holds the ones that do not fit,
+ * which are then stored as 0xFFFFFFFF in the fixed fields.
+ */
+typedef struct FileHeader {
+	char*    fileName;
+	char*    extraField;
+	char*    fileComment;
+	uint64_t compressSize;
+	uint64_t uncompressSize;
+	uint64_t localHeaderOffset;
+	uint32_t signature;
+	uint32_t crc32;
+	uint32_t externalFileAttribs;
+	uint16_t madeByVersion;
+	uint16_t needToExtractVersion;
+	uint16_t bitFlags;
+	uint16_t compressMethod;
+	uint16_t lastModFileTime;
+	uint16_t lastModFileDate;
+	uint16_t fileNameLen;
+	uint16_t extraFieldLen;
+	uint16_t fileCommentLen;
+	uint16_t diskNumStart;
+	uint16_t internalFileAttribs;
+} FileHeader __attribute__ ((aligned (16)));
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(FileHeader) == 88, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(FileHeader) == 72, "Check your assumptions");
+#endif
+
+/*
+ * Zip Reader
+ *   - ZipArchive the entries are read from
+ *   - FileHeader list loaded from the Central Directory
+ *   - HashMap index of the entry names to their FileHeader, built once when
+ *     the Zip archive is opened
+ *   - Inflate instance reused for every entry; its output window and
+ *     decoders are allocated on the first deflated entry read
+ *   - Memory mapped sidecar index the entries are looked up in instead of the
+ *     FileHeader list and HashMap, or NULL if the Central Directory was loaded
+ *   - FileHeader views of the sidecar index entries, filled in on lookup
+ */
+typedef struct ZipReader {
+	ZipArchive  zipArchive;
+	ListArray   fileHeaderList;
+	HashMap     fileHeaderMap;
+	Inflate     inflate;
+	void       *indexData;
+	FileHeader *indexHeaderList;
+	bool        isInflateInit;
+} ZipReader;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(ZipReader) == 888, "Check your assumptions");
 #elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(ZipArchive) == 384, "Check your assumptions");
+static_assert(sizeof(ZipReader) == 704, "Check your assumptions");
+#endif
+
+/*
+ * Zip Writer
+ *   - AIOFile struct for the Zip archive being written
+ *   - AIOContext for the Linux AIO writes of the archive
+ *   - Deflate encoder, reset for every entry
+ *   - FileHeader entries written so far, for the Central Directory
+ *   - FileBufferList for reading the files added to the archive
+ *   - AIOContext for Linux AIO reads of the added files
+ *   - OutputBuffer chain of the archive data not yet written; every full slab
+ *     starts at a 32KB aligned archive offset and is written with O_DIRECT
+ *   - OutputBuffer chain of the slabs with writes in flight
+ *   - Archive offset of the next byte to be appended
+ */
+typedef struct ZipWriter {
+	AIOFile         aioFile;
+	AIOContext      writeContext;
+	Deflate         deflate;
+	ListArray       fileHeaderList;
+	FileBufferList  bufferList;
+	AIOContext     *aioContext;
+	OutputBuffer   *headBuffer;
+	OutputBuffer   *tailBuffer;
+	OutputBuffer   *pendingBuffer;
+	int64_t         offset;
+} ZipWriter;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(ZipWriter) == 3224, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(ZipWriter) == 3120, "Check your assumptions");
 #endif
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
@@ -122,4 +252,233 @@ void ce667b0d_initZipArchive(ZipArchive *zipArchive, AIOContext *aioContext, cha
  */
 void ce667b0d_unzip(ZipArchive *zipArchive);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_unzipParallel
+ * Description: Extract files from a Zip archive using numThreads worker threads.
+ *              Entries are partitioned by compressed size and every worker
+ *              opens its own reader; all directories are created before the
+ *              workers start.
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to unzip
+ *   numThreads     The number of worker threads; one extracts serially
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_unzipParallel(ZipArchive *zipArchive, uint32_t numThreads);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_test
+ * Description: Inflates every entry of a Zip archive into a discard sink and
+ *              verifies its CRC-32 without creating any files or directories.
+ *              Prints one line per entry with its throughput, then the totals.
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to test
+ * Returns:         True if every entry was found and verified, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_test(ZipArchive *zipArchive);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_testParallel
+ * Description: Tests a Zip archive like ce667b0d_test() using numThreads
+ *              worker threads, partitioned as with ce667b0d_unzipParallel()
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to test
+ *   numThreads     The number of worker threads; one tests serially
+ * Returns:         True if every entry was found and verified, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_testParallel(ZipArchive *zipArchive, uint32_t numThreads);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_list
+ * Description: Prints the entries of a Zip archive with their sizes, dates and
+ *              CRC-32 values. Only the End of Central Directory record and the
+ *              Central Directory are read.
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to list
+ * Returns:         True if the whole Central Directory was read, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_list(ZipArchive *zipArchive);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_setEntryFilter
+ * Description: Restricts extraction, testing and listing to the entries for
+ *              which entryFilter returns true. The byte ranges of the selected
+ *              entries are merged and read ahead of extraction, so the I/O is
+ *              proportional to the selected data rather than the archive.
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to filter
+ *   entryFilter    The function called with each entry name, or NULL for all
+ *   filterData     A pointer passed through to entryFilter
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_setEntryFilter(ZipArchive *zipArchive, ZipEntryFilter entryFilter, void *filterData);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_setGlobFilter
+ * Description: Restricts the ZipArchive to the entries whose names match the
+ *              shell wildcard pattern, e.g. "*.so". As with unzip, '*' also
+ *              matches across '/' characters, so a directory name followed by
+ *              '/' and '*' selects the whole subtree.
+ *
+ * Parameters:
+ *   zipArchive     The ZipArchive instance to filter
+ *   pattern        The wildcard pattern; must outlive the ZipArchive operations
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_setGlobFilter(ZipArchive *zipArchive, char *pattern);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_closeZipReader
+ * Description: Frees dynamically allocated memory within the ZipReader instance
+ *              and closes the Zip archive
+ *
+ * Parameters:
+ *   zipReader  A pointer to the ZipReader instance to close
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_closeZipReader(ZipReader *zipReader);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_openZipReader
+ * Description: Opens the Zip archive, loads its Central Directory and indexes
+ *              the entries by name for random access
+ *
+ * Parameters:
+ *   zipReader      A pointer to the ZipReader instance to initalize
+ *   aioContext     The AIOContext to use for Zip file access
+ *   fileName       The name of the Zip archive file
+ * Returns:     True if the Central Directory was loaded, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_openZipReader(ZipReader *zipReader, AIOContext *aioContext, char *fileName);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_openZipReaderIndex
+ * Description: Opens the Zip archive using the sidecar index file if it was
+ *              built from the archive at its current size and modification
+ *              time. The index is memory mapped and no per-entry memory is
+ *              allocated. Otherwise the Central Directory is loaded and the
+ *              index file is rewritten for the next open, if possible.
+ *
+ * Parameters:
+ *   zipReader      A pointer to the ZipReader instance to initalize
+ *   aioContext     The AIOContext to use for Zip file access
+ *   fileName       The name of the Zip archive file
+ *   indexName      The name of the sidecar index file
+ * Returns:     True if the index or Central Directory was loaded, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_openZipReaderIndex(ZipReader *zipReader, AIOContext *aioContext, char *fileName, char *indexName);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_findEntry
+ * Description: Looks up the FileHeader of an entry in the Zip archive by name
+ *
+ * Parameters:
+ *   zipReader  A pointer to the ZipReader instance
+ *   entryName  The name of the entry as stored in the archive
+ * Returns:     The FileHeader of the entry, or NULL if not found
+ * ----------------------------------------------------------------------------
+ */
+FileHeader *ce667b0d_findEntry(ZipReader *zipReader, char *entryName);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_readEntry
+ * Description: Reads only the byte range of the entry from the Zip archive
+ *              and inflates it into the buffer; the CRC-32 is verified
+ *
+ * Parameters:
+ *   zipReader      A pointer to the ZipReader instance
+ *   fileHeader     The FileHeader of the entry to read
+ *   buffer         The buffer to hold the uncompressed entry data
+ *   length         The length of the buffer; at least uncompressSize
+ * Returns:     True if the entry was read and verified, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_readEntry(ZipReader *zipReader, FileHeader *fileHeader, void *buffer, uint64_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_streamEntry
+ * Description: Reads only the byte range of the entry from the Zip archive
+ *              and passes the uncompressed data to the sink chunk by chunk.
+ *              The CRC-32 can only be verified after the last chunk has been
+ *              passed to the sink.
+ *
+ * Parameters:
+ *   zipReader      A pointer to the ZipReader instance
+ *   fileHeader     The FileHeader of the entry to read
+ *   sink           The sink function each chunk is passed to, or NULL to only
+ *                  verify the CRC-32
+ *   sinkData       The data passed to the sink function
+ * Returns:     True if the entry was read and verified, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_streamEntry(ZipReader *zipReader, FileHeader *fileHeader, InflateSinkFunc sink, void *sinkData);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_cleanUpZipWriter
+ * Description: Frees dynamically allocated memory within the ZipWriter instance
+ *
+ * Parameters:
+ *   zipWriter  A pointer to the ZipWriter instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_cleanUpZipWriter(ZipWriter *zipWriter);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_initZipWriter
+ * Description: Initializes an existing ZipWriter struct and creates the Zip
+ *              archive file
+ *
+ * Parameters:
+ *   zipWriter      A pointer to the ZipWriter instance to initalize
+ *   aioContext     The AIOContext to use for reading the added files
+ *   fileName       The name of the Zip archive file to create
+ *   level          The deflate compression level; zero stores the entries
+ * Returns:     True if the Zip archive file was created, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_initZipWriter(ZipWriter *zipWriter, AIOContext *aioContext, char *fileName, int level);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_addFile
+ * Description: Adds a file or directory to the Zip archive. The file data is
+ *              streamed through the Deflate encoder and followed by a data
+ *              descriptor, so the archive is written strictly sequentially.
+ *
+ * Parameters:
+ *   zipWriter  A pointer to the ZipWriter instance
+ *   pathName   The path of the file or directory to add
+ *   entryName  The name of the entry within the archive, or NULL to use pathName
+ * Returns:     True if the entry was added, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool ce667b0d_addFile(ZipWriter *zipWriter, char *pathName, char *entryName);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce667b0d_closeZipWriter
+ * Description: Writes the Central Directory and End of Central Directory
+ *              record, waits for the outstanding writes and closes the archive
+ *
+ * Parameters:
+ *   zipWriter  A pointer to the ZipWriter instance
+ * ----------------------------------------------------------------------------
+ */
+void ce667b0d_closeZipWriter(ZipWriter *zipWriter);
+
 #endif /* ORG_DEVOPSBROKER_COMPRESS_ZIP_ZIPARCHIVE_H */
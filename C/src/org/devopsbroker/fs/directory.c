@@ -29,6 +29,7 @@
 
 #include <stdlib.h>
 
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -47,8 +48,21 @@
 #define DIRPATH_BUFFER_SIZE 64
 #define FILEPATHLIST_SIZE 64
 
+#define DIRCACHE_MAP_CAPACITY  256
+#define DIRCACHE_MAX_OPEN_FDS  64
+
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
+typedef struct CachedDir {
+	char *pathName;
+	int   fd;
+} CachedDir;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(CachedDir) == 16, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(CachedDir) == 8, "Check your assumptions");
+#endif
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
@@ -63,6 +77,12 @@ static int compareFile(void *first, void *second);
 
 static void readDirectory(Directory *directory, DirPath *dirPath);
 
+static CachedDir *findCachedDir(DirCache *dirCache, char *pathName, char *pathEnd);
+static CachedDir *makeCachedDir(DirCache *dirCache, CachedDir *parentDir, char *pathName, char *name, char *nameEnd,
+                                uint32_t mode, bool *makeDir);
+static void destroyCachedDir(void *cachedDirPtr);
+static void printMakeDirError(char *pathName, int errorNum);
+
 // ═════════════════════════ Function Implementations ═════════════════════════
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -145,6 +165,12 @@ void d0059b5b_cleanUpDirectory(Directory *directory) {
 	b196167f_cleanUpListArray(&directory->fileList, f668c4bd_free);
 }
 
+void d0059b5b_cleanUpDirCache(DirCache *dirCache) {
+	c47905f7_cleanUpHashMap(&dirCache->dirMap);
+	b196167f_cleanUpListArray(&dirCache->dirList, destroyCachedDir);
+	dirCache->numOpenFds = 0;
+}
+
 void d0059b5b_cleanUpDirPath(DirPath *dirPath) {
 	f668c4bd_free(dirPath->buffer);
 }
@@ -161,6 +187,12 @@ void d0059b5b_initDirectory(Directory *directory, char *name) {
 	f668c4bd_meminit(&directory->subdirList, sizeof(ListArray) * 2);
 }
 
+void d0059b5b_initDirCache(DirCache *dirCache) {
+	c47905f7_initHashMap(&dirCache->dirMap, f6215943_hashCode, f6215943_isEqual, DIRCACHE_MAP_CAPACITY);
+	b196167f_initListArray(&dirCache->dirList);
+	dirCache->numOpenFds = 0;
+}
+
 void d0059b5b_initDirPath(DirPath *dirPath, char *path) {
 	dirPath->length = f6215943_getLength(path);
 	dirPath->size = dirPath->length + DIRPATH_BUFFER_SIZE;
@@ -222,19 +254,11 @@ bool d0059b5b_makeDirectory(char *pathName, uint32_t mode, bool hasFilename) {
 	for (uint32_t i=1; i <= subdirList.length; i++) {
 		if (i < subdirList.length || !hasFilename) {
 			if (stat(pathName, &dirStatus) == SYSTEM_ERROR_CODE && errno == ENOENT) {
-				if (mkdir(pathName, mode) == SYSTEM_ERROR_CODE) {
-					StringBuilder errorMessage;
-
-					c598a24c_initStringBuilder(&errorMessage);
-
-					c598a24c_append_string(&errorMessage, "Cannot make directory '");
-					c598a24c_append_string(&errorMessage, pathName);
-					c598a24c_append_char(&errorMessage, '\'');
-
-					c7c88e52_printLibError(errorMessage.buffer, errno);
-					c598a24c_cleanUpStringBuilder(&errorMessage);
-				} else {
+				if (mkdir(pathName, mode) != SYSTEM_ERROR_CODE) {
 					makeDir = true;
+				} else if (errno != EEXIST) {
+					// EEXIST means another thread created the directory after stat()
+					printMakeDirError(pathName, errno);
 				}
 			}
 		}
@@ -252,6 +276,66 @@ bool d0059b5b_makeDirectory(char *pathName, uint32_t mode, bool hasFilename) {
 	return makeDir;
 }
 
+bool d0059b5b_makeCachedDirectory(DirCache *dirCache, char *pathName, uint32_t mode, bool hasFilename) {
+	CachedDir *parentDir, *cachedDir;
+	char *dirEnd, *name, *nameEnd;
+	bool makeDir;
+
+	// 1. Find the end of the directory portion of pathName
+	dirEnd = pathName + f6215943_getLength(pathName);
+
+	if (hasFilename) {
+		while (dirEnd > pathName && (*dirEnd) != '/') {
+			dirEnd--;
+		}
+	}
+
+	while (dirEnd > pathName && dirEnd[-1] == '/') {
+		dirEnd--;
+	}
+
+	// 2. Nothing to do if there is no directory or it is already cached
+	if (dirEnd == pathName || findCachedDir(dirCache, pathName, dirEnd) != NULL) {
+		return false;
+	}
+
+	// 3. Create subdirectories from the base directory to the leaves
+	parentDir = NULL;
+	name = pathName;
+	nameEnd = pathName + 1;
+	makeDir = false;
+
+	while (true) {
+		while (nameEnd < dirEnd && (*nameEnd) != '/') {
+			nameEnd++;
+		}
+
+		cachedDir = findCachedDir(dirCache, pathName, nameEnd);
+
+		if (cachedDir == NULL) {
+			cachedDir = makeCachedDir(dirCache, parentDir, pathName, name, nameEnd, mode, &makeDir);
+
+			if (cachedDir == NULL) {
+				break;
+			}
+		}
+
+		if (nameEnd == dirEnd) {
+			break;
+		}
+
+		// Advance past any repeated '/' to the next subdirectory
+		while ((*nameEnd) == '/') {
+			nameEnd++;
+		}
+
+		parentDir = cachedDir;
+		name = nameEnd;
+	}
+
+	return makeDir;
+}
+
 void d0059b5b_find(FilePathList *filePathList, DirPath *dirPath, bool isMatch(char *filename)) {
 	Directory currentDir;
 
@@ -428,3 +512,91 @@ static void readDirectory(Directory *directory, DirPath *dirPath) {
 		b196167f_sort(&directory->fileList, compareFile);
 	}
 }
+
+static CachedDir *findCachedDir(DirCache *dirCache, char *pathName, char *pathEnd) {
+	CachedDir *cachedDir;
+	char endChar;
+
+	// Terminate pathName at pathEnd just long enough for the lookup
+	endChar = (*pathEnd);
+	(*pathEnd) = '\0';
+	cachedDir = c47905f7_get(&dirCache->dirMap, pathName);
+	(*pathEnd) = endChar;
+
+	return cachedDir;
+}
+
+static CachedDir *makeCachedDir(DirCache *dirCache, CachedDir *parentDir, char *pathName, char *name, char *nameEnd,
+                                uint32_t mode, bool *makeDir) {
+	CachedDir *cachedDir;
+	uint32_t pathLen;
+	char endChar;
+	int status;
+
+	endChar = (*nameEnd);
+	(*nameEnd) = '\0';
+
+	// 1. Open the parent directory the first time a subdirectory is made in it
+	if (parentDir != NULL && parentDir->fd == SYSTEM_ERROR_CODE && dirCache->numOpenFds < DIRCACHE_MAX_OPEN_FDS) {
+		parentDir->fd = open(parentDir->pathName, O_PATH | O_DIRECTORY | O_CLOEXEC);
+
+		if (parentDir->fd != SYSTEM_ERROR_CODE) {
+			dirCache->numOpenFds++;
+		}
+	}
+
+	// 2. Make the directory relative to its parent to skip the path walk
+	if (parentDir != NULL && parentDir->fd != SYSTEM_ERROR_CODE) {
+		status = mkdirat(parentDir->fd, name, mode);
+	} else {
+		status = mkdirat(AT_FDCWD, pathName, mode);
+	}
+
+	if (status != SYSTEM_ERROR_CODE) {
+		(*makeDir) = true;
+	} else if (errno != EEXIST) {
+		printMakeDirError(pathName, errno);
+		(*nameEnd) = endChar;
+
+		return NULL;
+	}
+
+	// 3. Remember the directory whether it was created or already existed
+	pathLen = nameEnd - pathName;
+
+	cachedDir = f668c4bd_malloc(sizeof(CachedDir));
+	cachedDir->pathName = f668c4bd_stralloc(pathLen);
+	cachedDir->fd = SYSTEM_ERROR_CODE;
+	f6215943_copyToBuffer(pathName, cachedDir->pathName, pathLen);
+
+	c47905f7_put(&dirCache->dirMap, cachedDir->pathName, cachedDir);
+	b196167f_add(&dirCache->dirList, cachedDir);
+
+	(*nameEnd) = endChar;
+
+	return cachedDir;
+}
+
+static void destroyCachedDir(void *cachedDirPtr) {
+	CachedDir *cachedDir = cachedDirPtr;
+
+	if (cachedDir->fd != SYSTEM_ERROR_CODE) {
+		close(cachedDir->fd);
+	}
+
+	f668c4bd_free(cachedDir->pathName);
+	f668c4bd_free(cachedDir);
+}
+
+static void printMakeDirError(char *pathName, int errorNum) {
+	StringBuilder errorMessage;
+
+	c598a24c_initStringBuilder(&errorMessage);
+
+	c598a24c_append_string(&errorMessage, "Cannot make directory '");
+	c598a24c_append_string(&errorMessage, pathName);
+	c598a24c_append_char(&errorMessage, '\'');
+
+	c7c88e52_printLibError(errorMessage.buffer, errorNum);
+	c598a24c_cleanUpStringBuilder(&errorMessage);
+}
@@ -33,6 +33,7 @@
 
 #include <assert.h>
 
+#include "../adt/hashmap.h"
 #include "../adt/listarray.h"
 #include "../lang/stringbuilder.h"
 
@@ -76,6 +77,23 @@ static_assert(sizeof(Directory) == 288, "Check your assumptions");
 static_assert(sizeof(Directory) == 280, "Check your assumptions");
 #endif
 
+/*
+ * Remembers every directory created or found during one pass of directory
+ * creation (e.g. a single archive extraction) so each one is created only once,
+ * relative to an open descriptor of its parent. Not thread-safe.
+ */
+typedef struct DirCache {
+	HashMap dirMap;
+	ListArray dirList;
+	uint32_t numOpenFds;
+} DirCache;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(DirCache) == 64, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(DirCache) == 40, "Check your assumptions");
+#endif
+
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
 
@@ -167,6 +185,17 @@ void d0059b5b_destroyFilePathList(FilePathList *filePathList);
  */
 void d0059b5b_cleanUpDirectory(Directory *directory);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d0059b5b_cleanUpDirCache
+ * Description: Closes the cached directory descriptors and frees dynamically
+ *              allocated memory within the DirCache instance
+ *
+ * Parameters:
+ *   dirCache   A pointer to the DirCache instance to clean up
+ * ----------------------------------------------------------------------------
+ */
+void d0059b5b_cleanUpDirCache(DirCache *dirCache);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d0059b5b_cleanUpDirPath
  * Description: Frees dynamically allocated memory within the DirPath instance
@@ -198,6 +227,16 @@ void d0059b5b_cleanUpFilePathList(FilePathList *filePathList);
  */
 void d0059b5b_initDirectory(Directory *directory, char *name);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d0059b5b_initDirCache
+ * Description: Initializes an existing DirCache struct
+ *
+ * Parameters:
+ *   dirCache   A pointer to the DirCache instance to initalize
+ * ----------------------------------------------------------------------------
+ */
+void d0059b5b_initDirCache(DirCache *dirCache);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d0059b5b_initDirPath
  * Description: Initializes an existing DirPath struct
@@ -247,6 +286,21 @@ void d0059b5b_listContents(Directory *directory, DirPath *dirPath, bool isRecurs
  */
 bool d0059b5b_makeDirectory(char *pathName, uint32_t mode, bool hasFilename);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    d0059b5b_makeCachedDirectory
+ * Description: Creates the directory from pathName, if not already exists, and
+ *              skips every directory already known to the DirCache instance
+ *
+ * Parameters:
+ *   dirCache       A pointer to the DirCache instance to use
+ *   pathName       The directory path name to create
+ *   mode           The file permissions for the new directory
+ *   hasFilename    True if the last element is a filename, false otherwise
+ * Returns:     True if at least one directory was created, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool d0059b5b_makeCachedDirectory(DirCache *dirCache, char *pathName, uint32_t mode, bool hasFilename);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    d0059b5b_find
  * Description: Searches for files in a directory hierarchy starting from the
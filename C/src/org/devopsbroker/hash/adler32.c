@@ -0,0 +1,93 @@
+/*
+ * adler32.c - DevOpsBroker C source file for the Adler-32 checksum functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The modulo is deferred as zlib does: ADLER32_NMAX is the largest number of
+ * bytes that can be summed before B overflows 32 bits.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _DEFAULT_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include "adler32.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define ADLER32_MODULO  65521
+#define ADLER32_NMAX    5552
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+uint32_t c6725c09_adler32(void *buffer, uint32_t length, uint32_t adler32) {
+	uint8_t *bytePtr;
+	uint32_t sumA, sumB, numBytes;
+
+	bytePtr = buffer;
+	sumA = adler32 & 0xFFFF;
+	sumB = adler32 >> 16;
+
+	while (length > 0) {
+		numBytes = (length > ADLER32_NMAX) ? ADLER32_NMAX : length;
+		length -= numBytes;
+
+		// 1. Sum sixteen bytes at a time; B gains sixteen times A plus the byte sums weighted by position
+		while (numBytes >= 16) {
+			uint32_t byteSum = 0, weightedSum = 0;
+
+			for (uint32_t i=0; i < 16; i++) {
+				byteSum += bytePtr[i];
+				weightedSum += (16 - i) * bytePtr[i];
+			}
+
+			sumB += (sumA << 4) + weightedSum;
+			sumA += byteSum;
+			bytePtr += 16;
+			numBytes -= 16;
+		}
+
+		// 2. Sum the remaining bytes
+		while (numBytes > 0) {
+			sumA += *bytePtr++;
+			sumB += sumA;
+			numBytes--;
+		}
+
+		// 3. Reduce the sums before they can overflow
+		sumA %= ADLER32_MODULO;
+		sumB %= ADLER32_MODULO;
+	}
+
+	return (sumB << 16) | sumA;
+}
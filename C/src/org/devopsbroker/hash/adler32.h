@@ -0,0 +1,66 @@
+/*
+ * adler32.h - DevOpsBroker C header file for the Adler-32 checksum functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_HASH_ADLER32_H | md5sum | cut -c 25-32
+ *
+ * Adler-32 (RFC 1950) is the checksum in the trailer of a zlib stream. It is
+ * made of two 16-bit sums modulo 65521: A is one plus the sum of the bytes,
+ * and B is the sum of the successive values of A.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_HASH_ADLER32_H
+#define ORG_DEVOPSBROKER_HASH_ADLER32_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+
+#include <assert.h>
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define ADLER32_INITIAL_VALUE  1
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    c6725c09_adler32
+ * Description: Calculates the Adler-32 of the input data for length bytes
+ *
+ * Parameters:
+ *   buffer     A pointer to the data buffer to calculate the Adler-32
+ *   length     The length of the buffer to calculate
+ *   adler32    The initial Adler-32 value to start from; ADLER32_INITIAL_VALUE
+ *              for the first chunk
+ * Returns:     The calculated Adler-32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t c6725c09_adler32(void *buffer, uint32_t length, uint32_t adler32);
+
+#endif /* ORG_DEVOPSBROKER_HASH_ADLER32_H */
@@ -0,0 +1,457 @@
+/*
+ * crc32.c - DevOpsBroker C source file for the CRC-32 hash functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The folding constants are the bit-reflected x^n mod P(x) values from the
+ * Intel white paper "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction":
+ *
+ *   k1 = x^(4*128+32) mod P(x)    k2 = x^(4*128-32) mod P(x)
+ *   k3 = x^(128+32) mod P(x)      k4 = x^(128-32) mod P(x)
+ *   k5 = x^64 mod P(x)
+ *   mu = x^64 / P(x)              P(x) = 0x104C11DB7 (reflected 0x1DB710641)
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "crc32.h"
+
+#include "../info/cpuid.h"
+#include "../io/file.h"
+#include "../lang/error.h"
+#include "../lang/memory.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define CRC32_POLYNOMIAL   0xEDB88320
+
+// Four 128-bit lanes are folded in parallel for every 64 bytes of input
+#define PCLMUL_FOLD_SIZE   64
+
+// Largest piece of a 64-bit length passed to a 32-bit length implementation
+#define CRC32_MAX_PIECE    0x40000000
+
+// Slicing-by-16 lookup tables, built once by initCrc32()
+static uint32_t slice16LUT[16][256];
+
+// The powers x^(2^n) modulo the CRC polynomial, built once by initCrc32()
+static uint32_t x2nModPLUT[32];
+
+// The CRC-32 implementation selected for the CPU by initCrc32()
+static uint32_t (*crc32Function)(const uint8_t *buffer, uint32_t length, uint32_t crc);
+static pthread_once_t crc32Once = PTHREAD_ONCE_INIT;
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef struct Crc32Worker {
+	uint8_t   *buffer;
+	uint64_t   length;
+	uint32_t   crc32;
+	pthread_t  thread;
+	bool       isThreaded;
+} Crc32Worker;
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static uint32_t crc32Large(const uint8_t *buffer, uint64_t length, uint32_t crc);
+static void *runCrc32Worker(void *crc32WorkerPtr);
+static uint32_t multModP(uint32_t a, uint32_t b);
+static uint32_t x8nModP(uint64_t n);
+
+static uint32_t crc32Slice16(const uint8_t *buffer, uint32_t length, uint32_t crc);
+
+#if defined(__x86_64__)
+static uint32_t crc32Pclmul(const uint8_t *buffer, uint32_t length, uint32_t crc);
+#endif
+
+static void initCrc32();
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+uint32_t b7e0468d_crc32(void *buffer, uint32_t length, uint32_t crc32) {
+	pthread_once(&crc32Once, initCrc32);
+
+	return ~crc32Function(buffer, length, ~crc32);
+}
+
+uint32_t b7e0468d_crc32Combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB) {
+	pthread_once(&crc32Once, initCrc32);
+
+	return multModP(x8nModP(lengthB), crcA) ^ crcB;
+}
+
+bool b7e0468d_crc32File(const char *pathName, uint32_t numThreads, uint32_t *crc32) {
+	FileStatus fileStatus;
+	void *buffer;
+	int fd;
+
+	// 1. Open the file and retrieve its size
+	fd = open(pathName, O_RDONLY | O_CLOEXEC);
+
+	if (fd == SYSTEM_ERROR_CODE) {
+		c7c88e52_printLibError(pathName, errno);
+		return false;
+	}
+
+	if (!e2f74138_getDescriptorStatus(fd, &fileStatus)) {
+		close(fd);
+		return false;
+	}
+
+	*crc32 = 0;
+
+	// 2. Memory map the file and calculate its CRC-32
+	if (fileStatus.st_size > 0) {
+		buffer = mmap(NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (buffer == MAP_FAILED) {
+			c7c88e52_printLibError(pathName, errno);
+			close(fd);
+			return false;
+		}
+
+		// Each worker reads its chunk front to back
+		madvise(buffer, fileStatus.st_size, MADV_SEQUENTIAL);
+
+		*crc32 = b7e0468d_crc32Parallel(buffer, fileStatus.st_size, 0, numThreads);
+		munmap(buffer, fileStatus.st_size);
+	}
+
+	close(fd);
+
+	return true;
+}
+
+uint32_t b7e0468d_crc32Parallel(void *buffer, uint64_t length, uint32_t crc32, uint32_t numThreads) {
+	Crc32Worker *workerList;
+	uint8_t *chunk = buffer;
+	uint64_t chunkSize;
+
+	pthread_once(&crc32Once, initCrc32);
+
+	// 1. Limit the number of threads so no chunk is smaller than CRC32_MIN_CHUNK_SIZE
+	if (numThreads > length / CRC32_MIN_CHUNK_SIZE) {
+		numThreads = length / CRC32_MIN_CHUNK_SIZE;
+	}
+
+	if (numThreads <= 1) {
+		return ~crc32Large(buffer, length, ~crc32);
+	}
+
+	// 2. Split the buffer into one chunk per thread; the last takes the remainder
+	workerList = f668c4bd_malloc(sizeof(Crc32Worker) * numThreads);
+	chunkSize = (length / numThreads) & ~((uint64_t) PCLMUL_FOLD_SIZE - 1);
+
+	for (uint32_t i=0; i < numThreads; i++) {
+		workerList[i].buffer = chunk;
+		workerList[i].length = (i == numThreads - 1) ? length - (chunk - (uint8_t*) buffer) : chunkSize;
+		workerList[i].isThreaded = (pthread_create(&workerList[i].thread, NULL, runCrc32Worker, &workerList[i]) == 0);
+
+		chunk += chunkSize;
+	}
+
+	// 3. Combine the chunk CRC-32 values in order
+	for (uint32_t i=0; i < numThreads; i++) {
+		if (workerList[i].isThreaded) {
+			pthread_join(workerList[i].thread, NULL);
+		} else {
+			// Fall back to checksumming the chunk on this thread
+			runCrc32Worker(&workerList[i]);
+		}
+
+		crc32 = multModP(x8nModP(workerList[i].length), crc32) ^ workerList[i].crc32;
+	}
+
+	f668c4bd_free(workerList);
+
+	return crc32;
+}
+
+uint32_t b7e0468d_crc32Pclmul(void *buffer, uint32_t length, uint32_t crc32) {
+	pthread_once(&crc32Once, initCrc32);
+
+#if defined(__x86_64__)
+	return ~crc32Pclmul(buffer, length, ~crc32);
+#else
+	return ~crc32Slice16(buffer, length, ~crc32);
+#endif
+}
+
+uint32_t b7e0468d_crc32Slice16(void *buffer, uint32_t length, uint32_t crc32) {
+	pthread_once(&crc32Once, initCrc32);
+
+	return ~crc32Slice16(buffer, length, ~crc32);
+}
+
+// ═════════════════════════ Private Implementations ══════════════════════════
+
+static uint32_t crc32Large(const uint8_t *buffer, uint64_t length, uint32_t crc) {
+	uint32_t pieceLength;
+
+	do {
+		pieceLength = (length > CRC32_MAX_PIECE) ? CRC32_MAX_PIECE : length;
+		crc = crc32Function(buffer, pieceLength, crc);
+
+		buffer += pieceLength;
+		length -= pieceLength;
+	} while (length > 0);
+
+	return crc;
+}
+
+static void *runCrc32Worker(void *crc32WorkerPtr) {
+	Crc32Worker *crc32Worker = crc32WorkerPtr;
+
+	crc32Worker->crc32 = ~crc32Large(crc32Worker->buffer, crc32Worker->length, ~0U);
+
+	return NULL;
+}
+
+/*
+ * Multiplies a and b modulo the CRC polynomial in GF(2). The bits are
+ * reflected, so the high bit is the x^0 term and shifting b right multiplies
+ * it by x.
+ */
+static uint32_t multModP(uint32_t a, uint32_t b) {
+	uint32_t product = 0;
+
+	while (a != 0) {
+		if (a & 0x80000000) {
+			product ^= b;
+		}
+
+		a <<= 1;
+		b = (b >> 1) ^ (CRC32_POLYNOMIAL & -(b & 1));
+	}
+
+	return product;
+}
+
+/*
+ * Returns x^(8 * n) modulo the CRC polynomial, which shifts a CRC-32 past n
+ * zero bytes. The order of x divides 2^32 - 1, so x^(2^32) wraps to x^(2^0).
+ */
+static uint32_t x8nModP(uint64_t n) {
+	uint32_t power = 0x80000000;
+	uint32_t k = 3;
+
+	while (n != 0) {
+		if (n & 1) {
+			power = multModP(x2nModPLUT[k & 31], power);
+		}
+
+		n >>= 1;
+		k++;
+	}
+
+	return power;
+}
+
+/*
+ * Slicing-by-16 from https://create.stephan-brumme.com/crc32/#slicing-by-16-overview
+ * processes 16 bytes per step with one table lookup per byte; the tables can
+ * overlap the lookups since no lookup depends on another within the step
+ */
+static uint32_t crc32Slice16(const uint8_t *buffer, uint32_t length, uint32_t crc) {
+	uint32_t one, two, three, four;
+
+	while (length >= 16) {
+		memcpy(&one, buffer, sizeof(uint32_t));
+		memcpy(&two, buffer + 4, sizeof(uint32_t));
+		memcpy(&three, buffer + 8, sizeof(uint32_t));
+		memcpy(&four, buffer + 12, sizeof(uint32_t));
+		one ^= crc;
+
+		crc = slice16LUT[ 0][(four  >> 24)       ] ^ slice16LUT[ 1][(four  >> 16) & 0xFF]
+		    ^ slice16LUT[ 2][(four  >>  8) & 0xFF] ^ slice16LUT[ 3][ four         & 0xFF]
+		    ^ slice16LUT[ 4][(three >> 24)       ] ^ slice16LUT[ 5][(three >> 16) & 0xFF]
+		    ^ slice16LUT[ 6][(three >>  8) & 0xFF] ^ slice16LUT[ 7][ three        & 0xFF]
+		    ^ slice16LUT[ 8][(two   >> 24)       ] ^ slice16LUT[ 9][(two   >> 16) & 0xFF]
+		    ^ slice16LUT[10][(two   >>  8) & 0xFF] ^ slice16LUT[11][ two          & 0xFF]
+		    ^ slice16LUT[12][(one   >> 24)       ] ^ slice16LUT[13][(one   >> 16) & 0xFF]
+		    ^ slice16LUT[14][(one   >>  8) & 0xFF] ^ slice16LUT[15][ one          & 0xFF];
+
+		buffer += 16;
+		length -= 16;
+	}
+
+	while (length--) {
+		crc = (crc >> 8) ^ slice16LUT[0][(crc ^ *buffer++) & 0xFF];
+	}
+
+	return crc;
+}
+
+#if defined(__x86_64__)
+
+/*
+ * Folds four 128-bit lanes across each 64 bytes of input with carry-less
+ * multiplication, folds the lanes into one, and then reduces the remaining
+ * 128 bits to the 32-bit CRC with a Barrett reduction. Any tail of less than
+ * 16 bytes is finished with slicing-by-16.
+ */
+__attribute__((target("pclmul,sse2")))
+static uint32_t crc32Pclmul(const uint8_t *buffer, uint32_t length, uint32_t crc) {
+	const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+	const __m128i k5 = _mm_set_epi64x(0, 0x0163CD6124);
+	const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+	__m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+	if (length < PCLMUL_FOLD_SIZE) {
+		return crc32Slice16(buffer, length, crc);
+	}
+
+	// 1. Load the first 64 bytes into the four lanes
+	x1 = _mm_loadu_si128((const __m128i*) (buffer + 0x00));
+	x2 = _mm_loadu_si128((const __m128i*) (buffer + 0x10));
+	x3 = _mm_loadu_si128((const __m128i*) (buffer + 0x20));
+	x4 = _mm_loadu_si128((const __m128i*) (buffer + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+
+	buffer += PCLMUL_FOLD_SIZE;
+	length -= PCLMUL_FOLD_SIZE;
+
+	// 2. Fold each lane 512 bits forward onto the next 64 bytes
+	while (length >= PCLMUL_FOLD_SIZE) {
+		x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*) (buffer + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*) (buffer + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*) (buffer + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*) (buffer + 0x30)));
+
+		buffer += PCLMUL_FOLD_SIZE;
+		length -= PCLMUL_FOLD_SIZE;
+	}
+
+	// 3. Fold the four lanes into one
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// 4. Fold any remaining 16-byte blocks
+	while (length >= 16) {
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*) buffer));
+
+		buffer += 16;
+		length -= 16;
+	}
+
+	// 5. Fold 128 bits down to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// 6. Barrett reduction of the 64 bits down to the 32-bit CRC
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	crc = _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+
+	return crc32Slice16(buffer, length, crc);
+}
+
+#endif
+
+static void initCrc32() {
+	CPUID cpuid;
+	uint32_t crc;
+
+	// 1. Build the slicing-by-16 lookup tables
+	for (uint32_t i=0; i < 256; i++) {
+		crc = i;
+
+		for (int j=0; j < 8; j++) {
+			crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & -(crc & 1));
+		}
+
+		slice16LUT[0][i] = crc;
+	}
+
+	for (uint32_t i=0; i < 256; i++) {
+		for (int j=1; j < 16; j++) {
+			slice16LUT[j][i] = (slice16LUT[j-1][i] >> 8) ^ slice16LUT[0][slice16LUT[j-1][i] & 0xFF];
+		}
+	}
+
+	// 2. Build the x^(2^n) table starting from x^1
+	x2nModPLUT[0] = 0x40000000;
+
+	for (int n=1; n < 32; n++) {
+		x2nModPLUT[n] = multModP(x2nModPLUT[n-1], x2nModPLUT[n-1]);
+	}
+
+	// 3. Select the PCLMULQDQ folding implementation if the CPU supports it
+	crc32Function = crc32Slice16;
+
+#if defined(__x86_64__)
+	memset(&cpuid, 0, sizeof(CPUID));
+	f618482d_getProcessorInfo(&cpuid);
+
+	if (cpuid.hasPCLMULQDQ && cpuid.hasSSE2) {
+		crc32Function = crc32Pclmul;
+	}
+#endif
+}
@@ -20,9 +20,22 @@
  *
  * echo ORG_DEVOPSBROKER_HASH_CRC32 | md5sum | cut -c 25-32
  *
- * The algorithm used to calcualte the CRC-32 is the Half-Byte version found
- * at https://create.stephan-brumme.com/crc32/. It is documented below for
- * local reference since I implemented it in x86-64 assembly.
+ * b7e0468d_crc32 selects the fastest implementation for the CPU the first time
+ * it is called:
+ *
+ *   PCLMULQDQ    Folds four 128-bit lanes with carry-less multiplication
+ *   Slice16      Slicing-by-16 table lookups for CPUs without PCLMULQDQ
+ *
+ * Large buffers can be split into chunks that are checksummed independently,
+ * as b7e0468d_crc32Combine computes CRC(A + B) from CRC(A), CRC(B) and the
+ * length of B. Appending the length of B zero bits to CRC(A) is the same as
+ * multiplying it by x^(8 * length) modulo the CRC polynomial, and the powers
+ * x^(2^n) are precomputed so the multiplication costs one GF(2) product per
+ * set bit of the length.
+ *
+ * The original Half-Byte version found at https://create.stephan-brumme.com/crc32/
+ * is still available in x86-64 assembly as b7e0468d_crc32HalfByte. It is
+ * documented below for local reference.
  * -----------------------------------------------------------------------------
  */
 
@@ -32,11 +45,15 @@
 // ═════════════════════════════════ Includes ═════════════════════════════════
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <assert.h>
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
+// Smallest chunk b7e0468d_crc32Parallel hands to a worker thread
+#define CRC32_MIN_CHUNK_SIZE  (4 * 1024 * 1024)
+
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -61,6 +78,93 @@
  */
 uint32_t b7e0468d_crc32(void *buffer, uint32_t length, uint32_t crc32);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32Combine
+ * Description: Combines the CRC-32 values of two consecutive blocks of data
+ *
+ * Parameters:
+ *   crcA       The CRC-32 of the first block of data
+ *   crcB       The CRC-32 of the second block of data, started from zero
+ *   lengthB    The length of the second block of data
+ * Returns:     The CRC-32 of the first block followed by the second block
+ * ----------------------------------------------------------------------------
+ */
+uint32_t b7e0468d_crc32Combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32File
+ * Description: Calculates the CRC-32 of a file by memory mapping it and
+ *              checksumming it with b7e0468d_crc32Parallel
+ *
+ * Parameters:
+ *   pathName       The name of the file to calculate the CRC-32
+ *   numThreads     The maximum number of threads to use
+ *   crc32          Set to the calculated CRC-32 of the file
+ * Returns:     True if the file was read, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+bool b7e0468d_crc32File(const char *pathName, uint32_t numThreads, uint32_t *crc32);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32Parallel
+ * Description: Calculates the CRC-32 of a large buffer by splitting it into
+ *              one chunk per thread and combining the chunk CRC-32 values.
+ *              No chunk is smaller than CRC32_MIN_CHUNK_SIZE, so small buffers
+ *              are checksummed on the calling thread.
+ *
+ * Parameters:
+ *   buffer         A pointer to the data buffer to calculate the CRC-32
+ *   length         The length of the buffer to calculate
+ *   crc32          The initial CRC-32 value to start from (allows chunk calculations)
+ *   numThreads     The maximum number of threads to use
+ * Returns:     The calculated CRC-32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t b7e0468d_crc32Parallel(void *buffer, uint64_t length, uint32_t crc32, uint32_t numThreads);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32HalfByte
+ * Description: Calculates the CRC-32 of the input data for length bytes using
+ *              the Half-Byte lookup table; reads up to eight bytes past the
+ *              end of the buffer
+ *
+ * Parameters:
+ *   buffer     A pointer to the data buffer to calculate the CRC-32
+ *   length     The length of the buffer to calculate
+ *   crc32      The initial CRC-32 value to start from (allows chunk calculations)
+ * Returns:     The calculated CRC-32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t b7e0468d_crc32HalfByte(void *buffer, uint32_t length, uint32_t crc32);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32Pclmul
+ * Description: Calculates the CRC-32 of the input data for length bytes by
+ *              folding with the PCLMULQDQ instruction; the CPU must support it
+ *
+ * Parameters:
+ *   buffer     A pointer to the data buffer to calculate the CRC-32
+ *   length     The length of the buffer to calculate
+ *   crc32      The initial CRC-32 value to start from (allows chunk calculations)
+ * Returns:     The calculated CRC-32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t b7e0468d_crc32Pclmul(void *buffer, uint32_t length, uint32_t crc32);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    b7e0468d_crc32Slice16
+ * Description: Calculates the CRC-32 of the input data for length bytes using
+ *              slicing-by-16 lookup tables
+ *
+ * Parameters:
+ *   buffer     A pointer to the data buffer to calculate the CRC-32
+ *   length     The length of the buffer to calculate
+ *   crc32      The initial CRC-32 value to start from (allows chunk calculations)
+ * Returns:     The calculated CRC-32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t b7e0468d_crc32Slice16(void *buffer, uint32_t length, uint32_t crc32);
+
 /*
 	From https://create.stephan-brumme.com/crc32/#half-byte
 
@@ -22,7 +22,7 @@
 ; This file implements the following x86-64 assembly language functions for the
 ; org.devopsbroker.hash.crc32.h header file:
 ;
-;   o void b7e0468d_crc32(void *buffer, uint32_t length);
+;   o uint32_t b7e0468d_crc32HalfByte(void *buffer, uint32_t length, uint32_t crc32);
 ; -----------------------------------------------------------------------------
 ;
 
@@ -50,10 +50,10 @@ section .bss                ; RESX directives
 
 section .text               ; TEXT section
 
-; ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ b7e0468d_crc32 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+; ~~~~~~~~~~~~~~~~~~~~~~~~~~ b7e0468d_crc32HalfByte ~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-	global  b7e0468d_crc32:function
-b7e0468d_crc32:
+	global  b7e0468d_crc32HalfByte:function
+b7e0468d_crc32HalfByte:
 ; Parameters:
 ;	rdi : void *buffer
 ;	esi : uint32_t length
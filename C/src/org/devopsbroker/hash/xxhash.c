@@ -0,0 +1,202 @@
+/*
+ * xxhash.c - DevOpsBroker C source file for the xxHash32 hash functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The constants and mixing steps follow the xxHash specification at
+ * https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _DEFAULT_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <string.h>
+
+#include "xxhash.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define XXHASH32_PRIME1  2654435761U
+#define XXHASH32_PRIME2  2246822519U
+#define XXHASH32_PRIME3  3266489917U
+#define XXHASH32_PRIME4  668265263U
+#define XXHASH32_PRIME5  374761393U
+
+#define rotateLeft(value, count)  (((value) << (count)) | ((value) >> (32 - (count))))
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static inline uint32_t readLane(const uint8_t *bytePtr);
+static inline uint32_t mixLane(uint32_t acc, uint32_t lane);
+static const uint8_t *hashStripes(uint32_t *acc, const uint8_t *bytePtr, uint32_t numStripes);
+static uint32_t finishHash(uint32_t hash, const uint8_t *bytePtr, uint32_t length);
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void e0ee98a1_initXXHash32(XXHash32 *xxHash, uint32_t seed) {
+	xxHash->acc[0] = seed + XXHASH32_PRIME1 + XXHASH32_PRIME2;
+	xxHash->acc[1] = seed + XXHASH32_PRIME2;
+	xxHash->acc[2] = seed;
+	xxHash->acc[3] = seed - XXHASH32_PRIME1;
+	xxHash->totalLength = 0;
+	xxHash->seed = seed;
+	xxHash->stripeLength = 0;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+uint32_t e0ee98a1_xxHash32(void *buffer, uint32_t length, uint32_t seed) {
+	const uint8_t *bytePtr = buffer;
+	uint32_t acc[4];
+	uint32_t hash;
+
+	if (length >= XXHASH32_STRIPE_SIZE) {
+		acc[0] = seed + XXHASH32_PRIME1 + XXHASH32_PRIME2;
+		acc[1] = seed + XXHASH32_PRIME2;
+		acc[2] = seed;
+		acc[3] = seed - XXHASH32_PRIME1;
+
+		bytePtr = hashStripes(acc, bytePtr, length / XXHASH32_STRIPE_SIZE);
+		hash = rotateLeft(acc[0], 1) + rotateLeft(acc[1], 7) + rotateLeft(acc[2], 12) + rotateLeft(acc[3], 18);
+	} else {
+		hash = seed + XXHASH32_PRIME5;
+	}
+
+	return finishHash(hash + length, bytePtr, length % XXHASH32_STRIPE_SIZE);
+}
+
+void e0ee98a1_updateXXHash32(XXHash32 *xxHash, void *buffer, uint32_t length) {
+	const uint8_t *bytePtr = buffer;
+	uint32_t numBytes;
+
+	xxHash->totalLength += length;
+
+	// 1. Complete the partial stripe left over from the last chunk
+	if (xxHash->stripeLength > 0) {
+		numBytes = XXHASH32_STRIPE_SIZE - xxHash->stripeLength;
+
+		if (length < numBytes) {
+			memcpy(xxHash->stripe + xxHash->stripeLength, bytePtr, length);
+			xxHash->stripeLength += length;
+			return;
+		}
+
+		memcpy(xxHash->stripe + xxHash->stripeLength, bytePtr, numBytes);
+		hashStripes(xxHash->acc, xxHash->stripe, 1);
+		bytePtr += numBytes;
+		length -= numBytes;
+	}
+
+	// 2. Hash the whole stripes of the chunk in place
+	bytePtr = hashStripes(xxHash->acc, bytePtr, length / XXHASH32_STRIPE_SIZE);
+
+	// 3. Keep the rest of the chunk for the next call
+	xxHash->stripeLength = length % XXHASH32_STRIPE_SIZE;
+	memcpy(xxHash->stripe, bytePtr, xxHash->stripeLength);
+}
+
+uint32_t e0ee98a1_digestXXHash32(XXHash32 *xxHash) {
+	uint32_t hash;
+
+	if (xxHash->totalLength >= XXHASH32_STRIPE_SIZE) {
+		hash = rotateLeft(xxHash->acc[0], 1) + rotateLeft(xxHash->acc[1], 7)
+		     + rotateLeft(xxHash->acc[2], 12) + rotateLeft(xxHash->acc[3], 18);
+	} else {
+		hash = xxHash->seed + XXHASH32_PRIME5;
+	}
+
+	// The length is added modulo 2^32
+	return finishHash(hash + (uint32_t) xxHash->totalLength, xxHash->stripe, xxHash->stripeLength);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static inline uint32_t readLane(const uint8_t *bytePtr) {
+	uint32_t lane;
+
+	memcpy(&lane, bytePtr, sizeof(uint32_t));
+
+	return lane;
+}
+
+static inline uint32_t mixLane(uint32_t acc, uint32_t lane) {
+	acc += lane * XXHASH32_PRIME2;
+	acc = rotateLeft(acc, 13);
+
+	return acc * XXHASH32_PRIME1;
+}
+
+static const uint8_t *hashStripes(uint32_t *acc, const uint8_t *bytePtr, uint32_t numStripes) {
+	uint32_t acc0 = acc[0], acc1 = acc[1], acc2 = acc[2], acc3 = acc[3];
+
+	// Keep the accumulators in registers across the stripes
+	while (numStripes > 0) {
+		acc0 = mixLane(acc0, readLane(bytePtr));
+		acc1 = mixLane(acc1, readLane(bytePtr + 4));
+		acc2 = mixLane(acc2, readLane(bytePtr + 8));
+		acc3 = mixLane(acc3, readLane(bytePtr + 12));
+
+		bytePtr += XXHASH32_STRIPE_SIZE;
+		numStripes--;
+	}
+
+	acc[0] = acc0;
+	acc[1] = acc1;
+	acc[2] = acc2;
+	acc[3] = acc3;
+
+	return bytePtr;
+}
+
+static uint32_t finishHash(uint32_t hash, const uint8_t *bytePtr, uint32_t length) {
+	// 1. Mix in the remaining bytes four and then one at a time
+	while (length >= 4) {
+		hash += readLane(bytePtr) * XXHASH32_PRIME3;
+		hash = rotateLeft(hash, 17) * XXHASH32_PRIME4;
+		bytePtr += 4;
+		length -= 4;
+	}
+
+	while (length > 0) {
+		hash += (*bytePtr++) * XXHASH32_PRIME5;
+		hash = rotateLeft(hash, 11) * XXHASH32_PRIME1;
+		length--;
+	}
+
+	// 2. Avalanche
+	hash ^= hash >> 15;
+	hash *= XXHASH32_PRIME2;
+	hash ^= hash >> 13;
+	hash *= XXHASH32_PRIME3;
+	hash ^= hash >> 16;
+
+	return hash;
+}
@@ -0,0 +1,123 @@
+/*
+ * xxhash.h - DevOpsBroker C header file for the xxHash32 hash functionality
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * echo ORG_DEVOPSBROKER_HASH_XXHASH_H | md5sum | cut -c 25-32
+ *
+ * xxHash32 is the checksum of the LZ4 frame format. The input is consumed in
+ * 16-byte stripes by four independent accumulators, so the multiplications of
+ * consecutive 4-byte lanes overlap in the pipeline. Inputs of less than 16
+ * bytes skip the accumulators, and the tail of every input is mixed in four
+ * bytes and then one byte at a time before the final avalanche.
+ *
+ * An XXHash32 struct hashes input that arrives in chunks of any size; the
+ * part of a stripe left over from one chunk is buffered until the next.
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_HASH_XXHASH_H
+#define ORG_DEVOPSBROKER_HASH_XXHASH_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+
+#include <assert.h>
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define XXHASH32_STRIPE_SIZE  16
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+/*
+ * XXHash32
+ *   - The four stripe accumulators
+ *   - Partial stripe left over from the last chunk
+ *   - Total length hashed so far
+ *   - Seed and length of the partial stripe
+ */
+typedef struct XXHash32 {
+	uint32_t acc[4];
+	uint8_t  stripe[XXHASH32_STRIPE_SIZE];
+	uint64_t totalLength;
+	uint32_t seed;
+	uint32_t stripeLength;
+} XXHash32;
+
+static_assert(sizeof(XXHash32) == 48, "Check your assumptions");
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Init/Clean Up Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e0ee98a1_initXXHash32
+ * Description: Initializes an XXHash32 struct to hash a new input
+ *
+ * Parameters:
+ *   xxHash     A pointer to the XXHash32 instance to initialize
+ *   seed       The seed of the hash
+ * ----------------------------------------------------------------------------
+ */
+void e0ee98a1_initXXHash32(XXHash32 *xxHash, uint32_t seed);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e0ee98a1_xxHash32
+ * Description: Calculates the xxHash32 of the input data for length bytes
+ *
+ * Parameters:
+ *   buffer     A pointer to the data buffer to hash
+ *   length     The length of the buffer to hash
+ *   seed       The seed of the hash
+ * Returns:     The xxHash32 of the buffer
+ * ----------------------------------------------------------------------------
+ */
+uint32_t e0ee98a1_xxHash32(void *buffer, uint32_t length, uint32_t seed);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e0ee98a1_updateXXHash32
+ * Description: Adds the next chunk of the input to the hash
+ *
+ * Parameters:
+ *   xxHash     A pointer to the XXHash32 instance
+ *   buffer     A pointer to the next chunk of the input
+ *   length     The length of the chunk
+ * ----------------------------------------------------------------------------
+ */
+void e0ee98a1_updateXXHash32(XXHash32 *xxHash, void *buffer, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e0ee98a1_digestXXHash32
+ * Description: Returns the xxHash32 of the input added so far; more input can
+ *              still be added afterwards
+ *
+ * Parameters:
+ *   xxHash     A pointer to the XXHash32 instance
+ * Returns:     The xxHash32 of the input added so far
+ * ----------------------------------------------------------------------------
+ */
+uint32_t e0ee98a1_digestXXHash32(XXHash32 *xxHash);
+
+#endif /* ORG_DEVOPSBROKER_HASH_XXHASH_H */
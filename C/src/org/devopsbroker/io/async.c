@@ -28,9 +28,14 @@
 // ═════════════════════════════════ Includes ═════════════════════════════════
 
 #include <stdlib.h>
+#include <time.h>
 
 #include <unistd.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 #include <sys/syscall.h>
 
 #include "async.h"
@@ -45,7 +50,12 @@
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
 #define ASYNC_MAX_REQUEST_QUEUE_CAPACITY  2048
-#define ASYNC_TIMEOUT_NSEC  6000000
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ASYNC_CPU_RELAX()  __builtin_ia32_pause()
+#else
+#define ASYNC_CPU_RELAX()  __asm__ __volatile__("" ::: "memory")
+#endif
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -65,10 +75,18 @@ static_assert(sizeof(AIORequestPool) == 28, "Check your assumptions");
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
-AIORequestPool aioRequestPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
+__thread AIORequestPool aioRequestPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
+static AIOStats *createAIOStats();
+static AIORing *getAIORing(aio_context_t aioContextId);
+static int64_t getMonotonicTime();
+static uint64_t readTicks();
+static uint32_t getLog2Bucket(uint64_t value, uint32_t numBuckets);
+static void recordLatency(AIOStats *aioStats, AIOEvent *eventList, int32_t numEvents);
+static int32_t reapEvents(AIOContext *aioContext, AIOEvent *eventList, uint32_t maxEvents);
+static uint32_t readAIORing(AIORing *aioRing, AIOEvent *eventList, uint32_t maxEvents);
 
 // ═════════════════════════ Function Implementations ═════════════════════════
 
@@ -83,7 +101,8 @@ AIORequest *f1207515_acquireAIORequest() {
 	}
 
 	if (aioRequestPool.structStack.length == 0) {
-		// Acquire new FileBuffer from the memory pool
+		// Acquire new AIORequest from the memory pool; memory recycled from another
+		// thread is not zeroed, so f1207515_read() and f1207515_write() set every field
 		aioRequest = f502a409_acquireMemory(sizeof(AIORequest));
 		aioRequestPool.numAIORequestAlloc++;
 	} else {
@@ -108,6 +127,20 @@ void f1207515_releaseAIORequest(AIORequest *aioRequest) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
+void f1207515_destroyAIORequestPool(bool debug) {
+	if (debug) {
+		puts("AIORequestPool Statistics:");
+		printf("\tNumber of AIORequests Allocated: %u\n", aioRequestPool.numAIORequestAlloc);
+		printf("\tNumber of AIORequests Free:      %u\n", aioRequestPool.numAIORequestFree);
+		printf("\tNumber of AIORequests In Use     %u\n", aioRequestPool.numAIORequestInUse);
+		printf("\tNumber of AIORequests Used:      %u\n", aioRequestPool.numAIORequestUsed);
+		printf("\n");
+	}
+
+	// Clean up the struct stack
+	f106c0ab_cleanUpStackArray(&aioRequestPool.structStack, NULL);
+}
+
 AIOContext *f1207515_createAIOContext(uint32_t maxOperations) {
 	AIOContext *aioContext;
 	aio_context_t aioContextId;
@@ -132,9 +165,10 @@ AIOContext *f1207515_createAIOContext(uint32_t maxOperations) {
 
 	aioContext->id = aioContextId;
 	aioContext->requestQueue = b8da7268_createQueueBounded(maxOperations);
-	aioContext->timeout.tv_sec = 0;
-	aioContext->timeout.tv_nsec = ASYNC_TIMEOUT_NSEC;
+	aioContext->stats = createAIOStats();
+	aioContext->ring = getAIORing(aioContextId);
 	aioContext->maxOperations = maxOperations;
+	aioContext->spinLimit = ASYNC_MIN_SPIN_LIMIT;
 
 	return aioContext;
 }
@@ -151,6 +185,7 @@ int f1207515_destroyAIOContext(AIOContext *aioContext) {
 	}
 
 	b8da7268_destroyQueueBounded(aioContext->requestQueue);
+	f668c4bd_free(aioContext->stats);
 	f668c4bd_free(aioContext);
 
 	return 0;
@@ -170,6 +205,7 @@ int f1207515_cleanUpAIOContext(AIOContext *aioContext) {
 	}
 
 	b8da7268_destroyQueueBounded(aioContext->requestQueue);
+	f668c4bd_free(aioContext->stats);
 
 	return 0;
 }
@@ -196,9 +232,10 @@ int f1207515_initAIOContext(AIOContext *aioContext, uint32_t maxOperations) {
 
 	aioContext->id = aioContextId;
 	aioContext->requestQueue = b8da7268_createQueueBounded(maxOperations);
-	aioContext->timeout.tv_sec = 0;
-	aioContext->timeout.tv_nsec = ASYNC_TIMEOUT_NSEC;
+	aioContext->stats = createAIOStats();
+	aioContext->ring = getAIORing(aioContextId);
 	aioContext->maxOperations = maxOperations;
+	aioContext->spinLimit = ASYNC_MIN_SPIN_LIMIT;
 
 	return 0;
 }
@@ -232,6 +269,16 @@ void f1207515_initAIOTicket(AIOTicket *aioTicket) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+int f1207515_allocate(AIOFile *aioFile, int64_t length) {
+	if (fallocate(aioFile->fd, 0, 0, length) == SYSTEM_ERROR_CODE) {
+		return SYSTEM_ERROR_CODE;
+	}
+
+	aioFile->fileSize = length;
+
+	return 0;
+}
+
 int f1207515_create(AIOFile *aioFile, FileAccessMode aMode, int flags, uint32_t mode) {
 	if (aMode == FOPEN_READONLY) {
 		StringBuilder errorMessage;
@@ -276,6 +323,7 @@ AIORequest *f1207515_read(AIOFile *aioFile, void *buf, size_t bufSize) {
 	aioReadRequest = f1207515_acquireAIORequest();
 
 	aioReadRequest->aio_data = 0;
+	aioReadRequest->aio_rw_flags = 0;
 	aioReadRequest->aio_fildes = aioFile->fd;
 	aioReadRequest->aio_lio_opcode = AIO_READ;
 	aioReadRequest->aio_reqprio = 0;
@@ -288,6 +336,7 @@ AIORequest *f1207515_read(AIOFile *aioFile, void *buf, size_t bufSize) {
 	aioReadRequest->aio_offset = aioFile->offset;
 	aioReadRequest->aio_flags = 0;
 	aioReadRequest->aio_resfd = 0;
+	aioReadRequest->aio_reserved2 = 0;
 	aioFile->offset += bufSize;
 
 	// Keep track of some metrics
@@ -313,6 +362,7 @@ AIORequest *f1207515_write(AIOFile *aioFile, void *buf, size_t count) {
 	aioWriteRequest = f1207515_acquireAIORequest();
 
 	aioWriteRequest->aio_data = 0;
+	aioWriteRequest->aio_rw_flags = 0;
 	aioWriteRequest->aio_fildes = aioFile->fd;
 	aioWriteRequest->aio_lio_opcode = AIO_WRITE;
 	aioWriteRequest->aio_reqprio = 0;
@@ -325,6 +375,7 @@ AIORequest *f1207515_write(AIOFile *aioFile, void *buf, size_t count) {
 	aioWriteRequest->aio_offset = aioFile->offset;
 	aioWriteRequest->aio_flags = 0;
 	aioWriteRequest->aio_resfd = 0;
+	aioWriteRequest->aio_reserved2 = 0;
 	aioFile->offset += count;
 
 	// Keep track of some metrics
@@ -337,10 +388,38 @@ AIORequest *f1207515_write(AIOFile *aioFile, void *buf, size_t count) {
 	return aioWriteRequest;
 }
 
+ssize_t f1207515_writeBuffered(AIOFile *aioFile, void *buf, size_t count) {
+	ssize_t numBytes;
+	int statusFlags;
+
+	// 1. Clear O_DIRECT so the unaligned write goes through the page cache
+	statusFlags = fcntl(aioFile->fd, F_GETFL);
+
+	if (statusFlags == SYSTEM_ERROR_CODE) {
+		return SYSTEM_ERROR_CODE;
+	}
+
+	if ((statusFlags & O_DIRECT) && fcntl(aioFile->fd, F_SETFL, statusFlags & ~O_DIRECT) == SYSTEM_ERROR_CODE) {
+		return SYSTEM_ERROR_CODE;
+	}
+
+	// 2. Write the data at the current AIOFile offset
+	numBytes = pwrite(aioFile->fd, buf, count, aioFile->offset);
+
+	if (numBytes > 0) {
+		aioFile->offset += numBytes;
+		aioFile->aioContext->numBytesWrite += numBytes;
+	}
+
+	return numBytes;
+}
+
 bool f1207515_submit(AIOFile *aioFile) {
 	AIORequest *aioRequest;
 	AIOContext *aioContext;
 	AIOTicket *aioTicket;
+	AIOStats *aioStats;
+	uint64_t submitTicks;
 	int numRequests = 0;
 	long retValue;
 
@@ -359,15 +438,34 @@ bool f1207515_submit(AIOFile *aioFile) {
 		numRequests++;
 	}
 
-	aioTicket->numRequests = numRequests;
+	// Sample the queue depth and timestamp the requests with the TSC
+	aioStats = aioContext->stats;
+	aioStats->queueDepthList[getLog2Bucket(aioStats->numInFlight, ASYNC_QUEUE_DEPTH_NUM_BUCKETS)]++;
+	submitTicks = readTicks();
+
+	for (int i=0; i < numRequests; i++) {
+		aioTicket->requestList[i]->aio_data = submitTicks;
+	}
 
 	retValue = syscall(__NR_io_submit, aioContext->id, numRequests, aioTicket->requestList);
 
-	if (retValue < 0) {
-		errno = -retValue;
+	// Only wait on the accepted requests; requeue the rest for the next submit
+	aioTicket->numRequests = (retValue < 0) ? 0 : retValue;
+
+	for (int i=aioTicket->numRequests; i < numRequests; i++) {
+		b8da7268_enqueue(aioContext->requestQueue, aioTicket->requestList[i]);
+	}
+
+	if (retValue <= 0) {
 		return false;
 	}
 
+	aioStats->numInFlight += retValue;
+
+	if (aioStats->numInFlight > aioStats->maxQueueDepth) {
+		aioStats->maxQueueDepth = aioStats->numInFlight;
+	}
+
 	return true;
 }
 
@@ -375,39 +473,46 @@ int32_t f1207515_getEvents(AIOFile *aioFile) {
 	AIORequest *aioRequest;
 	AIOContext *aioContext;
 	AIOTicket *aioTicket;
-	long retValue;
+	AIOEvent *eventList;
+	int32_t numEvents;
 
 	aioContext = aioFile->aioContext;
 	aioTicket = &aioFile->aioTicket;
 
-	retValue = syscall(__NR_io_getevents, aioContext->id, 1, aioTicket->numRequests,
-		    aioTicket->eventList, &aioContext->timeout);
+	// Nothing to wait for if every request has already completed
+	if (aioTicket->numEvents >= aioTicket->numRequests) {
+		return 0;
+	}
 
-	if (retValue < 0) {
-		errno = -retValue;
+	// Append to the events already received for this AIOTicket
+	eventList = &aioTicket->eventList[aioTicket->numEvents];
+	numEvents = reapEvents(aioContext, eventList, aioTicket->numRequests - aioTicket->numEvents);
+
+	if (numEvents < 0) {
 		return SYSTEM_ERROR_CODE;
 	}
 
 	// Keep track of some metrics
-	aioTicket->numEvents += retValue;
+	aioTicket->numEvents += numEvents;
+	recordLatency(aioContext->stats, eventList, numEvents);
 
-	for (uint32_t i=0; i < retValue; i++) {
+	for (int32_t i=0; i < numEvents; i++) {
 		#if __SIZEOF_POINTER__ == 8
-		aioRequest = (AIORequest*) aioTicket->eventList[i].obj;
+		aioRequest = (AIORequest*) eventList[i].obj;
 		#elif  __SIZEOF_POINTER__ == 4
-		aioRequest = (AIORequest*) ((uint32_t) aioTicket->eventList[i].obj);
+		aioRequest = (AIORequest*) ((uint32_t) eventList[i].obj);
 		#endif
 
 		if (aioRequest->aio_lio_opcode == AIO_READ) {
-			aioContext->numBytesRead += aioTicket->eventList[i].res;
-			aioTicket->numBytesRead += aioTicket->eventList[i].res;
+			aioContext->numBytesRead += eventList[i].res;
+			aioTicket->numBytesRead += eventList[i].res;
 		} else if (aioRequest->aio_lio_opcode == AIO_WRITE) {
-			aioContext->numBytesWrite += aioTicket->eventList[i].res;
-			aioTicket->numBytesWrite += aioTicket->eventList[i].res;
+			aioContext->numBytesWrite += eventList[i].res;
+			aioTicket->numBytesWrite += eventList[i].res;
 		}
 	}
 
-	return retValue;
+	return numEvents;
 }
 
 void f1207515_printContext(AIOContext *aioContext) {
@@ -419,6 +524,8 @@ void f1207515_printContext(AIOContext *aioContext) {
 	printf("\tNum Bytes Read:     %ld bytes\n", aioContext->numBytesRead);
 	printf("\tNum Write Requests: %u\n", aioContext->numWriteRequests);
 	printf("\tNum Bytes Written:  %ld bytes\n", aioContext->numBytesWrite);
+	printf("\tNum Ring Events:    %u\n", aioContext->numRingEvents);
+	printf("\tSpin Limit:         %u\n", aioContext->spinLimit);
 	#elif  __SIZEOF_POINTER__ == 4
 	printf("AIOContext ID: %lu\n", aioContext->id);
 	printf("\tMax Operations:     %u\n", aioContext->maxOperations);
@@ -427,10 +534,71 @@ void f1207515_printContext(AIOContext *aioContext) {
 	printf("\tNum Bytes Read:     %lld bytes\n", aioContext->numBytesRead);
 	printf("\tNum Write Requests: %u\n", aioContext->numWriteRequests);
 	printf("\tNum Bytes Written:  %lld bytes\n", aioContext->numBytesWrite);
+	printf("\tNum Ring Events:    %u\n", aioContext->numRingEvents);
+	printf("\tSpin Limit:         %u\n", aioContext->spinLimit);
 	#endif
 	printf("\n");
 }
 
+void f1207515_getStats(AIOContext *aioContext, AIOStats *aioStats) {
+	// 1. Copy the current statistics
+	f668c4bd_memcopy(aioContext->stats, aioStats, sizeof(AIOStats));
+
+#if defined(__x86_64__) || defined(__i386__)
+	// 2. Calibrate the TSC against the monotonic clock since initialization
+	uint64_t elapsedTicks = readTicks() - aioStats->startTicks;
+	int64_t elapsedTime = getMonotonicTime() - aioStats->startTime;
+
+	aioStats->ticksPerNanosec = (elapsedTime > 0) ? ((double) elapsedTicks) / elapsedTime : 0.0;
+#else
+	// 2. Without a TSC the ticks are already nanoseconds
+	aioStats->ticksPerNanosec = 1.0;
+#endif
+}
+
+void f1207515_printStats(AIOStats *aioStats) {
+	static const char *opcodeNames[AIOSTATS_NUM_OPCODES] = { "Read", "Write", "Other" };
+	AIOLatency *aioLatency;
+	double ticksPerNanosec;
+
+	ticksPerNanosec = (aioStats->ticksPerNanosec > 0.0) ? aioStats->ticksPerNanosec : 1.0;
+
+	printf("AIOStats:\n");
+	printf("\tTicks Per Nanosec:  %.3f\n", aioStats->ticksPerNanosec);
+	printf("\tNum In Flight:      %u\n", aioStats->numInFlight);
+	printf("\tMax Queue Depth:    %u\n", aioStats->maxQueueDepth);
+
+	for (uint32_t i=0; i < AIOSTATS_NUM_OPCODES; i++) {
+		aioLatency = &aioStats->latencyList[i];
+
+		if (aioLatency->numSamples == 0) {
+			continue;
+		}
+
+		printf("\t%s Latency:\n", opcodeNames[i]);
+		printf("\t\tNum Samples:    %llu\n", (unsigned long long) aioLatency->numSamples);
+		printf("\t\tMean:           %.0f ns\n", aioLatency->totalTicks / ticksPerNanosec / aioLatency->numSamples);
+		printf("\t\tMax:            %.0f ns\n", aioLatency->maxTicks / ticksPerNanosec);
+
+		for (uint32_t j=0; j < ASYNC_LATENCY_NUM_BUCKETS; j++) {
+			if (aioLatency->bucketList[j] > 0) {
+				printf("\t\t< %12.0f ns: %llu\n", ((double) (2ULL << j)) / ticksPerNanosec,
+				       (unsigned long long) aioLatency->bucketList[j]);
+			}
+		}
+	}
+
+	printf("\tQueue Depth:\n");
+
+	for (uint32_t i=0; i < ASYNC_QUEUE_DEPTH_NUM_BUCKETS; i++) {
+		if (aioStats->queueDepthList[i] > 0) {
+			printf("\t\t< %5u: %llu\n", 2U << i, (unsigned long long) aioStats->queueDepthList[i]);
+		}
+	}
+
+	printf("\n");
+}
+
 void f1207515_printTicket(AIOTicket *aioTicket) {
 	AIORequest *requestPtr;
 
@@ -489,3 +657,170 @@ void f1207515_printTicket(AIOTicket *aioTicket) {
 
 	printf("\n");
 }
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static AIOStats *createAIOStats() {
+	AIOStats *aioStats = f668c4bd_malloc(sizeof(AIOStats));
+
+	f668c4bd_meminit(aioStats, sizeof(AIOStats));
+
+	// Pair the TSC with the monotonic clock for later calibration
+	aioStats->startTime = getMonotonicTime();
+	aioStats->startTicks = readTicks();
+
+	return aioStats;
+}
+
+static AIORing *getAIORing(aio_context_t aioContextId) {
+	AIORing *aioRing;
+
+	#if __SIZEOF_POINTER__ == 8
+	aioRing = (AIORing*) aioContextId;
+	#elif  __SIZEOF_POINTER__ == 4
+	aioRing = (AIORing*) ((uint32_t) aioContextId);
+	#endif
+
+	// Only read the ring if its layout is the one we know about
+	if (aioRing->magic != ASYNC_AIORING_MAGIC || aioRing->incompatFeatures != 0) {
+		return NULL;
+	}
+
+	return aioRing;
+}
+
+static int32_t reapEvents(AIOContext *aioContext, AIOEvent *eventList, uint32_t maxEvents) {
+	uint32_t numEvents;
+	long retValue;
+
+	if (aioContext->ring != NULL) {
+		// 1. Fast path: completions are already waiting in the ring
+		numEvents = readAIORing(aioContext->ring, eventList, maxEvents);
+
+		// 2. Spin on the ring tail up to the adaptive spin limit
+		for (uint32_t i=0; numEvents == 0 && i < aioContext->spinLimit; i++) {
+			ASYNC_CPU_RELAX();
+			numEvents = readAIORing(aioContext->ring, eventList, maxEvents);
+
+			if (numEvents > 0 && aioContext->spinLimit < ASYNC_MAX_SPIN_LIMIT) {
+				aioContext->spinLimit <<= 1;
+			}
+		}
+
+		if (numEvents > 0) {
+			aioContext->numRingEvents += numEvents;
+			return numEvents;
+		}
+
+		// Spinning did not pay off this time
+		if (aioContext->spinLimit > ASYNC_MIN_SPIN_LIMIT) {
+			aioContext->spinLimit >>= 1;
+		}
+	}
+
+	// 3. Block in the kernel until at least one event completes
+	do {
+		retValue = syscall(__NR_io_getevents, aioContext->id, 1, maxEvents, eventList, NULL);
+	} while (retValue == -1 && errno == EINTR);
+
+	if (retValue < 0) {
+		return SYSTEM_ERROR_CODE;
+	}
+
+	return retValue;
+}
+
+static uint32_t readAIORing(AIORing *aioRing, AIOEvent *eventList, uint32_t maxEvents) {
+	uint32_t numEvents;
+	uint32_t head;
+	uint32_t tail;
+
+	// The head is only advanced by this consumer; the tail is written by the
+	// kernel and must be read before the events it publishes
+	head = aioRing->head;
+	tail = __atomic_load_n(&aioRing->tail, __ATOMIC_ACQUIRE);
+	numEvents = 0;
+
+	while (head != tail && numEvents < maxEvents) {
+		eventList[numEvents++] = aioRing->eventList[head];
+
+		if (++head == aioRing->numEvents) {
+			head = 0;
+		}
+	}
+
+	// Publish the new head only after the events have been copied out
+	if (numEvents > 0) {
+		__atomic_store_n(&aioRing->head, head, __ATOMIC_RELEASE);
+	}
+
+	return numEvents;
+}
+
+static int64_t getMonotonicTime() {
+	struct timespec timeSpec;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeSpec);
+
+	return (((int64_t) timeSpec.tv_sec) * 1000000000) + timeSpec.tv_nsec;
+}
+
+static uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec timeSpec;
+
+	// Without a TSC the coarse monotonic clock is cheap enough to read per request
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &timeSpec);
+
+	return (((uint64_t) timeSpec.tv_sec) * 1000000000) + timeSpec.tv_nsec;
+#endif
+}
+
+static uint32_t getLog2Bucket(uint64_t value, uint32_t numBuckets) {
+	uint32_t bucket;
+
+	// Values of zero and one both land in the first bucket
+	bucket = (value > 1) ? 63 - __builtin_clzll(value) : 0;
+
+	return (bucket < numBuckets) ? bucket : numBuckets - 1;
+}
+
+static void recordLatency(AIOStats *aioStats, AIOEvent *eventList, int32_t numEvents) {
+	AIORequest *aioRequest;
+	AIOLatency *aioLatency;
+	uint64_t completeTicks;
+	uint64_t latencyTicks;
+
+	// One TSC read covers every event reaped in this batch
+	completeTicks = readTicks();
+	aioStats->numInFlight -= numEvents;
+
+	for (int32_t i=0; i < numEvents; i++) {
+		#if __SIZEOF_POINTER__ == 8
+		aioRequest = (AIORequest*) eventList[i].obj;
+		#elif  __SIZEOF_POINTER__ == 4
+		aioRequest = (AIORequest*) ((uint32_t) eventList[i].obj);
+		#endif
+
+		if (aioRequest->aio_lio_opcode == AIO_READ) {
+			aioLatency = &aioStats->latencyList[AIOSTATS_READ];
+		} else if (aioRequest->aio_lio_opcode == AIO_WRITE) {
+			aioLatency = &aioStats->latencyList[AIOSTATS_WRITE];
+		} else {
+			aioLatency = &aioStats->latencyList[AIOSTATS_OTHER];
+		}
+
+		// The event data field carries the submit timestamp from aio_data
+		latencyTicks = completeTicks - eventList[i].data;
+
+		aioLatency->bucketList[getLog2Bucket(latencyTicks, ASYNC_LATENCY_NUM_BUCKETS)]++;
+		aioLatency->numSamples++;
+		aioLatency->totalTicks += latencyTicks;
+
+		if (latencyTicks > aioLatency->maxTicks) {
+			aioLatency->maxTicks = latencyTicks;
+		}
+	}
+}
@@ -56,6 +56,14 @@
 
 #define ASYNC_AIOTICKET_MAXSIZE  32768
 
+#define ASYNC_AIORING_MAGIC  0xa10a10a1
+
+#define ASYNC_MIN_SPIN_LIMIT  64
+#define ASYNC_MAX_SPIN_LIMIT  16384
+
+#define ASYNC_LATENCY_NUM_BUCKETS      40
+#define ASYNC_QUEUE_DEPTH_NUM_BUCKETS  16
+
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
 /*
@@ -166,36 +174,107 @@ typedef struct io_event AIOEvent;
 static_assert(sizeof(AIOEvent) == 32, "Check your assumptions");
 
 /*
- * Amount of Time to Wait for Events
- *   time_t     tv_sec;
- *     - number of seconds to wait
- *   long       tv_nsec;
- *     - number of nanoseconds to wait [0 .. 999999999]
+ * Linux AIO Completion Ring
+ *   - The aio_context_t returned by io_setup() is the address of this ring,
+ *     which the kernel maps into the process address space
+ *   - The kernel produces io_events at the tail and the consumer advances
+ *     the head; events can be reaped without entering the kernel
+ *   - Only usable when magic is ASYNC_AIORING_MAGIC and incompatFeatures is 0
  */
-typedef struct timespec WaitTime;
+typedef struct AIORing {
+	uint32_t id;
+	uint32_t numEvents;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t magic;
+	uint32_t compatFeatures;
+	uint32_t incompatFeatures;
+	uint32_t headerLength;
+	AIOEvent eventList[];
+} AIORing;
+
+static_assert(sizeof(AIORing) == 32, "Check your assumptions");
 
-#if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(WaitTime) == 16, "Check your assumptions");
-#elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(WaitTime) == 8, "Check your assumptions");
-#endif
+/*
+ * AIO Statistics Opcodes
+ *   - Latency histograms are kept separately for reads, writes and every
+ *     other AIOCommand
+ */
+typedef enum AIOStatsOpcode {
+	AIOSTATS_READ = 0,
+	AIOSTATS_WRITE = 1,
+	AIOSTATS_OTHER = 2,
+	AIOSTATS_NUM_OPCODES = 3
+} AIOStatsOpcode;
+
+/*
+ * AIO Latency Histogram
+ *   - bucketList[i] counts the requests that completed within [2^i, 2^(i+1))
+ *     TSC ticks of being submitted; the last bucket also counts anything slower
+ *   - totalTicks and maxTicks give the mean and worst-case latency
+ */
+typedef struct AIOLatency {
+	uint64_t bucketList[ASYNC_LATENCY_NUM_BUCKETS];
+	uint64_t numSamples;
+	uint64_t totalTicks;
+	uint64_t maxTicks;
+} AIOLatency;
+
+static_assert(sizeof(AIOLatency) == 344, "Check your assumptions");
+
+/*
+ * AIO Statistics
+ *   - Latency histograms per AIOStatsOpcode, measured with the TSC from
+ *     io_submit() to the time the completion was reaped
+ *   - queueDepthList[i] counts the submits made while [2^i, 2^(i+1)) requests
+ *     were already in flight; bucket zero also counts an idle queue
+ *   - f1207515_submit() stores the TSC in each aio_data field, which the
+ *     kernel hands back in the data field of the matching AIOEvent
+ *   - startTicks/startTime pair the TSC with CLOCK_MONOTONIC when the
+ *     AIOContext was initialized; ticksPerNanosec is only filled in by a
+ *     f1207515_getStats() snapshot
+ *   - Without a TSC (non-x86 builds) ticks are CLOCK_MONOTONIC_COARSE
+ *     nanoseconds and ticksPerNanosec is always one
+ */
+typedef struct AIOStats {
+	AIOLatency latencyList[AIOSTATS_NUM_OPCODES];
+	uint64_t   queueDepthList[ASYNC_QUEUE_DEPTH_NUM_BUCKETS];
+	uint64_t   startTicks;
+	int64_t    startTime;
+	double     ticksPerNanosec;
+	uint32_t   numInFlight;
+	uint32_t   maxQueueDepth;
+} AIOStats;
+
+static_assert(sizeof(AIOStats) == 1192, "Check your assumptions");
 
+/*
+ * AIOContext
+ *   - stats holds the latency and queue depth histograms of the AIOContext
+ *   - ring is NULL when the completion ring cannot be read from user space
+ *   - spinLimit is the number of ring polls made before blocking in
+ *     io_getevents(); it doubles each time spinning finds a completion and
+ *     halves each time it does not
+ */
 typedef struct AIOContext {
 	aio_context_t id;
 	QueueBounded *requestQueue;
-	WaitTime      timeout;
+	AIOStats     *stats;
+	AIORing      *ring;
 	int64_t       numBytesRead;
 	int64_t       numBytesWrite;
 	uint32_t      maxOperations;
 	uint32_t      numRequests;
 	uint32_t      numReadRequests;
 	uint32_t      numWriteRequests;
+	uint32_t      spinLimit;
+	uint32_t      numRingEvents;
 } AIOContext;
 
 #if __SIZEOF_POINTER__ == 8
-static_assert(sizeof(AIOContext) == 64, "Check your assumptions");
+static_assert(sizeof(AIOContext) == 72, "Check your assumptions");
 #elif  __SIZEOF_POINTER__ == 4
-static_assert(sizeof(AIOContext) == 48, "Check your assumptions");
+static_assert(sizeof(AIOContext) == 56, "Check your assumptions");
 #endif
 
 typedef struct AIOTicket {
@@ -257,6 +336,19 @@ void f1207515_releaseAIORequest(AIORequest *aioRequest);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    f1207515_destroyAIORequestPool
+ * Description: Frees the memory allocated to the calling thread's AIORequestPool;
+ *              the AIORequest structs themselves belong to the MemoryPool.
+ *              An AIOContext and the requests queued on it are therefore
+ *              owned by one thread and cannot be handed to another.
+ *
+ * Parameters:
+ *   debug      True to print internal statistics, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+void f1207515_destroyAIORequestPool(bool debug);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_createAIOContext
  * Description: Creates an AIOContext struct instance
@@ -348,6 +440,19 @@ void f1207515_initAIOTicket(AIOTicket *aioTicket);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    f1207515_allocate
+ * Description: Preallocates disk space for the first length bytes of the file
+ *              so that AIO writes do not have to allocate blocks as they go
+ *
+ * Parameters:
+ *   aioFile    The AIOFile instance to preallocate
+ *   length     The final size of the file in bytes
+ * Returns:     Zero if the operation succeeded, SYSTEM_ERROR_CODE otherwise
+ * ----------------------------------------------------------------------------
+ */
+int f1207515_allocate(AIOFile *aioFile, int64_t length);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_create
  * Description: Creates the file specified by pathname; file always created
@@ -407,13 +512,30 @@ AIORequest *f1207515_read(AIOFile *aioFile, void *buf, size_t bufSize);
  */
 AIORequest *f1207515_write(AIOFile *aioFile, void *buf, size_t count);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    f1207515_writeBuffered
+ * Description: Synchronously writes count bytes at the current AIOFile offset
+ *              through the page cache; used for the unaligned tail of a file
+ *              whose aligned portion was written with O_DIRECT
+ *
+ * Parameters:
+ *   aioFile    The AIOFile instance to write to
+ *   buf        The data buffer to write from
+ *   count      The number of bytes to write from the buffer
+ * Returns:     The number of bytes written, or SYSTEM_ERROR_CODE
+ * ----------------------------------------------------------------------------
+ */
+ssize_t f1207515_writeBuffered(AIOFile *aioFile, void *buf, size_t count);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_submit
- * Description: Submits all queued AIORequest blocks for processing
+ * Description: Submits up to eight queued AIORequest blocks for processing.
+ *              The AIOTicket only counts the requests the kernel accepted;
+ *              the rest are requeued for the next submit.
  *
  * Parameters:
  *   aioFile    The AIOFile instance to submit I/O operations for
- * Returns:     True if the AIO submit operation succeeded, false otherwise
+ * Returns:     True if at least one AIORequest was accepted, false otherwise
  * ----------------------------------------------------------------------------
  */
 bool f1207515_submit(AIOFile *aioFile);
@@ -421,6 +543,10 @@ bool f1207515_submit(AIOFile *aioFile);
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_getEvents
  * Description: Read asynchronous I/O events from the Linux completion queue
+ *              and appends them to the events already held by the AIOTicket.
+ *              Completions are reaped straight from the user-space mapped
+ *              completion ring, spinning up to the adaptive spin limit, and
+ *              io_getevents() blocks only when the ring stays empty.
  *
  * Parameters:
  *   aioFile    The AIOFile instance to retrieve events for
@@ -429,6 +555,19 @@ bool f1207515_submit(AIOFile *aioFile);
  */
 int32_t f1207515_getEvents(AIOFile *aioFile);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    f1207515_getStats
+ * Description: Takes a snapshot of the AIOContext latency and queue depth
+ *              statistics, calibrating the TSC tick rate against the
+ *              monotonic clock so the histograms can be read in nanoseconds
+ *
+ * Parameters:
+ *   aioContext     The AIOContext instance to take the snapshot of
+ *   aioStats       The AIOStats instance to copy the statistics into
+ * ----------------------------------------------------------------------------
+ */
+void f1207515_getStats(AIOContext *aioContext, AIOStats *aioStats);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_printContext
  * Description: Prints the AIOContext information for debugging purposes
@@ -439,6 +578,16 @@ int32_t f1207515_getEvents(AIOFile *aioFile);
  */
 void f1207515_printContext(AIOContext *aioContext);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    f1207515_printStats
+ * Description: Prints an AIOStats snapshot for debugging purposes
+ *
+ * Parameters:
+ *   aioStats   The AIOStats snapshot to print
+ * ----------------------------------------------------------------------------
+ */
+void f1207515_printStats(AIOStats *aioStats);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f1207515_printTicket
  * Description: Prints the AIOTicket information for debugging purposes
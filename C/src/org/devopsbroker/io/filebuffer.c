@@ -36,6 +36,7 @@
 #include "../lang/integer.h"
 #include "../lang/memory.h"
 #include "../lang/stringbuilder.h"
+#include "../memory/hugepagepool.h"
 #include "../memory/memorypool.h"
 #include "../memory/pagepool.h"
 #include "../memory/slabpool.h"
@@ -62,10 +63,16 @@ static_assert(sizeof(FileBufferPool) == 28, "Check your assumptions");
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
-FileBufferPool fileBufferPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
+__thread FileBufferPool fileBufferPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
+static void *acquireIOBuffer(uint32_t ioSize);
+static FreeBufferFunc getFreeIOBuffer(uint32_t ioSize);
+static uint32_t getIOSize(uint32_t length);
+static void releaseReads(AIOFile *aioFile, FreeBufferFunc freeBuffer);
+static FileBuffer *slideWindow(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length, int64_t minReadLength);
+static bool readFileBlocks(AIOFile *aioFile, FileBufferList *bufferList, uint32_t numBlocks);
 
 // ═════════════════════════ Function Implementations ═════════════════════════
 
@@ -112,6 +119,30 @@ void ce97d170_releaseFileBuffer(FileBuffer *fileBuffer) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
+void ce97d170_destroyFileBufferPool(bool debug) {
+	if (debug) {
+		puts("FileBufferPool Statistics:");
+		printf("\tNumber of FileBuffers Allocated: %u\n", fileBufferPool.numFileBufferAlloc);
+		printf("\tNumber of FileBuffers Free:      %u\n", fileBufferPool.numFileBufferFree);
+		printf("\tNumber of FileBuffers In Use     %u\n", fileBufferPool.numFileBufferInUse);
+		printf("\tNumber of FileBuffers Used:      %u\n", fileBufferPool.numFileBufferUsed);
+		printf("\n");
+	}
+
+	// Clean up the struct stack
+	f106c0ab_cleanUpStackArray(&fileBufferPool.structStack, NULL);
+}
+
+void ce97d170_destroyThreadPools(bool debug) {
+	// Each pool returns its memory to the one below it, so destroy from the top down
+	f1207515_destroyAIORequestPool(debug);
+	ce97d170_destroyFileBufferPool(debug);
+	b86b2c8d_destroyMemoryPool(debug);
+	f502a409_destroyPagePool(debug);
+	b426145b_destroySlabPool(debug);
+	e65fff63_destroyHugePagePool(debug);
+}
+
 FileBufferList *ce97d170_createFileBufferList() {
 	FileBufferList *bufferList = f668c4bd_malloc(sizeof(FileBufferList));
 
@@ -120,6 +151,7 @@ FileBufferList *ce97d170_createFileBufferList() {
 	bufferList->fileOffset = 0;
 	bufferList->length = 0;
 	bufferList->size = FILEBUFFERLIST_DEFAULT_SIZE;
+	bufferList->ioSize = FILEBUFFER_MIN_IO_SIZE;
 
 	return bufferList;
 }
@@ -178,6 +210,7 @@ void ce97d170_initFileBufferList(FileBufferList *bufferList) {
 	bufferList->fileOffset = 0;
 	bufferList->length = 0;
 	bufferList->size = FILEBUFFERLIST_DEFAULT_SIZE;
+	bufferList->ioSize = FILEBUFFER_MIN_IO_SIZE;
 }
 
 void ce97d170_resetFileBufferList(FileBufferList *bufferList, void freeBuffer(void *buffer)) {
@@ -225,26 +258,34 @@ void ce97d170_addBuffer(FileBufferList *bufferList, FileBuffer *fileBuffer) {
 	bufferList->values[bufferList->length++] = fileBuffer;
 }
 
-FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, uint32_t length) {
+FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, int64_t length) {
 	FileBuffer *fileBuffer;
 	int64_t bufferListEnd;
 	int64_t dataEnd;
+	uint32_t low;
+	uint32_t high;
+	uint32_t mid;
 
 	if (bufferList->length > 0 && bufferList->fileOffset <= offset) {
 		bufferListEnd = bufferList->fileOffset + bufferList->numBytes;
 		dataEnd = offset + length;
 
 		if (bufferListEnd >= dataEnd) {
-			fileBuffer = bufferList->values[0];
+			low = 0;
+			high = bufferList->length - 1;
 
-			for (uint32_t i=1; i < bufferList->length; i++) {
-				if (bufferList->values[i]->fileOffset <= offset) {
-					fileBuffer = bufferList->values[i];
+			// Find the last FileBuffer beginning at or before the offset
+			while (low < high) {
+				mid = (low + high + 1) >> 1;
+
+				if (bufferList->values[mid]->fileOffset <= offset) {
+					low = mid;
 				} else {
-					break;
+					high = mid - 1;
 				}
 			}
 
+			fileBuffer = bufferList->values[low];
 			fileBuffer->dataOffset = offset - fileBuffer->fileOffset;
 
 			return fileBuffer;
@@ -254,15 +295,77 @@ FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, ui
 	return NULL;
 }
 
+void ce97d170_copyData(FileBuffer *fileBuffer, void *dest, uint32_t length) {
+	uint32_t bufferLength;
+	uint32_t dataOffset;
+	void *bufferPtr;
+
+	// Only the first FileBuffer starts at its data offset
+	dataOffset = fileBuffer->dataOffset;
+
+	while (length > 0) {
+		bufferPtr = fileBuffer->buffer + dataOffset;
+		bufferLength = fileBuffer->numBytes - dataOffset;
+		bufferLength = (bufferLength > length) ? length : bufferLength;
+		dataOffset = 0;
+
+		f668c4bd_memcopy(bufferPtr, dest, bufferLength);
+
+		dest += bufferLength;
+		length -= bufferLength;
+		fileBuffer = fileBuffer->next;
+	}
+}
+
+uint32_t ce97d170_copyDataCrc32(FileBuffer *fileBuffer, void *dest, uint32_t length, uint32_t crc32) {
+	uint32_t bufferLength;
+	uint32_t dataOffset;
+	uint32_t pageLength;
+	void *bufferPtr;
+
+	// Only the first FileBuffer starts at its data offset
+	dataOffset = fileBuffer->dataOffset;
+
+	while (length > 0) {
+		bufferPtr = fileBuffer->buffer + dataOffset;
+		bufferLength = fileBuffer->numBytes - dataOffset;
+		bufferLength = (bufferLength > length) ? length : bufferLength;
+		dataOffset = 0;
+
+		length -= bufferLength;
+
+		// Checksum each page as soon as it has been copied
+		while (bufferLength > 0) {
+			pageLength = (bufferLength > MEMORY_PAGE_SIZE) ? MEMORY_PAGE_SIZE : bufferLength;
+
+			f668c4bd_memcopy(bufferPtr, dest, pageLength);
+			crc32 = b7e0468d_crc32(dest, pageLength, crc32);
+
+			bufferPtr += pageLength;
+			dest += pageLength;
+			bufferLength -= pageLength;
+		}
+
+		fileBuffer = fileBuffer->next;
+	}
+
+	return crc32;
+}
+
 uint32_t ce97d170_crc32(FileBuffer *fileBuffer, uint32_t length) {
 	uint32_t bufferLength;
+	uint32_t dataOffset;
 	void *bufferPtr;
 	uint32_t crc32 = 0;
 
+	// Only the first FileBuffer starts at its data offset
+	dataOffset = fileBuffer->dataOffset;
+
 	while (length > 0) {
-		bufferPtr = fileBuffer->buffer + fileBuffer->dataOffset;
-		bufferLength = fileBuffer->numBytes - fileBuffer->dataOffset;
+		bufferPtr = fileBuffer->buffer + dataOffset;
+		bufferLength = fileBuffer->numBytes - dataOffset;
 		bufferLength = (bufferLength > length) ? length : bufferLength;
+		dataOffset = 0;
 
 		crc32 = b7e0468d_crc32(bufferPtr, bufferLength, crc32);
 
@@ -273,6 +376,90 @@ uint32_t ce97d170_crc32(FileBuffer *fileBuffer, uint32_t length) {
 	return crc32;
 }
 
+void ce97d170_evictFileBuffers(FileBufferList *bufferList, int64_t offset, void freeBuffer(void *buffer)) {
+	FileBuffer *fileBuffer;
+	uint32_t numEvict = 0;
+
+	// 1. Release each FileBuffer that ends at or before the offset
+	while (numEvict < bufferList->length) {
+		fileBuffer = bufferList->values[numEvict];
+
+		if (fileBuffer->fileOffset + fileBuffer->numBytes > offset) {
+			break;
+		}
+
+		bufferList->fileOffset += fileBuffer->numBytes;
+		bufferList->numBytes -= fileBuffer->numBytes;
+
+		if (freeBuffer != NULL) {
+			freeBuffer(fileBuffer->buffer);
+		}
+
+		ce97d170_releaseFileBuffer(fileBuffer);
+		numEvict++;
+	}
+
+	// 2. Shift the remaining FileBuffers to the front of the list
+	if (numEvict > 0) {
+		bufferList->length -= numEvict;
+
+		for (uint32_t i=0; i < bufferList->length; i++) {
+			bufferList->values[i] = bufferList->values[i + numEvict];
+		}
+	}
+}
+
+bool ce97d170_extendFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t length) {
+	int64_t bufferListEnd;
+	uint32_t numBlocks;
+
+	// 1. Position the AIOFile at the tail of the FileBufferList
+	bufferListEnd = bufferList->fileOffset + bufferList->numBytes;
+
+	if (length <= 0 || bufferListEnd >= aioFile->fileSize) {
+		return false;
+	}
+
+	aioFile->offset = bufferListEnd;
+
+	// 2. Do not read past the end of the file
+	if (length > aioFile->fileSize - bufferListEnd) {
+		length = aioFile->fileSize - bufferListEnd;
+	}
+
+	numBlocks = (length + bufferList->ioSize - 1) / bufferList->ioSize;
+
+	// 3. Read the data
+	return readFileBlocks(aioFile, bufferList, numBlocks);
+}
+
+uint32_t ce97d170_setPreferredIOSize(FileBufferList *bufferList, uint32_t ioSize) {
+	ioSize = getIOSize(ioSize);
+
+	// FileBuffers of the previous I/O size must go back to their own pool
+	if (ioSize != bufferList->ioSize && bufferList->length > 0) {
+		ce97d170_resetFileBufferList(bufferList, ce97d170_getFreeBuffer(bufferList));
+	}
+
+	bufferList->ioSize = ioSize;
+
+	return ioSize;
+}
+
+FileBuffer *ce97d170_prefetchFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length) {
+	// Read exactly the requested range; the caller already knows how much it needs
+	return slideWindow(aioFile, bufferList, offset, length, 0);
+}
+
+FileBuffer *ce97d170_slideFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length) {
+	// Read ahead at least one AIOTicket of I/O size units
+	return slideWindow(aioFile, bufferList, offset, length, (int64_t) bufferList->ioSize << 3);
+}
+
+FreeBufferFunc ce97d170_getFreeBuffer(FileBufferList *bufferList) {
+	return getFreeIOBuffer(bufferList->ioSize);
+}
+
 FileBuffer *ce97d170_getBuffer(FileBufferList *bufferList, uint32_t index) {
 	if (bufferList->length > index) {
 		return bufferList->values[index];
@@ -284,17 +471,18 @@ FileBuffer *ce97d170_getBuffer(FileBufferList *bufferList, uint32_t index) {
 FileBuffer *ce97d170_readFileBuffer(AIOFile *aioFile, uint64_t length) {
 	FileBuffer *fileBuffer;
 	AIOTicket *aioTicket;
+	uint32_t ioSize;
 	void *bufferPtr;
 
 	aioTicket = &aioFile->aioTicket;
 
-	if (length > MEMORY_PAGE_SIZE) {
+	if (length > FILEBUFFER_MAX_IO_SIZE) {
 		StringBuilder errorMessage;
 		c598a24c_initStringBuilder(&errorMessage);
 
 		c598a24c_append_string(&errorMessage, "Cannot read FileBuffer: length ");
 		c598a24c_append_uint(&errorMessage, length);
-		c598a24c_append_string(&errorMessage, " greater than PagePool page size of 4096");
+		c598a24c_append_string(&errorMessage, " greater than maximum I/O size of 2097152");
 
 		c7c88e52_printError_string(errorMessage.buffer);
 		c598a24c_cleanUpStringBuilder(&errorMessage);
@@ -303,7 +491,8 @@ FileBuffer *ce97d170_readFileBuffer(AIOFile *aioFile, uint64_t length) {
 	}
 
 	// 1. Create FileBuffer
-	bufferPtr = f502a409_acquirePage();
+	ioSize = getIOSize(length);
+	bufferPtr = acquireIOBuffer(ioSize);
 	fileBuffer = ce97d170_acquireFileBuffer(bufferPtr);
 	fileBuffer->fileOffset = aioFile->offset;
 
@@ -311,13 +500,25 @@ FileBuffer *ce97d170_readFileBuffer(AIOFile *aioFile, uint64_t length) {
 	f1207515_initAIOTicket(aioTicket);
 
 	// 3. Read file data
-	f1207515_read(aioFile, bufferPtr, MEMORY_PAGE_SIZE);
+	f1207515_read(aioFile, bufferPtr, ioSize);
 
 	// 4. Submit the AIORequests
-	f1207515_submit(aioFile);
+	if (!f1207515_submit(aioFile)) {
+		c7c88e52_printLibError("Cannot submit AIO read", errno);
+		releaseReads(aioFile, getFreeIOBuffer(ioSize));
+		ce97d170_releaseFileBuffer(fileBuffer);
+		return NULL;
+	}
 
 	// 5. Retrieve the AIOEvents
-	f1207515_getEvents(aioFile);
+	while (aioTicket->numEvents < aioTicket->numRequests) {
+		if (f1207515_getEvents(aioFile) == SYSTEM_ERROR_CODE) {
+			c7c88e52_printLibError("Cannot retrieve AIO read events", errno);
+			getFreeIOBuffer(ioSize)(bufferPtr);
+			ce97d170_releaseFileBuffer(fileBuffer);
+			return NULL;
+		}
+	}
 
 	// 6. Print the ticket
 	// f1207515_printTicket(&aioTicket);
@@ -332,84 +533,239 @@ FileBuffer *ce97d170_readFileBuffer(AIOFile *aioFile, uint64_t length) {
 }
 
 void ce97d170_readFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t length) {
-	FileBuffer *fileBuffer;
-	AIOTicket *aioTicket;
 	uint32_t numBlocks;
-	int32_t numEvents;
-	void *bufferPtr;
-
-	aioTicket = &aioFile->aioTicket;
 
 	// Reset the FileBufferList if contains data
 	if (bufferList->length > 0) {
-		ce97d170_resetFileBufferList(bufferList, f502a409_releasePage);
+		ce97d170_resetFileBufferList(bufferList, ce97d170_getFreeBuffer(bufferList));
 	}
 
-	if (aioFile->numRequestsRemaining > 0) {
-		// Get the remaining events from the submitted requests
-		numEvents = f1207515_getEvents(aioFile);
+	// Calculate the number of blocks to read
+	numBlocks = (length + bufferList->ioSize - 1) / bufferList->ioSize;
 
-	} else {
-		// Create and submit new AIORequests
-		f1207515_initAIOTicket(aioTicket);
+	readFileBlocks(aioFile, bufferList, numBlocks);
+}
 
-		// Calculate the number of blocks to read
-		length = f45efac2_min_uint32(length, ASYNC_AIOTICKET_MAXSIZE);
-		numBlocks = (length + 4095) >> 12;
+void ce97d170_write(FileBuffer *fileBuffer, int fd, uint32_t length, char *pathName) {
+	uint32_t bufferLength;
+	uint32_t dataOffset;
+	void *bufferPtr;
 
-		// Read file data
-		for (uint32_t i=0; i < numBlocks; i++) {
-			bufferPtr = f502a409_acquirePage();
-			f1207515_read(aioFile, bufferPtr, MEMORY_PAGE_SIZE);
-		}
+	// Only the first FileBuffer starts at its data offset
+	dataOffset = fileBuffer->dataOffset;
+
+	while (length > 0) {
+		bufferPtr = fileBuffer->buffer + dataOffset;
+		bufferLength = fileBuffer->numBytes - dataOffset;
+		bufferLength = (bufferLength > length) ? length : bufferLength;
+		dataOffset = 0;
+
+		e2f74138_writeFile(fd, bufferPtr, bufferLength, pathName);
+
+		length -= bufferLength;
+		fileBuffer = fileBuffer->next;
+	}
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void *acquireIOBuffer(uint32_t ioSize) {
+	if (ioSize <= MEMORY_PAGE_SIZE) {
+		return f502a409_acquirePage();
+	} else if (ioSize <= SLABPOOL_SLAB_SIZE) {
+		return b426145b_acquireSlab();
+	}
 
-		// Submit the AIORequests
-		aioFile->numRequestsRemaining = numBlocks;
-		f1207515_submit(aioFile);
+	return e65fff63_acquireRegion();
+}
 
-		// Retrieve the AIOEvents
-		numEvents = f1207515_getEvents(aioFile);
+static FreeBufferFunc getFreeIOBuffer(uint32_t ioSize) {
+	if (ioSize <= MEMORY_PAGE_SIZE) {
+		return f502a409_releasePage;
+	} else if (ioSize <= SLABPOOL_SLAB_SIZE) {
+		return b426145b_releaseSlab;
 	}
 
-	// Print the ticket
-	aioFile->numRequestsRemaining -= numEvents;
-//	f1207515_printTicket(aioTicket);
+	return e65fff63_releaseRegion;
+}
+
+static uint32_t getIOSize(uint32_t length) {
+	if (length <= MEMORY_PAGE_SIZE) {
+		return MEMORY_PAGE_SIZE;
+	} else if (length <= SLABPOOL_SLAB_SIZE) {
+		return SLABPOOL_SLAB_SIZE;
+	}
 
-	// Create FileBuffer objects from the AIORequests
-	for (int32_t i=0; i < numEvents; i++) {
-		AIORequest *aioRequest;
+	return HUGEPAGEPOOL_REGION_SIZE;
+}
 
-		#if __SIZEOF_POINTER__ == 8
-		aioRequest = (AIORequest*)aioTicket->eventList[i].obj;
-		bufferPtr = (void*) aioRequest->aio_buf;
-		#elif  __SIZEOF_POINTER__ == 4
-		aioRequest = (AIORequest*) ((uint32_t) aioTicket->eventList[i].obj);
-		bufferPtr = (void*) ((uint32_t) aioRequest->aio_buf);
-		#endif
+static inline AIORequest *getEventRequest(AIOEvent *aioEvent) {
+	#if __SIZEOF_POINTER__ == 8
+	return (AIORequest*) aioEvent->obj;
+	#elif  __SIZEOF_POINTER__ == 4
+	return (AIORequest*) ((uint32_t) aioEvent->obj);
+	#endif
+}
+
+static inline void *getRequestBuffer(AIORequest *aioRequest) {
+	#if __SIZEOF_POINTER__ == 8
+	return (void*) aioRequest->aio_buf;
+	#elif  __SIZEOF_POINTER__ == 4
+	return (void*) ((uint32_t) aioRequest->aio_buf);
+	#endif
+}
+
+static void releaseReads(AIOFile *aioFile, FreeBufferFunc freeBuffer) {
+	QueueBounded *requestQueue;
+	AIORequest *aioRequest;
+	AIOTicket *aioTicket;
 
-		fileBuffer = ce97d170_acquireFileBuffer(bufferPtr);
-		fileBuffer->numBytes = (int64_t) aioTicket->eventList[i].res;
-		fileBuffer->fileOffset = (int64_t) aioRequest->aio_offset;
+	aioTicket = &aioFile->aioTicket;
+	requestQueue = aioFile->aioContext->requestQueue;
 
-		ce97d170_addBuffer(bufferList, fileBuffer);
+	// 1. Release the reads of the AIOTicket; they were never submitted or will never complete
+	for (uint32_t i=0; i < aioTicket->numRequests; i++) {
+		freeBuffer(getRequestBuffer(aioTicket->requestList[i]));
+		f1207515_releaseAIORequest(aioTicket->requestList[i]);
 	}
 
-	// Clean up the AIOTicket
-	f1207515_cleanUpAIOTicket(aioTicket);
+	f1207515_initAIOTicket(aioTicket);
+
+	// 2. Release the reads still waiting in the request queue
+	while (!b8da7268_isEmpty(requestQueue)) {
+		aioRequest = b8da7268_dequeue(requestQueue);
+		freeBuffer(getRequestBuffer(aioRequest));
+		f1207515_releaseAIORequest(aioRequest);
+	}
 }
 
-void ce97d170_write(FileBuffer *fileBuffer, int fd, uint32_t length, char *pathName) {
-	uint32_t bufferLength;
+static FileBuffer *slideWindow(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length, int64_t minReadLength) {
+	FileBuffer *fileBuffer;
+	int64_t bufferListEnd;
+	int64_t readLength;
+
+	// 1. Nothing to do if the window already contains the data
+	fileBuffer = ce97d170_containsData(bufferList, offset, length);
+
+	if (fileBuffer != NULL) {
+		return fileBuffer;
+	}
+
+	bufferListEnd = bufferList->fileOffset + bufferList->numBytes;
+
+	if (bufferList->length > 0 && bufferList->fileOffset <= offset && offset <= bufferListEnd) {
+		// 2a. Evict the pages in front of the data and keep the overlap
+		ce97d170_evictFileBuffers(bufferList, offset, ce97d170_getFreeBuffer(bufferList));
+	} else {
+		// 2b. Backwards seek or gap in the window; start over at the Direct I/O offset
+		ce97d170_resetFileBufferList(bufferList, ce97d170_getFreeBuffer(bufferList));
+		bufferList->fileOffset = (offset >> 9) << 9;
+	}
+
+	// 3. Read the missing data at the tail, reading ahead at least minReadLength bytes
+	bufferListEnd = bufferList->fileOffset + bufferList->numBytes;
+	readLength = offset + length - bufferListEnd;
+
+	if (readLength < minReadLength) {
+		readLength = minReadLength;
+	}
+
+	ce97d170_extendFileBufferList(aioFile, bufferList, readLength);
+
+	return ce97d170_containsData(bufferList, offset, length);
+}
+
+static bool readFileBlocks(AIOFile *aioFile, FileBufferList *bufferList, uint32_t numBlocks) {
+	AIOEvent *sortedEvents[8];
+	AIORequest *aioRequest;
+	AIOEvent *aioEvent;
+	FileBuffer *fileBuffer;
+	AIOTicket *aioTicket;
+	FreeBufferFunc freeBuffer;
+	uint32_t numTicketBlocks;
+	uint32_t numQueued;
+	uint32_t j;
 	void *bufferPtr;
+	bool isValid;
 
-	while (length > 0) {
-		bufferPtr = fileBuffer->buffer + fileBuffer->dataOffset;
-		bufferLength = fileBuffer->numBytes - fileBuffer->dataOffset;
-		bufferLength = (bufferLength > length) ? length : bufferLength;
+	aioTicket = &aioFile->aioTicket;
+	freeBuffer = ce97d170_getFreeBuffer(bufferList);
+	numQueued = 0;
+	isValid = true;
 
-		e2f74138_writeFile(fd, bufferPtr, bufferLength, pathName);
+	while (numBlocks > 0) {
+		// 1. Queue up to one AIOTicket worth of page reads, counting the ones left over from a partial submit
+		f1207515_initAIOTicket(aioTicket);
+		numTicketBlocks = f45efac2_min_uint32(numBlocks, 8);
 
-		length -= bufferLength;
-		fileBuffer = fileBuffer->next;
+		for (; numQueued < numTicketBlocks; numQueued++) {
+			bufferPtr = acquireIOBuffer(bufferList->ioSize);
+			f1207515_read(aioFile, bufferPtr, bufferList->ioSize);
+		}
+
+		// 2. Submit the AIORequests and wait for every AIOEvent; the reads block until the whole ticket completes
+		if (!f1207515_submit(aioFile)) {
+			c7c88e52_printLibError("Cannot submit AIO read", errno);
+			releaseReads(aioFile, freeBuffer);
+			return false;
+		}
+
+		numQueued -= aioTicket->numRequests;
+
+		while (aioTicket->numEvents < aioTicket->numRequests) {
+			if (f1207515_getEvents(aioFile) == SYSTEM_ERROR_CODE) {
+				c7c88e52_printLibError("Cannot retrieve AIO read events", errno);
+				releaseReads(aioFile, freeBuffer);
+				return false;
+			}
+		}
+
+		// 3. Completions arrive out of order; sort them by file offset
+		for (uint32_t i=0; i < aioTicket->numEvents; i++) {
+			aioEvent = &aioTicket->eventList[i];
+			aioRequest = getEventRequest(aioEvent);
+
+			for (j=i; j > 0 && getEventRequest(sortedEvents[j-1])->aio_offset > aioRequest->aio_offset; j--) {
+				sortedEvents[j] = sortedEvents[j-1];
+			}
+
+			sortedEvents[j] = aioEvent;
+		}
+
+		// 4. Create FileBuffer objects from the sorted AIOEvents
+		for (uint32_t i=0; i < aioTicket->numEvents; i++) {
+			aioEvent = sortedEvents[i];
+			aioRequest = getEventRequest(aioEvent);
+			bufferPtr = getRequestBuffer(aioRequest);
+
+			// A failed read, or a short read before the end of the file, leaves a hole in the window
+			if (isValid && (aioEvent->res < 0 || (aioEvent->res < (int64_t) aioRequest->aio_nbytes
+			        && (int64_t) aioRequest->aio_offset + aioEvent->res < aioFile->fileSize))) {
+				c7c88e52_printLibError(aioFile->fileName, (aioEvent->res < 0) ? -aioEvent->res : EIO);
+				isValid = false;
+			}
+
+			if (isValid && aioEvent->res > 0) {
+				fileBuffer = ce97d170_acquireFileBuffer(bufferPtr);
+				fileBuffer->numBytes = (uint32_t) aioEvent->res;
+				fileBuffer->fileOffset = (int64_t) aioRequest->aio_offset;
+
+				ce97d170_addBuffer(bufferList, fileBuffer);
+			} else {
+				freeBuffer(bufferPtr);
+			}
+		}
+
+		// 5. Clean up the AIOTicket
+		numBlocks -= aioTicket->numRequests;
+		f1207515_cleanUpAIOTicket(aioTicket);
+		f1207515_initAIOTicket(aioTicket);
+
+		if (!isValid) {
+			releaseReads(aioFile, freeBuffer);
+			return false;
+		}
 	}
+
+	return true;
 }
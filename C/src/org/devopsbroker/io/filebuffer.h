@@ -38,6 +38,8 @@
 
 // ═══════════════════════════════ Preprocessor ═══════════════════════════════
 
+#define FILEBUFFER_MIN_IO_SIZE  4096
+#define FILEBUFFER_MAX_IO_SIZE  2097152
 
 // ═════════════════════════════════ Typedefs ═════════════════════════════════
 
@@ -55,15 +57,27 @@ static_assert(sizeof(FileBuffer) == 32, "Check your assumptions");
 static_assert(sizeof(FileBuffer) == 24, "Check your assumptions");
 #endif
 
+/*
+ * FileBufferList
+ *   - ioSize is the size of each AIO read and of each FileBuffer; 4KB uses
+ *     PagePool pages, 32KB uses SlabPool slabs and 2MB uses HugePagePool regions
+ */
 typedef struct FileBufferList {
 	FileBuffer **values;
 	int64_t      numBytes;
 	int64_t      fileOffset;
 	uint32_t     length;
 	uint32_t     size;
+	uint32_t     ioSize;
 } FileBufferList;
 
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(FileBufferList) == 40, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
 static_assert(sizeof(FileBufferList) == 32, "Check your assumptions");
+#endif
+
+typedef void (*FreeBufferFunc)(void *buffer);
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
@@ -95,6 +109,32 @@ void ce97d170_releaseFileBuffer(FileBuffer *fileBuffer);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_destroyFileBufferPool
+ * Description: Frees the memory allocated to the calling thread's FileBufferPool;
+ *              the FileBuffer structs themselves belong to the MemoryPool.
+ *              A FileBufferList and its buffers stay with the thread that
+ *              filled it.
+ *
+ * Parameters:
+ *   debug      True to print internal statistics, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+void ce97d170_destroyFileBufferPool(bool debug);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_destroyThreadPools
+ * Description: Destroys every thread-local pool of the calling thread in
+ *              dependency order: AIORequest, FileBuffer, memory, page, slab
+ *              and huge page. A worker thread calls this last, after it has
+ *              released everything it acquired from the pools.
+ *
+ * Parameters:
+ *   debug      True to print internal statistics, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+void ce97d170_destroyThreadPools(bool debug);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_createFileBufferList
  * Description: Creates a FileBufferList struct instance
@@ -179,7 +219,8 @@ void ce97d170_addBuffer(FileBufferList *bufferList, FileBuffer *fileBuffer);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_containsData
- * Description: Returns true if the FileBuffer contains the data, false otherwise
+ * Description: Binary searches the FileBufferList by file offset for the
+ *              FileBuffer holding the beginning of the data
  *
  * Parameters:
  *   bufferList     A pointer to the FileBufferList instance to inspect
@@ -189,7 +230,36 @@ void ce97d170_addBuffer(FileBufferList *bufferList, FileBuffer *fileBuffer);
  *              otherwise
  * ----------------------------------------------------------------------------
  */
-FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, uint32_t length);
+FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, int64_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_copyData
+ * Description: Copies length bytes starting at the FileBuffer data offset into
+ *              a contiguous buffer, following the FileBuffer chain as needed
+ *
+ * Parameters:
+ *   fileBuffer     A pointer to the FileBuffer instance to begin with
+ *   dest           The destination buffer
+ *   length         The length of the data to copy
+ * ----------------------------------------------------------------------------
+ */
+void ce97d170_copyData(FileBuffer *fileBuffer, void *dest, uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_copyDataCrc32
+ * Description: Copies length bytes like ce97d170_copyData() and updates the
+ *              CRC-32 of each page of data right after it is copied, while it
+ *              is still in the L1 cache
+ *
+ * Parameters:
+ *   fileBuffer     A pointer to the FileBuffer instance to begin with
+ *   dest           The destination buffer
+ *   length         The length of the data to copy
+ *   crc32          The CRC-32 of the data before this (allows chunk calculations)
+ * Returns:     The updated CRC-32
+ * ----------------------------------------------------------------------------
+ */
+uint32_t ce97d170_copyDataCrc32(FileBuffer *fileBuffer, void *dest, uint32_t length, uint32_t crc32);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_crc32
@@ -203,6 +273,96 @@ FileBuffer *ce97d170_containsData(FileBufferList *bufferList, int64_t offset, ui
  */
 uint32_t ce97d170_crc32(FileBuffer *fileBuffer, uint32_t length);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_evictFileBuffers
+ * Description: Releases every FileBuffer at the head of the FileBufferList
+ *              that ends at or before the specified file offset
+ *
+ * Parameters:
+ *   bufferList     A pointer to the FileBufferList instance
+ *   offset         The file offset where the window now begins
+ *   freeBuffer     A function pointer to the method that frees the underlying
+ *                  buffer contained within the FileBuffer instance
+ * ----------------------------------------------------------------------------
+ */
+void ce97d170_evictFileBuffers(FileBufferList *bufferList, int64_t offset, void freeBuffer(void *buffer));
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_extendFileBufferList
+ * Description: Appends length bytes of file data to the tail of the
+ *              FileBufferList using batched AIO page reads
+ *
+ * Parameters:
+ *   aioFile        A pointer to the AIOFile instance to read from
+ *   bufferList     A pointer to the FileBufferList instance to extend
+ *   length         The length of data to append
+ * Returns:     True if the data was read, false if at end of file or on error
+ * ----------------------------------------------------------------------------
+ */
+bool ce97d170_extendFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_prefetchFileBufferList
+ * Description: Moves the FileBufferList window to the requested range like
+ *              ce97d170_slideFileBufferList() but without any read-ahead, so
+ *              only the I/O size units covering the range are read
+ *
+ * Parameters:
+ *   aioFile        A pointer to the AIOFile instance to read from
+ *   bufferList     A pointer to the FileBufferList instance
+ *   offset         The file offset where the range begins
+ *   length         The length of the range starting from the offset
+ * Returns:     The FileBuffer that contains the beginning of the range, or NULL
+ *              if the range could not be read
+ * ----------------------------------------------------------------------------
+ */
+FileBuffer *ce97d170_prefetchFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_setPreferredIOSize
+ * Description: Sets the size of each AIO read and FileBuffer, rounded up to a
+ *              4KB page, a 32KB slab or a 2MB huge page region. Any FileBuffers
+ *              already held by the FileBufferList are released.
+ *
+ * Parameters:
+ *   bufferList     A pointer to the FileBufferList instance
+ *   ioSize         The preferred I/O size in bytes
+ * Returns:     The I/O size actually used
+ * ----------------------------------------------------------------------------
+ */
+uint32_t ce97d170_setPreferredIOSize(FileBufferList *bufferList, uint32_t ioSize);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_slideFileBufferList
+ * Description: Slides the FileBufferList window forward so it contains the
+ *              requested data; pages before the offset are evicted and the
+ *              missing data is read at the tail, at least one AIOTicket of
+ *              I/O size units at a time. Only a backwards seek or a
+ *              jump past the end of the window resets the FileBufferList.
+ *
+ * Parameters:
+ *   aioFile        A pointer to the AIOFile instance to read from
+ *   bufferList     A pointer to the FileBufferList instance
+ *   offset         The file offset where the data begins
+ *   length         The length of the data starting from the offset
+ * Returns:     The FileBuffer that contains the beginning of the data, or NULL
+ *              if the data could not be read
+ * ----------------------------------------------------------------------------
+ */
+FileBuffer *ce97d170_slideFileBufferList(AIOFile *aioFile, FileBufferList *bufferList, int64_t offset, int64_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    ce97d170_getFreeBuffer
+ * Description: Returns the method that frees the underlying buffers of the
+ *              FileBufferList based upon its I/O size
+ *
+ * Parameters:
+ *   bufferList     A pointer to the FileBufferList instance
+ * Returns:     The function pointer to pass as the freeBuffer parameter
+ * ----------------------------------------------------------------------------
+ */
+FreeBufferFunc ce97d170_getFreeBuffer(FileBufferList *bufferList);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_getBuffer
  * Description: Returns the FileBuffer at the specified index
@@ -218,10 +378,12 @@ FileBuffer *ce97d170_getBuffer(FileBufferList *bufferList, uint32_t index);
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_readFileBuffer
  * Description: Returns a FileBuffer instance populated with the requested data
+ *              using a single AIO read; the FileBuffer is backed by a page, a
+ *              slab or a huge page region depending upon the length
  *
  * Parameters:
  *   aioFile    A pointer to the AIOFile instance to read from
- *   length     The length of data to read
+ *   length     The length of data to read (up to FILEBUFFER_MAX_IO_SIZE)
  * Returns:     A FileBuffer instance populated with the requested data
  * ----------------------------------------------------------------------------
  */
@@ -229,7 +391,8 @@ FileBuffer *ce97d170_readFileBuffer(AIOFile *aioFile, uint64_t length);
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    ce97d170_readFileBufferList
- * Description: Loads the requested data into the FileBufferList instance
+ * Description: Loads the requested data into the FileBufferList instance in
+ *              I/O size units, eight AIO reads per AIOTicket
  *
  * Parameters:
  *   aioFile        A pointer to the AIOFile instance
@@ -0,0 +1,118 @@
+/*
+ * hugepagepool.c - DevOpsBroker C source file for the org.devopsbroker.memory.HugePagePool struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-53
+ *
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _DEFAULT_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <sys/mman.h>
+
+#include "hugepagepool.h"
+
+#include "../lang/memory.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+__thread HugePagePool hugePagePool = { {NULL, 0, 0}, 0, 0, 0, 0 };
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static void populateHugePagePool();
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void e65fff63_destroyHugePagePool(bool debug) {
+	if (debug) {
+		puts("HugePagePool Statistics:");
+		printf("\tNumber of Regions Allocated: %u\n", hugePagePool.numRegionsAlloc);
+		printf("\tNumber of Regions Free:      %u\n", hugePagePool.numRegionsFree);
+		printf("\tNumber of Regions In Use     %u\n", hugePagePool.numRegionsInUse);
+		printf("\tNumber of Regions Used:      %u\n", hugePagePool.numRegionsUsed);
+		printf("\n");
+	}
+
+	// Clean up the region stack
+	f106c0ab_cleanUpStackArray(&hugePagePool.regionStack, f668c4bd_free);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void *e65fff63_acquireRegion() {
+	void *regionPtr;
+
+	// Initialize the region stack if no regions have been allocated yet
+	if (hugePagePool.numRegionsAlloc == 0) {
+		f106c0ab_initStackArray(&hugePagePool.regionStack);
+	}
+
+	// Populate the HugePagePool with another region if no regions are free
+	if (hugePagePool.numRegionsFree == 0) {
+		populateHugePagePool();
+	}
+
+	// Keep track of HugePagePool statistics
+	hugePagePool.numRegionsFree--;
+	hugePagePool.numRegionsInUse++;
+	hugePagePool.numRegionsUsed++;
+
+	// Pop the region off the stack and return
+	regionPtr = f106c0ab_pop(&hugePagePool.regionStack);
+
+	return regionPtr;
+}
+
+void e65fff63_releaseRegion(void *regionPtr) {
+	// Keep track of HugePagePool statistics
+	hugePagePool.numRegionsFree++;
+	hugePagePool.numRegionsInUse--;
+
+	f106c0ab_push(&hugePagePool.regionStack, regionPtr);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Private Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void populateHugePagePool() {
+	// Allocate a 2MB region aligned on a 2MB huge page boundary
+	void *region = f668c4bd_alignedAlloc(HUGEPAGEPOOL_REGION_SIZE, HUGEPAGEPOOL_REGION_SIZE);
+
+	// Ask for transparent huge page backing; this is only a hint
+	madvise(region, HUGEPAGEPOOL_REGION_SIZE, MADV_HUGEPAGE);
+
+	// Add region to the region stack and keep HugePagePool statistics
+	f106c0ab_push(&hugePagePool.regionStack, region);
+	hugePagePool.numRegionsAlloc++;
+	hugePagePool.numRegionsFree++;
+}
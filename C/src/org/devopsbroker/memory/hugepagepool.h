@@ -0,0 +1,99 @@
+/*
+ * hugepagepool.h - DevOpsBroker C header file for the org.devopsbroker.memory.HugePagePool struct
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-53
+ *
+ * echo ORG_DEVOPSBROKER_MEMORY_HUGEPAGEPOOL | md5sum | cut -c 25-32
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_MEMORY_HUGEPAGEPOOL_H
+#define ORG_DEVOPSBROKER_MEMORY_HUGEPAGEPOOL_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+
+#include <assert.h>
+
+#include "../adt/stackarray.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define HUGEPAGEPOOL_REGION_SIZE  2097152
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef struct HugePagePool {
+	StackArray regionStack;
+	uint32_t   numRegionsAlloc;
+	uint32_t   numRegionsFree;
+	uint32_t   numRegionsInUse;
+	uint32_t   numRegionsUsed;
+} HugePagePool;
+
+#if __SIZEOF_POINTER__ == 8
+static_assert(sizeof(HugePagePool) == 32, "Check your assumptions");
+#elif  __SIZEOF_POINTER__ == 4
+static_assert(sizeof(HugePagePool) == 28, "Check your assumptions");
+#endif
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ Create/Destroy Functions ~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e65fff63_destroyHugePagePool
+ * Description: Frees the memory allocated to the calling thread's HugePagePool.
+ *              Regions must be released on the thread that acquired them;
+ *              a region released elsewhere is only freed with the other
+ *              thread's pool.
+ *
+ * Parameters:
+ *   debug      True to print internal statistics, false otherwise
+ * ----------------------------------------------------------------------------
+ */
+void e65fff63_destroyHugePagePool(bool debug);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Utility Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e65fff63_acquireRegion
+ * Description: Acquires a 2MB memory region from the internal HugePagePool;
+ *              the region is aligned on a 2MB boundary so the kernel can back
+ *              it with a transparent huge page
+ *
+ * Returns:     The region if available, NULL otherwise
+ * ----------------------------------------------------------------------------
+ */
+void *e65fff63_acquireRegion();
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    e65fff63_releaseRegion
+ * Description: Releases a 2MB memory region back into the internal HugePagePool
+ *
+ * Parameters:
+ *   regionPtr  The memory region to return to the HugePagePool
+ * ----------------------------------------------------------------------------
+ */
+void e65fff63_releaseRegion(void *regionPtr);
+
+#endif /* ORG_DEVOPSBROKER_MEMORY_HUGEPAGEPOOL_H */
@@ -44,7 +44,7 @@
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
-MemoryPool memoryPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
+__thread MemoryPool memoryPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
@@ -61,7 +61,10 @@ static_assert(sizeof(MemoryPool) == 28, "Check your assumptions");
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    b86b2c8d_destroyMemoryPool
- * Description: Frees the memory allocated to the internal MemoryPool
+ * Description: Frees the memory allocated to the calling thread's MemoryPool.
+ *              Blocks cannot be released one at a time; all of them go back
+ *              to the PagePool here, so no block may be used by any thread
+ *              once the acquiring thread destroys its MemoryPool.
  *
  * Parameters:
  *   debug      True to print internal statistics, false otherwise
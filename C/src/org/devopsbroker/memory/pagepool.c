@@ -42,7 +42,7 @@
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
-PagePool pagePool = { {NULL, 0, 0}, {NULL, 0, 0}, 0, 0, 0, 0 };
+__thread PagePool pagePool = { {NULL, 0, 0}, {NULL, 0, 0}, 0, 0, 0, 0 };
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
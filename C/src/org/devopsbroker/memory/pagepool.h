@@ -64,7 +64,11 @@ static_assert(sizeof(PagePool) == 40, "Check your assumptions");
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    f502a409_destroyPagePool
- * Description: Frees the memory allocated to the internal PagePool
+ * Description: Frees the memory allocated to the calling thread's PagePool.
+ *              Pages are carved out of slabs owned by the pool and those
+ *              slabs are returned here whether or not their pages are still
+ *              in use, so every page must be released on the thread that
+ *              acquired it before that thread destroys its PagePool.
  *
  * Parameters:
  *   debug      True to print internal statistics, false otherwise
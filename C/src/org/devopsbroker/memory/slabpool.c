@@ -42,7 +42,7 @@
 
 // ═════════════════════════════ Global Variables ═════════════════════════════
 
-SlabPool slabPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
+__thread SlabPool slabPool = { {NULL, 0, 0}, 0, 0, 0, 0 };
 
 // ════════════════════════════ Function Prototypes ═══════════════════════════
 
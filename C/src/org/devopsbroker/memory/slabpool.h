@@ -62,7 +62,10 @@ static_assert(sizeof(SlabPool) == 28, "Check your assumptions");
 
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    b426145b_destroySlabPool
- * Description: Frees the memory allocated to the internal SlabPool
+ * Description: Frees the memory allocated to the calling thread's SlabPool.
+ *              Release each slab on the thread that acquired it; a slab
+ *              released on another thread lands in that thread's SlabPool,
+ *              and slabs still in use when their pool is destroyed leak.
  *
  * Parameters:
  *   debug      True to print internal statistics, false otherwise
@@ -0,0 +1,102 @@
+/*
+ * testinput.c - DevOpsBroker C source file for unit test input and timing
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _DEFAULT_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "testinput.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+static char *wordList[] = {
+	"the", "archive", "entry", "deflate", "window", "offset", "buffer", "length",
+	"distance", "literal", "symbol", "block", "header", "file", "directory", "error",
+	"const", "static", "uint32_t", "return", "while", "for", "if", "else"
+};
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~ Test Input Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+uint8_t *createTextInput(uint32_t length) {
+	uint8_t *input = malloc(length);
+	uint32_t numWords = sizeof(wordList) / sizeof(char*);
+	uint32_t i = 0, wordLength;
+	char *word;
+
+	srandom(1);
+
+	while (i < length) {
+		word = wordList[random() % numWords];
+		wordLength = strlen(word);
+
+		for (uint32_t j=0; j < wordLength && i < length; j++) {
+			input[i++] = word[j];
+		}
+
+		if (i < length) {
+			input[i++] = (random() % 8 == 0) ? '\n' : ' ';
+		}
+	}
+
+	return input;
+}
+
+uint8_t *createRandomInput(uint32_t length, uint32_t seed) {
+	uint8_t *input = malloc(length + TEST_INPUT_PADDING);
+
+	srandom(seed);
+
+	for (uint32_t i=0; i < length + TEST_INPUT_PADDING; i++) {
+		input[i] = random();
+	}
+
+	return input;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Timing Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+double getSeconds() {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
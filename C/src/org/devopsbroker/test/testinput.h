@@ -0,0 +1,85 @@
+/*
+ * testinput.h - DevOpsBroker C header file for unit test input and timing
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * Generates the repeatable text and random inputs the compression and checksum
+ * benchmarks run on, and the monotonic timer they are measured with.
+ *
+ * echo ORG_DEVOPSBROKER_TEST_TESTINPUT | md5sum | cut -c 25-32
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef ORG_DEVOPSBROKER_TEST_TESTINPUT_H
+#define ORG_DEVOPSBROKER_TEST_TESTINPUT_H
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdint.h>
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_PADDING  8
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ═══════════════════════════ Function Declarations ══════════════════════════
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~ Test Input Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    createTextInput
+ * Description: Creates length bytes of source-code-like words separated by
+ *              spaces and newlines; the same text is returned on every call
+ *
+ * Parameters:
+ *   length     The number of bytes to create
+ * Returns:     The malloc'd text, which the caller must free
+ * ----------------------------------------------------------------------------
+ */
+uint8_t *createTextInput(uint32_t length);
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    createRandomInput
+ * Description: Creates length random bytes from the given seed, followed by
+ *              TEST_INPUT_PADDING more for code that reads past the end
+ *
+ * Parameters:
+ *   length     The number of bytes to create
+ *   seed       The seed passed to srandom()
+ * Returns:     The malloc'd bytes, which the caller must free
+ * ----------------------------------------------------------------------------
+ */
+uint8_t *createRandomInput(uint32_t length, uint32_t seed);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Timing Functions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    getSeconds
+ * Description: Reads the monotonic clock
+ *
+ * Returns:     The monotonic time in seconds
+ * ----------------------------------------------------------------------------
+ */
+double getSeconds();
+
+#endif /* ORG_DEVOPSBROKER_TEST_TESTINPUT_H */
@@ -87,6 +87,23 @@ time_t a66923ff_convertTimeFromDOS(uint16_t dosDate, uint16_t dosTime) {
 	return mktime(&dos);
 }
 
+void a66923ff_convertTimeToDOS(time_t seconds, uint16_t *dosDate, uint16_t *dosTime) {
+	Time dos;
+
+	// 1. Break down the local time, the same as the MS-DOS conversion uses
+	if (localtime_r(&seconds, &dos) == NULL || dos.tm_year < 80) {
+		*dosDate = (1 << 5) | 1;
+		*dosTime = 0;
+		return;
+	}
+
+	// 2. Convert to the MS-DOS date
+	*dosDate = ((dos.tm_year - 80) << 9) | ((dos.tm_mon + 1) << 5) | dos.tm_mday;
+
+	// 3. Convert to the MS-DOS time
+	*dosTime = (dos.tm_hour << 11) | (dos.tm_min << 5) | (dos.tm_sec >> 1);
+}
+
 time_t a66923ff_getTime() {
 	return time(NULL);
 }
@@ -120,6 +120,19 @@ void a66923ff_initTime(Time *time, time_t seconds);
  */
 time_t a66923ff_convertTimeFromDOS(uint16_t dosDate, uint16_t dosTime);
 
+/* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Function:    a66923ff_convertTimeToDOS
+ * Description: Converts a time_t value into the MS-DOS date and time format;
+ *              times before 1980 are clamped to January 1, 1980
+ *
+ * Parameters:
+ *   seconds    The time since epoch as a time_t object
+ *   dosDate    Set to the date in MS-DOS format
+ *   dosTime    Set to the time in MS-DOS format
+ * ----------------------------------------------------------------------------
+ */
+void a66923ff_convertTimeToDOS(time_t seconds, uint16_t *dosDate, uint16_t *dosTime);
+
 /* ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
  * Function:    a66923ff_getTime
  * Description: Returns the number of seconds since the Epoch,
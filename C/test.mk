@@ -56,6 +56,12 @@ default: test
 clean:
 	$(call printInfo,Cleaning $(SRC_DIR)/adt directory)
 	/bin/rm -fv $(SRC_DIR)/adt/*.a
+	$(call printInfo,Cleaning $(SRC_DIR)/compress directory)
+	/bin/rm -fv $(SRC_DIR)/compress/*.a
+	$(call printInfo,Cleaning $(SRC_DIR)/fs directory)
+	/bin/rm -fv $(SRC_DIR)/fs/*.a
+	$(call printInfo,Cleaning $(SRC_DIR)/hash directory)
+	/bin/rm -fv $(SRC_DIR)/hash/*.a
 	$(call printInfo,Cleaning $(SRC_DIR)/info directory)
 	/bin/rm -fv $(SRC_DIR)/info/*.a
 	$(call printInfo,Cleaning $(SRC_DIR)/io directory)
@@ -82,6 +88,22 @@ $(SRC_DIR)/adt/%.a: $(SRC_DIR)/adt/%.c
 	$(call printInfo,Compiling $(@F))
 	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -o $@
 
+$(SRC_DIR)/compress/%.a: $(SRC_DIR)/compress/%.c
+	$(call printInfo,Compiling $(@F))
+	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -lz -lpthread -o $@
+
+$(SRC_DIR)/fs/%.a: $(SRC_DIR)/fs/%.c
+	$(call printInfo,Compiling $(@F))
+	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -lpthread -o $@
+
+$(SRC_DIR)/hash/%.a: $(SRC_DIR)/hash/%.c
+	$(call printInfo,Compiling $(@F))
+	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -lpthread -o $@
+
+$(SRC_DIR)/io/%.a: $(SRC_DIR)/io/%.c
+	$(call printInfo,Compiling $(@F))
+	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -o $@
+
 $(SRC_DIR)/lang/%.a: $(SRC_DIR)/lang/%.c
 	$(call printInfo,Compiling $(@F))
 	$(CC) $(CFLAGS) $< $(INCLUDE_DIRS) $(LIB_DIRS) $(LIB_NAMES) -o $@
@@ -0,0 +1,195 @@
+/*
+ * testDeflate.c - DevOpsBroker C source file for testing org/devopsbroker/compress/deflate.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The Deflate output is checked by inflating it with zlib, and the compressed
+ * size and throughput are compared against zlib at the same level.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "org/devopsbroker/compress/deflate.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE  (4 * 1024 * 1024)
+#define TEST_CHUNK_SIZE  7777
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static int64_t deflateInput(int level, uint8_t *input, uint32_t length, uint32_t chunkSize, bool *isValid, double *elapsedTime);
+static void testDeflate_roundTrip(char *inputName, uint8_t *input, uint32_t length);
+static void testDeflate_benchmark(uint8_t *input, uint32_t length);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	uint8_t *textInput, *randomInput, *zeroInput;
+
+	textInput = createTextInput(TEST_INPUT_SIZE);
+	randomInput = createRandomInput(TEST_INPUT_SIZE / 4, 2);
+	zeroInput = calloc(TEST_INPUT_SIZE / 4, 1);
+
+	testDeflate_roundTrip("text", textInput, TEST_INPUT_SIZE);
+	testDeflate_roundTrip("random", randomInput, TEST_INPUT_SIZE / 4);
+	testDeflate_roundTrip("zero", zeroInput, TEST_INPUT_SIZE / 4);
+	testDeflate_roundTrip("single byte", textInput, 1);
+	testDeflate_benchmark(textInput, TEST_INPUT_SIZE);
+
+	free(textInput);
+	free(randomInput);
+	free(zeroInput);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static int64_t deflateInput(int level, uint8_t *input, uint32_t length, uint32_t chunkSize, bool *isValid, double *elapsedTime) {
+	OutputBuffer outputBuffer;
+	OutputBuffer *bufPtr;
+	Deflate deflate;
+	z_stream zStream;
+	uint8_t *output;
+	uint32_t offset, numBytes;
+	int64_t totalOut;
+	double startTime;
+	int status;
+
+	// 1. Compress the input in chunks
+	startTime = getSeconds();
+	c49f5b0d_initOutputBuffer(&outputBuffer);
+	a8a82d35_initDeflate(&deflate, level, &outputBuffer);
+
+	offset = 0;
+	do {
+		numBytes = (length - offset > chunkSize) ? chunkSize : length - offset;
+		a8a82d35_deflate(&deflate, input + offset, numBytes, offset + numBytes == length);
+		offset += numBytes;
+	} while (offset < length);
+
+	*elapsedTime = getSeconds() - startTime;
+
+	// 2. Inflate the OutputBuffer chain with zlib and compare with the input
+	output = malloc(length + 1);
+	memset(&zStream, 0, sizeof(z_stream));
+	inflateInit2(&zStream, -MAX_WBITS);
+	zStream.next_out = output;
+	zStream.avail_out = length + 1;
+	status = Z_OK;
+
+	for (bufPtr = &outputBuffer; bufPtr != NULL && status == Z_OK; bufPtr = bufPtr->next) {
+		zStream.next_in = bufPtr->buffer;
+		zStream.avail_in = bufPtr->length;
+		status = inflate(&zStream, Z_NO_FLUSH);
+	}
+
+	*isValid = (status == Z_STREAM_END && zStream.total_out == length && memcmp(input, output, length) == 0
+	           && deflate.crc32 == crc32(0, input, length));
+	totalOut = deflate.totalOut;
+
+	inflateEnd(&zStream);
+	free(output);
+	a8a82d35_cleanUpDeflate(&deflate);
+	c49f5b0d_cleanUpOutputBuffer(&outputBuffer);
+
+	return totalOut;
+}
+
+static void testDeflate_roundTrip(char *inputName, uint8_t *input, uint32_t length) {
+	char label[64];
+	double elapsedTime;
+	bool isValid;
+
+	printf("a8a82d35_deflate(): %s input\n", inputName);
+
+	for (int level=DEFLATE_MIN_LEVEL; level <= DEFLATE_MAX_LEVEL; level++) {
+		deflateInput(level, input, length, length, &isValid, &elapsedTime);
+		sprintf(label, "  level %d\t\t\t\t", level);
+		positiveTestBool(label, true, isValid);
+
+		deflateInput(level, input, length, TEST_CHUNK_SIZE, &isValid, &elapsedTime);
+		sprintf(label, "  level %d, %d byte chunks\t\t", level, TEST_CHUNK_SIZE);
+		positiveTestBool(label, true, isValid);
+	}
+
+	printf("\n");
+}
+
+static void testDeflate_benchmark(uint8_t *input, uint32_t length) {
+	static const int levelList[] = { 1, 6, 9 };
+	z_stream zStream;
+	uint8_t *output;
+	uLong outputLength;
+	int64_t deflateSize;
+	double startTime, deflateTime, zlibTime;
+	bool isValid;
+	int level;
+
+	printTestName("a8a82d35_deflate() versus zlib");
+
+	for (uint32_t i=0; i < sizeof(levelList) / sizeof(int); i++) {
+		level = levelList[i];
+
+		deflateSize = deflateInput(level, input, length, length, &isValid, &deflateTime);
+		positiveTestBool("  round trip\t\t\t\t", true, isValid);
+
+		memset(&zStream, 0, sizeof(z_stream));
+		deflateInit2(&zStream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+		outputLength = deflateBound(&zStream, length);
+		output = malloc(outputLength);
+
+		startTime = getSeconds();
+		zStream.next_in = input;
+		zStream.avail_in = length;
+		zStream.next_out = output;
+		zStream.avail_out = outputLength;
+		deflate(&zStream, Z_FINISH);
+		zlibTime = getSeconds() - startTime;
+
+		printf("  level %d: deflate %ld bytes in %.3fs, zlib %lu bytes in %.3fs\n",
+		       level, deflateSize, deflateTime, zStream.total_out, zlibTime);
+
+		deflateEnd(&zStream);
+		free(output);
+	}
+
+	printf("\n");
+}
@@ -0,0 +1,496 @@
+/*
+ * testGzip.c - DevOpsBroker C source file for testing org/devopsbroker/compress/gzip.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * Gzip files written by zlib are read back with GzipReader, and gzip files
+ * written by GzipWriter are read back with zlib. The zlib files cover several
+ * members, every optional header field, corrupt trailers and trailing garbage.
+ * The parallel gzip files are checked against the single-threaded ones for
+ * one to four threads, including input that ends on a batch boundary.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include "org/devopsbroker/compress/gzip.h"
+#include "org/devopsbroker/lang/error.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE   (1024 * 1024)
+#define TEST_READ_LENGTH  1000
+
+// Room after a gzip file for a second member or trailing garbage
+#define TEST_TRAILER_SIZE  64
+
+// Offset of the FHCRC in the member written with every optional field
+#define TEST_FHCRC_OFFSET  (GZIP_HEADER_SIZE + 2 + 11 + 13 + 8)
+
+// Blocks read per worker thread before the workers start, as in gzip.c
+#define TEST_BLOCKS_PER_THREAD  8
+#define TEST_MAX_THREADS        4
+#define TEST_PARALLEL_SIZE      (2 * TEST_MAX_THREADS * TEST_BLOCKS_PER_THREAD * GZIP_BLOCK_SIZE)
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+static char testDirName[] = "/tmp/testGzip.XXXXXX";
+static char inputName[64];
+static char outputName[64];
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static uint8_t *gzipWithZlib(uint8_t *input, uint32_t length, gz_header *gzHeader, uint32_t *compressLength);
+static bool isZlibGunzip(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length);
+static void writeTestFile(char *fileName, uint8_t *data, uint32_t length);
+static uint8_t *readTestFile(char *fileName, uint32_t *length);
+static bool isGunzipped(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length);
+static uint8_t *gzipTestFile(uint32_t numThreads, uint32_t *gzipLength);
+
+static void testGzip_gunzip(uint8_t *input, uint32_t length);
+static void testGzip_readGzip(uint8_t *input, uint32_t length);
+static void testGzip_gzip(uint8_t *input, uint32_t length);
+static void testGzip_gzipParallel(uint8_t *input, uint32_t numThreads);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	uint8_t *textInput;
+
+	textInput = createTextInput(TEST_PARALLEL_SIZE);
+
+	mkdtemp(testDirName);
+	sprintf(inputName, "%s/input", testDirName);
+	sprintf(outputName, "%s/output", testDirName);
+
+	testGzip_gunzip(textInput, TEST_INPUT_SIZE);
+	testGzip_readGzip(textInput, TEST_INPUT_SIZE);
+	testGzip_gzip(textInput, TEST_INPUT_SIZE);
+
+	for (uint32_t numThreads=1; numThreads <= TEST_MAX_THREADS; numThreads++) {
+		testGzip_gzipParallel(textInput, numThreads);
+	}
+
+	unlink(inputName);
+	unlink(outputName);
+	rmdir(testDirName);
+
+	free(textInput);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static uint8_t *gzipWithZlib(uint8_t *input, uint32_t length, gz_header *gzHeader, uint32_t *compressLength) {
+	z_stream zStream;
+	uint8_t *compressed;
+	uLong compressSize;
+
+	memset(&zStream, 0, sizeof(z_stream));
+	deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+
+	if (gzHeader != NULL) {
+		deflateSetHeader(&zStream, gzHeader);
+	}
+
+	compressSize = deflateBound(&zStream, length) + TEST_TRAILER_SIZE;
+	compressed = calloc(compressSize + TEST_TRAILER_SIZE, 1);
+
+	zStream.next_in = input;
+	zStream.avail_in = length;
+	zStream.next_out = compressed;
+	zStream.avail_out = compressSize;
+	deflate(&zStream, Z_FINISH);
+
+	*compressLength = zStream.total_out;
+	deflateEnd(&zStream);
+
+	return compressed;
+}
+
+static bool isZlibGunzip(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length) {
+	z_stream zStream;
+	uint8_t *output;
+	uint32_t numOutput;
+	int status;
+
+	output = malloc(length + 1);
+	memset(&zStream, 0, sizeof(z_stream));
+	inflateInit2(&zStream, MAX_WBITS + 16);
+
+	zStream.next_in = compressed;
+	zStream.avail_in = compressLength;
+	zStream.next_out = output;
+	zStream.avail_out = length + 1;
+
+	// Inflate one member after the other until the input is used up
+	do {
+		status = inflate(&zStream, Z_NO_FLUSH);
+
+		if (status == Z_STREAM_END && zStream.avail_in > 0) {
+			inflateReset(&zStream);
+			status = Z_OK;
+		}
+	} while (status == Z_OK);
+
+	numOutput = length + 1 - zStream.avail_out;
+	inflateEnd(&zStream);
+
+	status = (status == Z_STREAM_END && numOutput == length && memcmp(input, output, length) == 0);
+	free(output);
+
+	return status;
+}
+
+static void writeTestFile(char *fileName, uint8_t *data, uint32_t length) {
+	FILE *file;
+
+	file = fopen(fileName, "w");
+	fwrite(data, 1, length, file);
+	fclose(file);
+}
+
+static uint8_t *readTestFile(char *fileName, uint32_t *length) {
+	uint8_t *data;
+	FILE *file;
+	long fileSize;
+
+	file = fopen(fileName, "r");
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	data = malloc(fileSize + 1);
+	*length = fread(data, 1, fileSize, file);
+	fclose(file);
+
+	return data;
+}
+
+static bool isGunzipped(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length) {
+	uint8_t *output;
+	uint32_t outputLength;
+	int inputFd, outputFd;
+	bool isOk;
+
+	// 1. Decompress the gzip file straight into the output file
+	writeTestFile(inputName, compressed, compressLength);
+
+	inputFd = open(inputName, O_RDONLY);
+	outputFd = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	isOk = aadb6d78_gunzip(inputFd, outputFd, inputName);
+
+	close(inputFd);
+	close(outputFd);
+
+	// 2. Only a successful decompression has to reproduce the input
+	if (isOk) {
+		output = readTestFile(outputName, &outputLength);
+		isOk = (outputLength == length && memcmp(input, output, length) == 0);
+		free(output);
+	}
+
+	return isOk;
+}
+
+static uint8_t *gzipTestFile(uint32_t numThreads, uint32_t *gzipLength) {
+	uint8_t *gzip;
+	int inputFd, outputFd;
+	bool isOk;
+
+	inputFd = open(inputName, O_RDONLY);
+	outputFd = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	isOk = aadb6d78_gzipParallel(inputFd, outputFd, outputName, 6, numThreads);
+	close(inputFd);
+	close(outputFd);
+
+	if (!isOk) {
+		return NULL;
+	}
+
+	gzip = readTestFile(outputName, gzipLength);
+
+	return gzip;
+}
+
+static void testGzip_gunzip(uint8_t *input, uint32_t length) {
+	static const char garbage[] = "trailing garbage";
+	gz_header gzHeader;
+	uint8_t *gzip, *secondMember, *gzipHeader, *gzipEmpty;
+	uint32_t gzipLength, firstLength, gzipHeaderLength, gzipEmptyLength;
+
+	printTestName("aadb6d78_gunzip()");
+
+	// 1. A gzip file of two members, a member with every optional field, and an empty member
+	gzip = gzipWithZlib(input, length / 3, NULL, &firstLength);
+	secondMember = gzipWithZlib(input + length / 3, length - length / 3, NULL, &gzipLength);
+	gzip = realloc(gzip, firstLength + gzipLength + TEST_TRAILER_SIZE);
+	memcpy(gzip + firstLength, secondMember, gzipLength + TEST_TRAILER_SIZE);
+	gzipLength += firstLength;
+	free(secondMember);
+
+	memset(&gzHeader, 0, sizeof(gz_header));
+	gzHeader.extra = (uint8_t*) "extra field";
+	gzHeader.extra_len = 11;
+	gzHeader.name = (uint8_t*) "testGzip.txt";
+	gzHeader.comment = (uint8_t*) "comment";
+	gzHeader.hcrc = 1;
+	gzipHeader = gzipWithZlib(input, length, &gzHeader, &gzipHeaderLength);
+	gzipEmpty = gzipWithZlib(input, 0, NULL, &gzipEmptyLength);
+
+	positiveTestBool("  two members\t\t\t\t", true, isGunzipped(gzip, gzipLength, input, length));
+	positiveTestBool("  FEXTRA, FNAME, FCOMMENT and FHCRC\t", true, isGunzipped(gzipHeader, gzipHeaderLength, input, length));
+	positiveTestBool("  empty member\t\t\t\t", true, isGunzipped(gzipEmpty, gzipEmptyLength, input, 0));
+
+	// 2. Trailing garbage after the last member is ignored, as gzip does
+	memcpy(gzip + gzipLength, garbage, sizeof(garbage));
+	positiveTestBool("  trailing garbage\t\t\t", true, isGunzipped(gzip, gzipLength + sizeof(garbage), input, length));
+
+	// 3. Empty and cut off files
+	positiveTestBool("  empty file fails\t\t\t", false, isGunzipped(gzip, 0, input, 0));
+	positiveTestBool("  cut off header fails\t\t\t", false, isGunzipped(gzipHeader, TEST_FHCRC_OFFSET, input, length));
+	positiveTestBool("  cut off trailer fails\t\t", false, isGunzipped(gzip, gzipLength - 1, input, length));
+
+	// 4. Corrupt CRC-32 and ISIZE of the first member, and FHCRC
+	gzip[firstLength - 8] ^= 0x01;
+	positiveTestBool("  bad CRC-32 fails\t\t\t", false, isGunzipped(gzip, gzipLength, input, length));
+	gzip[firstLength - 8] ^= 0x01;
+
+	gzip[firstLength - 4] ^= 0x01;
+	positiveTestBool("  bad ISIZE fails\t\t\t", false, isGunzipped(gzip, gzipLength, input, length));
+	gzip[firstLength - 4] ^= 0x01;
+
+	gzipHeader[TEST_FHCRC_OFFSET] ^= 0x01;
+	positiveTestBool("  bad FHCRC fails\t\t\t", false, isGunzipped(gzipHeader, gzipHeaderLength, input, length));
+
+	// 5. The file is still valid after undoing the corruption
+	positiveTestBool("  repaired file\t\t\t\t", true, isGunzipped(gzip, gzipLength, input, length));
+
+	free(gzip);
+	free(gzipHeader);
+	free(gzipEmpty);
+
+	printf("\n");
+}
+
+static void testGzip_readGzip(uint8_t *input, uint32_t length) {
+	GzipReader gzipReader;
+	gz_header gzHeader;
+	uint8_t *gzip, *output;
+	uint32_t gzipLength, outputLength;
+	ssize_t numBytes;
+	int inputFd;
+
+	printTestName("aadb6d78_readGzip()");
+
+	// 1. A member with FNAME and MTIME
+	memset(&gzHeader, 0, sizeof(gz_header));
+	gzHeader.name = (uint8_t*) "testGzip.txt";
+	gzHeader.time = 1589000000;
+	gzip = gzipWithZlib(input, length, &gzHeader, &gzipLength);
+	writeTestFile(inputName, gzip, gzipLength);
+
+	// 2. Read the decompressed data in pieces that do not line up with the output chunks
+	inputFd = open(inputName, O_RDONLY);
+	aadb6d78_initGzipReader(&gzipReader, inputFd, inputName);
+
+	output = malloc(length + TEST_READ_LENGTH);
+	outputLength = 0;
+
+	while ((numBytes = aadb6d78_readGzip(&gzipReader, output + outputLength, TEST_READ_LENGTH)) > 0) {
+		outputLength += numBytes;
+	}
+
+	positiveTestBool("  readGzip() ends with zero\t\t", true, numBytes == 0);
+	positiveTestBool("  decompressed data matches\t\t", true, outputLength == length && memcmp(input, output, length) == 0);
+	positiveTestBool("  FNAME = testGzip.txt\t\t\t", true, gzipReader.fileName != NULL && strcmp(gzipReader.fileName, "testGzip.txt") == 0);
+	positiveTestInt("  MTIME = 1589000000\t\t\t", 1589000000, gzipReader.modTime);
+	positiveTestInt("  numMembers = 1\t\t\t", 1, gzipReader.numMembers);
+
+	aadb6d78_cleanUpGzipReader(&gzipReader);
+	close(inputFd);
+
+	// 3. A bad CRC-32 is reported once the data before it has been read
+	gzip[gzipLength - 8] ^= 0x01;
+	writeTestFile(inputName, gzip, gzipLength);
+
+	inputFd = open(inputName, O_RDONLY);
+	aadb6d78_initGzipReader(&gzipReader, inputFd, inputName);
+
+	while ((numBytes = aadb6d78_readGzip(&gzipReader, output, TEST_READ_LENGTH)) > 0);
+
+	positiveTestBool("  bad CRC-32 returns an error\t\t", true, numBytes == SYSTEM_ERROR_CODE);
+
+	aadb6d78_cleanUpGzipReader(&gzipReader);
+	close(inputFd);
+
+	free(output);
+	free(gzip);
+
+	printf("\n");
+}
+
+static void testGzip_gzip(uint8_t *input, uint32_t length) {
+	static const int levelList[] = { 1, 6, 9 };
+	GzipWriter gzipWriter;
+	z_stream zStream;
+	gz_header gzHeader;
+	uint8_t *gzip;
+	uint8_t fileName[32];
+	uint8_t outputByte;
+	uint32_t gzipLength;
+	char label[64];
+	int inputFd, outputFd;
+	bool isOk;
+
+	printTestName("aadb6d78_gzip()");
+
+	// 1. One member per level, and one of empty input
+	writeTestFile(inputName, input, length);
+
+	for (uint32_t i=0; i < sizeof(levelList) / sizeof(int); i++) {
+		inputFd = open(inputName, O_RDONLY);
+		outputFd = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		isOk = aadb6d78_gzip(inputFd, outputFd, outputName, levelList[i]);
+		close(inputFd);
+		close(outputFd);
+
+		gzip = readTestFile(outputName, &gzipLength);
+		sprintf(label, "  level %d, zlib gunzips it\t\t", levelList[i]);
+		positiveTestBool(label, true, isOk && isZlibGunzip(gzip, gzipLength, input, length));
+		free(gzip);
+	}
+
+	writeTestFile(inputName, input, 0);
+	inputFd = open(inputName, O_RDONLY);
+	outputFd = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	isOk = aadb6d78_gzip(inputFd, outputFd, outputName, 6);
+	close(inputFd);
+	close(outputFd);
+
+	gzip = readTestFile(outputName, &gzipLength);
+	positiveTestBool("  empty input, zlib gunzips it\t\t", true, isOk && isZlibGunzip(gzip, gzipLength, input, 0));
+	free(gzip);
+
+	// 2. Two members written one after the other; the first has an FNAME and MTIME
+	outputFd = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	aadb6d78_initGzipWriter(&gzipWriter, outputFd, outputName, 6);
+
+	aadb6d78_startMember(&gzipWriter, "testGzip.txt", 1589000000);
+	isOk = aadb6d78_writeGzip(&gzipWriter, input, length / 2);
+	isOk &= aadb6d78_finishMember(&gzipWriter);
+
+	aadb6d78_startMember(&gzipWriter, NULL, 0);
+	isOk &= aadb6d78_writeGzip(&gzipWriter, input + length / 2, length - length / 2);
+	isOk &= aadb6d78_finishMember(&gzipWriter);
+
+	aadb6d78_cleanUpGzipWriter(&gzipWriter);
+	close(outputFd);
+
+	gzip = readTestFile(outputName, &gzipLength);
+	positiveTestBool("  two members, zlib gunzips them\t", true, isOk && isZlibGunzip(gzip, gzipLength, input, length));
+
+	// 3. zlib reads the FNAME and MTIME of the first member
+	memset(&zStream, 0, sizeof(z_stream));
+	memset(&gzHeader, 0, sizeof(gz_header));
+	gzHeader.name = fileName;
+	gzHeader.name_max = sizeof(fileName);
+
+	inflateInit2(&zStream, MAX_WBITS + 16);
+	inflateGetHeader(&zStream, &gzHeader);
+	zStream.next_in = gzip;
+	zStream.avail_in = gzipLength;
+	zStream.next_out = &outputByte;
+	zStream.avail_out = 1;
+	inflate(&zStream, Z_BLOCK);
+
+	positiveTestBool("  FNAME = testGzip.txt\t\t\t", true, gzHeader.done == 1 && strcmp((char*) fileName, "testGzip.txt") == 0);
+	positiveTestInt("  MTIME = 1589000000\t\t\t", 1589000000, gzHeader.time);
+
+	inflateEnd(&zStream);
+	free(gzip);
+
+	printf("\n");
+}
+
+static void testGzip_gzipParallel(uint8_t *input, uint32_t numThreads) {
+	// Empty and one byte input, one block plus a byte, whole batches, and a partial batch
+	const uint32_t batchLength = numThreads * TEST_BLOCKS_PER_THREAD * GZIP_BLOCK_SIZE;
+	const uint32_t lengthList[] = {
+		0, 1, GZIP_BLOCK_SIZE + 1, batchLength, 2 * batchLength, batchLength + 12345
+	};
+	uint8_t *gzip;
+	uint8_t *serialGzip;
+	uint32_t gzipLength, serialLength;
+	char label[64];
+	bool isValid;
+
+	sprintf(label, "aadb6d78_gzipParallel(%u thread%s)", numThreads, (numThreads == 1) ? "" : "s");
+	printTestName(label);
+
+	for (uint32_t i=0; i < sizeof(lengthList) / sizeof(uint32_t); i++) {
+		// 1. Both gzip files share the input file, and so its MTIME
+		writeTestFile(inputName, input, lengthList[i]);
+		serialGzip = gzipTestFile(1, &serialLength);
+		gzip = gzipTestFile(numThreads, &gzipLength);
+
+		isValid = (serialGzip != NULL && gzip != NULL);
+
+		// 2. The header and the CRC-32 and ISIZE trailer match the single-threaded ones
+		if (isValid) {
+			isValid = memcmp(gzip, serialGzip, GZIP_HEADER_SIZE) == 0
+			       && memcmp(gzip + gzipLength - GZIP_TRAILER_SIZE, serialGzip + serialLength - GZIP_TRAILER_SIZE, GZIP_TRAILER_SIZE) == 0;
+		}
+
+		sprintf(label, "  %u bytes, matches gzip()\t\t", lengthList[i]);
+		positiveTestBool(label, true, isValid);
+
+		// 3. Both zlib and GzipReader decompress it back into the input
+		sprintf(label, "  %u bytes, zlib gunzips it\t\t", lengthList[i]);
+		positiveTestBool(label, true, gzip != NULL && isZlibGunzip(gzip, gzipLength, input, lengthList[i]));
+
+		sprintf(label, "  %u bytes, gunzip() reads it\t\t", lengthList[i]);
+		positiveTestBool(label, true, gzip != NULL && isGunzipped(gzip, gzipLength, input, lengthList[i]));
+
+		free(serialGzip);
+		free(gzip);
+	}
+
+	printf("\n");
+}
@@ -0,0 +1,869 @@
+/*
+ * testInflate.c - DevOpsBroker C source file for testing org/devopsbroker/compress/inflate.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * The Inflate input is produced by zlib, and the inflated output is checked
+ * against the original bytes chunk by chunk. The input is pulled from a chain
+ * of FileBuffers or fed in pieces, with the split points chosen at random.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "org/devopsbroker/compress/inflate.h"
+#include "org/devopsbroker/hash/crc32.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE   (4 * 1024 * 1024)
+#define TEST_MAX_SPLIT    20000
+#define TEST_MAX_BUFFERS  8192
+
+// Room after a compressed stream for trailing garbage
+#define TEST_TRAILER_SIZE  64
+
+// Enough split points to cut a dynamic block header at every byte
+#define TEST_HEADER_SPLITS  320
+
+// Repeats just inside the 32KB window so every backref reaches across the ring
+#define TEST_RING_PERIOD  (INFLATE_WINDOW_SIZE - 777)
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static uint8_t *deflateInput(uint8_t *input, uint32_t length, int level, int strategy, uint32_t *compressLength);
+static bool isEqualChunk(Inflate *inflate, uint8_t *input, uint32_t length, uint32_t *offset);
+static bool inflatePull(uint8_t *compressed, uint32_t compressLength, uint32_t maxSplit, uint8_t *input,
+                        uint32_t length, InflationStatus *status);
+static bool feedPiece(Inflate *inflate, uint8_t *piece, uint32_t pieceLength, uint8_t *input, uint32_t length,
+                      uint32_t *outputOffset, uint32_t *numOutputFull, bool *isEqual);
+static bool inflateFeed(uint8_t *compressed, uint32_t compressLength, uint32_t maxSplit, uint8_t *input,
+                        uint32_t length, InflationStatus *status);
+static bool inflateSplit(uint8_t *compressed, uint32_t compressLength, uint32_t splitOffset, uint8_t *input,
+                         uint32_t length, uint32_t *numOutputFull);
+static uint64_t findBlockHeader(uint8_t *compressed, uint32_t compressLength, uint32_t length, uint32_t blockNum);
+static uint8_t *inflateOutput(uint8_t *compressed, uint32_t compressLength, uint32_t length);
+static uint8_t *deflateFormat(uint8_t *input, uint32_t length, int windowBits, gz_header *gzHeader, uint32_t *compressLength);
+static bool isInflatedBuffer(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length,
+                             InflateFormat format, InflationStatus expectedStatus);
+
+static void testInflate_roundTrip(char *inputName, uint8_t *input, uint32_t length);
+static void testInflate_blockTypes(uint8_t *input, uint32_t length);
+static void testInflate_ringWrap(uint8_t *input, uint32_t length);
+static void testInflate_truncated(uint8_t *input, uint32_t length);
+static void testInflate_corrupt(uint8_t *input, uint32_t length);
+static void testInflate_feedOneByte(uint8_t *input, uint32_t length);
+static void testInflate_feedOutputFull(uint8_t *input, uint32_t length);
+static void testInflate_feedSplitHeader(uint8_t *input, uint32_t length);
+static void testInflate_fastLoop(char *inputName, uint8_t *input, uint32_t length);
+static void testInflate_crc32(uint8_t *input, uint32_t length);
+static void testInflate_inflateBuffer(uint8_t *input, uint32_t length);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	uint8_t *textInput, *randomInput, *zeroInput;
+
+	textInput = createTextInput(TEST_INPUT_SIZE);
+	randomInput = createRandomInput(TEST_INPUT_SIZE / 4, 3);
+	zeroInput = calloc(TEST_INPUT_SIZE / 4, 1);
+
+	testInflate_roundTrip("text", textInput, TEST_INPUT_SIZE);
+	testInflate_roundTrip("random", randomInput, TEST_INPUT_SIZE / 4);
+	testInflate_roundTrip("zero", zeroInput, TEST_INPUT_SIZE / 4);
+	testInflate_roundTrip("single byte", textInput, 1);
+	testInflate_blockTypes(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_ringWrap(randomInput, TEST_INPUT_SIZE / 4);
+	testInflate_truncated(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_corrupt(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_feedOneByte(textInput, TEST_INPUT_SIZE / 16);
+	testInflate_feedOutputFull(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_feedSplitHeader(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_fastLoop("text", textInput, TEST_INPUT_SIZE);
+	testInflate_fastLoop("random", randomInput, TEST_INPUT_SIZE / 4);
+	testInflate_crc32(textInput, TEST_INPUT_SIZE / 4);
+	testInflate_inflateBuffer(textInput, TEST_INPUT_SIZE / 4);
+
+	free(textInput);
+	free(randomInput);
+	free(zeroInput);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static uint8_t *deflateInput(uint8_t *input, uint32_t length, int level, int strategy, uint32_t *compressLength) {
+	z_stream zStream;
+	uint8_t *compressed;
+	uLong compressSize;
+
+	memset(&zStream, 0, sizeof(z_stream));
+	deflateInit2(&zStream, level, Z_DEFLATED, -MAX_WBITS, 8, strategy);
+	compressSize = deflateBound(&zStream, length);
+	compressed = malloc(compressSize + TEST_INPUT_PADDING);
+
+	zStream.next_in = input;
+	zStream.avail_in = length;
+	zStream.next_out = compressed;
+	zStream.avail_out = compressSize;
+	deflate(&zStream, Z_FINISH);
+
+	*compressLength = zStream.total_out;
+	deflateEnd(&zStream);
+
+	// The padding is not part of the stream
+	memset(compressed + *compressLength, 0, TEST_INPUT_PADDING);
+
+	return compressed;
+}
+
+static bool isEqualChunk(Inflate *inflate, uint8_t *input, uint32_t length, uint32_t *offset) {
+	bool isEqual;
+
+	isEqual = (length - *offset >= inflate->outputLength)
+	          && memcmp(input + *offset, inflate->output, inflate->outputLength) == 0;
+	*offset += inflate->outputLength;
+
+	return isEqual;
+}
+
+static bool inflatePull(uint8_t *compressed, uint32_t compressLength, uint32_t maxSplit, uint8_t *input,
+                        uint32_t length, InflationStatus *status) {
+	FileBuffer *fileBuffers;
+	Inflate inflate;
+	uint32_t numBuffers, inputOffset, outputOffset, numBytes;
+	bool isInflated, isEqual;
+
+	// 1. Split the compressed stream across a chain of FileBuffers
+	fileBuffers = calloc(TEST_MAX_BUFFERS, sizeof(FileBuffer));
+	numBuffers = 0;
+	inputOffset = 0;
+
+	do {
+		numBytes = (maxSplit == 0) ? compressLength : 1 + (random() % maxSplit);
+
+		if (numBytes > compressLength - inputOffset || numBuffers == TEST_MAX_BUFFERS - 1) {
+			numBytes = compressLength - inputOffset;
+		}
+
+		ce97d170_initFileBuffer(&fileBuffers[numBuffers], compressed + inputOffset);
+		fileBuffers[numBuffers].fileOffset = inputOffset;
+		fileBuffers[numBuffers].numBytes = numBytes;
+
+		if (numBuffers > 0) {
+			fileBuffers[numBuffers - 1].next = &fileBuffers[numBuffers];
+		}
+
+		inputOffset += numBytes;
+		numBuffers++;
+	} while (inputOffset < compressLength);
+
+	// 2. Pull every chunk of output and compare it with the input
+	d592eb82_initInflate(&inflate, fileBuffers, compressLength);
+	outputOffset = 0;
+	isEqual = true;
+
+	while (!(isInflated = d592eb82_inflate(&inflate)) && inflate.status == INFLATE_OUTPUT_FULL) {
+		isEqual &= isEqualChunk(&inflate, input, length, &outputOffset);
+	}
+
+	// The CRC-32 is updated as each chunk is handed out
+	if (isInflated) {
+		isEqual &= isEqualChunk(&inflate, input, length, &outputOffset);
+		isEqual &= (inflate.crc32 == b7e0468d_crc32(input, length, 0));
+	}
+
+	*status = inflate.status;
+
+	d592eb82_cleanUpInflate(&inflate);
+	free(fileBuffers);
+
+	return isInflated && isEqual && outputOffset == length;
+}
+
+static bool feedPiece(Inflate *inflate, uint8_t *piece, uint32_t pieceLength, uint8_t *input, uint32_t length,
+                      uint32_t *outputOffset, uint32_t *numOutputFull, bool *isEqual) {
+	uint8_t *feedChunk;
+	bool isInflated;
+
+	// 1. Feed a copy of the piece, which is clobbered once the piece is used up
+	feedChunk = malloc(pieceLength);
+	memcpy(feedChunk, piece, pieceLength);
+	isInflated = d592eb82_inflateFeed(inflate, feedChunk, pieceLength);
+
+	// 2. Take each full chunk of output and resume
+	while (!isInflated && inflate->status == INFLATE_OUTPUT_FULL) {
+		*isEqual &= isEqualChunk(inflate, input, length, outputOffset);
+		*numOutputFull += 1;
+		isInflated = d592eb82_inflateFeed(inflate, NULL, 0);
+	}
+
+	memset(feedChunk, 0xA5, pieceLength);
+	free(feedChunk);
+
+	return isInflated;
+}
+
+static bool inflateFeed(uint8_t *compressed, uint32_t compressLength, uint32_t maxSplit, uint8_t *input,
+                        uint32_t length, InflationStatus *status) {
+	Inflate inflate;
+	uint32_t inputOffset, outputOffset, numBytes, numOutputFull;
+	bool isInflated, isEqual;
+
+	d592eb82_initInflate(&inflate, NULL, 0);
+	inputOffset = 0;
+	outputOffset = 0;
+	numOutputFull = 0;
+	isEqual = true;
+
+	do {
+		numBytes = 1 + (random() % maxSplit);
+
+		if (numBytes > compressLength - inputOffset) {
+			numBytes = compressLength - inputOffset;
+		}
+
+		isInflated = feedPiece(&inflate, compressed + inputOffset, numBytes, input, length, &outputOffset,
+		                       &numOutputFull, &isEqual);
+		inputOffset += numBytes;
+	} while (!isInflated && inflate.status == INFLATE_NEED_INPUT && inputOffset < compressLength);
+
+	if (isInflated) {
+		isEqual &= isEqualChunk(&inflate, input, length, &outputOffset);
+		isEqual &= (inflate.crc32 == b7e0468d_crc32(input, length, 0));
+	}
+
+	*status = inflate.status;
+
+	d592eb82_cleanUpInflate(&inflate);
+
+	return isInflated && isEqual && outputOffset == length;
+}
+
+static bool inflateSplit(uint8_t *compressed, uint32_t compressLength, uint32_t splitOffset, uint8_t *input,
+                         uint32_t length, uint32_t *numOutputFull) {
+	Inflate inflate;
+	uint32_t outputOffset;
+	bool isInflated, isEqual;
+
+	d592eb82_initInflate(&inflate, NULL, 0);
+	outputOffset = 0;
+	*numOutputFull = 0;
+	isEqual = true;
+
+	// 1. The first piece must leave the Inflate waiting for more input
+	isInflated = feedPiece(&inflate, compressed, splitOffset, input, length, &outputOffset, numOutputFull, &isEqual);
+	isEqual &= (!isInflated && inflate.status == INFLATE_NEED_INPUT);
+
+	// 2. The second piece finishes the stream
+	if (isEqual) {
+		isInflated = feedPiece(&inflate, compressed + splitOffset, compressLength - splitOffset, input, length,
+		                       &outputOffset, numOutputFull, &isEqual);
+	}
+
+	if (isInflated) {
+		isEqual &= isEqualChunk(&inflate, input, length, &outputOffset);
+	}
+
+	d592eb82_cleanUpInflate(&inflate);
+
+	return isInflated && isEqual && outputOffset == length;
+}
+
+static uint64_t findBlockHeader(uint8_t *compressed, uint32_t compressLength, uint32_t length, uint32_t blockNum) {
+	z_stream zStream;
+	uint8_t *output;
+	uint64_t bitPos;
+	int status;
+
+	// Have zlib stop at every block boundary; data_type holds the unused bits of the last byte read
+	output = malloc(length + 1);
+	memset(&zStream, 0, sizeof(z_stream));
+	inflateInit2(&zStream, -MAX_WBITS);
+	zStream.next_in = compressed;
+	zStream.avail_in = compressLength;
+	zStream.next_out = output;
+	zStream.avail_out = length + 1;
+	bitPos = 0;
+
+	for (uint32_t i=0; i < blockNum; i++) {
+		status = inflate(&zStream, Z_BLOCK);
+
+		// Skip the stop at the start of the stream
+		while (status == Z_OK && zStream.total_in == 0) {
+			status = inflate(&zStream, Z_BLOCK);
+		}
+
+		if (status != Z_OK || (zStream.data_type & 0x80) == 0) {
+			bitPos = 0;
+			break;
+		}
+
+		bitPos = (zStream.total_in << 3) - (zStream.data_type & 0x07);
+	}
+
+	inflateEnd(&zStream);
+	free(output);
+
+	return bitPos;
+}
+
+static uint8_t *inflateOutput(uint8_t *compressed, uint32_t compressLength, uint32_t length) {
+	FileBuffer fileBuffer;
+	Inflate inflate;
+	uint8_t *output;
+	uint32_t outputOffset;
+	bool isInflated;
+
+	ce97d170_initFileBuffer(&fileBuffer, compressed);
+	fileBuffer.numBytes = compressLength;
+
+	d592eb82_initInflate(&inflate, &fileBuffer, compressLength);
+	output = calloc(length + INFLATE_OUTPUT_LENGTH, 1);
+	outputOffset = 0;
+
+	// Copy out every chunk, stopping at the first one past the expected length
+	do {
+		isInflated = d592eb82_inflate(&inflate);
+
+		if (isInflated || inflate.status == INFLATE_OUTPUT_FULL) {
+			memcpy(output + outputOffset, inflate.output, inflate.outputLength);
+			outputOffset += inflate.outputLength;
+		}
+	} while (!isInflated && inflate.status == INFLATE_OUTPUT_FULL && outputOffset <= length);
+
+	d592eb82_cleanUpInflate(&inflate);
+
+	return output;
+}
+
+static uint8_t *deflateFormat(uint8_t *input, uint32_t length, int windowBits, gz_header *gzHeader, uint32_t *compressLength) {
+	z_stream zStream;
+	uint8_t *compressed;
+	uLong compressSize;
+
+	// -15 is raw DEFLATE, 15 is zlib and 31 is gzip
+	memset(&zStream, 0, sizeof(z_stream));
+	deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+
+	if (gzHeader != NULL) {
+		deflateSetHeader(&zStream, gzHeader);
+	}
+
+	compressSize = deflateBound(&zStream, length) + TEST_TRAILER_SIZE;
+	compressed = calloc(compressSize + TEST_TRAILER_SIZE, 1);
+
+	zStream.next_in = input;
+	zStream.avail_in = length;
+	zStream.next_out = compressed;
+	zStream.avail_out = compressSize;
+	deflate(&zStream, Z_FINISH);
+
+	*compressLength = zStream.total_out;
+	deflateEnd(&zStream);
+
+	return compressed;
+}
+
+static bool isInflatedBuffer(uint8_t *compressed, uint32_t compressLength, uint8_t *input, uint32_t length,
+                             InflateFormat format, InflationStatus expectedStatus) {
+	InflationStatus status;
+	uint8_t *output;
+	uint32_t numProduced;
+	bool isValid;
+
+	output = malloc(length + 1);
+	status = d592eb82_inflateBuffer(compressed, compressLength, output, length, &numProduced, format);
+
+	// Only a successful inflation has to reproduce the input
+	isValid = (status == expectedStatus);
+
+	if (isValid && status == INFLATE_SUCCESS) {
+		isValid = (numProduced == length && memcmp(input, output, length) == 0);
+	}
+
+	free(output);
+
+	return isValid;
+}
+
+static void testInflate_roundTrip(char *inputName, uint8_t *input, uint32_t length) {
+	InflationStatus status;
+	uint8_t *compressed;
+	uint32_t compressLength;
+	char label[64];
+
+	printf("d592eb82_inflate(): %s input\n", inputName);
+	srandom(3);
+
+	for (int level=Z_NO_COMPRESSION; level <= Z_BEST_COMPRESSION; level++) {
+		compressed = deflateInput(input, length, level, Z_DEFAULT_STRATEGY, &compressLength);
+
+		sprintf(label, "  level %d\t\t\t\t", level);
+		positiveTestBool(label, true, inflatePull(compressed, compressLength, 0, input, length, &status));
+
+		sprintf(label, "  level %d, random FileBuffer splits\t", level);
+		positiveTestBool(label, true, inflatePull(compressed, compressLength, TEST_MAX_SPLIT, input, length, &status));
+
+		sprintf(label, "  level %d, random feed splits\t\t", level);
+		positiveTestBool(label, true, inflateFeed(compressed, compressLength, TEST_MAX_SPLIT, input, length, &status));
+
+		free(compressed);
+	}
+
+	printf("\n");
+}
+
+static void testInflate_blockTypes(uint8_t *input, uint32_t length) {
+	static const int strategyList[] = { Z_DEFAULT_STRATEGY, Z_FIXED, Z_DEFAULT_STRATEGY };
+	static const int levelList[] = { Z_NO_COMPRESSION, Z_DEFAULT_COMPRESSION, Z_DEFAULT_COMPRESSION };
+	static const char *blockTypeName[] = { "stored", "fixed", "dynamic" };
+	InflationStatus status;
+	uint8_t *compressed;
+	uint32_t compressLength;
+	char label[64];
+
+	printTestName("d592eb82_inflate() block types");
+	srandom(3);
+
+	for (uint32_t blockType=0; blockType < 3; blockType++) {
+		compressed = deflateInput(input, length, levelList[blockType], strategyList[blockType], &compressLength);
+
+		// BTYPE follows the BFINAL bit of the first block header
+		sprintf(label, "  first block is %s\t\t", blockTypeName[blockType]);
+		positiveTestInt(label, blockType, (compressed[0] >> 1) & 0x03);
+
+		sprintf(label, "  %s blocks\t\t\t", blockTypeName[blockType]);
+		positiveTestBool(label, true, inflatePull(compressed, compressLength, 0, input, length, &status));
+
+		sprintf(label, "  %s blocks, random feed splits\t", blockTypeName[blockType]);
+		positiveTestBool(label, true, inflateFeed(compressed, compressLength, TEST_MAX_SPLIT, input, length, &status));
+
+		free(compressed);
+	}
+
+	printf("\n");
+}
+
+static void testInflate_ringWrap(uint8_t *input, uint32_t length) {
+	InflationStatus status;
+	uint8_t *periodic, *compressed;
+	uint32_t compressLength;
+
+	printTestName("d592eb82_inflate() ring wrap");
+	srandom(3);
+
+	// Random bytes repeated with a period of almost the whole window
+	periodic = malloc(length);
+	memcpy(periodic, input, TEST_RING_PERIOD);
+
+	for (uint32_t i=TEST_RING_PERIOD; i < length; i++) {
+		periodic[i] = periodic[i - TEST_RING_PERIOD];
+	}
+
+	compressed = deflateInput(periodic, length, Z_BEST_COMPRESSION, Z_DEFAULT_STRATEGY, &compressLength);
+
+	positiveTestBool("  repeats are backrefs\t\t\t", true, compressLength < 2 * TEST_RING_PERIOD);
+	positiveTestBool("  pulled output matches\t\t\t", true, inflatePull(compressed, compressLength, 0, periodic, length, &status));
+	positiveTestBool("  fed output matches\t\t\t", true, inflateFeed(compressed, compressLength, TEST_MAX_SPLIT, periodic, length, &status));
+
+	free(compressed);
+	free(periodic);
+
+	printf("\n");
+}
+
+static void testInflate_truncated(uint8_t *input, uint32_t length) {
+	InflationStatus status;
+	uint8_t *compressed;
+	uint32_t compressLength;
+	uint32_t cutList[5];
+	char label[64];
+	bool isInflated;
+
+	printTestName("d592eb82_inflate() truncated stream");
+	srandom(3);
+
+	for (int level=Z_NO_COMPRESSION; level <= Z_BEST_COMPRESSION; level += 6) {
+		compressed = deflateInput(input, length, level, Z_DEFAULT_STRATEGY, &compressLength);
+
+		cutList[0] = 1;
+		cutList[1] = 2;
+		cutList[2] = compressLength / 3;
+		cutList[3] = compressLength / 2;
+		cutList[4] = compressLength - 1;
+
+		for (uint32_t i=0; i < 5; i++) {
+			isInflated = inflatePull(compressed, cutList[i], 0, input, length, &status);
+			sprintf(label, "  level %d, %u bytes: NEED_INPUT\t", level, cutList[i]);
+			positiveTestBool(label, true, !isInflated && status == INFLATE_NEED_INPUT);
+
+			isInflated = inflateFeed(compressed, cutList[i], TEST_MAX_SPLIT, input, length, &status);
+			sprintf(label, "  level %d, %u bytes fed: NEED_INPUT\t", level, cutList[i]);
+			positiveTestBool(label, true, !isInflated && status == INFLATE_NEED_INPUT);
+		}
+
+		free(compressed);
+	}
+
+	printf("\n");
+}
+
+static void testInflate_corrupt(uint8_t *input, uint32_t length) {
+	static const uint8_t dictionary[] = "a preset dictionary the inflater never sees";
+	static uint8_t badBlockType[] = { 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	static uint8_t badStoredLength[] = { 0x01, 0x05, 0x00, 0xFA, 0xFE, 'h', 'e', 'l', 'l', 'o', 0, 0, 0, 0, 0, 0, 0, 0 };
+	InflationStatus status;
+	z_stream zStream;
+	uint8_t *compressed;
+	uint32_t compressLength;
+	bool isInflated;
+
+	printTestName("d592eb82_inflate() corrupt stream");
+	srandom(3);
+
+	// 1. BTYPE 11 is reserved
+	isInflated = inflatePull(badBlockType, 1, 0, input, length, &status);
+	positiveTestBool("  reserved block type: INPUT_ERROR\t", true, !isInflated && status == INFLATE_INPUT_ERROR);
+
+	// 2. NLEN of a stored block must be the complement of LEN
+	isInflated = inflatePull(badStoredLength, 10, 0, (uint8_t*) "hello", 5, &status);
+	positiveTestBool("  stored NLEN mismatch: INPUT_ERROR\t", true, !isInflated && status == INFLATE_INPUT_ERROR);
+
+	isInflated = inflateFeed(badStoredLength, 10, 3, (uint8_t*) "hello", 5, &status);
+	positiveTestBool("  fed NLEN mismatch: INPUT_ERROR\t", true, !isInflated && status == INFLATE_INPUT_ERROR);
+
+	// 3. Backrefs into a preset dictionary point before the start of the stream
+	memset(&zStream, 0, sizeof(z_stream));
+	deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	deflateSetDictionary(&zStream, dictionary, sizeof(dictionary) - 1);
+	compressed = malloc(256 + TEST_INPUT_PADDING);
+	memset(compressed, 0, 256 + TEST_INPUT_PADDING);
+
+	zStream.next_in = (uint8_t*) dictionary;
+	zStream.avail_in = sizeof(dictionary) - 1;
+	zStream.next_out = compressed;
+	zStream.avail_out = 256;
+	deflate(&zStream, Z_FINISH);
+	compressLength = zStream.total_out;
+	deflateEnd(&zStream);
+
+	isInflated = inflatePull(compressed, compressLength, 0, (uint8_t*) dictionary, sizeof(dictionary) - 1, &status);
+	positiveTestBool("  backref before start: INPUT_ERROR\t", true, !isInflated && status == INFLATE_INPUT_ERROR);
+
+	free(compressed);
+
+	printf("\n");
+}
+
+static void testInflate_feedOneByte(uint8_t *input, uint32_t length) {
+	InflationStatus status;
+	uint8_t *compressed;
+	uint32_t compressLength;
+	char label[64];
+
+	printTestName("d592eb82_inflateFeed() one byte at a time");
+
+	for (int level=Z_NO_COMPRESSION; level <= Z_BEST_COMPRESSION; level += 3) {
+		compressed = deflateInput(input, length, level, Z_DEFAULT_STRATEGY, &compressLength);
+
+		sprintf(label, "  level %d, %u one byte feeds\t", level, compressLength);
+		positiveTestBool(label, true, inflateFeed(compressed, compressLength, 1, input, length, &status));
+
+		free(compressed);
+	}
+
+	printf("\n");
+}
+
+static void testInflate_feedOutputFull(uint8_t *input, uint32_t length) {
+	Inflate inflate;
+	uint8_t *compressed;
+	uint32_t compressLength, outputOffset, numOutputFull;
+	char label[64];
+	bool isInflated, isEqual;
+
+	printTestName("d592eb82_inflateFeed() resume after OUTPUT_FULL");
+
+	for (int level=Z_NO_COMPRESSION; level <= Z_BEST_COMPRESSION; level += 9) {
+		compressed = deflateInput(input, length, level, Z_DEFAULT_STRATEGY, &compressLength);
+
+		// 1. Feed the whole stream at once; every chunk but the last comes back with OUTPUT_FULL
+		d592eb82_initInflate(&inflate, NULL, 0);
+		outputOffset = 0;
+		numOutputFull = 0;
+		isEqual = true;
+
+		isInflated = feedPiece(&inflate, compressed, compressLength, input, length, &outputOffset, &numOutputFull, &isEqual);
+
+		if (isInflated) {
+			isEqual &= isEqualChunk(&inflate, input, length, &outputOffset);
+		}
+
+		sprintf(label, "  level %d, OUTPUT_FULL count\t\t", level);
+		positiveTestInt(label, (length - 1) / INFLATE_OUTPUT_LENGTH, numOutputFull);
+
+		sprintf(label, "  level %d, resumed output matches\t", level);
+		positiveTestBool(label, true, isInflated && isEqual && outputOffset == length);
+
+		d592eb82_cleanUpInflate(&inflate);
+		free(compressed);
+	}
+
+	printf("\n");
+}
+
+static void testInflate_feedSplitHeader(uint8_t *input, uint32_t length) {
+	uint8_t *compressed;
+	uint64_t bitPos;
+	uint32_t compressLength, headerOffset, numOutputFull, blockType;
+	char label[64];
+	bool isValid;
+
+	printTestName("d592eb82_inflateFeed() split dynamic header");
+
+	compressed = deflateInput(input, length, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY, &compressLength);
+
+	for (uint32_t blockNum=0; blockNum < 2; blockNum++) {
+		bitPos = findBlockHeader(compressed, compressLength, length, blockNum);
+		headerOffset = bitPos >> 3;
+		blockType = ((compressed[headerOffset] | (compressed[headerOffset + 1] << 8)) >> ((bitPos & 0x07) + 1)) & 0x03;
+
+		sprintf(label, "  block %u is dynamic\t\t\t", blockNum);
+		positiveTestInt(label, 2, blockType);
+
+		// 1. The second header starts past the carry buffer, so the first piece is chained and not copied
+		if (blockNum > 0) {
+			positiveTestBool("  block 1 starts past the carry buffer\t", true, headerOffset > INFLATE_INPUT_LENGTH);
+		}
+
+		// 2. Cut the stream at every byte of the header; the cut off header is kept for the next piece
+		isValid = (blockNum == 0 || bitPos > 0);
+
+		for (uint32_t i=1; i <= TEST_HEADER_SPLITS && isValid; i++) {
+			isValid = inflateSplit(compressed, compressLength, headerOffset + i, input, length, &numOutputFull);
+		}
+
+		sprintf(label, "  block %u header cut at %u offsets\t", blockNum, TEST_HEADER_SPLITS);
+		positiveTestBool(label, true, isValid);
+	}
+
+	free(compressed);
+
+	printf("\n");
+}
+
+static void testInflate_fastLoop(char *inputName, uint8_t *input, uint32_t length) {
+	static const int strategyList[] = { Z_DEFAULT_STRATEGY, Z_FIXED };
+	InflationStatus status;
+	uint8_t *compressed, *fastOutput, *portableOutput;
+	uint32_t compressLength;
+	char label[64];
+	bool isFastLoop, isValid;
+
+	printf("d592eb82_setFastLoop(): %s input\n", inputName);
+	srandom(3);
+
+	positiveTestBool("  setFastLoop(false) = false\t\t", false, d592eb82_setFastLoop(false));
+	isFastLoop = d592eb82_setFastLoop(true);
+	printf("  BMI2 fast loop is %s\n", isFastLoop ? "supported" : "not supported");
+
+	for (uint32_t i=0; i < sizeof(strategyList) / sizeof(int); i++) {
+		for (int level=Z_BEST_SPEED; level <= Z_BEST_COMPRESSION; level += 4) {
+			compressed = deflateInput(input, length, level, strategyList[i], &compressLength);
+
+			// 1. Inflate with the fast loop, where supported, then with only the portable decoder
+			d592eb82_setFastLoop(true);
+			fastOutput = inflateOutput(compressed, compressLength, length);
+
+			d592eb82_setFastLoop(false);
+			portableOutput = inflateOutput(compressed, compressLength, length);
+			isValid = inflateFeed(compressed, compressLength, TEST_MAX_SPLIT, input, length, &status);
+
+			// 2. Both must match each other and the input
+			sprintf(label, "  %s level %d, outputs match\t", (i == 0) ? "dynamic" : "fixed", level);
+			positiveTestBool(label, true, memcmp(fastOutput, portableOutput, length) == 0
+			                              && memcmp(input, portableOutput, length) == 0);
+
+			sprintf(label, "  %s level %d, portable feed\t", (i == 0) ? "dynamic" : "fixed", level);
+			positiveTestBool(label, true, isValid);
+
+			free(portableOutput);
+			free(fastOutput);
+			free(compressed);
+		}
+	}
+
+	d592eb82_setFastLoop(true);
+
+	printf("\n");
+}
+
+static void testInflate_crc32(uint8_t *input, uint32_t length) {
+	static const uint32_t sizeList[] = {
+		0, 1, INFLATE_OUTPUT_LENGTH - 1, INFLATE_OUTPUT_LENGTH, INFLATE_OUTPUT_LENGTH + 1, INFLATE_RING_SIZE - 1,
+		INFLATE_RING_SIZE, INFLATE_RING_SIZE + 1, 3 * INFLATE_RING_SIZE + 1
+	};
+	static const int levelList[] = { Z_NO_COMPRESSION, Z_DEFAULT_COMPRESSION };
+	FileBuffer fileBuffer;
+	Inflate inflate;
+	InflationStatus status;
+	uint8_t *compressed;
+	uint32_t compressLength, outputOffset, size;
+	uLong expectedCrc32;
+	char label[64];
+	bool isInflated, isValid;
+
+	printTestName("Inflate crc32 versus b7e0468d_crc32()");
+	srandom(3);
+
+	for (uint32_t i=0; i < sizeof(levelList) / sizeof(int); i++) {
+		for (uint32_t j=0; j < sizeof(sizeList) / sizeof(uint32_t) && sizeList[j] <= length; j++) {
+			size = sizeList[j];
+			compressed = deflateInput(input, size, levelList[i], Z_DEFAULT_STRATEGY, &compressLength);
+
+			// 1. The CRC-32 covers exactly the output handed out so far, chunk by chunk
+			ce97d170_initFileBuffer(&fileBuffer, compressed);
+			fileBuffer.numBytes = compressLength;
+			d592eb82_initInflate(&inflate, &fileBuffer, compressLength);
+			outputOffset = 0;
+			expectedCrc32 = crc32(0, NULL, 0);
+			isValid = true;
+
+			do {
+				isInflated = d592eb82_inflate(&inflate);
+
+				if (isInflated || inflate.status == INFLATE_OUTPUT_FULL) {
+					expectedCrc32 = crc32(expectedCrc32, inflate.output, inflate.outputLength);
+					isValid &= isEqualChunk(&inflate, input, size, &outputOffset) && inflate.crc32 == expectedCrc32;
+				}
+			} while (!isInflated && inflate.status == INFLATE_OUTPUT_FULL);
+
+			isValid &= isInflated && inflate.crc32 == b7e0468d_crc32(input, size, 0);
+			d592eb82_cleanUpInflate(&inflate);
+
+			sprintf(label, "  %s %u bytes\t\t", (levelList[i] == 0) ? "stored" : "dynamic", size);
+			positiveTestBool(label, true, isValid);
+
+			// 2. The same with the input fed in random pieces
+			sprintf(label, "  %s %u bytes fed\t\t", (levelList[i] == 0) ? "stored" : "dynamic", size);
+			positiveTestBool(label, true, inflateFeed(compressed, compressLength, TEST_MAX_SPLIT, input, size, &status));
+
+			free(compressed);
+		}
+	}
+
+	printf("\n");
+}
+
+static void testInflate_inflateBuffer(uint8_t *input, uint32_t length) {
+	static const char garbage[] = "trailing garbage";
+	gz_header gzHeader;
+	uint8_t *raw, *zlib, *gzip, *secondMember, *gzipHeader, *gzipEmpty;
+	uint32_t rawLength, zlibLength, gzipLength, firstLength, gzipHeaderLength, gzipEmptyLength;
+
+	printTestName("d592eb82_inflateBuffer()");
+
+	// 1. One stream of each format, plus a gzip stream of two members
+	raw = deflateFormat(input, length, -MAX_WBITS, NULL, &rawLength);
+	zlib = deflateFormat(input, length, MAX_WBITS, NULL, &zlibLength);
+	gzip = deflateFormat(input, length / 3, MAX_WBITS + 16, NULL, &firstLength);
+	gzipEmpty = deflateFormat(input, 0, MAX_WBITS + 16, NULL, &gzipEmptyLength);
+
+	secondMember = deflateFormat(input + length / 3, length - length / 3, MAX_WBITS + 16, NULL, &gzipLength);
+	gzip = realloc(gzip, firstLength + gzipLength + TEST_TRAILER_SIZE);
+	memcpy(gzip + firstLength, secondMember, gzipLength + TEST_TRAILER_SIZE);
+	gzipLength += firstLength;
+	free(secondMember);
+
+	// A member with FEXTRA, FNAME, FCOMMENT and FHCRC
+	memset(&gzHeader, 0, sizeof(gz_header));
+	gzHeader.extra = (uint8_t*) "extra field";
+	gzHeader.extra_len = 11;
+	gzHeader.name = (uint8_t*) "testInflate.txt";
+	gzHeader.comment = (uint8_t*) "comment";
+	gzHeader.hcrc = 1;
+	gzipHeader = deflateFormat(input, length, MAX_WBITS + 16, &gzHeader, &gzipHeaderLength);
+
+	positiveTestBool("  raw\t\t\t\t\t", true, isInflatedBuffer(raw, rawLength, input, length, INFLATE_FORMAT_RAW, INFLATE_SUCCESS));
+	positiveTestBool("  zlib\t\t\t\t\t", true, isInflatedBuffer(zlib, zlibLength, input, length, INFLATE_FORMAT_ZLIB, INFLATE_SUCCESS));
+	positiveTestBool("  gzip, two members\t\t\t", true, isInflatedBuffer(gzip, gzipLength, input, length, INFLATE_FORMAT_GZIP, INFLATE_SUCCESS));
+	positiveTestBool("  gzip, optional header fields\t\t", true, isInflatedBuffer(gzipHeader, gzipHeaderLength, input, length, INFLATE_FORMAT_GZIP, INFLATE_SUCCESS));
+	positiveTestBool("  gzip, empty member\t\t\t", true, isInflatedBuffer(gzipEmpty, gzipEmptyLength, input, 0, INFLATE_FORMAT_GZIP, INFLATE_SUCCESS));
+
+	// 2. The output buffer is one byte short
+	positiveTestBool("  raw, short output: OUTPUT_FULL\t", true, isInflatedBuffer(raw, rawLength, input, length - 1, INFLATE_FORMAT_RAW, INFLATE_OUTPUT_FULL));
+
+	// 3. The trailer is cut off
+	positiveTestBool("  zlib, cut off: NEED_INPUT\t\t", true, isInflatedBuffer(zlib, zlibLength - 1, input, length, INFLATE_FORMAT_ZLIB, INFLATE_NEED_INPUT));
+	positiveTestBool("  gzip, cut off: NEED_INPUT\t\t", true, isInflatedBuffer(gzip, gzipLength - 1, input, length, INFLATE_FORMAT_GZIP, INFLATE_NEED_INPUT));
+
+	// 4. Data after the end of the stream is ignored
+	memcpy(raw + rawLength, garbage, sizeof(garbage));
+	memcpy(zlib + zlibLength, garbage, sizeof(garbage));
+	memcpy(gzip + gzipLength, garbage, sizeof(garbage));
+
+	positiveTestBool("  raw, trailing garbage\t\t\t", true, isInflatedBuffer(raw, rawLength + sizeof(garbage), input, length, INFLATE_FORMAT_RAW, INFLATE_SUCCESS));
+	positiveTestBool("  zlib, trailing garbage\t\t", true, isInflatedBuffer(zlib, zlibLength + sizeof(garbage), input, length, INFLATE_FORMAT_ZLIB, INFLATE_SUCCESS));
+	positiveTestBool("  gzip, trailing garbage\t\t", true, isInflatedBuffer(gzip, gzipLength + sizeof(garbage), input, length, INFLATE_FORMAT_GZIP, INFLATE_SUCCESS));
+
+	// 5. Corrupt Adler-32, CRC-32 of the first member, ISIZE of the last member, and FHCRC
+	zlib[zlibLength - 1] ^= 0x01;
+	gzip[firstLength - 8] ^= 0x01;
+	raw[0] = 0x07;
+	gzipHeader[gzipHeaderLength - 1] ^= 0x01;
+
+	positiveTestBool("  zlib, bad Adler-32: INPUT_ERROR\t", true, isInflatedBuffer(zlib, zlibLength, input, length, INFLATE_FORMAT_ZLIB, INFLATE_INPUT_ERROR));
+	positiveTestBool("  gzip, bad CRC-32: INPUT_ERROR\t\t", true, isInflatedBuffer(gzip, gzipLength, input, length, INFLATE_FORMAT_GZIP, INFLATE_INPUT_ERROR));
+	positiveTestBool("  gzip, bad ISIZE: INPUT_ERROR\t\t", true, isInflatedBuffer(gzipHeader, gzipHeaderLength, input, length, INFLATE_FORMAT_GZIP, INFLATE_INPUT_ERROR));
+	positiveTestBool("  raw, bad block type: INPUT_ERROR\t", true, isInflatedBuffer(raw, rawLength, input, length, INFLATE_FORMAT_RAW, INFLATE_INPUT_ERROR));
+
+	// The FHCRC follows the 10 byte header, FEXTRA, FNAME and FCOMMENT
+	gzipHeader[gzipHeaderLength - 1] ^= 0x01;
+	gzipHeader[10 + 2 + 11 + 16 + 8] ^= 0x01;
+	positiveTestBool("  gzip, bad FHCRC: INPUT_ERROR\t\t", true, isInflatedBuffer(gzipHeader, gzipHeaderLength, input, length, INFLATE_FORMAT_GZIP, INFLATE_INPUT_ERROR));
+
+	free(raw);
+	free(zlib);
+	free(gzip);
+	free(gzipHeader);
+	free(gzipEmpty);
+
+	printf("\n");
+}
@@ -0,0 +1,319 @@
+/*
+ * testLz4.c - DevOpsBroker C source file for testing org/devopsbroker/compress/lz4.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * LZ4 blocks and frames are round-tripped over text, random and zero input,
+ * with the frames fed to the decoder in small chunks, and malformed input is
+ * checked to fail. The compression ratio and throughput in GB/s are compared
+ * against Deflate at levels 1 and 6.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "org/devopsbroker/compress/deflate.h"
+#include "org/devopsbroker/compress/inflate.h"
+#include "org/devopsbroker/compress/lz4.h"
+#include "org/devopsbroker/hash/xxhash.h"
+#include "org/devopsbroker/lang/error.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE   (4 * 1024 * 1024)
+#define TEST_CHUNK_SIZE   7777
+#define TEST_FEED_SIZE    1000
+#define TEST_NUM_REPEATS  5
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef struct TestSink {
+	uint8_t *buffer;
+	uint32_t length;
+	uint32_t size;
+} TestSink;
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static bool appendToSink(void *sinkData, void *buffer, uint32_t length);
+static bool lz4Frame(uint8_t *input, uint32_t length, TestSink *frame);
+static bool unLz4Frame(TestSink *frame, uint32_t feedSize, TestSink *output);
+static void testLz4_xxHash(uint8_t *input);
+static void testLz4_roundTrip(char *inputName, uint8_t *input, uint32_t length);
+static void testLz4_malformed(uint8_t *input);
+static void testLz4_benchmark(uint8_t *input, uint32_t length);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	uint8_t *textInput, *randomInput, *zeroInput;
+
+	textInput = createTextInput(TEST_INPUT_SIZE);
+	randomInput = createRandomInput(TEST_INPUT_SIZE / 4, 2);
+	zeroInput = calloc(TEST_INPUT_SIZE / 4, 1);
+
+	testLz4_xxHash(textInput);
+	testLz4_roundTrip("text", textInput, TEST_INPUT_SIZE);
+	testLz4_roundTrip("random", randomInput, TEST_INPUT_SIZE / 4);
+	testLz4_roundTrip("zero", zeroInput, TEST_INPUT_SIZE / 4);
+	testLz4_roundTrip("single byte", textInput, 1);
+	testLz4_malformed(textInput);
+	testLz4_benchmark(textInput, TEST_INPUT_SIZE);
+
+	free(textInput);
+	free(randomInput);
+	free(zeroInput);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static bool appendToSink(void *sinkData, void *buffer, uint32_t length) {
+	TestSink *sink = sinkData;
+
+	if (sink->length + length > sink->size) {
+		sink->size = (sink->length + length) * 2;
+		sink->buffer = realloc(sink->buffer, sink->size);
+	}
+
+	memcpy(sink->buffer + sink->length, buffer, length);
+	sink->length += length;
+
+	return true;
+}
+
+static bool lz4Frame(uint8_t *input, uint32_t length, TestSink *frame) {
+	Lz4Encoder encoder;
+	uint32_t offset, numBytes;
+	bool isValid = true;
+
+	memset(frame, 0, sizeof(TestSink));
+	aa7e0bd8_initLz4Encoder(&encoder, appendToSink, frame);
+
+	offset = 0;
+	do {
+		numBytes = (length - offset > TEST_CHUNK_SIZE) ? TEST_CHUNK_SIZE : length - offset;
+		isValid &= aa7e0bd8_lz4Compress(&encoder, input + offset, numBytes, offset + numBytes == length);
+		offset += numBytes;
+	} while (offset < length);
+
+	isValid &= (encoder.totalIn == length && encoder.totalOut == frame->length);
+	aa7e0bd8_cleanUpLz4Encoder(&encoder);
+
+	return isValid;
+}
+
+static bool unLz4Frame(TestSink *frame, uint32_t feedSize, TestSink *output) {
+	Lz4Decoder decoder;
+	uint32_t offset, numBytes;
+	bool isDone = false;
+
+	memset(output, 0, sizeof(TestSink));
+	aa7e0bd8_initLz4Decoder(&decoder, appendToSink, output);
+
+	for (offset = 0; offset < frame->length; offset += numBytes) {
+		numBytes = (frame->length - offset > feedSize) ? feedSize : frame->length - offset;
+		isDone = aa7e0bd8_lz4Feed(&decoder, frame->buffer + offset, numBytes);
+
+		if (!isDone && decoder.status != INFLATE_NEED_INPUT) {
+			break;
+		}
+	}
+
+	aa7e0bd8_cleanUpLz4Decoder(&decoder);
+
+	return isDone;
+}
+
+static void testLz4_xxHash(uint8_t *input) {
+	XXHash32 xxHash;
+	uint32_t offset;
+
+	printTestName("e0ee98a1_xxHash32()");
+
+	positiveTestBool("  empty input\t\t\t\t", true, e0ee98a1_xxHash32("", 0, 0) == 0x02CC5D05);
+	positiveTestBool("  \"abc\"\t\t\t\t\t", true, e0ee98a1_xxHash32("abc", 3, 0) == 0x32D153FF);
+
+	e0ee98a1_initXXHash32(&xxHash, 1);
+
+	for (offset = 0; offset + 37 <= 100000; offset += 37) {
+		e0ee98a1_updateXXHash32(&xxHash, input + offset, 37);
+	}
+
+	positiveTestBool("  37 byte chunks\t\t\t", true,
+	                 e0ee98a1_digestXXHash32(&xxHash) == e0ee98a1_xxHash32(input, offset, 1));
+
+	printf("\n");
+}
+
+static void testLz4_roundTrip(char *inputName, uint8_t *input, uint32_t length) {
+	TestSink frame, output;
+	char testName[64];
+	uint8_t *block, *blockOutput;
+	uint32_t blockLength;
+	bool isValid;
+
+	snprintf(testName, sizeof(testName), "aa7e0bd8_lz4(): %s input", inputName);
+	printTestName(testName);
+
+	// 1. Block
+	block = malloc(LZ4_COMPRESS_BOUND(length));
+	blockOutput = malloc(length);
+	blockLength = aa7e0bd8_compressBlock(input, length, block, LZ4_COMPRESS_BOUND(length));
+
+	isValid = (blockLength > 0 && aa7e0bd8_decompressBlock(block, blockLength, blockOutput, length) == (int32_t) length
+	           && memcmp(input, blockOutput, length) == 0);
+	positiveTestBool("  block\t\t\t\t\t", true, isValid);
+	positiveTestBool("  block, output one byte short\t\t", true,
+	                 aa7e0bd8_decompressBlock(block, blockLength, blockOutput, length - 1) == SYSTEM_ERROR_CODE);
+
+	// 2. Frame, fed whole and in small chunks
+	isValid = lz4Frame(input, length, &frame);
+	positiveTestBool("  frame\t\t\t\t\t", true, isValid);
+
+	isValid = unLz4Frame(&frame, frame.length, &output) && output.length == length
+	          && memcmp(input, output.buffer, length) == 0;
+	positiveTestBool("  frame fed whole\t\t\t", true, isValid);
+	free(output.buffer);
+
+	isValid = unLz4Frame(&frame, TEST_FEED_SIZE, &output) && output.length == length
+	          && memcmp(input, output.buffer, length) == 0;
+	positiveTestBool("  frame fed in small chunks\t\t", true, isValid);
+	free(output.buffer);
+
+	free(frame.buffer);
+	free(block);
+	free(blockOutput);
+
+	printf("\n");
+}
+
+static void testLz4_malformed(uint8_t *input) {
+	TestSink frame, output;
+	uint8_t block[64];
+	uint32_t blockLength;
+
+	printTestName("aa7e0bd8_lz4(): malformed input");
+
+	// 1. Offset past the start of the output
+	blockLength = aa7e0bd8_compressBlock("abcdabcdabcdabcdabcdabcd", 24, block, sizeof(block));
+	block[6] = 0xFF;
+	positiveTestBool("  block offset out of range\t\t", true,
+	                 aa7e0bd8_decompressBlock(block, blockLength, block + 32, 32) == SYSTEM_ERROR_CODE);
+	positiveTestBool("  empty block\t\t\t\t", true,
+	                 aa7e0bd8_decompressBlock(block, 0, block + 32, 32) == SYSTEM_ERROR_CODE);
+
+	// 2. Corrupt content checksum and truncated frame
+	lz4Frame(input, 100000, &frame);
+	frame.buffer[frame.length - 1] ^= 0x01;
+	positiveTestBool("  frame content checksum\t\t", false, unLz4Frame(&frame, TEST_FEED_SIZE, &output));
+	free(output.buffer);
+
+	frame.length -= 5;
+	positiveTestBool("  frame cut off\t\t\t\t", false, unLz4Frame(&frame, TEST_FEED_SIZE, &output));
+	free(output.buffer);
+
+	frame.buffer[0] ^= 0x01;
+	positiveTestBool("  frame magic number\t\t\t", false, unLz4Frame(&frame, TEST_FEED_SIZE, &output));
+	free(output.buffer);
+	free(frame.buffer);
+
+	printf("\n");
+}
+
+static void testLz4_benchmark(uint8_t *input, uint32_t length) {
+	static const int levelList[] = { 1, 6 };
+	OutputBuffer outputBuffer;
+	OutputBuffer *bufPtr;
+	Deflate deflate;
+	uint8_t *compressed, *output;
+	uint32_t compressLength, numProduced;
+	double startTime, compressTime, decompressTime;
+
+	printTestName("aa7e0bd8_lz4() versus a8a82d35_deflate()");
+
+	compressed = malloc(LZ4_COMPRESS_BOUND(length));
+	output = malloc(length);
+
+	// 1. LZ4 block
+	compressTime = decompressTime = 1e9;
+
+	for (uint32_t i=0; i < TEST_NUM_REPEATS; i++) {
+		startTime = getSeconds();
+		compressLength = aa7e0bd8_compressBlock(input, length, compressed, LZ4_COMPRESS_BOUND(length));
+		startTime = getSeconds() - startTime;
+		compressTime = (startTime < compressTime) ? startTime : compressTime;
+
+		startTime = getSeconds();
+		aa7e0bd8_decompressBlock(compressed, compressLength, output, length);
+		startTime = getSeconds() - startTime;
+		decompressTime = (startTime < decompressTime) ? startTime : decompressTime;
+	}
+
+	printf("  lz4:       ratio %.2f, compress %.2f GB/s, decompress %.2f GB/s\n",
+	       (double) length / compressLength, length / compressTime / 1e9, length / decompressTime / 1e9);
+
+	// 2. Deflate, inflated from one contiguous buffer
+	for (uint32_t i=0; i < sizeof(levelList) / sizeof(int); i++) {
+		c49f5b0d_initOutputBuffer(&outputBuffer);
+		a8a82d35_initDeflate(&deflate, levelList[i], &outputBuffer);
+
+		startTime = getSeconds();
+		a8a82d35_deflate(&deflate, input, length, true);
+		compressTime = getSeconds() - startTime;
+
+		compressLength = 0;
+		for (bufPtr = &outputBuffer; bufPtr != NULL; bufPtr = bufPtr->next) {
+			memcpy(compressed + compressLength, bufPtr->buffer, bufPtr->length);
+			compressLength += bufPtr->length;
+		}
+
+		startTime = getSeconds();
+		d592eb82_inflateBuffer(compressed, compressLength, output, length, &numProduced, INFLATE_FORMAT_RAW);
+		decompressTime = getSeconds() - startTime;
+
+		printf("  deflate %d:  ratio %.2f, compress %.2f GB/s, decompress %.2f GB/s\n", levelList[i],
+		       (double) length / compressLength, length / compressTime / 1e9, length / decompressTime / 1e9);
+
+		a8a82d35_cleanUpDeflate(&deflate);
+		c49f5b0d_cleanUpOutputBuffer(&outputBuffer);
+	}
+
+	positiveTestBool("  round trip\t\t\t\t", true, memcmp(input, output, length) == 0);
+
+	free(compressed);
+	free(output);
+
+	printf("\n");
+}
@@ -0,0 +1,534 @@
+/*
+ * testZipArchive.c - DevOpsBroker C source file for testing org/devopsbroker/compress/ziparchive.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-46
+ *
+ * Writes stored and deflated archives with ZipWriter, extracts them and checks
+ * every extracted file against the original bytes. The entry sizes exercise
+ * O_DIRECT writes only, the buffered tail only, and both together. The test
+ * and list modes are run on the same archives before and after a byte of the
+ * entry data is corrupted. ZipReader looks the entries up through the
+ * Central Directory and through the sidecar index, which is rejected and
+ * rebuilt once it is corrupt, cut off or older than the archive. An archive
+ * with more entries than the End of Central Directory record can count needs
+ * Zip64 records, checked with unzip -t and read back with ZipReader.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "org/devopsbroker/compress/ziparchive.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE  (3 * 1024 * 1024)
+#define TEST_NUM_FILES   10
+
+// Offsets of the magic and numSlots fields of the sidecar index header
+#define TEST_INDEX_MAGIC_OFFSET     0
+#define TEST_INDEX_NUMSLOTS_OFFSET  36
+
+// One entry more than the 16-bit entry count of the End of Central Directory record
+#define TEST_ZIP64_NUM_ENTRIES  65536
+#define TEST_ZIP64_ENTRY_SIZE   100
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+// Empty, tail only, a single 512 byte sector, whole chunks, and chunks plus a tail
+static const uint32_t testFileSizes[TEST_NUM_FILES] = {
+	0, 1, 511, 512, 4096, 32768, 65536 + 4095, 98304 + 777, 1048576 + 1, TEST_INPUT_SIZE
+};
+
+static char testDirName[] = "/tmp/testZipArchive.XXXXXX";
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static void writeTestFile(char *fileName, uint8_t *data, uint32_t length);
+static bool isEqualTestFile(char *fileName, uint8_t *data, uint32_t length);
+static bool writeTestArchive(char *zipName, uint8_t *input, int level);
+static bool isExtractedArchive(char *outputDir, uint8_t *input);
+static void flipTestByte(char *fileName, long offset);
+static void corruptTestFile(char *fileName);
+static bool isReadEntries(ZipReader *zipReader, uint8_t *input);
+static int openTestReader(ZipReader *zipReader, AIOContext *aioContext, char *zipName, char *indexName, uint8_t *input);
+static int removeTestPath(const char *pathName, const struct stat *fileStatus, int typeFlag, struct FTW *ftwBuf);
+
+static void testZipArchive_unzip(char *inputName, uint8_t *input, int level, uint32_t numThreads);
+static void testZipArchive_test(char *inputName, uint8_t *input, int level, uint32_t numThreads);
+static void testZipArchive_list(char *inputName, uint8_t *input, int level);
+static void testZipArchive_zipReader(uint8_t *input);
+static void testZipArchive_zipIndex(uint8_t *input);
+static void testZipArchive_zip64(uint8_t *input);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	uint8_t *textInput, *randomInput;
+
+	textInput = createTextInput(TEST_INPUT_SIZE);
+	randomInput = createRandomInput(TEST_INPUT_SIZE, 5);
+
+	mkdtemp(testDirName);
+
+	testZipArchive_unzip("text", textInput, 0, 1);
+	testZipArchive_unzip("text", textInput, 6, 1);
+	testZipArchive_unzip("random", randomInput, 6, 1);
+	testZipArchive_unzip("text", textInput, 6, 4);
+	testZipArchive_test("text", textInput, 6, 1);
+	testZipArchive_test("random", randomInput, 0, 4);
+	testZipArchive_list("text", textInput, 6);
+	testZipArchive_zipReader(textInput);
+	testZipArchive_zipIndex(textInput);
+	testZipArchive_zip64(textInput);
+
+	nftw(testDirName, removeTestPath, 16, FTW_DEPTH | FTW_PHYS);
+
+	free(textInput);
+	free(randomInput);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static void writeTestFile(char *fileName, uint8_t *data, uint32_t length) {
+	FILE *file;
+
+	file = fopen(fileName, "w");
+	fwrite(data, 1, length, file);
+	fclose(file);
+}
+
+static bool isEqualTestFile(char *fileName, uint8_t *data, uint32_t length) {
+	uint8_t *fileData;
+	FILE *file;
+	size_t numBytes;
+	bool isEqual;
+
+	file = fopen(fileName, "r");
+
+	if (file == NULL) {
+		return false;
+	}
+
+	// Read one byte more than expected to catch files that are too long
+	fileData = malloc(length + 1);
+	numBytes = fread(fileData, 1, length + 1, file);
+	isEqual = (numBytes == length && memcmp(data, fileData, length) == 0);
+
+	free(fileData);
+	fclose(file);
+
+	return isEqual;
+}
+
+static bool writeTestArchive(char *zipName, uint8_t *input, int level) {
+	AIOContext aioContext;
+	ZipWriter zipWriter;
+	char pathName[128];
+	char entryName[32];
+	bool isValid;
+
+	f1207515_initAIOContext(&aioContext, 64);
+
+	if (!ce667b0d_initZipWriter(&zipWriter, &aioContext, zipName, level)) {
+		f1207515_cleanUpAIOContext(&aioContext);
+		return false;
+	}
+
+	// Each file is a different length prefix of the same input
+	isValid = true;
+
+	for (uint32_t i=0; i < TEST_NUM_FILES; i++) {
+		sprintf(entryName, "file%u.bin", i);
+		sprintf(pathName, "%s/%s", testDirName, entryName);
+
+		writeTestFile(pathName, input, testFileSizes[i]);
+		isValid &= ce667b0d_addFile(&zipWriter, pathName, entryName);
+		unlink(pathName);
+	}
+
+	ce667b0d_closeZipWriter(&zipWriter);
+	ce667b0d_cleanUpZipWriter(&zipWriter);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	return isValid;
+}
+
+static bool isExtractedArchive(char *outputDir, uint8_t *input) {
+	char pathName[128];
+	bool isValid = true;
+
+	for (uint32_t i=0; i < TEST_NUM_FILES && isValid; i++) {
+		sprintf(pathName, "%s/file%u.bin", outputDir, i);
+		isValid = isEqualTestFile(pathName, input, testFileSizes[i]);
+	}
+
+	return isValid;
+}
+
+static void flipTestByte(char *fileName, long offset) {
+	FILE *file;
+	int value;
+
+	file = fopen(fileName, "r+");
+
+	fseek(file, offset, SEEK_SET);
+	value = fgetc(file);
+	fseek(file, offset, SEEK_SET);
+	fputc(value ^ 0xFF, file);
+
+	fclose(file);
+}
+
+static void corruptTestFile(char *fileName) {
+	struct stat fileStatus;
+
+	// The middle of every test archive is inside the data of the largest entry
+	stat(fileName, &fileStatus);
+	flipTestByte(fileName, fileStatus.st_size / 2);
+}
+
+static bool isReadEntries(ZipReader *zipReader, uint8_t *input) {
+	FileHeader *fileHeader;
+	uint8_t *output;
+	char entryName[32];
+	bool isValid;
+
+	output = malloc(TEST_INPUT_SIZE);
+	isValid = true;
+
+	// Every entry is found by name and reads back as its prefix of the input
+	for (uint32_t i=0; i < TEST_NUM_FILES && isValid; i++) {
+		sprintf(entryName, "file%u.bin", i);
+		fileHeader = ce667b0d_findEntry(zipReader, entryName);
+
+		isValid = (fileHeader != NULL)
+		       && fileHeader->uncompressSize == testFileSizes[i]
+		       && ce667b0d_readEntry(zipReader, fileHeader, output, TEST_INPUT_SIZE)
+		       && memcmp(input, output, testFileSizes[i]) == 0
+		       && ce667b0d_streamEntry(zipReader, fileHeader, NULL, NULL);
+	}
+
+	free(output);
+
+	// Names that are not in the archive are not found
+	return isValid
+	       && ce667b0d_findEntry(zipReader, "file10.bin") == NULL
+	       && ce667b0d_findEntry(zipReader, "file1.bi") == NULL
+	       && ce667b0d_findEntry(zipReader, "") == NULL;
+}
+
+static int openTestReader(ZipReader *zipReader, AIOContext *aioContext, char *zipName, char *indexName, uint8_t *input) {
+	int status;
+
+	// 0 if the open fails, 1 if the Central Directory was loaded, and 2 if the sidecar index was mapped
+	if (!ce667b0d_openZipReaderIndex(zipReader, aioContext, zipName, indexName)) {
+		return 0;
+	}
+
+	status = (zipReader->indexData == NULL) ? 1 : 2;
+
+	if (!isReadEntries(zipReader, input)) {
+		status = 0;
+	}
+
+	ce667b0d_closeZipReader(zipReader);
+
+	return status;
+}
+
+static int removeTestPath(const char *pathName, const struct stat *fileStatus, int typeFlag, struct FTW *ftwBuf) {
+	return remove(pathName);
+}
+
+static void testZipArchive_unzip(char *inputName, uint8_t *input, int level, uint32_t numThreads) {
+	AIOContext aioContext;
+	ZipArchive zipArchive;
+	char zipName[64];
+	char outputDir[64];
+	char label[96];
+
+	sprintf(label, "ce667b0d_unzipParallel(%s, level %d, %u thread%s)", inputName, level, numThreads, (numThreads == 1) ? "" : "s");
+	printTestName(label);
+
+	sprintf(zipName, "%s/test.zip", testDirName);
+	sprintf(outputDir, "%s/output", testDirName);
+
+	positiveTestBool("  ZipWriter adds every file\t\t", true, writeTestArchive(zipName, input, level));
+
+	// Extract into a fresh output directory
+	nftw(outputDir, removeTestPath, 16, FTW_DEPTH | FTW_PHYS);
+	mkdir(outputDir, 0755);
+
+	f1207515_initAIOContext(&aioContext, 64);
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	zipArchive.outputDir = outputDir;
+
+	ce667b0d_unzipParallel(&zipArchive, numThreads);
+
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	positiveTestBool("  Extracted files match the input\t", true, isExtractedArchive(outputDir, input));
+
+	unlink(zipName);
+
+	printf("\n");
+}
+
+static void testZipArchive_test(char *inputName, uint8_t *input, int level, uint32_t numThreads) {
+	AIOContext aioContext;
+	ZipArchive zipArchive;
+	char zipName[64];
+	char label[96];
+	bool isValid;
+
+	sprintf(label, "ce667b0d_testParallel(%s, level %d, %u thread%s)", inputName, level, numThreads, (numThreads == 1) ? "" : "s");
+	printTestName(label);
+
+	sprintf(zipName, "%s/test.zip", testDirName);
+	positiveTestBool("  ZipWriter adds every file\t\t", true, writeTestArchive(zipName, input, level));
+
+	// 1. Every entry of the archive verifies
+	f1207515_initAIOContext(&aioContext, 64);
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	isValid = ce667b0d_testParallel(&zipArchive, numThreads);
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+
+	positiveTestBool("  testParallel() is true\t\t", true, isValid);
+
+	// 2. One flipped byte of entry data fails the test
+	corruptTestFile(zipName);
+
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	isValid = ce667b0d_testParallel(&zipArchive, numThreads);
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	positiveTestBool("  corrupt entry, testParallel() is false\t", false, isValid);
+
+	unlink(zipName);
+
+	printf("\n");
+}
+
+static void testZipArchive_list(char *inputName, uint8_t *input, int level) {
+	AIOContext aioContext;
+	ZipArchive zipArchive;
+	char zipName[64];
+	char label[96];
+	bool isValid;
+
+	sprintf(label, "ce667b0d_list(%s, level %d)", inputName, level);
+	printTestName(label);
+
+	sprintf(zipName, "%s/test.zip", testDirName);
+	positiveTestBool("  ZipWriter adds every file\t\t", true, writeTestArchive(zipName, input, level));
+
+	// 1. The whole Central Directory is listed
+	f1207515_initAIOContext(&aioContext, 64);
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	isValid = ce667b0d_list(&zipArchive);
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+
+	positiveTestBool("  list() is true\t\t\t", true, isValid);
+
+	// 2. The entry data is never read, so a corrupt entry is still listed
+	corruptTestFile(zipName);
+
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	isValid = ce667b0d_list(&zipArchive);
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+
+	positiveTestBool("  corrupt entry, list() is true\t\t", true, isValid);
+
+	// 3. A file without an End of Central Directory record is not listed
+	writeTestFile(zipName, input, 4096);
+
+	ce667b0d_initZipArchive(&zipArchive, &aioContext, zipName);
+	isValid = ce667b0d_list(&zipArchive);
+	ce667b0d_cleanUpZipArchive(&zipArchive);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	positiveTestBool("  not a Zip archive, list() is false\t", false, isValid);
+
+	unlink(zipName);
+
+	printf("\n");
+}
+
+static void testZipArchive_zipReader(uint8_t *input) {
+	AIOContext aioContext;
+	ZipReader zipReader;
+	char zipName[64];
+	bool isValid;
+
+	printTestName("ce667b0d_openZipReader()");
+
+	sprintf(zipName, "%s/test.zip", testDirName);
+	positiveTestBool("  ZipWriter adds every file\t\t", true, writeTestArchive(zipName, input, 6));
+
+	// The entries are looked up in the HashMap of the Central Directory
+	f1207515_initAIOContext(&aioContext, 64);
+	isValid = ce667b0d_openZipReader(&zipReader, &aioContext, zipName);
+
+	if (isValid) {
+		isValid = isReadEntries(&zipReader, input);
+		ce667b0d_closeZipReader(&zipReader);
+	}
+
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	positiveTestBool("  findEntry() and readEntry()\t\t", true, isValid);
+
+	unlink(zipName);
+
+	printf("\n");
+}
+
+static void testZipArchive_zipIndex(uint8_t *input) {
+	AIOContext aioContext;
+	ZipReader zipReader;
+	char zipName[64];
+	char indexName[64];
+
+	printTestName("ce667b0d_openZipReaderIndex()");
+
+	sprintf(zipName, "%s/test.zip", testDirName);
+	sprintf(indexName, "%s/test.zip.idx", testDirName);
+	positiveTestBool("  ZipWriter adds every file\t\t", true, writeTestArchive(zipName, input, 6));
+
+	f1207515_initAIOContext(&aioContext, 64);
+
+	// 1. The first open builds the sidecar index and the second one maps it
+	positiveTestInt("  no index, Central Directory loaded\t", 1, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+	positiveTestBool("  index file written\t\t\t", true, access(indexName, F_OK) == 0);
+	positiveTestInt("  index mapped\t\t\t\t", 2, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+
+	// 2. An index with a corrupt header is rejected and rebuilt
+	flipTestByte(indexName, TEST_INDEX_MAGIC_OFFSET);
+	positiveTestInt("  bad magic rejected\t\t\t", 1, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+	positiveTestInt("  rebuilt index mapped\t\t\t", 2, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+
+	flipTestByte(indexName, TEST_INDEX_NUMSLOTS_OFFSET);
+	positiveTestInt("  bad numSlots rejected\t\t", 1, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+	positiveTestInt("  rebuilt index mapped\t\t\t", 2, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+
+	// 3. A cut off index is rejected and rebuilt
+	truncate(indexName, 100);
+	positiveTestInt("  cut off index rejected\t\t", 1, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+	positiveTestInt("  rebuilt index mapped\t\t\t", 2, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+
+	// 4. An index built before the archive was rewritten is stale
+	writeTestArchive(zipName, input, 1);
+	positiveTestInt("  stale index rejected\t\t\t", 1, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+	positiveTestInt("  rebuilt index mapped\t\t\t", 2, openTestReader(&zipReader, &aioContext, zipName, indexName, input));
+
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	unlink(indexName);
+	unlink(zipName);
+
+	printf("\n");
+}
+
+static void testZipArchive_zip64(uint8_t *input) {
+	AIOContext aioContext;
+	ZipWriter zipWriter;
+	ZipReader zipReader;
+	FileHeader *fileHeader;
+	uint8_t output[TEST_ZIP64_ENTRY_SIZE];
+	char zipName[64];
+	char pathName[64];
+	char entryName[32];
+	char command[128];
+	bool isValid;
+
+	printTestName("ce667b0d_closeZipWriter(65536 entries)");
+
+	sprintf(zipName, "%s/zip64.zip", testDirName);
+	sprintf(pathName, "%s/entry.txt", testDirName);
+
+	// 1. Every entry is the same small file under a different name
+	writeTestFile(pathName, input, TEST_ZIP64_ENTRY_SIZE);
+	f1207515_initAIOContext(&aioContext, 64);
+
+	isValid = ce667b0d_initZipWriter(&zipWriter, &aioContext, zipName, 6);
+
+	if (isValid) {
+		for (uint32_t i=0; i < TEST_ZIP64_NUM_ENTRIES; i++) {
+			sprintf(entryName, "entry%05u.txt", i);
+			isValid &= ce667b0d_addFile(&zipWriter, pathName, entryName);
+		}
+
+		ce667b0d_closeZipWriter(&zipWriter);
+		ce667b0d_cleanUpZipWriter(&zipWriter);
+	}
+
+	unlink(pathName);
+	positiveTestBool("  ZipWriter adds every file\t\t", true, isValid);
+
+	// 2. unzip only finds every entry through the Zip64 End of Central Directory record
+	sprintf(command, "unzip -tqq %s", zipName);
+	positiveTestInt("  unzip -t exits with 0\t\t", 0, system(command));
+
+	// 3. ZipReader loads every entry and reads back the first and the last one
+	isValid = ce667b0d_openZipReader(&zipReader, &aioContext, zipName);
+
+	if (isValid) {
+		isValid = (zipReader.fileHeaderList.length == TEST_ZIP64_NUM_ENTRIES);
+
+		for (uint32_t i=0; i < TEST_ZIP64_NUM_ENTRIES && isValid; i += TEST_ZIP64_NUM_ENTRIES - 1) {
+			sprintf(entryName, "entry%05u.txt", i);
+			fileHeader = ce667b0d_findEntry(&zipReader, entryName);
+
+			isValid = (fileHeader != NULL)
+			       && ce667b0d_readEntry(&zipReader, fileHeader, output, TEST_ZIP64_ENTRY_SIZE)
+			       && memcmp(input, output, TEST_ZIP64_ENTRY_SIZE) == 0;
+		}
+
+		ce667b0d_closeZipReader(&zipReader);
+	}
+
+	positiveTestBool("  ZipReader reads every entry\t\t", true, isValid);
+
+	f1207515_cleanUpAIOContext(&aioContext);
+	unlink(zipName);
+
+	printf("\n");
+}
@@ -0,0 +1,230 @@
+/*
+ * testDirectory.c - DevOpsBroker C source file for testing org/devopsbroker/fs/directory.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * Creates nested and repeated paths through a DirCache, and has two workers
+ * with a DirCache each race to create the same directory tree so that every
+ * mkdirat() lost to the other worker fails with EEXIST.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ftw.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "org/devopsbroker/fs/directory.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_NUM_WORKERS   2
+#define TEST_NUM_ROUNDS    8
+#define TEST_NUM_SUBDIRS   32
+#define TEST_NUM_LEAVES    4
+
+// The race root, its subdirectories, and the leaves of every subdirectory
+#define TEST_NUM_RACE_DIRS  (1 + TEST_NUM_SUBDIRS + (TEST_NUM_SUBDIRS * TEST_NUM_LEAVES))
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+/*
+ * RaceWorker
+ *   - DirCache of the worker, never shared with the other worker
+ *   - Barrier both workers wait on before they start
+ *   - Round number naming the race root directory
+ */
+typedef struct RaceWorker {
+	DirCache           dirCache;
+	pthread_barrier_t *barrier;
+	pthread_t          thread;
+	uint32_t           round;
+} RaceWorker;
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+static char testDirName[] = "/tmp/testDirectory.XXXXXX";
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static bool isDirectory(char *pathName);
+static void *runRaceWorker(void *raceWorkerPtr);
+static bool isRaceTree(uint32_t round);
+static int removeTestPath(const char *pathName, const struct stat *fileStatus, int typeFlag, struct FTW *ftwBuf);
+
+static void testDirectory_makeCachedDirectory();
+static void testDirectory_race();
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	// Every path is relative to the temporary directory
+	mkdtemp(testDirName);
+	chdir(testDirName);
+
+	testDirectory_makeCachedDirectory();
+	testDirectory_race();
+
+	chdir("/");
+	nftw(testDirName, removeTestPath, 16, FTW_DEPTH | FTW_PHYS);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static bool isDirectory(char *pathName) {
+	struct stat fileStatus;
+
+	return stat(pathName, &fileStatus) == 0 && S_ISDIR(fileStatus.st_mode);
+}
+
+static void *runRaceWorker(void *raceWorkerPtr) {
+	RaceWorker *raceWorker;
+	char pathName[64];
+
+	raceWorker = (RaceWorker *) raceWorkerPtr;
+	pthread_barrier_wait(raceWorker->barrier);
+
+	// Both workers create the same paths in the same order to collide as often as possible
+	for (uint32_t i=0; i < TEST_NUM_SUBDIRS; i++) {
+		for (uint32_t j=0; j < TEST_NUM_LEAVES; j++) {
+			sprintf(pathName, "race%u/dir%u/leaf%u/file.txt", raceWorker->round, i, j);
+			d0059b5b_makeCachedDirectory(&raceWorker->dirCache, pathName, 0755, true);
+		}
+	}
+
+	return NULL;
+}
+
+static bool isRaceTree(uint32_t round) {
+	char pathName[64];
+	bool isValid;
+
+	sprintf(pathName, "race%u", round);
+	isValid = isDirectory(pathName);
+
+	for (uint32_t i=0; i < TEST_NUM_SUBDIRS && isValid; i++) {
+		for (uint32_t j=0; j < TEST_NUM_LEAVES && isValid; j++) {
+			sprintf(pathName, "race%u/dir%u/leaf%u", round, i, j);
+			isValid = isDirectory(pathName);
+		}
+	}
+
+	return isValid;
+}
+
+static int removeTestPath(const char *pathName, const struct stat *fileStatus, int typeFlag, struct FTW *ftwBuf) {
+	return remove(pathName);
+}
+
+static void testDirectory_makeCachedDirectory() {
+	DirCache dirCache;
+	char pathName[64];
+	FILE *file;
+
+	printTestName("d0059b5b_makeCachedDirectory()");
+	d0059b5b_initDirCache(&dirCache);
+
+	// 1. Every directory of a nested path is created and cached, but not the filename
+	strcpy(pathName, "a/b/c/file.txt");
+	positiveTestBool("  a/b/c/file.txt creates a/b/c\t\t", true, d0059b5b_makeCachedDirectory(&dirCache, pathName, 0755, true));
+	positiveTestBool("  a/b/c is a directory\t\t\t", true, isDirectory("a/b/c"));
+	positiveTestBool("  a/b/c/file.txt does not exist\t\t", false, access("a/b/c/file.txt", F_OK) == 0);
+	positiveTestInt("  three directories cached\t\t", 3, dirCache.dirList.length);
+
+	// 2. A repeated path is found in the cache and creates nothing
+	positiveTestBool("  a/b/c/file.txt again creates nothing\t", false, d0059b5b_makeCachedDirectory(&dirCache, pathName, 0755, true));
+	positiveTestInt("  still three directories cached\t", 3, dirCache.dirList.length);
+
+	// 3. A sibling only adds the last directory; trailing slashes are ignored
+	strcpy(pathName, "a/b/d//");
+	positiveTestBool("  a/b/d// creates a/b/d\t\t\t", true, d0059b5b_makeCachedDirectory(&dirCache, pathName, 0755, false));
+	positiveTestBool("  a/b/d is a directory\t\t\t", true, isDirectory("a/b/d"));
+	positiveTestInt("  four directories cached\t\t", 4, dirCache.dirList.length);
+
+	// 4. Directories made outside the DirCache fail with EEXIST and are cached all the same
+	mkdir("x", 0755);
+	mkdir("x/y", 0755);
+
+	strcpy(pathName, "x/y/z/file.txt");
+	positiveTestBool("  x/y/z/file.txt creates x/y/z\t\t", true, d0059b5b_makeCachedDirectory(&dirCache, pathName, 0755, true));
+	positiveTestBool("  x/y/z is a directory\t\t\t", true, isDirectory("x/y/z"));
+	positiveTestInt("  seven directories cached\t\t", 7, dirCache.dirList.length);
+
+	// 5. A file in the way of a directory fails without caching the directory below it
+	file = fopen("blocker", "w");
+	fclose(file);
+
+	strcpy(pathName, "blocker/sub/file.txt");
+	positiveTestBool("  blocker/sub/file.txt fails\t\t", false, d0059b5b_makeCachedDirectory(&dirCache, pathName, 0755, true));
+	positiveTestBool("  blocker/sub does not exist\t\t", false, access("blocker/sub", F_OK) == 0);
+
+	d0059b5b_cleanUpDirCache(&dirCache);
+
+	printf("\n");
+}
+
+static void testDirectory_race() {
+	RaceWorker workerList[TEST_NUM_WORKERS];
+	pthread_barrier_t barrier;
+	bool isValid;
+
+	printTestName("d0059b5b_makeCachedDirectory(2 workers)");
+
+	isValid = true;
+
+	for (uint32_t round=0; round < TEST_NUM_ROUNDS && isValid; round++) {
+		// 1. Start both workers on the same race root at the same time
+		pthread_barrier_init(&barrier, NULL, TEST_NUM_WORKERS);
+
+		for (uint32_t i=0; i < TEST_NUM_WORKERS; i++) {
+			d0059b5b_initDirCache(&workerList[i].dirCache);
+			workerList[i].barrier = &barrier;
+			workerList[i].round = round;
+			pthread_create(&workerList[i].thread, NULL, runRaceWorker, &workerList[i]);
+		}
+
+		// 2. A directory lost to EEXIST is cached like one the worker created itself
+		for (uint32_t i=0; i < TEST_NUM_WORKERS; i++) {
+			pthread_join(workerList[i].thread, NULL);
+			isValid &= (workerList[i].dirCache.dirList.length == TEST_NUM_RACE_DIRS);
+			d0059b5b_cleanUpDirCache(&workerList[i].dirCache);
+		}
+
+		pthread_barrier_destroy(&barrier);
+		isValid &= isRaceTree(round);
+	}
+
+	positiveTestBool("  every directory created and cached\t", true, isValid);
+
+	printf("\n");
+}
@@ -0,0 +1,214 @@
+/*
+ * testCrc32.c - DevOpsBroker C source file for testing org/devopsbroker/hash/crc32.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-51
+ *
+ * Every CRC-32 implementation is checked against the standard check value and
+ * against each other over random lengths, alignments and chunk splits, and the
+ * throughput of each implementation is reported in GB/s. Combined and parallel
+ * CRC-32 values are checked against a single pass over the same data.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "org/devopsbroker/hash/crc32.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_INPUT_SIZE     (16 * 1024 * 1024)
+#define TEST_RANDOM_LENGTH  5000
+#define TEST_NUM_RANDOM     2000
+#define TEST_NUM_REPEATS    5
+#define TEST_MAX_THREADS    8
+
+#define CRC32_CHECK_VALUE   0xCBF43926
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+typedef uint32_t (*Crc32Function)(void *buffer, uint32_t length, uint32_t crc32);
+
+typedef struct Crc32Variant {
+	char *name;
+	Crc32Function function;
+} Crc32Variant;
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+static Crc32Variant variantList[] = {
+	{ "b7e0468d_crc32()",         b7e0468d_crc32 },
+	{ "b7e0468d_crc32Pclmul()",   b7e0468d_crc32Pclmul },
+	{ "b7e0468d_crc32Slice16()",  b7e0468d_crc32Slice16 },
+	{ "b7e0468d_crc32HalfByte()", b7e0468d_crc32HalfByte }
+};
+
+#define NUM_VARIANTS  (sizeof(variantList) / sizeof(Crc32Variant))
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static void testCrc32_checkValue();
+static void testCrc32_variants(uint8_t *input);
+static void testCrc32_benchmark(uint8_t *input, uint32_t length);
+static void testCrc32_combine(uint8_t *input);
+static void testCrc32_parallel(uint8_t *input, uint32_t length);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	// The Half-Byte implementation reads up to eight bytes past the end, which the padding covers
+	uint8_t *input = createRandomInput(TEST_INPUT_SIZE, 1);
+
+	testCrc32_checkValue();
+	testCrc32_variants(input);
+	testCrc32_benchmark(input, TEST_INPUT_SIZE);
+	testCrc32_combine(input);
+	testCrc32_parallel(input, TEST_INPUT_SIZE);
+
+	free(input);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static void testCrc32_checkValue() {
+	char checkInput[16] = "123456789";
+	char label[64];
+
+	printTestName("CRC-32 check value of \"123456789\"");
+
+	for (uint32_t i=0; i < NUM_VARIANTS; i++) {
+		sprintf(label, "  %-28s\t", variantList[i].name);
+		positiveTestBool(label, true, variantList[i].function(checkInput, 9, 0) == CRC32_CHECK_VALUE);
+	}
+
+	printf("\n");
+}
+
+static void testCrc32_variants(uint8_t *input) {
+	uint32_t offset, length, split, expected, crc32;
+	char label[64];
+	bool isValid;
+
+	printTestName("CRC-32 random lengths, alignments and chunks");
+
+	for (uint32_t i=1; i < NUM_VARIANTS; i++) {
+		isValid = true;
+		srandom(2);
+
+		for (uint32_t j=0; j < TEST_NUM_RANDOM && isValid; j++) {
+			offset = random() % 64;
+			length = random() % TEST_RANDOM_LENGTH;
+			split = (length == 0) ? 0 : random() % length;
+
+			expected = b7e0468d_crc32Slice16(input + offset, length, 0);
+
+			crc32 = variantList[i].function(input + offset, split, 0);
+			crc32 = variantList[i].function(input + offset + split, length - split, crc32);
+
+			isValid = (crc32 == expected);
+		}
+
+		sprintf(label, "  %-28s\t", variantList[i].name);
+		positiveTestBool(label, true, isValid);
+	}
+
+	printf("\n");
+}
+
+static void testCrc32_benchmark(uint8_t *input, uint32_t length) {
+	double startTime, elapsedTime, bestTime;
+
+	printTestName("CRC-32 throughput");
+
+	for (uint32_t i=0; i < NUM_VARIANTS; i++) {
+		bestTime = 1e9;
+
+		for (int j=0; j < TEST_NUM_REPEATS; j++) {
+			startTime = getSeconds();
+			variantList[i].function(input, length, 0);
+			elapsedTime = getSeconds() - startTime;
+
+			if (elapsedTime < bestTime) {
+				bestTime = elapsedTime;
+			}
+		}
+
+		printf("  %-28s %6.2f GB/s\n", variantList[i].name, length / bestTime / 1e9);
+	}
+
+	printf("\n");
+}
+
+static void testCrc32_combine(uint8_t *input) {
+	uint32_t lengthA, lengthB, crcA, crcB;
+	bool isValid = true;
+
+	printTestName("b7e0468d_crc32Combine()");
+	srandom(3);
+
+	for (uint32_t i=0; i < TEST_NUM_RANDOM && isValid; i++) {
+		lengthA = random() % TEST_RANDOM_LENGTH;
+		lengthB = random() % TEST_RANDOM_LENGTH;
+
+		crcA = b7e0468d_crc32(input, lengthA, 0);
+		crcB = b7e0468d_crc32(input + lengthA, lengthB, 0);
+
+		isValid = (b7e0468d_crc32Combine(crcA, crcB, lengthB) == b7e0468d_crc32(input + lengthA, lengthB, crcA));
+	}
+
+	positiveTestBool("  random block pairs\t\t\t", true, isValid);
+	positiveTestBool("  empty second block\t\t\t", true, b7e0468d_crc32Combine(CRC32_CHECK_VALUE, 0, 0) == CRC32_CHECK_VALUE);
+
+	printf("\n");
+}
+
+static void testCrc32_parallel(uint8_t *input, uint32_t length) {
+	double startTime, elapsedTime;
+	uint32_t expected, crc32;
+	char label[64];
+
+	printTestName("b7e0468d_crc32Parallel()");
+	expected = b7e0468d_crc32(input + 1, length - 1, 0);
+
+	for (uint32_t numThreads=1; numThreads <= TEST_MAX_THREADS; numThreads *= 2) {
+		startTime = getSeconds();
+		crc32 = b7e0468d_crc32Parallel(input + 1, length - 1, 0, numThreads);
+		elapsedTime = getSeconds() - startTime;
+
+		sprintf(label, "  %u threads, %6.2f GB/s\t\t", numThreads, length / elapsedTime / 1e9);
+		positiveTestBool(label, true, crc32 == expected);
+	}
+
+	crc32 = b7e0468d_crc32Parallel(input + 1, length - 1, b7e0468d_crc32(input, 1, 0), 3);
+	positiveTestBool("  chained from a prior CRC-32\t\t", true, crc32 == b7e0468d_crc32(input, length, 0));
+
+	printf("\n");
+}
@@ -0,0 +1,204 @@
+/*
+ * testFileBuffer.c - DevOpsBroker C source file for testing org/devopsbroker/io/filebuffer.h
+ *
+ * Copyright (C) 2020 Edward Smith <edwardsmith@devopsbroker.org>
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -----------------------------------------------------------------------------
+ * Developed on Ubuntu 18.04.4 LTS running kernel.osrelease = 5.3.0-46
+ *
+ * Checks the I/O unit selected for each preferred I/O size and reads an
+ * unaligned file through a FileBufferList in 4KB, 32KB and 2MB units.
+ * -----------------------------------------------------------------------------
+ */
+
+// ════════════════════════════ Feature Test Macros ═══════════════════════════
+
+#define _GNU_SOURCE
+
+// ═════════════════════════════════ Includes ═════════════════════════════════
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "org/devopsbroker/io/filebuffer.h"
+#include "org/devopsbroker/lang/memory.h"
+#include "org/devopsbroker/memory/hugepagepool.h"
+#include "org/devopsbroker/memory/pagepool.h"
+#include "org/devopsbroker/memory/slabpool.h"
+#include "org/devopsbroker/test/testinput.h"
+#include "org/devopsbroker/test/unittest.h"
+
+// ═══════════════════════════════ Preprocessor ═══════════════════════════════
+
+#define TEST_FILE_SIZE  (5 * 1024 * 1024 + 1234)
+
+// ═════════════════════════════════ Typedefs ═════════════════════════════════
+
+
+// ═════════════════════════════ Global Variables ═════════════════════════════
+
+
+// ════════════════════════════ Function Prototypes ═══════════════════════════
+
+static void testFileBuffer_setPreferredIOSize();
+static void testFileBuffer_readFileBufferList(char *fileName, uint8_t *input, uint32_t ioSize);
+static void testFileBuffer_readFileBuffer(char *fileName, uint8_t *input);
+
+// ══════════════════════════════════ main() ══════════════════════════════════
+
+int main(int argc, char *argv[]) {
+	char fileName[] = "/tmp/testFileBuffer.XXXXXX";
+	uint8_t *input;
+	FILE *file;
+	int fd;
+
+	input = createRandomInput(TEST_FILE_SIZE, 4);
+
+	fd = mkstemp(fileName);
+	file = fdopen(fd, "w");
+	fwrite(input, 1, TEST_FILE_SIZE, file);
+	fclose(file);
+
+	testFileBuffer_setPreferredIOSize();
+	testFileBuffer_readFileBufferList(fileName, input, MEMORY_PAGE_SIZE);
+	testFileBuffer_readFileBufferList(fileName, input, SLABPOOL_SLAB_SIZE);
+	testFileBuffer_readFileBufferList(fileName, input, HUGEPAGEPOOL_REGION_SIZE);
+	testFileBuffer_readFileBuffer(fileName, input);
+
+	unlink(fileName);
+	free(input);
+
+	// Exit with success
+	exit(EXIT_SUCCESS);
+}
+
+// ═════════════════════════ Function Implementations ═════════════════════════
+
+static void testFileBuffer_setPreferredIOSize() {
+	FileBufferList bufferList;
+
+	printTestName("ce97d170_setPreferredIOSize()");
+	ce97d170_initFileBufferList(&bufferList);
+
+	positiveTestInt("  Default ioSize = 4096\t\t\t", MEMORY_PAGE_SIZE, bufferList.ioSize);
+	positiveTestInt("  setPreferredIOSize(0) = 4096\t\t", MEMORY_PAGE_SIZE, ce97d170_setPreferredIOSize(&bufferList, 0));
+	positiveTestInt("  setPreferredIOSize(4096) = 4096\t", MEMORY_PAGE_SIZE, ce97d170_setPreferredIOSize(&bufferList, 4096));
+	positiveTestInt("  setPreferredIOSize(4097) = 32768\t", SLABPOOL_SLAB_SIZE, ce97d170_setPreferredIOSize(&bufferList, 4097));
+	positiveTestInt("  setPreferredIOSize(32768) = 32768\t", SLABPOOL_SLAB_SIZE, ce97d170_setPreferredIOSize(&bufferList, 32768));
+	positiveTestInt("  setPreferredIOSize(32769) = 2097152\t", HUGEPAGEPOOL_REGION_SIZE, ce97d170_setPreferredIOSize(&bufferList, 32769));
+	positiveTestInt("  setPreferredIOSize(2097152) = 2097152\t", HUGEPAGEPOOL_REGION_SIZE, ce97d170_setPreferredIOSize(&bufferList, 2097152));
+	positiveTestInt("  bufferList.ioSize = 2097152\t\t", HUGEPAGEPOOL_REGION_SIZE, bufferList.ioSize);
+	printf("\n");
+
+	// Each I/O size frees its buffers back to the pool it acquired them from
+	ce97d170_setPreferredIOSize(&bufferList, 4096);
+	positiveTestVoid("  getFreeBuffer(4096) = releasePage\t", f502a409_releasePage, ce97d170_getFreeBuffer(&bufferList));
+	ce97d170_setPreferredIOSize(&bufferList, 32768);
+	positiveTestVoid("  getFreeBuffer(32768) = releaseSlab\t", b426145b_releaseSlab, ce97d170_getFreeBuffer(&bufferList));
+	ce97d170_setPreferredIOSize(&bufferList, 2097152);
+	positiveTestVoid("  getFreeBuffer(2097152) = releaseRegion\t", e65fff63_releaseRegion, ce97d170_getFreeBuffer(&bufferList));
+
+	ce97d170_cleanUpFileBufferList(&bufferList, ce97d170_getFreeBuffer(&bufferList));
+
+	printf("\n");
+}
+
+static void testFileBuffer_readFileBufferList(char *fileName, uint8_t *input, uint32_t ioSize) {
+	FileBufferList bufferList;
+	AIOContext aioContext;
+	AIOFile aioFile;
+	FileBuffer *fileBuffer;
+	uint8_t *output;
+	char label[64];
+	bool isValid;
+
+	sprintf(label, "ce97d170_readFileBufferList(%u)", ioSize);
+	printTestName(label);
+
+	f1207515_initAIOContext(&aioContext, 64);
+	f1207515_initAIOFile(&aioContext, &aioFile, fileName);
+	f1207515_open(&aioFile, FOPEN_READONLY, 0);
+
+	ce97d170_initFileBufferList(&bufferList);
+	ce97d170_setPreferredIOSize(&bufferList, ioSize);
+	ce97d170_readFileBufferList(&aioFile, &bufferList, TEST_FILE_SIZE);
+
+	// 1. Every FileBuffer is one I/O unit; only the last one can be short
+	isValid = (bufferList.length == (TEST_FILE_SIZE + ioSize - 1) / ioSize);
+
+	for (uint32_t i=0; i < bufferList.length && isValid; i++) {
+		fileBuffer = bufferList.values[i];
+		isValid = (fileBuffer->fileOffset == (int64_t) i * ioSize)
+		       && (fileBuffer->numBytes == ioSize || i == bufferList.length - 1);
+	}
+
+	sprintf(label, "  FileBuffers are %u byte units\t", ioSize);
+	positiveTestBool(label, true, isValid);
+
+	// 2. The FileBuffers hold the file
+	output = malloc(TEST_FILE_SIZE);
+	fileBuffer = ce97d170_containsData(&bufferList, 0, TEST_FILE_SIZE);
+	isValid = (fileBuffer != NULL);
+
+	if (isValid) {
+		ce97d170_copyData(fileBuffer, output, TEST_FILE_SIZE);
+		isValid = (memcmp(input, output, TEST_FILE_SIZE) == 0);
+	}
+
+	positiveTestBool("  FileBufferList matches the file\t", true, isValid);
+
+	free(output);
+	ce97d170_cleanUpFileBufferList(&bufferList, ce97d170_getFreeBuffer(&bufferList));
+	f1207515_cleanUpAIOFile(&aioFile);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	printf("\n");
+}
+
+static void testFileBuffer_readFileBuffer(char *fileName, uint8_t *input) {
+	AIOContext aioContext;
+	AIOFile aioFile;
+	FileBuffer *fileBuffer;
+
+	printTestName("ce97d170_readFileBuffer()");
+
+	f1207515_initAIOContext(&aioContext, 64);
+	f1207515_initAIOFile(&aioContext, &aioFile, fileName);
+	f1207515_open(&aioFile, FOPEN_READONLY, 0);
+
+	// A length between the slab and region sizes reads a whole 2MB region
+	fileBuffer = ce97d170_readFileBuffer(&aioFile, SLABPOOL_SLAB_SIZE + 1);
+	positiveTestBool("  readFileBuffer(32769) != NULL\t\t", true, fileBuffer != NULL);
+
+	if (fileBuffer != NULL) {
+		positiveTestInt("  FileBuffer numBytes = 2097152\t\t", HUGEPAGEPOOL_REGION_SIZE, fileBuffer->numBytes);
+		positiveTestBool("  FileBuffer matches the file\t\t", true, memcmp(input, fileBuffer->buffer, fileBuffer->numBytes) == 0);
+
+		e65fff63_releaseRegion(fileBuffer->buffer);
+		ce97d170_releaseFileBuffer(fileBuffer);
+	}
+
+	// Anything larger than one region is rejected
+	positiveTestVoid("  readFileBuffer(2097153) = NULL\t", NULL, ce97d170_readFileBuffer(&aioFile, FILEBUFFER_MAX_IO_SIZE + 1));
+
+	f1207515_cleanUpAIOFile(&aioFile);
+	f1207515_cleanUpAIOContext(&aioContext);
+
+	printf("\n");
+}